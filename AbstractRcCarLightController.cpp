@@ -19,6 +19,13 @@
  * --------------------------------------------------------------------*/
 
 #include "AbstractRcCarLightController.h"
+#include "FootprintBudget.h"
+
+// the light status is passed by value every loop and has to fit into a register pair
+#ifdef CHECK_FOOTPRINT_BUDGET
+static_assert(sizeof(AbstractRcCarLightController::CarLightsStatus_t) <= FootprintBudget::CAR_LIGHTS_STATUS,
+              "CarLightsStatus_t exceeds its RAM budget, see FootprintBudget.h");
+#endif
 
 /**
  * contructor
@@ -21,14 +21,30 @@
 #ifndef ABSTRACTRCCARLIGHTCONTROLLER_H_
 #define ABSTRACTRCCARLIGHTCONTROLLER_H_
 
-class LightSwitchBehaviour;
-
 /**
  * Abstarct base class for RC car light output
  *
- * Is offers a public struct to store the light status of the supported light categories and provides a setup and loop
- * method.
- * Both methods (setupPins and loop) has to be overloaded by a concrete implementation class.
+ * Is offers a public struct to store the light status of the supported light categories. A concrete implementation
+ * class provides the methods
+ *
+ *     void setupPins(void)
+ *     void addBehaviour(LightType_t pLightType, Behaviour *pLightSwitchBehaviour)
+ *     void loop(CarLightsStatus_t pLightStatus)
+ *     void showFrame(void)
+ *     bool isSteady(void)
+ *
+ * and the constant SHOW_MICROS.
+ *
+ * setupPins configures the output pins and is called by the setup of RcCarLights. addBehaviour assigns a behaviour
+ * of the behaviour type of the controller (see BasicLightSwitchBehaviour) to a light type. loop passes the light
+ * status to the outputs and is called by the frames of RcCarLights. Outputs, which block the interrupts while they
+ * are updated (e.g. a NeoPixel strip), are updated by showFrame instead, which RcCarLights calls from its main loop
+ * while no RC pulse is measured; SHOW_MICROS is the duration in microseconds, for which showFrame blocks the
+ * interrupts. isSteady tells whether the outputs set by the last loop stay unchanged as long as the light status
+ * does not change; if not (e.g. during a fade of a light), loop has to be called again as soon as possible.
+ *
+ * The methods are not virtual: RcCarLights is instantiated with the type of its light controller and calls them
+ * directly, so the controller needs no vtable and small methods are inlined.
  */
 class AbstractRcCarLightController
 {
@@ -60,34 +76,7 @@ public:
     /**
      * destructor
      */
-    virtual ~AbstractRcCarLightController(void);
-
-    /**
-     * setup the pins.
-     *
-     * This method will be called from the general setup method of class RcCarLights.
-     * Overload this method to configure the output pins as required.
-     */
-    virtual void setupPins(void) = 0;
-
-    /**
-     * allows to add a behaviour for a specifc light type.
-     *
-     * @param pLightType lights type where a behaviour should be assigned
-     * @param pLightSwitchBehaviour behaviour, which influences the light switching
-     */
-    virtual void addBehaviour(LightType_t pLightType, LightSwitchBehaviour *pLightSwitchBehaviour) = 0;
-
-    /**
-     * provides the given light status to the output pins
-     *
-     * This method will be called by the general loop method of class RcCarLights.
-     * Overload this method to implement the specific need to pass the light status
-     * information to the required output pins of the arduino board.
-     *
-     * @param lightStatus current light status
-     */
-    virtual void loop(CarLightsStatus_t pLightStatus) = 0;
+    ~AbstractRcCarLightController(void);
 };
 
 
@@ -9,61 +9,58 @@
 
 #include "CamaroRcCarLightController.h"
 #include "XenonLightSwitchBehaviour.h"
+#include "FootprintBudget.h"
 
-#define NEO_PIXEL_COUNT 14
-
-typedef enum
-{
-    POSITION_MARKER_FRONT_LEFT_PIXEL = 0,
-    FOG_LAMP_LEFT_PIXEL,
-    BLINKER_FRONT_LEFT,
-    BLINKER_FRONT_RIGHT_PIXEL,
-    FOG_LAMP_RIGHT_PIXEL,
-    POSITION_MARKER_FRONT_RIGHT_PIXEL,
-    POSITION_MARKER_REAR_RIGHT_PIXEL,
-    BACK_LIGHT_ONE_RIGHT_PIXEL,
-    BACK_LIGHT_TWO_RIGHT_PIXEL,
-    BACKUP_LIGHT_RIGHT_PIXEL,
-    BACKUP_LIGHT_LEFT_PIXEL,
-    BACK_LIGHT_TWO_LEFT_PIXEL,
-    BACK_LIGHT_ONE_LEFT_PIXEL,
-    POSITION_MARKER_REAR_LEFT_PIXEL
-} NeoPixelPosition_t;
+/**
+ * mask of a single pixel
+ */
+#define PIXEL(pPosition) (1U << (pPosition))
 
+// pixels showing the back lights, which are switched by tail, brake and blinker lights
+#define BACK_LIGHT_PIXELS (PIXEL(BACK_LIGHT_ONE_RIGHT_PIXEL) | PIXEL(BACK_LIGHT_TWO_RIGHT_PIXEL) \
+        | PIXEL(BACK_LIGHT_TWO_LEFT_PIXEL) | PIXEL(BACK_LIGHT_ONE_LEFT_PIXEL))
+
+// colors are perceived brightness values, the output stage (see PixelOutputStage) converts them for the LEDs. At full
+// brightness they show the former raw values 16, 32, 48, 64, 96 and 128 as 16, 32, 48, 64, 95 and 127.
 const uint32_t BLACK_COLOR = Adafruit_NeoPixel::Color(0, 0, 0);
 
-const uint32_t FOG_LIGHT_COLOR = Adafruit_NeoPixel::Color(96, 96, 96);
+const uint32_t FOG_LIGHT_COLOR = Adafruit_NeoPixel::Color(172, 172, 172);
 
-const uint32_t BLINKER_FRONT_COLOR = Adafruit_NeoPixel::Color(128, 128, 0);
+const uint32_t BLINKER_FRONT_COLOR = Adafruit_NeoPixel::Color(193, 193, 0);
 
-const uint32_t SIDE_MARKER_FRONT_COLOR = Adafruit_NeoPixel::Color(32, 32, 0);
-const uint32_t SIDE_MARKER_FRONT_BLINKER_COLOR = Adafruit_NeoPixel::Color(128, 128, 0);
+const uint32_t SIDE_MARKER_FRONT_COLOR = Adafruit_NeoPixel::Color(111, 111, 0);
+const uint32_t SIDE_MARKER_FRONT_BLINKER_COLOR = Adafruit_NeoPixel::Color(193, 193, 0);
 
-const uint32_t SIDE_MARKER_REAR_COLOR = Adafruit_NeoPixel::Color(32, 0, 0);
-const uint32_t SIDE_MARKER_READ_BLINKER_COLOR = Adafruit_NeoPixel::Color(128, 0, 0);
+const uint32_t SIDE_MARKER_REAR_COLOR = Adafruit_NeoPixel::Color(111, 0, 0);
+const uint32_t SIDE_MARKER_READ_BLINKER_COLOR = Adafruit_NeoPixel::Color(193, 0, 0);
 
-const uint32_t BACKUP_LIGHT_COLOR = Adafruit_NeoPixel::Color(64, 48, 16);
+const uint32_t BACKUP_LIGHT_COLOR = Adafruit_NeoPixel::Color(147, 131, 84);
 
 const uint32_t BACK_LIGHT_BREAK_BLINKER_COLOR = Adafruit_NeoPixel::Color(255, 0, 0);
-const uint32_t BACK_LIGHT_COLOR = Adafruit_NeoPixel::Color(48, 0, 0);
+const uint32_t BACK_LIGHT_COLOR = Adafruit_NeoPixel::Color(131, 0, 0);
 
 /**
- * constructor
- * @param pPinParkingLight specifies pin used for parking light
- * @param pPinHeadlight specifies pin used for headlight
- * @param pPinNeoPixel specifies pin used for NeoPixel signal
+ * constructor, the pins are taken from the vehicle configuration
  */
-CamaroRcCarLightController::CamaroRcCarLightController(int pPinParkingLight, int pPinHeadlight, int pPinNeoPixel) :
-        mPinParkingLight(pPinParkingLight), mPinHeadlight(pPinHeadlight), mNeoPixelStrip(NEO_PIXEL_COUNT, pPinNeoPixel,
-        NEO_GRB + NEO_KHZ800), mheadlightBehaviour(
-        NULL)
+template<typename TConfig, typename TBehaviour>
+BasicCamaroRcCarLightController<TConfig, TBehaviour>::BasicCamaroRcCarLightController(void) :
+        mNeoPixelStrip(NEO_PIXEL_COUNT, TConfig::PIN_NEO_PIXEL, NEO_GRB + NEO_KHZ800), mheadlightBehaviour(
+        NULL), mAnimatedPixelCount(0), mIsFrameChanged(false), mPushedFrameCount(0), mSkippedFrameCount(0)
 {
+    for (uint8_t pixel = 0; pixel < NEO_PIXEL_COUNT; ++pixel)
+    {
+        mPixelBehaviours[pixel] = NULL;
+        mPixelLightTypes[pixel] = PARKING_LIGHT;
+        mPixelBrightness[pixel] = 0;
+        mFrame[pixel] = BLACK_COLOR;
+    }
 }
 
 /**
  * destructor
  */
-CamaroRcCarLightController::~CamaroRcCarLightController()
+template<typename TConfig, typename TBehaviour>
+BasicCamaroRcCarLightController<TConfig, TBehaviour>::~BasicCamaroRcCarLightController()
 {
 }
 
@@ -72,82 +69,396 @@ CamaroRcCarLightController::~CamaroRcCarLightController()
  *
  * The method has to be called during setup of the arduino sketch
  */
-void CamaroRcCarLightController::setupPins(void)
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::setupPins(void)
 {
-    pinMode(mPinParkingLight, OUTPUT);
-    pinMode(mPinHeadlight, OUTPUT);
+    pinMode(TConfig::PIN_PARKING_LIGHT, OUTPUT);
+    pinMode(TConfig::PIN_HEADLIGHT, OUTPUT);
 
     mNeoPixelStrip.begin();
     mNeoPixelStrip.show();
 }
 
 /**
- * allows to add a specific switch on/off behavior for a light type. At the moment only the head lights are supported.
+ * allows to add a specific switch on/off behavior for a light type. The headlights use the behaviour for their pin,
+ * all lights on the NeoPixel strip for their pixels. The parking lights are switched hard.
  * @param pLightType light type
  * @param pLightSwitchBehaviour the new switch behavior of the specified light type.
  */
-void CamaroRcCarLightController::addBehaviour(LightType_t pLightType, LightSwitchBehaviour *pLightSwitchBehaviour)
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::addBehaviour(LightType_t pLightType,
+                                                                        TBehaviour *pLightSwitchBehaviour)
 {
-    // only for headlights a special behaviour was supported by this controller
     if (HEADLIGHT == pLightType)
     {
         mheadlightBehaviour = pLightSwitchBehaviour;
     }
+    else
+    {
+        addPixelBehaviour(pLightType, getPixelMask(pLightType), pLightSwitchBehaviour);
+    }
+}
+
+/**
+ * attaches a behaviour to a group of the pixels showing a light type
+ *
+ * @param pLightType light type, which switches the behaviour
+ * @param pPixelMask pixels of the group, bit 1 << NeoPixelPosition_t per pixel
+ * @param pLightSwitchBehaviour behaviour or NULL to switch the pixels hard again
+ */
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::addPixelBehaviour(LightType_t pLightType,
+                                                                             uint16_t pPixelMask,
+                                                                             TBehaviour *pLightSwitchBehaviour)
+{
+    pPixelMask &= getPixelMask(pLightType);
+
+    mAnimatedPixelCount = 0;
+    for (uint8_t pixel = 0; pixel < NEO_PIXEL_COUNT; ++pixel)
+    {
+        if (pPixelMask & PIXEL(pixel))
+        {
+            mPixelBehaviours[pixel] = pLightSwitchBehaviour;
+            mPixelLightTypes[pixel] = pLightType;
+        }
+        if (mPixelBehaviours[pixel])
+        {
+            ++mAnimatedPixelCount;
+        }
+    }
 }
 
 /**
- *  sets the configured pins according to the light status
+ *  sets the configured pins according to the light status and calculates the frame of the NeoPixel strip. The
+ *  frame is shown by showFrame.
  *
  *   @param pLightStatus current light status of all the lights
  */
-void CamaroRcCarLightController::loop(CarLightsStatus_t pLightStatus)
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::loop(CarLightsStatus_t pLightStatus)
 {
+    // all behaviours of the frame use the same time
+    unsigned long now = millis();
+
     // angle eyes
-    digitalWrite(mPinParkingLight, pLightStatus.parkingLight ? HIGH : LOW);
+    digitalWrite(TConfig::PIN_PARKING_LIGHT, pLightStatus.parkingLight ? HIGH : LOW);
 
     // headlights
     if (mheadlightBehaviour)
     {
-        mheadlightBehaviour->setLightStatus(
-                pLightStatus.headlight ? LightSwitchBehaviour::ON : LightSwitchBehaviour::OFF);
-        analogWrite(mPinHeadlight, mheadlightBehaviour->getBrightness() * 2.55);
+        mheadlightBehaviour->setLightStatusAt(
+                pLightStatus.headlight ? LightSwitchBehaviour::ON : LightSwitchBehaviour::OFF, now);
+        analogWrite(TConfig::PIN_HEADLIGHT, mheadlightBehaviour->getBrightnessAt(now));
     }
     else
     {
-        digitalWrite(mPinHeadlight, pLightStatus.headlight ? HIGH : LOW);
+        digitalWrite(TConfig::PIN_HEADLIGHT, pLightStatus.headlight ? HIGH : LOW);
+    }
+
+    if (0 != mAnimatedPixelCount)
+    {
+        updatePixelBrightness(pLightStatus, now);
+    }
+
+    for (uint8_t pixel = 0; pixel < NEO_PIXEL_COUNT; ++pixel)
+    {
+        setPixelColor(pixel, mPixelBehaviours[pixel] ? getAnimatedPixelColor(pixel, pLightStatus) :
+                getPixelColor(pixel, pLightStatus));
+    }
+
+    // the strip is only updated if a pixel has changed, show() is left to the main loop as it blocks the interrupts
+    if (!mIsFrameChanged)
+    {
+        ++mSkippedFrameCount;
+    }
+}
+
+/**
+ * @return true if the headlight behaviour and all pixel behaviours (if any) are steady
+ */
+template<typename TConfig, typename TBehaviour>
+bool BasicCamaroRcCarLightController<TConfig, TBehaviour>::isSteady(void)
+{
+    unsigned long now = millis();
+
+    if (mheadlightBehaviour && !mheadlightBehaviour->isSteadyAt(now))
+    {
+        return false;
+    }
+
+    for (uint8_t pixel = 0; 0 != mAnimatedPixelCount && pixel < NEO_PIXEL_COUNT; ++pixel)
+    {
+        if (mPixelBehaviours[pixel] && !mPixelBehaviours[pixel]->isSteadyAt(now))
+        {
+            return false;
+        }
     }
+    return true;
+}
+
+/**
+ * Sets the status of all pixel behaviours and calculates the brightness of all animated pixels into
+ * mPixelBrightness. A behaviour shared by a group of pixels is evaluated once for consecutive pixels of the group.
+ *
+ * @param pLightStatus current light status
+ * @param pNow current time in msec
+ */
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::updatePixelBrightness(CarLightsStatus_t pLightStatus,
+                                                                                 unsigned long pNow)
+{
+    TBehaviour *previous = NULL;
+    uint8_t brightness = 0;
 
-    // position lights are always on or blink
-    mNeoPixelStrip.setPixelColor(POSITION_MARKER_FRONT_LEFT_PIXEL,
-                                 pLightStatus.leftBlinker ? SIDE_MARKER_FRONT_BLINKER_COLOR : SIDE_MARKER_FRONT_COLOR);
-    mNeoPixelStrip.setPixelColor(POSITION_MARKER_FRONT_RIGHT_PIXEL,
-                                 pLightStatus.rightBlinker ? SIDE_MARKER_FRONT_BLINKER_COLOR : SIDE_MARKER_FRONT_COLOR);
-    mNeoPixelStrip.setPixelColor(POSITION_MARKER_REAR_LEFT_PIXEL,
-                                 pLightStatus.leftBlinker ? SIDE_MARKER_READ_BLINKER_COLOR : SIDE_MARKER_REAR_COLOR);
-    mNeoPixelStrip.setPixelColor(POSITION_MARKER_REAR_RIGHT_PIXEL,
-                                 pLightStatus.rightBlinker ? SIDE_MARKER_READ_BLINKER_COLOR : SIDE_MARKER_REAR_COLOR);
+    for (uint8_t pixel = 0; pixel < NEO_PIXEL_COUNT; ++pixel)
+    {
+        TBehaviour *behaviour = mPixelBehaviours[pixel];
+        if (behaviour && behaviour != previous)
+        {
+            behaviour->setLightStatusAt(isLightOn(pLightStatus, (LightType_t) mPixelLightTypes[pixel]) ?
+                    LightSwitchBehaviour::ON : LightSwitchBehaviour::OFF, pNow);
+            brightness = behaviour->getBrightnessAt(pNow);
+            previous = behaviour;
+        }
+        mPixelBrightness[pixel] = brightness;
+    }
+}
 
-    // blinker front
-    mNeoPixelStrip.setPixelColor(BLINKER_FRONT_LEFT, pLightStatus.leftBlinker ? BLINKER_FRONT_COLOR : BLACK_COLOR);
+/**
+ * @param pPixel index of the pixel
+ * @param pLightStatus light status
+ * @return color of a pixel without behaviour for the light status
+ */
+template<typename TConfig, typename TBehaviour>
+uint32_t BasicCamaroRcCarLightController<TConfig, TBehaviour>::getPixelColor(uint16_t pPixel,
+                                                                             CarLightsStatus_t pLightStatus)
+{
+    switch (pPixel)
+    {
+        // position lights are always on or blink
+        case POSITION_MARKER_FRONT_LEFT_PIXEL:
+            return pLightStatus.leftBlinker ? SIDE_MARKER_FRONT_BLINKER_COLOR : SIDE_MARKER_FRONT_COLOR;
+        case POSITION_MARKER_FRONT_RIGHT_PIXEL:
+            return pLightStatus.rightBlinker ? SIDE_MARKER_FRONT_BLINKER_COLOR : SIDE_MARKER_FRONT_COLOR;
+        case POSITION_MARKER_REAR_LEFT_PIXEL:
+            return pLightStatus.leftBlinker ? SIDE_MARKER_READ_BLINKER_COLOR : SIDE_MARKER_REAR_COLOR;
+        case POSITION_MARKER_REAR_RIGHT_PIXEL:
+            return pLightStatus.rightBlinker ? SIDE_MARKER_READ_BLINKER_COLOR : SIDE_MARKER_REAR_COLOR;
 
-    mNeoPixelStrip.setPixelColor(BLINKER_FRONT_RIGHT_PIXEL,
-                                 pLightStatus.rightBlinker ? BLINKER_FRONT_COLOR : BLACK_COLOR);
+        // blinker front
+        case BLINKER_FRONT_LEFT:
+            return pLightStatus.leftBlinker ? BLINKER_FRONT_COLOR : BLACK_COLOR;
+        case BLINKER_FRONT_RIGHT_PIXEL:
+            return pLightStatus.rightBlinker ? BLINKER_FRONT_COLOR : BLACK_COLOR;
 
-    // back light, blinker and break light rear
-    mNeoPixelStrip.setPixelColor(BACK_LIGHT_ONE_LEFT_PIXEL, getBackLightColor(pLightStatus, pLightStatus.leftBlinker));
-    mNeoPixelStrip.setPixelColor(BACK_LIGHT_TWO_LEFT_PIXEL, getBackLightColor(pLightStatus, pLightStatus.leftBlinker));
+        // back light, blinker and break light rear
+        case BACK_LIGHT_ONE_LEFT_PIXEL:
+        case BACK_LIGHT_TWO_LEFT_PIXEL:
+            return getBackLightColor(pLightStatus, pLightStatus.leftBlinker);
+        case BACK_LIGHT_ONE_RIGHT_PIXEL:
+        case BACK_LIGHT_TWO_RIGHT_PIXEL:
+            return getBackLightColor(pLightStatus, pLightStatus.rightBlinker);
 
-    mNeoPixelStrip.setPixelColor(BACK_LIGHT_ONE_RIGHT_PIXEL,
-                                 getBackLightColor(pLightStatus, pLightStatus.rightBlinker));
-    mNeoPixelStrip.setPixelColor(BACK_LIGHT_TWO_RIGHT_PIXEL,
-                                 getBackLightColor(pLightStatus, pLightStatus.rightBlinker));
+        // back up light
+        case BACKUP_LIGHT_LEFT_PIXEL:
+        case BACKUP_LIGHT_RIGHT_PIXEL:
+            return pLightStatus.backUpLight ? BACKUP_LIGHT_COLOR : BLACK_COLOR;
 
-    // back up light
-    mNeoPixelStrip.setPixelColor(BACKUP_LIGHT_LEFT_PIXEL, pLightStatus.backUpLight ? BACKUP_LIGHT_COLOR : BLACK_COLOR);
+        // fog lamps are not used
+        default:
+            return BLACK_COLOR;
+    }
+}
 
-    mNeoPixelStrip.setPixelColor(BACKUP_LIGHT_RIGHT_PIXEL, pLightStatus.backUpLight ? BACKUP_LIGHT_COLOR : BLACK_COLOR);
+/**
+ * blends a color channel
+ *
+ * @param pOff channel with the light off
+ * @param pOn channel with the light on
+ * @param pScale weight of pOn, 0-256
+ */
+static inline uint32_t blendChannel(uint8_t pOff, uint8_t pOn, uint16_t pScale)
+{
+    return (pOn >= pOff) ? pOff + (((uint16_t) (pOn - pOff) * pScale) >> 8) :
+            pOff - (((uint16_t) (pOff - pOn) * pScale) >> 8);
+}
 
+/**
+ * The color of an animated pixel is blended between its color with the light type of its behaviour off and on,
+ * weighted by the brightness of the behaviour. All other lights keep their status, so e.g. a fading blinker on the
+ * back lights fades between tail light and brake light color.
+ *
+ * @param pPixel index of the pixel
+ * @param pLightStatus current light status
+ * @return color of a pixel including the brightness of its behaviour
+ */
+template<typename TConfig, typename TBehaviour>
+uint32_t BasicCamaroRcCarLightController<TConfig, TBehaviour>::getAnimatedPixelColor(uint16_t pPixel,
+                                                                                     CarLightsStatus_t pLightStatus)
+{
+    LightType_t lightType = (LightType_t) mPixelLightTypes[pPixel];
+    uint8_t brightness = mPixelBrightness[pPixel];
+
+    // most of the time the behaviour is steady at either end
+    if (0 == brightness || 255 == brightness)
+    {
+        setLightOn(pLightStatus, lightType, 0 != brightness);
+        return getPixelColor(pPixel, pLightStatus);
+    }
+
+    setLightOn(pLightStatus, lightType, false);
+    uint32_t offColor = getPixelColor(pPixel, pLightStatus);
+    setLightOn(pLightStatus, lightType, true);
+    uint32_t onColor = getPixelColor(pPixel, pLightStatus);
+
+    // 0-255 is scaled to 0-256, so full brightness is exactly the on color
+    uint16_t scale = brightness + (brightness >> 7);
+
+    return (blendChannel(offColor >> 16, onColor >> 16, scale) << 16)
+            | (blendChannel(offColor >> 8, onColor >> 8, scale) << 8)
+            | blendChannel(offColor, onColor, scale);
+}
+
+/**
+ * @return status of the light type within the light status
+ */
+template<typename TConfig, typename TBehaviour>
+bool BasicCamaroRcCarLightController<TConfig, TBehaviour>::isLightOn(CarLightsStatus_t pLightStatus,
+                                                                     LightType_t pLightType)
+{
+    switch (pLightType)
+    {
+        case PARKING_LIGHT:
+        case TAIL_LIGHT:
+            return pLightStatus.parkingLight;
+        case HEADLIGHT:
+            return pLightStatus.headlight;
+        case RIGHT_BLINKER:
+            return pLightStatus.rightBlinker;
+        case LEFT_BLINKER:
+            return pLightStatus.leftBlinker;
+        case BACKUP_LIGHT:
+            return pLightStatus.backUpLight;
+        case BRAKE_LIGHT:
+            return pLightStatus.brakeLight;
+    }
+    return false;
+}
+
+/**
+ * sets the status of the light type within the light status
+ */
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::setLightOn(CarLightsStatus_t &pLightStatus,
+                                                                      LightType_t pLightType, bool pIsOn)
+{
+    switch (pLightType)
+    {
+        case PARKING_LIGHT:
+        case TAIL_LIGHT:
+            pLightStatus.parkingLight = pIsOn;
+            break;
+        case HEADLIGHT:
+            pLightStatus.headlight = pIsOn;
+            break;
+        case RIGHT_BLINKER:
+            pLightStatus.rightBlinker = pIsOn;
+            break;
+        case LEFT_BLINKER:
+            pLightStatus.leftBlinker = pIsOn;
+            break;
+        case BACKUP_LIGHT:
+            pLightStatus.backUpLight = pIsOn;
+            break;
+        case BRAKE_LIGHT:
+            pLightStatus.brakeLight = pIsOn;
+            break;
+    }
+}
+
+/**
+ * @param pLightType light type
+ * @return mask of the pixels showing the light type, the parking lights and headlights use pins only
+ */
+template<typename TConfig, typename TBehaviour>
+uint16_t BasicCamaroRcCarLightController<TConfig, TBehaviour>::getPixelMask(LightType_t pLightType)
+{
+    switch (pLightType)
+    {
+        case TAIL_LIGHT:
+        case BRAKE_LIGHT:
+            return BACK_LIGHT_PIXELS;
+        case RIGHT_BLINKER:
+            return PIXEL(BLINKER_FRONT_RIGHT_PIXEL) | PIXEL(POSITION_MARKER_FRONT_RIGHT_PIXEL)
+                    | PIXEL(POSITION_MARKER_REAR_RIGHT_PIXEL) | PIXEL(BACK_LIGHT_ONE_RIGHT_PIXEL)
+                    | PIXEL(BACK_LIGHT_TWO_RIGHT_PIXEL);
+        case LEFT_BLINKER:
+            return PIXEL(BLINKER_FRONT_LEFT) | PIXEL(POSITION_MARKER_FRONT_LEFT_PIXEL)
+                    | PIXEL(POSITION_MARKER_REAR_LEFT_PIXEL) | PIXEL(BACK_LIGHT_ONE_LEFT_PIXEL)
+                    | PIXEL(BACK_LIGHT_TWO_LEFT_PIXEL);
+        case BACKUP_LIGHT:
+            return PIXEL(BACKUP_LIGHT_RIGHT_PIXEL) | PIXEL(BACKUP_LIGHT_LEFT_PIXEL);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * sets the global brightness of the NeoPixel strip, which is applied with the next frame
+ *
+ * @param pBrightness perceived brightness of all pixels, 255 shows the colors unchanged
+ */
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::setBrightness(uint8_t pBrightness)
+{
+    if (pBrightness != mOutputStage.getBrightness())
+    {
+        mOutputStage.setBrightness(pBrightness);
+        mIsFrameChanged = true;
+    }
+}
+
+/**
+ * sets the color of a pixel, if it differs from the color of the last frame sent to the strip. The pixel buffer of
+ * the strip holds the output of the output stage, so the frame is kept separately.
+ * @param pPixel index of the pixel
+ * @param pColor new color
+ */
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::setPixelColor(uint16_t pPixel, uint32_t pColor)
+{
+    if (mFrame[pPixel] != pColor)
+    {
+        mFrame[pPixel] = pColor;
+        mIsFrameChanged = true;
+    }
+}
+
+/**
+ * shows the frame calculated last on the NeoPixel strip, if it differs from the frame shown last. The frame is
+ * copied into the pixel buffer of the strip with the interrupts disabled, as the frame may be calculated meanwhile,
+ * then the output stage is applied and the strip shown. show() blocks the interrupts for SHOW_MICROS, so this is
+ * called from the main loop at a time, at which no RC pulse is measured.
+ */
+template<typename TConfig, typename TBehaviour>
+void BasicCamaroRcCarLightController<TConfig, TBehaviour>::showFrame(void)
+{
+    if (!mIsFrameChanged)
+    {
+        return;
+    }
+
+    noInterrupts();
+    for (uint8_t pixel = 0; pixel < NEO_PIXEL_COUNT; ++pixel)
+    {
+        mNeoPixelStrip.setPixelColor(pixel, mFrame[pixel]);
+    }
+    mIsFrameChanged = false;
+    interrupts();
+
+    mOutputStage.apply(mNeoPixelStrip.getPixels(), NEO_PIXEL_COUNT * 3);
     mNeoPixelStrip.show();
+    ++mPushedFrameCount;
 }
 
 /**
@@ -156,7 +467,9 @@ void CamaroRcCarLightController::loop(CarLightsStatus_t pLightStatus)
  * @param pBlink is true if a blink light is currently on otherwise false
  * @return
  */
-uint32_t CamaroRcCarLightController::getBackLightColor(CarLightsStatus_t pLightStatus, bool pBlink)
+template<typename TConfig, typename TBehaviour>
+uint32_t BasicCamaroRcCarLightController<TConfig, TBehaviour>::getBackLightColor(CarLightsStatus_t pLightStatus,
+                                                                                 bool pBlink)
 {
     if (pLightStatus.brakeLight ^ pBlink)
     {
@@ -169,3 +482,11 @@ uint32_t CamaroRcCarLightController::getBackLightColor(CarLightsStatus_t pLightS
     return BLACK_COLOR;
 }
 
+// the controller of the vehicle of this build
+template class BasicCamaroRcCarLightController<VehicleConfig, KeyframeLightSwitchBehaviour>;
+
+// the controller of this build is embedded in RcCarLights
+#ifdef CHECK_FOOTPRINT_BUDGET
+static_assert(sizeof(CamaroRcCarLightController) <= FootprintBudget::CAMARO_RC_CAR_LIGHT_CONTROLLER,
+              "CamaroRcCarLightController exceeds its RAM budget, see FootprintBudget.h");
+#endif
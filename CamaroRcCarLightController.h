@@ -9,23 +9,58 @@
 #define CAMARORCCARLIGHTCONTROLLER_H_
 
 #include "AbstractRcCarLightController.h"
+#include "KeyframeLightSwitchBehaviour.h"
 #include "Adafruit_NeoPixel.h"
+#include "PixelOutputStage.h"
+#include "VehicleConfig.h"
 
-class CamaroRcCarLightController : public AbstractRcCarLightController
+/**
+ * Light controller of the Camaro: parking lights and headlights on pins, all other lights on a NeoPixel strip.
+ *
+ * Behaviours can be attached to the headlights and to every light shown on the strip, either to all pixels of a light
+ * type or to a group of them. The brightness of all animated pixels is evaluated in one pass per frame with a single
+ * read of the clock into a contiguous array; an animated pixel blends between its colors with the light off and on.
+ * The pins are taken from the vehicle configuration TConfig (see VehicleConfig.h), the behaviours are of the type
+ * TBehaviour and called without a virtual function.
+ */
+template<typename TConfig = VehicleConfig, typename TBehaviour = KeyframeLightSwitchBehaviour>
+class BasicCamaroRcCarLightController : public AbstractRcCarLightController
 {
 public:
     /**
-     * Constructor
-     * @param pPinParkingLight specifies pin used for parking light
-     * @param pPinHeadlight specifies pin used for headlight
-     * @param pPinNeoPixel specifies pin used for NeoPixel signal
+     * pixels of the NeoPixel strip, bit 1 << position of a pixel mask (see addPixelBehaviour) selects the pixel
      */
-    CamaroRcCarLightController(int pPinParkingLight, int pPinHeadlight, int pPinNeoPixel);
+    typedef enum
+    {
+        POSITION_MARKER_FRONT_LEFT_PIXEL = 0,
+        FOG_LAMP_LEFT_PIXEL,
+        BLINKER_FRONT_LEFT,
+        BLINKER_FRONT_RIGHT_PIXEL,
+        FOG_LAMP_RIGHT_PIXEL,
+        POSITION_MARKER_FRONT_RIGHT_PIXEL,
+        POSITION_MARKER_REAR_RIGHT_PIXEL,
+        BACK_LIGHT_ONE_RIGHT_PIXEL,
+        BACK_LIGHT_TWO_RIGHT_PIXEL,
+        BACKUP_LIGHT_RIGHT_PIXEL,
+        BACKUP_LIGHT_LEFT_PIXEL,
+        BACK_LIGHT_TWO_LEFT_PIXEL,
+        BACK_LIGHT_ONE_LEFT_PIXEL,
+        POSITION_MARKER_REAR_LEFT_PIXEL,
+        NEO_PIXEL_COUNT
+    } NeoPixelPosition_t;
+
+    // duration in microseconds, for which showing a frame blocks the interrupts (30 usec per pixel)
+    static const unsigned long SHOW_MICROS = NEO_PIXEL_COUNT * 30UL;
+
+    /**
+     * Constructor, the pins are taken from the vehicle configuration
+     */
+    BasicCamaroRcCarLightController(void);
 
     /**
      * destructor
      */
-    virtual ~CamaroRcCarLightController();
+    ~BasicCamaroRcCarLightController();
 
     /**
      * configures the required pins for OUTPUT.
@@ -35,19 +70,120 @@ public:
     void setupPins(void);
 
     /**
-     * allows to add a behavior for a specific light type. The Controller only support a behavior for the headlights.
+     * allows to add a behavior for a specific light type. The behaviour is attached to the headlight pin or to all
+     * pixels showing the light type, the parking light pin does not support behaviours.
      *
      * @param pLightType lights type where a behavior should be assigned
      * @param pLightSwitchBehaviour behavior, which influences the light switching
      */
-    void addBehaviour(LightType_t pLightType, LightSwitchBehaviour *pLightSwitchBehaviour);
+    void addBehaviour(LightType_t pLightType, TBehaviour *pLightSwitchBehaviour);
 
     /**
-     *  sets the configured pins according to the light status
+     * attaches a behaviour to a group of the pixels showing a light type. A pixel has one behaviour at most, a later
+     * call replaces the behaviour of the pixel.
+     *
+     * @param pLightType light type, which switches the behaviour
+     * @param pPixelMask pixels of the group, bit 1 << NeoPixelPosition_t per pixel. Pixels not showing the light type
+     * are ignored.
+     * @param pLightSwitchBehaviour behaviour or NULL to switch the pixels hard again
+     */
+    void addPixelBehaviour(LightType_t pLightType, uint16_t pPixelMask, TBehaviour *pLightSwitchBehaviour);
+
+    /**
+     *  sets the configured pins according to the light status and calculates the frame of the NeoPixel strip. The
+     *  frame is shown by showFrame.
      */
     void loop(CarLightsStatus_t pLightStatus);
 
+    /**
+     * shows the frame calculated last on the NeoPixel strip, if it differs from the frame shown last. The transfer
+     * to the strip blocks the interrupts for SHOW_MICROS, so it is called from the main loop at a time, at which no
+     * RC pulse is measured, and not from the frame.
+     */
+    void showFrame(void);
+
+    /**
+     * @return true if the headlight behaviour and all pixel behaviours (if any) are steady
+     */
+    bool isSteady(void);
+
+    /**
+     * sets the global brightness of the NeoPixel strip, which is applied with the next frame
+     *
+     * @param pBrightness perceived brightness of all pixels, 255 shows the colors unchanged
+     */
+    void setBrightness(uint8_t pBrightness);
+
+    /**
+     * @return number of pixels with a behaviour
+     */
+    inline uint8_t getAnimatedPixelCount(void)
+    {
+        return mAnimatedPixelCount;
+    }
+
+    /**
+     * @param pLightType light type
+     * @return mask of the pixels showing the light type, the parking lights and headlights use pins only
+     */
+    static uint16_t getPixelMask(LightType_t pLightType);
+
+    /**
+     * @return number of changed frames sent to the NeoPixel strip
+     */
+    inline unsigned long getPushedFrameCount(void)
+    {
+        return mPushedFrameCount;
+    }
+
+    /**
+     * @return number of loops, which left the frame unchanged
+     */
+    inline unsigned long getSkippedFrameCount(void)
+    {
+        return mSkippedFrameCount;
+    }
+
 private:
+    /**
+     * sets the status of all behaviours and calculates the brightness of all animated pixels
+     *
+     * @param pLightStatus current light status
+     * @param pNow current time in msec
+     */
+    void updatePixelBrightness(CarLightsStatus_t pLightStatus, unsigned long pNow);
+
+    /**
+     * @param pPixel index of the pixel
+     * @param pLightStatus light status
+     * @return color of a pixel without behaviour for the light status
+     */
+    uint32_t getPixelColor(uint16_t pPixel, CarLightsStatus_t pLightStatus);
+
+    /**
+     * @param pPixel index of the pixel
+     * @param pLightStatus current light status
+     * @return color of a pixel including the brightness of its behaviour
+     */
+    uint32_t getAnimatedPixelColor(uint16_t pPixel, CarLightsStatus_t pLightStatus);
+
+    /**
+     * @return status of the light type within the light status
+     */
+    static bool isLightOn(CarLightsStatus_t pLightStatus, LightType_t pLightType);
+
+    /**
+     * sets the status of the light type within the light status
+     */
+    static void setLightOn(CarLightsStatus_t &pLightStatus, LightType_t pLightType, bool pIsOn);
+
+    /**
+     * sets the color of a pixel, if it differs from the color of the last frame sent to the strip
+     * @param pPixel index of the pixel
+     * @param pColor new color
+     */
+    void setPixelColor(uint16_t pPixel, uint32_t pColor);
+
     /**
      * determine the current color of the back lights. It depends on parking light, brake light and blinking status
      * @param pLightStatus current light status
@@ -56,17 +192,40 @@ private:
      */
     uint32_t getBackLightColor(CarLightsStatus_t pLightStatus, bool pBlink);
 private:
-    // pin for parking lights
-    int mPinParkingLight;
-
-    // pin for headlights
-    int mPinHeadlight;
-
     // NeoPixel strip for all other lights
     Adafruit_NeoPixel mNeoPixelStrip;
 
+    // gamma correction and global brightness of the strip
+    PixelOutputStage mOutputStage;
+
+    // colors of the current frame as perceived brightness
+    uint32_t mFrame[NEO_PIXEL_COUNT];
+
     // light behavior for head lights
-    LightSwitchBehaviour *mheadlightBehaviour;
+    TBehaviour *mheadlightBehaviour;
+
+    // behaviour of every pixel, NULL for pixels switched hard
+    TBehaviour *mPixelBehaviours[NEO_PIXEL_COUNT];
+
+    // light type switching the behaviour of every pixel
+    uint8_t mPixelLightTypes[NEO_PIXEL_COUNT];
+
+    // brightness of every animated pixel in the current frame
+    uint8_t mPixelBrightness[NEO_PIXEL_COUNT];
+
+    // number of pixels with a behaviour
+    uint8_t mAnimatedPixelCount;
+
+    // true if at least one pixel differs from the frame shown last, set by the frame and cleared by showFrame
+    volatile bool mIsFrameChanged;
+
+    // number of frames sent to the strip
+    unsigned long mPushedFrameCount;
+
+    // number of frames not sent, because nothing changed
+    unsigned long mSkippedFrameCount;
 };
 
+typedef BasicCamaroRcCarLightController<VehicleConfig> CamaroRcCarLightController;
+
 #endif /* CAMARORCCARLIGHTCONTROLLER_H_ */
@@ -0,0 +1,118 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "DeadlineScheduler.h"
+
+// length of the statistics interval in msec
+#define STATISTICS_INTERVAL 1000
+
+/**
+ * constructor, no timer is scheduled
+ */
+DeadlineScheduler::DeadlineScheduler(void) :
+        mActiveTimers(0), mNextDeadline(0), mStatisticsTimestamp(0), mSkippedPasses(0), mExecutedPasses(0),
+        mSkippedPerSecond(0), mExecutedPerSecond(0)
+{
+    for (uint8_t i = 0; i < MAX_TIMERS; ++i)
+    {
+        mDeadlines[i] = 0;
+    }
+}
+
+/**
+ * sets the deadline of a timer, an earlier deadline of the timer is replaced
+ *
+ * @param pTimer timer number
+ * @param pDeadline timestamp in msec
+ */
+void DeadlineScheduler::schedule(uint8_t pTimer, unsigned long pDeadline)
+{
+    uint8_t mask = 1 << pTimer;
+
+    if ((mActiveTimers & mask) && mDeadlines[pTimer] == pDeadline)
+    {
+        return;
+    }
+
+    mDeadlines[pTimer] = pDeadline;
+    mActiveTimers |= mask;
+    updateNextDeadline();
+}
+
+/**
+ * removes the deadline of a timer
+ *
+ * @param pTimer timer number
+ */
+void DeadlineScheduler::cancel(uint8_t pTimer)
+{
+    uint8_t mask = 1 << pTimer;
+
+    if (mActiveTimers & mask)
+    {
+        mActiveTimers &= ~mask;
+        updateNextDeadline();
+    }
+}
+
+/**
+ * counts a loop pass for the statistics
+ *
+ * @param pNow current timestamp in msec
+ * @param pIsSkipped true if the pass was skipped, because nothing was due
+ */
+void DeadlineScheduler::countPass(unsigned long pNow, bool pIsSkipped)
+{
+    if (STATISTICS_INTERVAL <= pNow - mStatisticsTimestamp)
+    {
+        mSkippedPerSecond = mSkippedPasses;
+        mExecutedPerSecond = mExecutedPasses;
+        mSkippedPasses = 0;
+        mExecutedPasses = 0;
+        mStatisticsTimestamp = pNow;
+    }
+
+    if (pIsSkipped)
+    {
+        ++mSkippedPasses;
+    }
+    else
+    {
+        ++mExecutedPasses;
+    }
+}
+
+/**
+ * searches the earliest deadline of all scheduled timers. The deadlines are compared relative to each other, so
+ * a wrap around of millis() does not matter as long as all deadlines are less than 24 days apart.
+ */
+void DeadlineScheduler::updateNextDeadline(void)
+{
+    bool isFirst = true;
+
+    for (uint8_t i = 0; i < MAX_TIMERS; ++i)
+    {
+        if ((mActiveTimers & (1 << i)) && (isFirst || 0 > (long) (mDeadlines[i] - mNextDeadline)))
+        {
+            mNextDeadline = mDeadlines[i];
+            isFirst = false;
+        }
+    }
+}
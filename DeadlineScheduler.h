@@ -0,0 +1,123 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef DEADLINESCHEDULER_H_
+#define DEADLINESCHEDULER_H_
+
+#include <stdint.h>
+
+/**
+ * Keeps the deadlines of a few timers and tells the loop, whether any of them is due.
+ *
+ * Every timer is identified by a small number (0 .. MAX_TIMERS - 1) and has at most one deadline. The earliest
+ * deadline is cached, so the check in every loop pass is a single comparison. With only a handful of timers a
+ * linear search on changes is cheaper than a heap. All timestamps are in msec and may wrap around.
+ *
+ * Additionally the scheduler counts the loop passes, which were executed or skipped, per second.
+ */
+class DeadlineScheduler
+{
+public:
+    /**
+     * maximum number of timers
+     */
+    static const uint8_t MAX_TIMERS = 8;
+
+    /**
+     * constructor, no timer is scheduled
+     */
+    DeadlineScheduler(void);
+
+    /**
+     * sets the deadline of a timer, an earlier deadline of the timer is replaced
+     *
+     * @param pTimer timer number
+     * @param pDeadline timestamp in msec
+     */
+    void schedule(uint8_t pTimer, unsigned long pDeadline);
+
+    /**
+     * removes the deadline of a timer
+     *
+     * @param pTimer timer number
+     */
+    void cancel(uint8_t pTimer);
+
+    /**
+     * @param pNow current timestamp in msec
+     * @return true if the deadline of any timer is reached
+     */
+    inline bool isDue(unsigned long pNow)
+    {
+        return mActiveTimers && 0 <= (long) (pNow - mNextDeadline);
+    }
+
+    /**
+     * counts a loop pass for the statistics
+     *
+     * @param pNow current timestamp in msec
+     * @param pIsSkipped true if the pass was skipped, because nothing was due
+     */
+    void countPass(unsigned long pNow, bool pIsSkipped);
+
+    /**
+     * @return number of skipped loop passes within the last complete second
+     */
+    inline unsigned long getSkippedPerSecond(void)
+    {
+        return mSkippedPerSecond;
+    }
+
+    /**
+     * @return number of executed loop passes within the last complete second
+     */
+    inline unsigned long getExecutedPerSecond(void)
+    {
+        return mExecutedPerSecond;
+    }
+
+private:
+    /**
+     * searches the earliest deadline of all scheduled timers
+     */
+    void updateNextDeadline(void);
+
+    // deadline of every timer
+    unsigned long mDeadlines[MAX_TIMERS];
+
+    // bit mask of the timers with deadline
+    uint8_t mActiveTimers;
+
+    // earliest deadline of all active timers
+    unsigned long mNextDeadline;
+
+    // start of the current statistics interval
+    unsigned long mStatisticsTimestamp;
+
+    // skipped and executed passes within the current statistics interval
+    unsigned long mSkippedPasses;
+    unsigned long mExecutedPasses;
+
+    // skipped and executed passes within the last complete statistics interval
+    unsigned long mSkippedPerSecond;
+    unsigned long mExecutedPerSecond;
+};
+
+#endif /* DEADLINESCHEDULER_H_ */
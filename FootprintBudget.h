@@ -0,0 +1,80 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef FOOTPRINTBUDGET_H_
+#define FOOTPRINTBUDGET_H_
+
+#include <stddef.h>
+
+/**
+ * RAM budgets in bytes of the objects, which are embedded in RcCarLights or passed along every loop.
+ *
+ * An ATmega328 has 2 KB of RAM for all objects, the string literals, the heap (e.g. the pixel buffer of the NeoPixel
+ * strip) and the stack. A budget is checked by a static_assert next to the definition of its class, so a change,
+ * which lets a class grow beyond its budget, fails the build. Raise a budget only together with the RAM overview of
+ * tools/ElfFootprint.cpp.
+ *
+ * On the host, where int and pointers are wider and members are aligned, the simulator and the unit tests check own
+ * budgets, which are taken from the sizes of the host build. The budgets of the board are estimates from the member
+ * layout with 2 byte int and pointers and are not measured with avr-g++ yet, so the board build checks them only if
+ * FOOTPRINT_BOARD_MEASURED is defined. Take the sizes from an avr-g++ ELF with tools/ElfFootprint, correct the budgets
+ * of the board and define FOOTPRINT_BOARD_MEASURED here.
+ */
+//#define FOOTPRINT_BOARD_MEASURED
+
+// the budgets are checked on the host, on the board only after they have been measured
+#if !defined(__AVR__) || defined(FOOTPRINT_BOARD_MEASURED)
+#define CHECK_FOOTPRINT_BUDGET
+#endif
+
+struct FootprintBudget
+{
+#if defined(__AVR__)
+    // all sizes of the board are unverified estimates, see above
+
+    // light status passed by value to the controller every loop
+    static constexpr size_t CAR_LIGHTS_STATUS = 2;
+
+    // inputs of the RC receiver with filters, health and acceleration, largest with USE_POLLED_INPUT (about 322
+    // bytes)
+    static constexpr size_t REMOTE_CONTROL_CAR_ADAPTER = 336;
+
+    // NeoPixel strip (about 22 bytes), output stage (brightness only, the gamma table is in flash), frame, pixel
+    // behaviours and counters (125 bytes), about 147 bytes
+    static constexpr size_t CAMARO_RC_CAR_LIGHT_CONTROLLER = 160;
+
+    // state of a single animated light (about 9 bytes)
+    static constexpr size_t KEYFRAME_LIGHT_SWITCH_BEHAVIOUR = 10;
+#else
+    // light status passed by value to the controller every loop
+    static constexpr size_t CAR_LIGHTS_STATUS = 4;
+
+    // inputs of the RC receiver with filters, health and acceleration, largest with USE_POLLED_INPUT (648 bytes)
+    static constexpr size_t REMOTE_CONTROL_CAR_ADAPTER = 712;
+
+    // NeoPixel strip of the mock, output stage, frame and pixel behaviours (264 bytes)
+    static constexpr size_t CAMARO_RC_CAR_LIGHT_CONTROLLER = 292;
+
+    // state of a single animated light (32 bytes)
+    static constexpr size_t KEYFRAME_LIGHT_SWITCH_BEHAVIOUR = 40;
+#endif
+};
+
+#endif /* FOOTPRINTBUDGET_H_ */
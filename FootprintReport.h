@@ -0,0 +1,53 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef FOOTPRINTREPORT_H_
+#define FOOTPRINTREPORT_H_
+
+// define REPORT_FOOTPRINT to list the RAM and flash usage of the parts reported by FOOTPRINT as compiler warnings in
+// the build output, e.g. "reportFootprint() [with Part = XenonBehaviour; unsigned int RAM = 12; unsigned int
+// FLASH = 71]"
+//#define REPORT_FOOTPRINT
+
+#ifdef REPORT_FOOTPRINT
+
+/**
+ * The deprecation warning of this function shows its template arguments, which are the sizes to report.
+ */
+template<typename Part, unsigned int RAM, unsigned int FLASH>
+__attribute__((deprecated("footprint report"))) inline void reportFootprint(void)
+{
+}
+
+/**
+ * reports the RAM and flash usage in bytes of the part pName in the build output
+ */
+#define FOOTPRINT(pName, pRam, pFlash) \
+    struct pName; \
+    static inline void reportFootprintOf##pName(void) \
+    { \
+        reportFootprint<pName, (pRam), (pFlash)>(); \
+    }
+
+#else
+#define FOOTPRINT(pName, pRam, pFlash)
+#endif
+
+#endif /* FOOTPRINTREPORT_H_ */
@@ -0,0 +1,104 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "FrameClock.h"
+
+FrameListener * volatile FrameClock::sListener = NULL;
+
+volatile bool FrameClock::sIsFrameRunning = false;
+
+volatile unsigned long FrameClock::sOverruns = 0;
+
+#if defined(__AVR__)
+// frames are calculated with interrupts enabled, so the pin change interrupts of the pulse capture are not delayed
+ISR(TIMER1_COMPA_vect, ISR_NOBLOCK)
+{
+    FrameClock::handleTimer();
+}
+#endif
+
+/**
+ * starts the timer
+ *
+ * @param pListener listener called with every frame
+ */
+void FrameClock::start(FrameListener *pListener)
+{
+#if defined(__AVR__)
+    noInterrupts();
+    sListener = pListener;
+
+    // timer 1 in CTC mode, prescaler 64
+    TCCR1A = 0;
+    TCCR1B = bit(WGM12) | bit(CS11) | bit(CS10);
+    TCNT1 = 0;
+    OCR1A = F_CPU / 64 / FRAME_RATE - 1;
+    TIMSK1 |= bit(OCIE1A);
+    interrupts();
+#else
+    // the emulated timer calls the listener of its board, so every board on the host has its own frame clock
+    ArduinoMock::setTimerInterrupt(FRAME_PERIOD, handleMockTimer, pListener);
+#endif
+}
+
+/**
+ * stops the timer
+ */
+void FrameClock::stop(void)
+{
+#if defined(__AVR__)
+    noInterrupts();
+    TIMSK1 &= ~bit(OCIE1A);
+    sListener = NULL;
+    interrupts();
+#else
+    ArduinoMock::setTimerInterrupt(0, NULL, NULL);
+#endif
+}
+
+/**
+ * handles the timer interrupt. As interrupts are enabled during a frame, a frame which takes longer than the frame
+ * period would be entered again; the new frame is dropped in this case.
+ */
+void FrameClock::handleTimer(void)
+{
+    if (sIsFrameRunning)
+    {
+        ++sOverruns;
+        return;
+    }
+
+    sIsFrameRunning = true;
+    if (sListener)
+    {
+        sListener->onFrame();
+    }
+    sIsFrameRunning = false;
+}
+
+/**
+ * calls the listener of the emulated timer on the host
+ */
+void FrameClock::handleMockTimer(void *pListener)
+{
+    static_cast<FrameListener *>(pListener)->onFrame();
+}
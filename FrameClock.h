@@ -0,0 +1,105 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef FRAMECLOCK_H_
+#define FRAMECLOCK_H_
+
+#include <stdint.h>
+
+/**
+ * Receiver of the frames of the FrameClock.
+ */
+class FrameListener
+{
+public:
+    /**
+     * destructor
+     */
+    virtual ~FrameListener()
+    {
+    }
+
+    /**
+     * called at the frame rate from the timer interrupt. Interrupts are enabled, so the pulse capture is not delayed.
+     */
+    virtual void onFrame(void) = 0;
+};
+
+/**
+ * Fixed rate clock for the light animations.
+ *
+ * A hardware timer (timer 1 on AVR) raises an interrupt FRAME_RATE times per second, which calls the listener. The
+ * frames do not depend on the main loop, so a slow loop (e.g. pulseIn or serial output) does not delay blinking or
+ * fading. On the host the arduino mock fires the timer at exact multiples of FRAME_PERIOD.
+ *
+ * There is only one frame timer on the board, therefore the class is purely static.
+ */
+class FrameClock
+{
+public:
+    /**
+     * number of frames per second
+     */
+    static const unsigned int FRAME_RATE = 200;
+
+    /**
+     * time between two frames in microseconds
+     */
+    static const unsigned long FRAME_PERIOD = 1000000UL / FRAME_RATE;
+
+    /**
+     * starts the timer
+     *
+     * @param pListener listener called with every frame
+     */
+    static void start(FrameListener *pListener);
+
+    /**
+     * stops the timer
+     */
+    static void stop(void);
+
+    /**
+     * @return number of frames, which were dropped because the previous frame was still running
+     */
+    static inline unsigned long getOverruns(void)
+    {
+        return sOverruns;
+    }
+
+    /**
+     * handles the timer interrupt, called by the interrupt service routine
+     */
+    static void handleTimer(void);
+
+private:
+    /**
+     * calls the listener of the emulated timer on the host
+     */
+    static void handleMockTimer(void *pListener);
+
+    static FrameListener * volatile sListener;
+
+    static volatile bool sIsFrameRunning;
+
+    static volatile unsigned long sOverruns;
+};
+
+#endif /* FRAMECLOCK_H_ */
@@ -0,0 +1,101 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "KeyframeCurve.h"
+
+/**
+ * Calculates the brightness of a curve. The keyframe index is kept by the caller, so successive calls only check the
+ * next keyframe. A looping curve starts again at its first keyframe, when the elapsed time wraps around the duration.
+ *
+ * @param pCurve curve in PROGMEM
+ * @param pElapsed time in msec since the start of the curve
+ * @param pIndex position within the curve of the last call, 0 at the start of the curve
+ * @return brightness as PWM value (0-255)
+ */
+uint8_t KeyframeCurve::getLevel(const Curve_t *pCurve, unsigned long pElapsed, uint8_t &pIndex)
+{
+    const Keyframe_t *keyframes = (const Keyframe_t *) pgm_read_ptr(&pCurve->keyframes);
+    uint8_t last = pgm_read_byte(&pCurve->count) - 1;
+    uint16_t duration = pgm_read_word(&keyframes[last].time);
+
+    if (pElapsed > duration)
+    {
+        if (!pgm_read_byte(&pCurve->isLooping) || 0 == duration)
+        {
+            pIndex = last;
+            return pgm_read_byte(&keyframes[last].level);
+        }
+        pElapsed %= duration;
+    }
+
+    // the elapsed time of a looping curve has wrapped around
+    if (pIndex > last || (0 < pIndex && pElapsed < pgm_read_word(&keyframes[pIndex - 1].time)))
+    {
+        pIndex = 0;
+    }
+
+    while (pElapsed > pgm_read_word(&keyframes[pIndex].time))
+    {
+        pIndex++;
+    }
+
+    if (0 == pIndex)
+    {
+        return pgm_read_byte(&keyframes[0].level);
+    }
+
+    // linear interpolation with the precalculated slope (16 fractional bits, rounded)
+    //
+    // f(x) = f  + slope * (x   -  x )
+    //         0                    0
+    const Keyframe_t *previous = &keyframes[pIndex - 1];
+    int32_t slope = (int32_t) pgm_read_dword(&keyframes[pIndex].slope);
+    int32_t deltaT = pElapsed - pgm_read_word(&previous->time);
+
+    return pgm_read_byte(&previous->level) + ((slope * deltaT + 0x8000L) >> 16);
+}
+
+/**
+ * @param pCurve curve in PROGMEM
+ * @param pElapsed time in msec since the start of the curve
+ * @return true if the curve does not loop and its last keyframe has passed
+ */
+bool KeyframeCurve::isFinished(const Curve_t *pCurve, unsigned long pElapsed)
+{
+    if (pgm_read_byte(&pCurve->isLooping))
+    {
+        return false;
+    }
+
+    const Keyframe_t *keyframes = (const Keyframe_t *) pgm_read_ptr(&pCurve->keyframes);
+    return pElapsed > pgm_read_word(&keyframes[pgm_read_byte(&pCurve->count) - 1].time);
+}
+
+/**
+ * @param pCurve curve in PROGMEM
+ * @return brightness of the last keyframe as PWM value (0-255)
+ */
+uint8_t KeyframeCurve::getFinalLevel(const Curve_t *pCurve)
+{
+    const Keyframe_t *keyframes = (const Keyframe_t *) pgm_read_ptr(&pCurve->keyframes);
+    return pgm_read_byte(&keyframes[pgm_read_byte(&pCurve->count) - 1].level);
+}
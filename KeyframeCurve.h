@@ -0,0 +1,112 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef KEYFRAMECURVE_H_
+#define KEYFRAMECURVE_H_
+
+#include <stdint.h>
+
+/**
+ * converts a brightness in percent into a PWM value
+ */
+#define KEYFRAME_LEVEL(pPercent) ((uint8_t) (((pPercent) * 255L + 50) / 100))
+
+/**
+ * slope of the segment between two keyframes in PWM units per msec as fixed point value with 16 fractional bits
+ */
+#define KEYFRAME_SLOPE(pTime0, pPercent0, pTime1, pPercent1) \
+    ((((int32_t) KEYFRAME_LEVEL(pPercent1) - KEYFRAME_LEVEL(pPercent0)) * 65536L) / ((pTime1) - (pTime0)))
+
+/**
+ * first keyframe of a curve
+ */
+#define KEYFRAME_START(pPercent) { 0, KEYFRAME_LEVEL(pPercent), 0 }
+
+/**
+ * keyframe at pTime1 with brightness pPercent1, which is reached from the previous keyframe at pTime0 with
+ * brightness pPercent0
+ */
+#define KEYFRAME_STEP(pTime0, pPercent0, pTime1, pPercent1) \
+    { pTime1, KEYFRAME_LEVEL(pPercent1), KEYFRAME_SLOPE(pTime0, pPercent0, pTime1, pPercent1) }
+
+/**
+ * curve descriptor for a keyframe table pKeyframes
+ */
+#define KEYFRAME_CURVE(pKeyframes, pIsLooping) \
+    { pKeyframes, sizeof(pKeyframes) / sizeof(pKeyframes[0]), pIsLooping }
+
+/**
+ * Brightness curve of a light, defined by keyframes and stored in flash.
+ *
+ * A curve is a table of keyframes with increasing timestamps, the brightness between two keyframes is interpolated
+ * linearly with integer arithmetic. The slopes of all segments are calculated at compile time (see KEYFRAME_STEP).
+ * A looping curve repeats from its first keyframe after the last one, other curves keep the level of the last
+ * keyframe. Curves and keyframes are constant and shared by all lights using them, the position within a curve is
+ * held by the caller.
+ */
+class KeyframeCurve
+{
+public:
+    /**
+     * keyframe of a curve
+     */
+    typedef struct
+    {
+        uint16_t time;   // duration in milliseconds since the start of the curve
+        uint8_t level;   // brightness as PWM value
+        int32_t slope;   // slope of the segment from the previous keyframe, see KEYFRAME_SLOPE
+    } Keyframe_t;
+
+    /**
+     * curve descriptor, has to be stored in PROGMEM like its keyframes
+     */
+    typedef struct
+    {
+        const Keyframe_t *keyframes;   // keyframes in PROGMEM, the first one at time 0
+        uint8_t count;                 // number of keyframes
+        bool isLooping;                // true if the curve repeats after its last keyframe
+    } Curve_t;
+
+    /**
+     * calculates the brightness of a curve
+     *
+     * @param pCurve curve in PROGMEM
+     * @param pElapsed time in msec since the start of the curve
+     * @param pIndex position within the curve of the last call, 0 at the start of the curve. Calls with increasing
+     * pElapsed only move forward in the keyframe table.
+     * @return brightness as PWM value (0-255)
+     */
+    static uint8_t getLevel(const Curve_t *pCurve, unsigned long pElapsed, uint8_t &pIndex);
+
+    /**
+     * @param pCurve curve in PROGMEM
+     * @param pElapsed time in msec since the start of the curve
+     * @return true if the curve does not loop and its last keyframe has passed
+     */
+    static bool isFinished(const Curve_t *pCurve, unsigned long pElapsed);
+
+    /**
+     * @param pCurve curve in PROGMEM
+     * @return brightness of the last keyframe as PWM value (0-255)
+     */
+    static uint8_t getFinalLevel(const Curve_t *pCurve);
+};
+
+#endif /* KEYFRAMECURVE_H_ */
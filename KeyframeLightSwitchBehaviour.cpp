@@ -0,0 +1,261 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "KeyframeLightSwitchBehaviour.h"
+#include "FootprintReport.h"
+#include "FootprintBudget.h"
+
+/**
+ * Xenon light switching on: short flash, then a short flickering and a smooth startup
+ */
+static const KeyframeCurve::Keyframe_t sXenonOnKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(100),
+                KEYFRAME_STEP(0, 100, 60, 100),
+                KEYFRAME_STEP(60, 100, 65, 5),
+                KEYFRAME_STEP(65, 5, 250, 10),
+                KEYFRAME_STEP(250, 10, 400, 7),
+                KEYFRAME_STEP(400, 7, 2000, 100)
+        };
+
+static const KeyframeCurve::Curve_t sXenonOn PROGMEM = KEYFRAME_CURVE(sXenonOnKeyframes, false);
+
+/**
+ * Xenon light switching off: the light just turns off smoothly
+ */
+static const KeyframeCurve::Keyframe_t sXenonOffKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(100),
+                KEYFRAME_STEP(0, 100, 60, 50),
+                KEYFRAME_STEP(60, 50, 110, 10),
+                KEYFRAME_STEP(110, 10, 500, 0)
+        };
+
+static const KeyframeCurve::Curve_t sXenonOff PROGMEM = KEYFRAME_CURVE(sXenonOffKeyframes, false);
+
+/**
+ * Halogen light switching on: the cold filament glows dim first and reaches full brightness within 300 msec
+ */
+static const KeyframeCurve::Keyframe_t sHalogenOnKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(0),
+                KEYFRAME_STEP(0, 0, 40, 30),
+                KEYFRAME_STEP(40, 30, 150, 85),
+                KEYFRAME_STEP(150, 85, 300, 100)
+        };
+
+static const KeyframeCurve::Curve_t sHalogenOn PROGMEM = KEYFRAME_CURVE(sHalogenOnKeyframes, false);
+
+/**
+ * Halogen light switching off: fast drop, then the filament afterglows
+ */
+static const KeyframeCurve::Keyframe_t sHalogenOffKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(100),
+                KEYFRAME_STEP(0, 100, 80, 40),
+                KEYFRAME_STEP(80, 40, 200, 10),
+                KEYFRAME_STEP(200, 10, 350, 0)
+        };
+
+static const KeyframeCurve::Curve_t sHalogenOff PROGMEM = KEYFRAME_CURVE(sHalogenOffKeyframes, false);
+
+/**
+ * LED fading in, slow at the dark end where the eye is most sensitive
+ */
+static const KeyframeCurve::Keyframe_t sLedFadeOnKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(0),
+                KEYFRAME_STEP(0, 0, 80, 5),
+                KEYFRAME_STEP(80, 5, 160, 30),
+                KEYFRAME_STEP(160, 30, 250, 100)
+        };
+
+static const KeyframeCurve::Curve_t sLedFadeOn PROGMEM = KEYFRAME_CURVE(sLedFadeOnKeyframes, false);
+
+/**
+ * LED fading out, the reverse of fading in
+ */
+static const KeyframeCurve::Keyframe_t sLedFadeOffKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(100),
+                KEYFRAME_STEP(0, 100, 90, 30),
+                KEYFRAME_STEP(90, 30, 170, 5),
+                KEYFRAME_STEP(170, 5, 250, 0)
+        };
+
+static const KeyframeCurve::Curve_t sLedFadeOff PROGMEM = KEYFRAME_CURVE(sLedFadeOffKeyframes, false);
+
+/**
+ * strobe: two flashes of 40 msec, then dark until the second ends
+ */
+static const KeyframeCurve::Keyframe_t sStrobeKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(0),
+                KEYFRAME_STEP(0, 0, 1, 100),
+                KEYFRAME_STEP(1, 100, 40, 100),
+                KEYFRAME_STEP(40, 100, 41, 0),
+                KEYFRAME_STEP(41, 0, 120, 0),
+                KEYFRAME_STEP(120, 0, 121, 100),
+                KEYFRAME_STEP(121, 100, 160, 100),
+                KEYFRAME_STEP(160, 100, 161, 0),
+                KEYFRAME_STEP(161, 0, 1000, 0)
+        };
+
+static const KeyframeCurve::Curve_t sStrobe PROGMEM = KEYFRAME_CURVE(sStrobeKeyframes, true);
+
+/**
+ * flicker: irregular drops of the brightness, repeating after 730 msec
+ */
+static const KeyframeCurve::Keyframe_t sFlickerKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(90),
+                KEYFRAME_STEP(0, 90, 30, 100),
+                KEYFRAME_STEP(30, 100, 45, 40),
+                KEYFRAME_STEP(45, 40, 70, 95),
+                KEYFRAME_STEP(70, 95, 210, 85),
+                KEYFRAME_STEP(210, 85, 220, 20),
+                KEYFRAME_STEP(220, 20, 240, 100),
+                KEYFRAME_STEP(240, 100, 400, 90),
+                KEYFRAME_STEP(400, 90, 415, 60),
+                KEYFRAME_STEP(415, 60, 430, 100),
+                KEYFRAME_STEP(430, 100, 690, 95),
+                KEYFRAME_STEP(690, 95, 730, 90)
+        };
+
+static const KeyframeCurve::Curve_t sFlicker PROGMEM = KEYFRAME_CURVE(sFlickerKeyframes, true);
+
+/**
+ * switching off immediately
+ */
+static const KeyframeCurve::Keyframe_t sInstantOffKeyframes[] PROGMEM =
+        {
+                KEYFRAME_START(0)
+        };
+
+static const KeyframeCurve::Curve_t sInstantOff PROGMEM = KEYFRAME_CURVE(sInstantOffKeyframes, false);
+
+const KeyframeLightSwitchBehaviour::Profile_t KeyframeLightSwitchBehaviour::XENON PROGMEM = { &sXenonOn, &sXenonOff };
+
+const KeyframeLightSwitchBehaviour::Profile_t KeyframeLightSwitchBehaviour::HALOGEN PROGMEM =
+        { &sHalogenOn, &sHalogenOff };
+
+const KeyframeLightSwitchBehaviour::Profile_t KeyframeLightSwitchBehaviour::LED_FADE PROGMEM =
+        { &sLedFadeOn, &sLedFadeOff };
+
+const KeyframeLightSwitchBehaviour::Profile_t KeyframeLightSwitchBehaviour::STROBE PROGMEM =
+        { &sStrobe, &sInstantOff };
+
+const KeyframeLightSwitchBehaviour::Profile_t KeyframeLightSwitchBehaviour::FLICKER PROGMEM =
+        { &sFlicker, &sInstantOff };
+
+/**
+ * flash usage of a curve including its keyframes
+ */
+#define CURVE_FLASH(pCurve) (sizeof(pCurve) + sizeof(pCurve##Keyframes))
+
+// RAM per light and flash of the profile including both curves, shared by all lights of the same behaviour
+FOOTPRINT(XenonBehaviour, sizeof(KeyframeLightSwitchBehaviour),
+          sizeof(KeyframeLightSwitchBehaviour::Profile_t) + CURVE_FLASH(sXenonOn) + CURVE_FLASH(sXenonOff))
+FOOTPRINT(HalogenBehaviour, sizeof(KeyframeLightSwitchBehaviour),
+          sizeof(KeyframeLightSwitchBehaviour::Profile_t) + CURVE_FLASH(sHalogenOn) + CURVE_FLASH(sHalogenOff))
+FOOTPRINT(LedFadeBehaviour, sizeof(KeyframeLightSwitchBehaviour),
+          sizeof(KeyframeLightSwitchBehaviour::Profile_t) + CURVE_FLASH(sLedFadeOn) + CURVE_FLASH(sLedFadeOff))
+FOOTPRINT(StrobeBehaviour, sizeof(KeyframeLightSwitchBehaviour),
+          sizeof(KeyframeLightSwitchBehaviour::Profile_t) + CURVE_FLASH(sStrobe) + CURVE_FLASH(sInstantOff))
+FOOTPRINT(FlickerBehaviour, sizeof(KeyframeLightSwitchBehaviour),
+          sizeof(KeyframeLightSwitchBehaviour::Profile_t) + CURVE_FLASH(sFlicker) + CURVE_FLASH(sInstantOff))
+
+// every animated light takes this RAM
+#ifdef CHECK_FOOTPRINT_BUDGET
+static_assert(sizeof(KeyframeLightSwitchBehaviour) <= FootprintBudget::KEYFRAME_LIGHT_SWITCH_BEHAVIOUR,
+              "KeyframeLightSwitchBehaviour exceeds its RAM budget, see FootprintBudget.h");
+#endif
+
+/**
+ * constructor
+ *
+ * @param pProfile curves of the behaviour in PROGMEM
+ */
+KeyframeLightSwitchBehaviour::KeyframeLightSwitchBehaviour(const Profile_t *pProfile) :
+        mProfile(pProfile), mSwitchTimestamp(0), mKeyframeIndex(NOT_SWITCHED)
+{
+}
+
+/**
+ * destructor
+ */
+KeyframeLightSwitchBehaviour::~KeyframeLightSwitchBehaviour()
+{
+}
+
+/**
+ * Sets the light status. A change stores the timestamp and starts the curve of the new status.
+ *
+ * @param pLightStatus desired status of the controlled light
+ * @param pNow current time in msec
+ */
+void KeyframeLightSwitchBehaviour::setLightStatusAt( LightStatus_t pLightStatus, unsigned long pNow )
+{
+    if (pLightStatus != getLightStatus())
+    {
+        mSwitchTimestamp = pNow;
+        mKeyframeIndex = 0;
+
+        setLightStatusSelf(pLightStatus);
+    }
+}
+
+/**
+ * Calculates the current brightness of the light from the curve of the current light status.
+ *
+ * @param pNow current time in msec
+ * @return the current brightness of the light as PWM value (0-255)
+ */
+uint8_t KeyframeLightSwitchBehaviour::getBrightnessAt( unsigned long pNow )
+{
+    if (NOT_SWITCHED == mKeyframeIndex)
+    {
+        return KeyframeCurve::getFinalLevel(getCurve());
+    }
+
+    return KeyframeCurve::getLevel(getCurve(), pNow - mSwitchTimestamp, mKeyframeIndex);
+}
+
+/**
+ * The light is steady, if it was never switched or the curve of the current status has finished.
+ *
+ * @param pNow current time in msec
+ * @return true if the curve of the current status has finished, looping curves never finish
+ */
+bool KeyframeLightSwitchBehaviour::isSteadyAt( unsigned long pNow )
+{
+    return NOT_SWITCHED == mKeyframeIndex || KeyframeCurve::isFinished(getCurve(), pNow - mSwitchTimestamp);
+}
+
+/**
+ * @return curve of the current light status in PROGMEM
+ */
+const KeyframeCurve::Curve_t *KeyframeLightSwitchBehaviour::getCurve(void)
+{
+    return (const KeyframeCurve::Curve_t *) ((ON == getLightStatus()) ?
+            pgm_read_ptr(&mProfile->onCurve) : pgm_read_ptr(&mProfile->offCurve));
+}
@@ -0,0 +1,116 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef KEYFRAMELIGHTSWITCHBEHAVIOUR_H_
+#define KEYFRAMELIGHTSWITCHBEHAVIOUR_H_
+
+#include <avr/pgmspace.h>
+
+#include "LightSwitchBehaviour.h"
+#include "KeyframeCurve.h"
+
+/**
+ * Light switch behaviour, which follows a keyframe curve (see KeyframeCurve) for switching on and another one for
+ * switching off.
+ *
+ * The pair of curves is a profile in flash, which is shared by all lights with the same behaviour. An instance only
+ * holds a pointer to its profile, the time of the last switch and the position within the running curve, so every
+ * additional animated light costs a few bytes of RAM and no flash. Ready-made profiles are XENON, HALOGEN, LED_FADE,
+ * STROBE and FLICKER.
+ */
+class KeyframeLightSwitchBehaviour : public BasicLightSwitchBehaviour<KeyframeLightSwitchBehaviour>
+{
+public:
+    /**
+     * curves of a behaviour, has to be stored in PROGMEM
+     */
+    typedef struct
+    {
+        const KeyframeCurve::Curve_t *onCurve;    // curve after switching on
+        const KeyframeCurve::Curve_t *offCurve;   // curve after switching off
+    } Profile_t;
+
+    // xenon light: short flash, flickering and slow start up, slow cool down
+    static const Profile_t XENON PROGMEM;
+
+    // halogen light: filament warms up and cools down within a few hundred msec
+    static const Profile_t HALOGEN PROGMEM;
+
+    // LED with a soft fade in and out
+    static const Profile_t LED_FADE PROGMEM;
+
+    // double flash strobe repeating every second while on
+    static const Profile_t STROBE PROGMEM;
+
+    // irregular flickering like a defect fluorescent tube while on
+    static const Profile_t FLICKER PROGMEM;
+
+    /**
+     * constructor
+     *
+     * @param pProfile curves of the behaviour in PROGMEM
+     */
+    KeyframeLightSwitchBehaviour(const Profile_t *pProfile);
+
+    /**
+     * destructor
+     */
+    ~KeyframeLightSwitchBehaviour();
+
+    /**
+     * sets the light status and starts the curve of the new status
+     *
+     * @param pLightStatus desired status of the controlled light
+     * @param pNow current time in msec
+     */
+    void setLightStatusAt( LightStatus_t pLightStatus, unsigned long pNow );
+
+    /**
+     * @param pNow current time in msec
+     * @return the brightness of the running curve as PWM value (0-255)
+     */
+    uint8_t getBrightnessAt( unsigned long pNow );
+
+    /**
+     * @param pNow current time in msec
+     * @return true if the curve of the current status has finished, looping curves never finish
+     */
+    bool isSteadyAt( unsigned long pNow );
+
+private:
+    /**
+     * @return curve of the current light status in PROGMEM
+     */
+    const KeyframeCurve::Curve_t *getCurve(void);
+
+    // keyframe index of a light which was never switched
+    static const uint8_t NOT_SWITCHED = 0xFF;
+
+    // curves of the behaviour in PROGMEM
+    const Profile_t *mProfile;
+
+    // timestamp in msec of the last change of the light status
+    unsigned long mSwitchTimestamp;
+
+    // position within the running curve, NOT_SWITCHED before the first change of the light status
+    uint8_t mKeyframeIndex;
+};
+
+#endif /* KEYFRAMELIGHTSWITCHBEHAVIOUR_H_ */
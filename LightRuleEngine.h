@@ -0,0 +1,611 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef LIGHTRULEENGINE_H_
+#define LIGHTRULEENGINE_H_
+
+#include "AbstractRcCarLightController.h"
+#include "RemoteControlCarAdapter.h"
+
+/**
+ * Declarative light rules, which are bound at compile time.
+ *
+ * A rule combines a condition on the inputs with a target bit of CarLightsStatus_t and, if required, a delay. The
+ * rules of a vehicle are listed as template arguments of LightRuleEngine. All conditions, targets and rules are
+ * inline and have no virtual methods, so the compiler flattens the complete rule table into one straight update
+ * function. Rules without state do not occupy any RAM.
+ *
+ * All rules read the same snapshot of the inputs, which is collected once per loop (including a single millis()).
+ *
+ * Besides the inputs, some conditions and rules depend on the time only (durations, delays, blinking). They report
+ * the time in msec until they may change without any input change (getTimeToChange), so the loop can sleep until
+ * then. LIGHT_RULE_NO_CHANGE means the result changes with the inputs only.
+ */
+
+#define LIGHT_RULE_NO_CHANGE 0xFFFFFFFFUL
+
+/**
+ * snapshot of all inputs used by the light rules
+ */
+typedef struct
+{
+    RemoteControlCarAdapter::Throttle_t throttle;
+    RemoteControlCarAdapter::Throttle_t throttleSwitch;
+    RemoteControlCarAdapter::Steering_t steering;
+    unsigned long durationOfThrottleSwitch;
+    short acceleration;
+    bool isLightSwitchOn;
+    bool isFailsafe;
+    unsigned long now;
+} LightRuleInputs_t;
+
+typedef AbstractRcCarLightController::CarLightsStatus_t LightRuleStatus_t;
+
+/**
+ * @return the earlier of two times to change
+ */
+inline unsigned long lightRuleMinTime(unsigned long pTime1, unsigned long pTime2)
+{
+    return (pTime1 < pTime2) ? pTime1 : pTime2;
+}
+
+// ---- targets: a single bit of the light status ----
+
+#define LIGHT_RULE_TARGET(pName, pMember) \
+    struct pName \
+    { \
+        static inline bool get(const LightRuleStatus_t &pStatus) \
+        { \
+            return pStatus.pMember; \
+        } \
+        static inline void set(LightRuleStatus_t &pStatus, bool pValue) \
+        { \
+            pStatus.pMember = pValue; \
+        } \
+        static inline void toggle(LightRuleStatus_t &pStatus) \
+        { \
+            pStatus.pMember ^= 1; \
+        } \
+    }
+
+LIGHT_RULE_TARGET(ParkingLightTarget, parkingLight);
+LIGHT_RULE_TARGET(HeadlightTarget, headlight);
+LIGHT_RULE_TARGET(RightBlinkerTarget, rightBlinker);
+LIGHT_RULE_TARGET(LeftBlinkerTarget, leftBlinker);
+LIGHT_RULE_TARGET(BackUpLightTarget, backUpLight);
+LIGHT_RULE_TARGET(BrakeLightTarget, brakeLight);
+
+// ---- conditions ----
+
+/**
+ * true if the light switch is on
+ */
+struct LightSwitchIsOn
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &)
+    {
+        return pInputs.isLightSwitchOn;
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &)
+    {
+        return LIGHT_RULE_NO_CHANGE;
+    }
+};
+
+/**
+ * true if the RC signal is lost (see RemoteControlCarAdapter::isFailsafe)
+ */
+struct FailsafeIsActive
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &)
+    {
+        return pInputs.isFailsafe;
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &)
+    {
+        return LIGHT_RULE_NO_CHANGE;
+    }
+};
+
+/**
+ * true if the given light is on (evaluated with the status updated by the preceding rules)
+ */
+template<typename TTarget>
+struct LightIsOn
+{
+    static inline bool evaluate(const LightRuleInputs_t &, const LightRuleStatus_t &pStatus)
+    {
+        return TTarget::get(pStatus);
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &)
+    {
+        return LIGHT_RULE_NO_CHANGE;
+    }
+};
+
+/**
+ * true if the throttle has the given value
+ */
+template<RemoteControlCarAdapter::Throttle_t THROTTLE>
+struct ThrottleIs
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &)
+    {
+        return THROTTLE == pInputs.throttle;
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &)
+    {
+        return LIGHT_RULE_NO_CHANGE;
+    }
+};
+
+/**
+ * true if the throttle switch has the given value
+ */
+template<RemoteControlCarAdapter::Throttle_t THROTTLE>
+struct ThrottleSwitchIs
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &)
+    {
+        return THROTTLE == pInputs.throttleSwitch;
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &)
+    {
+        return LIGHT_RULE_NO_CHANGE;
+    }
+};
+
+/**
+ * true if the throttle switch did not change for longer than the given duration in msec
+ */
+template<unsigned long DURATION>
+struct ThrottleSwitchHeldLongerThan
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &)
+    {
+        return DURATION < pInputs.durationOfThrottleSwitch;
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &pInputs)
+    {
+        return (DURATION < pInputs.durationOfThrottleSwitch) ?
+                LIGHT_RULE_NO_CHANGE : DURATION + 1 - pInputs.durationOfThrottleSwitch;
+    }
+};
+
+/**
+ * true if the steering has the given value
+ */
+template<RemoteControlCarAdapter::Steering_t STEERING>
+struct SteeringIs
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &)
+    {
+        return STEERING == pInputs.steering;
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &)
+    {
+        return LIGHT_RULE_NO_CHANGE;
+    }
+};
+
+/**
+ * true if the acceleration is below the given level
+ */
+template<long LEVEL>
+struct AccelerationBelow
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &)
+    {
+        return LEVEL > pInputs.acceleration;
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &)
+    {
+        return LIGHT_RULE_NO_CHANGE;
+    }
+};
+
+template<typename TCondition>
+struct Not
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &pStatus)
+    {
+        return !TCondition::evaluate(pInputs, pStatus);
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &pInputs)
+    {
+        return TCondition::getTimeToChange(pInputs);
+    }
+};
+
+template<typename TCondition1, typename TCondition2>
+struct And
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &pStatus)
+    {
+        return TCondition1::evaluate(pInputs, pStatus) && TCondition2::evaluate(pInputs, pStatus);
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &pInputs)
+    {
+        return lightRuleMinTime(TCondition1::getTimeToChange(pInputs), TCondition2::getTimeToChange(pInputs));
+    }
+};
+
+template<typename TCondition1, typename TCondition2>
+struct Or
+{
+    static inline bool evaluate(const LightRuleInputs_t &pInputs, const LightRuleStatus_t &pStatus)
+    {
+        return TCondition1::evaluate(pInputs, pStatus) || TCondition2::evaluate(pInputs, pStatus);
+    }
+
+    static inline unsigned long getTimeToChange(const LightRuleInputs_t &pInputs)
+    {
+        return lightRuleMinTime(TCondition1::getTimeToChange(pInputs), TCondition2::getTimeToChange(pInputs));
+    }
+};
+
+// ---- delays ----
+
+/**
+ * constant delay in msec
+ */
+template<unsigned long DELAY>
+struct FixedDelay
+{
+    static inline unsigned long get(const LightRuleInputs_t &)
+    {
+        return DELAY;
+    }
+};
+
+/**
+ * delay in msec depending on whether the car stands still or moves
+ */
+template<unsigned long STAND_STILL_DELAY, unsigned long MOVING_DELAY>
+struct StandStillDelay
+{
+    static inline unsigned long get(const LightRuleInputs_t &pInputs)
+    {
+        return (RemoteControlCarAdapter::STOP == pInputs.throttle) ? STAND_STILL_DELAY : MOVING_DELAY;
+    }
+};
+
+// ---- rules ----
+
+/**
+ * the light is on as long as the condition is true
+ */
+template<typename TCondition, typename TTarget>
+class FollowRule
+{
+public:
+    inline void update(LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs)
+    {
+        TTarget::set(pStatus, TCondition::evaluate(pInputs, pStatus));
+    }
+
+    inline unsigned long getTimeToChange(const LightRuleStatus_t &, const LightRuleInputs_t &pInputs) const
+    {
+        return TCondition::getTimeToChange(pInputs);
+    }
+};
+
+/**
+ * the light is switched on by the set condition and stays on until the reset condition becomes true. The reset
+ * condition has priority.
+ */
+template<typename TSetCondition, typename TResetCondition, typename TTarget>
+class LatchRule
+{
+public:
+    inline void update(LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs)
+    {
+        if (TResetCondition::evaluate(pInputs, pStatus))
+        {
+            TTarget::set(pStatus, false);
+        }
+        else if (TSetCondition::evaluate(pInputs, pStatus))
+        {
+            TTarget::set(pStatus, true);
+        }
+    }
+
+    inline unsigned long getTimeToChange(const LightRuleStatus_t &, const LightRuleInputs_t &pInputs) const
+    {
+        return lightRuleMinTime(TSetCondition::getTimeToChange(pInputs), TResetCondition::getTimeToChange(pInputs));
+    }
+};
+
+/**
+ * the light is on while the condition is true and is switched off when the condition is false for longer than the
+ * release delay. The delay starts with the first update, which sees the condition false, so it does not depend on
+ * how often the rules are updated.
+ */
+template<typename TCondition, typename TReleaseDelay, typename TTarget>
+class ReleaseDelayRule
+{
+public:
+    ReleaseDelayRule() :
+            misReleasing(false), mReleaseTimestamp(0)
+    {
+    }
+
+    inline void update(LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs)
+    {
+        if (TCondition::evaluate(pInputs, pStatus))
+        {
+            TTarget::set(pStatus, true);
+            misReleasing = false;
+        }
+        else if (TTarget::get(pStatus))
+        {
+            if (!misReleasing)
+            {
+                misReleasing = true;
+                mReleaseTimestamp = pInputs.now;
+            }
+            if (TReleaseDelay::get(pInputs) <= pInputs.now - mReleaseTimestamp)
+            {
+                TTarget::set(pStatus, false);
+                misReleasing = false;
+            }
+        }
+    }
+
+    inline unsigned long getTimeToChange(const LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs) const
+    {
+        unsigned long timeToChange = TCondition::getTimeToChange(pInputs);
+
+        if (misReleasing && TTarget::get(pStatus))
+        {
+            timeToChange = lightRuleMinTime(timeToChange,
+                    mReleaseTimestamp + TReleaseDelay::get(pInputs) - pInputs.now);
+        }
+        return timeToChange;
+    }
+
+private:
+    // true while the condition is false and the light is still on
+    bool misReleasing;
+
+    // timestamp in msec when the condition was seen false the first time
+    unsigned long mReleaseTimestamp;
+};
+
+/**
+ * blinker: blinking is started by the start condition and stopped (both blinkers off) by the stop condition. While
+ * blinking, the left or right blinker toggles every PERIOD msec depending on the left/right conditions.
+ */
+template<typename TStartCondition, typename TStopCondition, typename TLeftCondition, typename TRightCondition,
+        unsigned long PERIOD>
+class BlinkerRule
+{
+public:
+    BlinkerRule() :
+            misBlinkingOn(false), mLastBlinkTimestamp(0)
+    {
+    }
+
+    inline void update(LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs)
+    {
+        if (TStopCondition::evaluate(pInputs, pStatus))
+        {
+            misBlinkingOn = false;
+            LeftBlinkerTarget::set(pStatus, false);
+            RightBlinkerTarget::set(pStatus, false);
+        }
+        else if (TStartCondition::evaluate(pInputs, pStatus))
+        {
+            misBlinkingOn = true;
+        }
+
+        if (misBlinkingOn)
+        {
+            if (TLeftCondition::evaluate(pInputs, pStatus))
+            {
+                blink<LeftBlinkerTarget, RightBlinkerTarget>(pStatus, pInputs.now);
+            }
+            else if (TRightCondition::evaluate(pInputs, pStatus))
+            {
+                blink<RightBlinkerTarget, LeftBlinkerTarget>(pStatus, pInputs.now);
+            }
+        }
+    }
+
+    inline unsigned long getTimeToChange(const LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs) const
+    {
+        unsigned long timeToChange = lightRuleMinTime(
+                lightRuleMinTime(TStartCondition::getTimeToChange(pInputs), TStopCondition::getTimeToChange(pInputs)),
+                lightRuleMinTime(TLeftCondition::getTimeToChange(pInputs), TRightCondition::getTimeToChange(pInputs)));
+
+        // next toggle
+        if (misBlinkingOn
+                && (TLeftCondition::evaluate(pInputs, pStatus) || TRightCondition::evaluate(pInputs, pStatus)))
+        {
+            timeToChange = lightRuleMinTime(timeToChange, mLastBlinkTimestamp + PERIOD + 1 - pInputs.now);
+        }
+        return timeToChange;
+    }
+
+    /**
+     * @return true if the blinker is active (independent of the current on/off phase)
+     */
+    inline bool isBlinkingOn(void) const
+    {
+        return misBlinkingOn;
+    }
+
+private:
+    template<typename TBlinkTarget, typename TOtherTarget>
+    inline void blink(LightRuleStatus_t &pStatus, unsigned long pNow)
+    {
+        TOtherTarget::set(pStatus, false);
+        if (PERIOD < pNow - mLastBlinkTimestamp)
+        {
+            TBlinkTarget::toggle(pStatus);
+            mLastBlinkTimestamp = pNow;
+        }
+    }
+
+    // is true if blinker is switched on, false otherwise
+    bool misBlinkingOn;
+
+    // last timestamp then blinker was switched on or off
+    unsigned long mLastBlinkTimestamp;
+};
+
+/**
+ * hazard lights: while the condition is true both blinkers toggle together every PERIOD msec and override the
+ * preceding rules. Both blinkers are switched off when the condition becomes false, afterwards the rule does not
+ * touch them anymore.
+ */
+template<typename TCondition, unsigned long PERIOD>
+class HazardRule
+{
+public:
+    HazardRule() :
+            misHazardOn(false), misBlinkOn(false), mLastBlinkTimestamp(0)
+    {
+    }
+
+    inline void update(LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs)
+    {
+        if (TCondition::evaluate(pInputs, pStatus))
+        {
+            if (!misHazardOn || PERIOD < pInputs.now - mLastBlinkTimestamp)
+            {
+                misBlinkOn = !misHazardOn || !misBlinkOn;
+                misHazardOn = true;
+                mLastBlinkTimestamp = pInputs.now;
+            }
+            LeftBlinkerTarget::set(pStatus, misBlinkOn);
+            RightBlinkerTarget::set(pStatus, misBlinkOn);
+        }
+        else if (misHazardOn)
+        {
+            misHazardOn = false;
+            LeftBlinkerTarget::set(pStatus, false);
+            RightBlinkerTarget::set(pStatus, false);
+        }
+    }
+
+    inline unsigned long getTimeToChange(const LightRuleStatus_t &, const LightRuleInputs_t &pInputs) const
+    {
+        unsigned long timeToChange = TCondition::getTimeToChange(pInputs);
+
+        // next toggle
+        if (misHazardOn)
+        {
+            timeToChange = lightRuleMinTime(timeToChange, mLastBlinkTimestamp + PERIOD + 1 - pInputs.now);
+        }
+        return timeToChange;
+    }
+
+    /**
+     * @return true if the hazard lights are active (independent of the current on/off phase)
+     */
+    inline bool isHazardOn(void) const
+    {
+        return misHazardOn;
+    }
+
+private:
+    // is true while the condition is true
+    bool misHazardOn;
+
+    // current phase of both blinkers
+    bool misBlinkOn;
+
+    // last timestamp then the blinkers were switched on or off
+    unsigned long mLastBlinkTimestamp;
+};
+
+// ---- engine ----
+
+/**
+ * evaluates the given rules in the order of the template arguments. The rules are base classes of the engine, so
+ * the state of a rule can be accessed with getRule<Rule>().
+ */
+template<typename ... TRules>
+class LightRuleEngine;
+
+template<>
+class LightRuleEngine<>
+{
+public:
+    inline void update(LightRuleStatus_t &, const LightRuleInputs_t &)
+    {
+    }
+
+    inline unsigned long getTimeToChange(const LightRuleStatus_t &, const LightRuleInputs_t &) const
+    {
+        return LIGHT_RULE_NO_CHANGE;
+    }
+};
+
+template<typename TRule, typename ... TRules>
+class LightRuleEngine<TRule, TRules...> : public TRule, public LightRuleEngine<TRules...>
+{
+public:
+    /**
+     * applies all rules to the light status
+     *
+     * @param pStatus light status to update
+     * @param pInputs input snapshot of the current loop
+     */
+    inline void update(LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs)
+    {
+        TRule::update(pStatus, pInputs);
+        LightRuleEngine<TRules...>::update(pStatus, pInputs);
+    }
+
+    /**
+     * @param pStatus light status after the last update
+     * @param pInputs input snapshot of the last update
+     * @return time in msec until any rule may change the light status without an input change, or
+     * LIGHT_RULE_NO_CHANGE
+     */
+    inline unsigned long getTimeToChange(const LightRuleStatus_t &pStatus, const LightRuleInputs_t &pInputs) const
+    {
+        return lightRuleMinTime(TRule::getTimeToChange(pStatus, pInputs),
+                LightRuleEngine<TRules...>::getTimeToChange(pStatus, pInputs));
+    }
+
+    /**
+     * @return the rule of the given type
+     */
+    template<typename TRequestedRule>
+    inline const TRequestedRule & getRule(void) const
+    {
+        return *this;
+    }
+};
+
+#endif /* LIGHTRULEENGINE_H_ */
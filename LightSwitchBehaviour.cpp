@@ -18,6 +18,8 @@
  *
  * --------------------------------------------------------------------*/
 
+#include "Arduino.h"
+
 #include "LightSwitchBehaviour.h"
 
 /**
@@ -27,10 +29,3 @@ LightSwitchBehaviour::LightSwitchBehaviour()
 {
     mLightStatus = OFF;
 }
-
-/**
- * destructor
- */
-LightSwitchBehaviour::~LightSwitchBehaviour()
-{
-}
@@ -21,9 +21,12 @@
 #ifndef LIGHTSWITCHBEHAVIOUR_H_
 #define LIGHTSWITCHBEHAVIOUR_H_
 
+#include <stdint.h>
+
+#include "Arduino.h"
+
 /**
- * class to change the behavior of the light switching. The base class will react as a normal switch.
- * But subclassing allows to implement different behaviors like dim on/off or flicking like xenon lights.
+ * light status of a behaviour, common to all light switch behaviours (see BasicLightSwitchBehaviour)
  */
 class LightSwitchBehaviour
 {
@@ -41,18 +44,6 @@ public:
      */
     LightSwitchBehaviour();
 
-    /**
-     * destructor
-     */
-    virtual ~LightSwitchBehaviour();
-
-    /**
-     * sets the lights status of the behavior. Can be overloaded by subclass to ad additional functionality. Every subclass has to call {@link #setLightStatusSelf}.
-     *
-     * @param pLightStatus desired status of the controlled light
-     */
-    virtual void setLightStatus( LightStatus_t pLightStatus ) = 0;
-
     /**
      *
      * @return the current light status
@@ -62,11 +53,6 @@ public:
         return mLightStatus;
     }
 
-    /**
-     * @return the bright of the lights controlled by the behavior
-     */
-    virtual unsigned short getBrightness( void ) = 0;
-
 protected:
 
     /**
@@ -88,4 +74,57 @@ private:
 
 };
 
+/**
+ * Base of the light switch behaviours (CRTP). The base class will react as a normal switch. But subclassing allows
+ * to implement different behaviors like dim on/off or flicking like xenon lights.
+ *
+ * A behaviour derives from BasicLightSwitchBehaviour<Behaviour> and defines
+ *
+ *     void setLightStatusAt(LightStatus_t pLightStatus, unsigned long pNow)
+ *     uint8_t getBrightnessAt(unsigned long pNow)
+ *     bool isSteadyAt(unsigned long pNow)
+ *
+ * setLightStatusAt has to call setLightStatusSelf. The light controllers are instantiated with the type of their
+ * behaviours and call them without a virtual function, so a behaviour needs no vtable and is inlined into the
+ * controller.
+ */
+template<typename TBehaviour>
+class BasicLightSwitchBehaviour : public LightSwitchBehaviour
+{
+public:
+    /**
+     * sets the lights status of the behavior at the current time
+     *
+     * @param pLightStatus desired status of the controlled light
+     */
+    inline void setLightStatus( LightStatus_t pLightStatus )
+    {
+        self().setLightStatusAt(pLightStatus, millis());
+    }
+
+    /**
+     * @return the brightness of the lights controlled by the behavior at the current time as PWM value (0-255), which
+     * can be passed to analogWrite directly
+     */
+    inline uint8_t getBrightness( void )
+    {
+        return self().getBrightnessAt(millis());
+    }
+
+    /**
+     * @return true if the brightness does not change anymore until the next change of the light status, false while
+     * a transition is running
+     */
+    inline bool isSteady( void )
+    {
+        return self().isSteadyAt(millis());
+    }
+
+private:
+    inline TBehaviour &self(void)
+    {
+        return static_cast<TBehaviour &>(*this);
+    }
+};
+
 #endif /* LIGHTSWITCHBEHAVIOUR_H_ */
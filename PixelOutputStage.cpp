@@ -0,0 +1,124 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "PixelOutputStage.h"
+
+/**
+ * integer square root by bisection, evaluated at compile time
+ */
+static constexpr uint32_t squareRoot(uint64_t pValue, uint32_t pLow, uint32_t pHigh)
+{
+    return (pLow >= pHigh) ? pLow :
+            ((uint64_t) ((pLow + pHigh + 1) / 2) * ((pLow + pHigh + 1) / 2) <= pValue) ?
+                    squareRoot(pValue, (pLow + pHigh + 1) / 2, pHigh) :
+                    squareRoot(pValue, pLow, (pLow + pHigh + 1) / 2 - 1);
+}
+
+/**
+ * gamma correction with a gamma of 2.5: 255 * (x / 255)^2.5 = x^2 * sqrt(x / 255) / 255, the square root is
+ * calculated with 16 fractional bits and the result is rounded
+ */
+static constexpr uint8_t gammaLevel(uint32_t pValue)
+{
+    return (uint8_t) (((uint64_t) pValue * pValue * squareRoot(((uint64_t) pValue << 32) / 255, 0, 65536)
+            + 255UL * 65536 / 2) / (255UL * 65536));
+}
+
+/**
+ * 16 consecutive entries of the gamma table
+ */
+#define GAMMA_ROW(pBase) \
+    gammaLevel(pBase), gammaLevel(pBase + 1), gammaLevel(pBase + 2), gammaLevel(pBase + 3), \
+    gammaLevel(pBase + 4), gammaLevel(pBase + 5), gammaLevel(pBase + 6), gammaLevel(pBase + 7), \
+    gammaLevel(pBase + 8), gammaLevel(pBase + 9), gammaLevel(pBase + 10), gammaLevel(pBase + 11), \
+    gammaLevel(pBase + 12), gammaLevel(pBase + 13), gammaLevel(pBase + 14), gammaLevel(pBase + 15)
+
+// the table has to be constant initialized to be placed in flash
+static_assert(0 == gammaLevel(0) && 32 == gammaLevel(111) && 255 == gammaLevel(255), "gamma table");
+
+/**
+ * gamma table, PWM value for every perceived brightness
+ */
+static const uint8_t sGammaTable[256] PROGMEM =
+        {
+                GAMMA_ROW(0), GAMMA_ROW(16), GAMMA_ROW(32), GAMMA_ROW(48),
+                GAMMA_ROW(64), GAMMA_ROW(80), GAMMA_ROW(96), GAMMA_ROW(112),
+                GAMMA_ROW(128), GAMMA_ROW(144), GAMMA_ROW(160), GAMMA_ROW(176),
+                GAMMA_ROW(192), GAMMA_ROW(208), GAMMA_ROW(224), GAMMA_ROW(240)
+        };
+
+/**
+ * constructor, full brightness
+ */
+PixelOutputStage::PixelOutputStage() :
+        mBrightness(255)
+{
+}
+
+/**
+ * Sets the global brightness. The brightness scales the perceived brightness before the gamma correction, when the
+ * stage is applied.
+ *
+ * @param pBrightness perceived brightness of all pixels, 255 shows the colors unchanged
+ */
+void PixelOutputStage::setBrightness(uint8_t pBrightness)
+{
+    mBrightness = pBrightness;
+}
+
+/**
+ * converts a pixel buffer in place with one lookup in the gamma table per byte, below full brightness every byte is
+ * scaled first
+ *
+ * @param pPixels bytes of the pixel buffer
+ * @param pSize number of bytes
+ */
+void PixelOutputStage::apply(uint8_t *pPixels, uint16_t pSize) const
+{
+    uint8_t *end = pPixels + pSize;
+    if (255 == mBrightness)
+    {
+        while (pPixels != end)
+        {
+            *pPixels = getGamma(*pPixels);
+            ++pPixels;
+        }
+    }
+    else
+    {
+        uint8_t brightness = mBrightness;
+        while (pPixels != end)
+        {
+            *pPixels = getGamma(scale(*pPixels, brightness));
+            ++pPixels;
+        }
+    }
+}
+
+/**
+ * @param pValue perceived brightness
+ * @return PWM value of the gamma table
+ */
+uint8_t PixelOutputStage::getGamma(uint8_t pValue)
+{
+    return pgm_read_byte(&sGammaTable[pValue]);
+}
@@ -0,0 +1,96 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef PIXELOUTPUTSTAGE_H_
+#define PIXELOUTPUTSTAGE_H_
+
+#include <stdint.h>
+
+/**
+ * Output stage of the NeoPixel strip: maps the perceived brightness of every color channel to the PWM value of the
+ * LED and applies a global brightness.
+ *
+ * The colors of the light controller are perceived brightness values, so fading and dimming look even. The LEDs are
+ * linear, the stage corrects this with a gamma of 2.5. The gamma table is calculated at compile time and kept in
+ * flash, applying the stage to a frame is a single table lookup in flash per byte. Below full brightness every byte
+ * is scaled by one multiplication before the lookup. The stage keeps no table in RAM, a table combining gamma and
+ * brightness would take 256 of the 2048 bytes of an ATmega328.
+ */
+class PixelOutputStage
+{
+public:
+    /**
+     * constructor, full brightness
+     */
+    PixelOutputStage();
+
+    /**
+     * sets the global brightness
+     *
+     * @param pBrightness perceived brightness of all pixels, 255 shows the colors unchanged
+     */
+    void setBrightness(uint8_t pBrightness);
+
+    /**
+     * @return global brightness
+     */
+    inline uint8_t getBrightness(void) const
+    {
+        return mBrightness;
+    }
+
+    /**
+     * @param pValue perceived brightness of a color channel
+     * @return PWM value of the channel including the global brightness
+     */
+    inline uint8_t getLevel(uint8_t pValue) const
+    {
+        return getGamma(scale(pValue, mBrightness));
+    }
+
+    /**
+     * converts a pixel buffer in place, the order of the color channels does not matter
+     *
+     * @param pPixels bytes of the pixel buffer, e.g. Adafruit_NeoPixel::getPixels()
+     * @param pSize number of bytes
+     */
+    void apply(uint8_t *pPixels, uint16_t pSize) const;
+
+    /**
+     * @param pValue perceived brightness
+     * @return PWM value of the gamma table
+     */
+    static uint8_t getGamma(uint8_t pValue);
+
+private:
+    /**
+     * scales a perceived brightness by the global brightness, 0-255 is scaled to 1-256 so full brightness keeps
+     * every value. value * (brightness + 1) / 256 needs a single 8 x 8 bit multiplication on an AVR.
+     */
+    static inline uint8_t scale(uint8_t pValue, uint8_t pBrightness)
+    {
+        return (uint16_t) (pValue * pBrightness + pValue) >> 8;
+    }
+
+    // global brightness
+    uint8_t mBrightness;
+};
+
+#endif /* PIXELOUTPUTSTAGE_H_ */
@@ -0,0 +1,103 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "PpmDecoder.h"
+
+/**
+ * constructor, the channel order of most car receivers is steering, throttle, 3rd channel
+ *
+ * @param pThrottleChannel index of the throttle channel within a frame
+ * @param pSteeringChannel index of the steering channel within a frame
+ * @param p3rdChannel index of the 3rd channel within a frame
+ */
+PpmDecoder::PpmDecoder(uint8_t pThrottleChannel, uint8_t pSteeringChannel, uint8_t p3rdChannel) :
+        RcFrameDecoder(pThrottleChannel, pSteeringChannel, p3rdChannel), mChannel(0), mExpectedChannels(0),
+        misSynced(false), misEdgeSeen(false), mLastEdgeMicros(0)
+{
+}
+
+/**
+ * handles a rising edge of the signal, may be called from an interrupt
+ *
+ * @param pMicros timestamp of the edge in usec
+ */
+void PpmDecoder::handleEdge(unsigned long pMicros)
+{
+    unsigned long interval = pMicros - mLastEdgeMicros;
+    bool isFirstEdge = !misEdgeSeen;
+    mLastEdgeMicros = pMicros;
+    misEdgeSeen = true;
+
+    if (isFirstEdge)
+    {
+        return;
+    }
+
+    if (SYNC_GAP <= interval)
+    {
+        if (misSynced)
+        {
+            // the frame has more or less channels than the last one
+            completeFrame(pMicros);
+        }
+        mChannel = 0;
+        misSynced = true;
+        return;
+    }
+
+    if (!misSynced)
+    {
+        // frame already published or dropped, wait for the next sync gap
+        return;
+    }
+
+    if (MIN_CHANNEL_WIDTH > interval || MAX_CHANNEL_WIDTH < interval || MAX_CHANNELS <= mChannel)
+    {
+        countError();
+        misSynced = false;
+        mExpectedChannels = 0;
+        return;
+    }
+
+    mFrame[mChannel++] = interval;
+    if (mChannel == mExpectedChannels)
+    {
+        publishFrame(mFrame, mChannel, pMicros);
+        misSynced = false;
+    }
+}
+
+/**
+ * publishes the channels received so far as a frame, if there are enough of them
+ *
+ * @param pMicros timestamp of the completion of the frame in usec
+ */
+void PpmDecoder::completeFrame(unsigned long pMicros)
+{
+    if (MIN_CHANNELS > mChannel)
+    {
+        countError();
+        mExpectedChannels = 0;
+        return;
+    }
+
+    mExpectedChannels = mChannel;
+    publishFrame(mFrame, mChannel, pMicros);
+}
@@ -0,0 +1,98 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef PPMDECODER_H_
+#define PPMDECODER_H_
+
+#include <stdint.h>
+
+#include "RcFrameDecoder.h"
+
+/**
+ * Decoder of a PPM sum signal, which carries all channels of a receiver on a single wire.
+ *
+ * Every channel is the time between two rising edges, a frame ends with a sync gap of at least SYNC_GAP. The decoder
+ * is fed with the timestamp of every rising edge, e.g. by the interrupt handler of the pin, and takes constant time
+ * per edge. After the first frame the number of channels is known and every later frame is published with the edge of
+ * its last channel, so the sync gap does not delay the inputs. A frame with an interval out of range is dropped and
+ * the decoder waits for the next sync gap.
+ */
+class PpmDecoder : public RcFrameDecoder
+{
+public:
+    /**
+     * minimum time in usec between two frames
+     */
+    static const unsigned long SYNC_GAP = 3000;
+
+    /**
+     * shortest valid channel in usec
+     */
+    static const unsigned long MIN_CHANNEL_WIDTH = 700;
+
+    /**
+     * longest valid channel in usec
+     */
+    static const unsigned long MAX_CHANNEL_WIDTH = 2300;
+
+    /**
+     * minimum number of channels of a frame
+     */
+    static const uint8_t MIN_CHANNELS = 3;
+
+    /**
+     * constructor, the channel order of most car receivers is steering, throttle, 3rd channel
+     *
+     * @param pThrottleChannel index of the throttle channel within a frame
+     * @param pSteeringChannel index of the steering channel within a frame
+     * @param p3rdChannel index of the 3rd channel within a frame
+     */
+    PpmDecoder(uint8_t pThrottleChannel = 1, uint8_t pSteeringChannel = 0, uint8_t p3rdChannel = 2);
+
+    /**
+     * handles a rising edge of the signal, may be called from an interrupt
+     *
+     * @param pMicros timestamp of the edge in usec
+     */
+    void handleEdge(unsigned long pMicros);
+
+private:
+    /**
+     * publishes the channels received so far as a frame, if there are enough of them
+     *
+     * @param pMicros timestamp of the completion of the frame in usec
+     */
+    void completeFrame(unsigned long pMicros);
+
+    // channels of the running frame
+    uint16_t mFrame[MAX_CHANNELS];
+    uint8_t mChannel;
+
+    // number of channels learned from the last frame, which ended with a sync gap
+    uint8_t mExpectedChannels;
+
+    // true if the decoder saw a sync gap and the running frame is not published yet
+    bool misSynced;
+    bool misEdgeSeen;
+
+    unsigned long mLastEdgeMicros;
+};
+
+#endif /* PPMDECODER_H_ */
@@ -0,0 +1,181 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "PulseCapture.h"
+
+PulseCapture::Channel_t PulseCapture::sChannels[PulseCapture::MAX_CHANNELS];
+
+uint8_t PulseCapture::sNumChannels = 0;
+
+volatile uint8_t PulseCapture::sPulseCount = 0;
+
+#if defined(__AVR__)
+// the pin change interrupts are grouped by port, every group calls the same handler which checks all channels
+ISR(PCINT0_vect)
+{
+    PulseCapture::handlePinChange();
+}
+
+ISR(PCINT1_vect)
+{
+    PulseCapture::handlePinChange();
+}
+
+ISR(PCINT2_vect)
+{
+    PulseCapture::handlePinChange();
+}
+#endif
+
+/**
+ * assigns an input pin to a channel and enables the pin change interrupt for the pin
+ *
+ * @param pChannel channel number (0 .. MAX_CHANNELS - 1)
+ * @param pPin arduino pin delivering the RC signal
+ */
+void PulseCapture::attach(uint8_t pChannel, int pPin)
+{
+    if (MAX_CHANNELS <= pChannel)
+    {
+        return;
+    }
+
+    noInterrupts();
+
+    Channel_t &channel = sChannels[pChannel];
+    channel.inputRegister = portInputRegister(digitalPinToPort(pPin));
+    channel.bitMask = digitalPinToBitMask(pPin);
+    channel.lastLevel = *channel.inputRegister & channel.bitMask;
+    channel.riseMicros = 0;
+    channel.width = 0;
+    channel.fallMicros = 0;
+
+    if (sNumChannels <= pChannel)
+    {
+        sNumChannels = pChannel + 1;
+    }
+
+#if defined(__AVR__)
+    *digitalPinToPCMSK(pPin) |= bit(digitalPinToPCMSKbit(pPin));
+    *digitalPinToPCICR(pPin) |= bit(digitalPinToPCICRbit(pPin));
+#else
+    attachInterrupt(digitalPinToInterrupt(pPin), handlePinChange, CHANGE);
+#endif
+
+    interrupts();
+}
+
+/**
+ * returns the width of the last complete pulse of a channel
+ *
+ * @param pChannel channel number
+ * @return pulse width in microseconds or 0 if no pulse was seen within PULSE_TIMEOUT
+ */
+unsigned long PulseCapture::getPulseWidth(uint8_t pChannel)
+{
+    unsigned long width;
+    unsigned long fallMicros;
+
+    // 32 bit values are not read atomically on AVR
+    noInterrupts();
+    width = sChannels[pChannel].width;
+    fallMicros = sChannels[pChannel].fallMicros;
+    interrupts();
+
+    if (PULSE_TIMEOUT < micros() - fallMicros)
+    {
+        return 0;
+    }
+
+    return width;
+}
+
+/**
+ * checks if the interrupts may be disabled for the given duration without delaying an edge. The next rising edge of
+ * a channel is expected MIN_PULSE_PERIOD after its last one at the earliest.
+ *
+ * @param pDuration duration in microseconds
+ * @return true if no edge is expected within the duration
+ */
+bool PulseCapture::isQuiet(unsigned long pDuration)
+{
+    for (uint8_t i = 0; i < sNumChannels; ++i)
+    {
+        // the timestamps are written by the interrupt handler and 32 bit values are not read atomically on AVR. The
+        // time is taken within the snapshot, so an edge after it can not lie in the future and wrap sinceRise.
+        noInterrupts();
+        unsigned long now = micros();
+        uint8_t level = sChannels[i].lastLevel;
+        unsigned long riseMicros = sChannels[i].riseMicros;
+        interrupts();
+
+        unsigned long sinceRise = now - riseMicros;
+        if (level && sinceRise <= PULSE_TIMEOUT)
+        {
+            // a pulse is running
+            return false;
+        }
+        if (0 != riseMicros && sinceRise <= PULSE_TIMEOUT && MIN_PULSE_PERIOD <= sinceRise + pDuration)
+        {
+            // the next pulse may start within the duration
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * handles an edge on any of the attached pins. A pin change interrupt does not tell which pin has changed, so the
+ * levels of all channels are compared with the levels seen before.
+ */
+void PulseCapture::handlePinChange(void)
+{
+    unsigned long now = micros();
+
+    for (uint8_t i = 0; i < sNumChannels; ++i)
+    {
+        Channel_t &channel = sChannels[i];
+
+        if (!channel.inputRegister)
+        {
+            continue;
+        }
+
+        uint8_t level = *channel.inputRegister & channel.bitMask;
+
+        if (level != channel.lastLevel)
+        {
+            if (level)
+            {
+                channel.riseMicros = now;
+            }
+            else if (channel.riseMicros)
+            {
+                channel.width = now - channel.riseMicros;
+                channel.fallMicros = now;
+                ++channel.count;
+                ++sPulseCount;
+            }
+            channel.lastLevel = level;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef PULSECAPTURE_H_
+#define PULSECAPTURE_H_
+
+#include <stdint.h>
+
+/**
+ * Interrupt driven measurement of RC pulse widths.
+ *
+ * Instead of waiting for the pulses with pulseIn, every edge on the configured input pins raises a pin change
+ * interrupt. The interrupt handler timestamps the rising edge and stores the pulse width on the falling edge, so
+ * reading the latest width never blocks.
+ *
+ * There is only one set of pin change interrupts on the board, therefore the class is purely static.
+ */
+class PulseCapture
+{
+public:
+    /**
+     * maximum number of channels, which could be captured
+     */
+    static const uint8_t MAX_CHANNELS = 3;
+
+    /**
+     * time in microseconds after which a captured pulse is considered outdated (signal lost). A RC receiver sends
+     * a pulse every 20 msec.
+     */
+    static const unsigned long PULSE_TIMEOUT = 50000;
+
+    /**
+     * shortest period in microseconds between two pulses of a channel, which a RC receiver uses (20 msec for most
+     * receivers, 14 msec in the fast modes of some)
+     */
+    static const unsigned long MIN_PULSE_PERIOD = 14000;
+
+    /**
+     * assigns an input pin to a channel and enables the pin change interrupt for the pin. The pin has to be
+     * configured as INPUT before.
+     *
+     * @param pChannel channel number (0 .. MAX_CHANNELS - 1)
+     * @param pPin arduino pin delivering the RC signal
+     */
+    static void attach(uint8_t pChannel, int pPin);
+
+    /**
+     * returns the width of the last complete pulse of a channel
+     *
+     * @param pChannel channel number
+     * @return pulse width in microseconds or 0 if no pulse was seen within PULSE_TIMEOUT
+     */
+    static unsigned long getPulseWidth(uint8_t pChannel);
+
+    /**
+     * returns a counter of the complete pulses on all channels. The counter wraps around, so it can only be used to
+     * detect new pulses by comparing it with a previous value.
+     *
+     * @return number of complete pulses (modulo 256)
+     */
+    static inline uint8_t getPulseCount(void)
+    {
+        return sPulseCount;
+    }
+
+    /**
+     * returns a counter of the complete pulses of a channel, which wraps around like getPulseCount
+     *
+     * @param pChannel channel number
+     * @return number of complete pulses of the channel (modulo 256)
+     */
+    static inline uint8_t getPulseCount(uint8_t pChannel)
+    {
+        return sChannels[pChannel].count;
+    }
+
+    /**
+     * checks if the interrupts may be disabled for the given duration without delaying an edge, e.g. to show a
+     * NeoPixel strip. This is the case if no pulse is running and no channel starts its next pulse within the
+     * duration, i.e. in the gap of the RC frame after the last channel. Lost channels are not waited for.
+     *
+     * @param pDuration duration in microseconds
+     * @return true if no edge is expected within the duration
+     */
+    static bool isQuiet(unsigned long pDuration);
+
+    /**
+     * handles an edge on any of the attached pins. Called by the pin change interrupt service routines.
+     */
+    static void handlePinChange(void);
+
+private:
+    typedef struct
+    {
+        volatile uint8_t *inputRegister;    // port input register of the pin
+        uint8_t bitMask;                    // bit of the pin within the port
+        uint8_t lastLevel;                  // level seen at the last interrupt
+        volatile uint8_t count;             // number of complete pulses (modulo 256)
+        unsigned long riseMicros;           // timestamp of the last rising edge
+        volatile unsigned long width;       // width of the last complete pulse
+        volatile unsigned long fallMicros;  // timestamp of the last falling edge
+    } Channel_t;
+
+    static Channel_t sChannels[MAX_CHANNELS];
+
+    static uint8_t sNumChannels;
+
+    static volatile uint8_t sPulseCount;
+};
+
+#endif /* PULSECAPTURE_H_ */
@@ -0,0 +1,115 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "PulsePoller.h"
+
+/**
+ * constructor, no channel is attached
+ */
+PulsePoller::PulsePoller(void)
+{
+    for (uint8_t i = 0; i < MAX_CHANNELS; ++i)
+    {
+        mChannels[i].inputRegister = NULL;
+        mChannels[i].bitMask = 0;
+        mChannels[i].riseMicros = 0;
+        mChannels[i].width = 0;
+    }
+}
+
+/**
+ * assigns an input pin to a channel. The pin has to be configured as INPUT before.
+ *
+ * @param pChannel channel number (0 .. MAX_CHANNELS - 1)
+ * @param pPin arduino pin delivering the RC signal
+ */
+void PulsePoller::attach(uint8_t pChannel, int pPin)
+{
+    if (MAX_CHANNELS <= pChannel)
+    {
+        return;
+    }
+
+    mChannels[pChannel].inputRegister = portInputRegister(digitalPinToPort(pPin));
+    mChannels[pChannel].bitMask = digitalPinToBitMask(pPin);
+}
+
+/**
+ * measures the next complete pulse of the given channels at once
+ *
+ * @param pChannelMask bit i selects channel i, unselected channels keep width 0
+ * @param pTimeout time in usec after which channels without a complete pulse get width 0
+ */
+void PulsePoller::measure(uint8_t pChannelMask, unsigned long pTimeout)
+{
+    // channels without a complete pulse yet
+    uint8_t pending = 0;
+    // channels, which were seen low, i.e. the next rising edge starts a complete pulse
+    uint8_t armed = 0;
+    // channels with a pulse in progress
+    uint8_t high = 0;
+
+    for (uint8_t i = 0; i < MAX_CHANNELS; ++i)
+    {
+        mChannels[i].width = 0;
+        if ((pChannelMask & bit(i)) && mChannels[i].inputRegister)
+        {
+            pending |= bit(i);
+        }
+    }
+
+    unsigned long start = micros();
+    unsigned long now = start;
+
+    while (pending && now - start < pTimeout)
+    {
+        now = micros();
+
+        for (uint8_t i = 0; i < MAX_CHANNELS; ++i)
+        {
+            uint8_t channelBit = bit(i);
+            if (!(pending & channelBit))
+            {
+                continue;
+            }
+
+            Channel_t &channel = mChannels[i];
+            if (*channel.inputRegister & channel.bitMask)
+            {
+                if ((armed & channelBit) && !(high & channelBit))
+                {
+                    channel.riseMicros = now;
+                    high |= channelBit;
+                }
+            }
+            else if (high & channelBit)
+            {
+                channel.width = now - channel.riseMicros;
+                pending &= ~channelBit;
+            }
+            else
+            {
+                armed |= channelBit;
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef PULSEPOLLER_H_
+#define PULSEPOLLER_H_
+
+#include <stdint.h>
+
+/**
+ * Blocking measurement of the pulse widths of all RC channels at once.
+ *
+ * pulseIn measures one channel after the other. A receiver sends the pulses of all channels within the same frame of
+ * 20 msec, so the next channel's pulse has mostly passed when pulseIn returns and a read of three channels spans two
+ * or three frames. The poller watches all pins in a single busy loop instead: it timestamps the rising and the falling
+ * edge of every channel and returns as soon as every channel has delivered a complete pulse, i.e. within one frame
+ * plus one pulse width. The widths of all channels are from the same frame, no matter whether the receiver sends the
+ * pulses together or one after another.
+ *
+ * A pulse, which is already running at the start of the measurement, is skipped. The resolution is the duration of
+ * a loop pass (a few usec on an AVR). Interrupts stay enabled, so an interrupt during an edge adds its duration to
+ * the width.
+ */
+class PulsePoller
+{
+public:
+    /**
+     * maximum number of channels
+     */
+    static const uint8_t MAX_CHANNELS = 3;
+
+    /**
+     * time in usec, after which a measurement gives up: a frame of 20 msec plus the longest pulse
+     */
+    static const unsigned long DEFAULT_TIMEOUT = 22500;
+
+    /**
+     * constructor, no channel is attached
+     */
+    PulsePoller(void);
+
+    /**
+     * assigns an input pin to a channel. The pin has to be configured as INPUT before.
+     *
+     * @param pChannel channel number (0 .. MAX_CHANNELS - 1)
+     * @param pPin arduino pin delivering the RC signal
+     */
+    void attach(uint8_t pChannel, int pPin);
+
+    /**
+     * measures the next complete pulse of the given channels at once
+     *
+     * @param pChannelMask bit i selects channel i, unselected channels keep width 0
+     * @param pTimeout time in usec after which channels without a complete pulse get width 0
+     */
+    void measure(uint8_t pChannelMask, unsigned long pTimeout = DEFAULT_TIMEOUT);
+
+    /**
+     * @param pChannel channel number
+     * @return pulse width in usec of the last measurement or 0 if no pulse was seen
+     */
+    inline unsigned long getPulseWidth(uint8_t pChannel) const
+    {
+        return mChannels[pChannel].width;
+    }
+
+private:
+    typedef struct
+    {
+        volatile uint8_t *inputRegister;    // port input register of the pin
+        uint8_t bitMask;                    // bit of the pin within the port
+        unsigned long riseMicros;           // timestamp of the rising edge
+        unsigned long width;                // width of the last complete pulse
+    } Channel_t;
+
+    Channel_t mChannels[MAX_CHANNELS];
+};
+
+#endif /* PULSEPOLLER_H_ */
@@ -0,0 +1,74 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <EEPROM.h>
+
+#include "RcCalibration.h"
+
+/**
+ * reads the record from the EEPROM
+ *
+ * @param pData receives the record, its content is undefined if the record is not valid
+ * @return true if the record is valid
+ */
+bool RcCalibration::load(Data_t &pData)
+{
+    EEPROM.get(EEPROM_ADDRESS, pData);
+    return MAGIC == pData.magic && VERSION == pData.version && calculateCrc(pData) == pData.crc;
+}
+
+/**
+ * writes the record with magic, version and CRC to the EEPROM. Only bytes which differ are written to save write
+ * cycles of the EEPROM.
+ *
+ * @param pThrottle calibration of the throttle channel
+ * @param pSteering calibration of the steering channel
+ */
+void RcCalibration::save(const Channel_t &pThrottle, const Channel_t &pSteering)
+{
+    Data_t data;
+    data.magic = MAGIC;
+    data.version = VERSION;
+    data.throttle = pThrottle;
+    data.steering = pSteering;
+    data.crc = calculateCrc(data);
+    EEPROM.put(EEPROM_ADDRESS, data);
+}
+
+/**
+ * @return CRC-16 (CCITT, initial value 0xFFFF) of the record without its CRC
+ */
+uint16_t RcCalibration::calculateCrc(const Data_t &pData)
+{
+    const uint8_t *bytes = (const uint8_t *) &pData;
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < offsetof(Data_t, crc); ++i)
+    {
+        crc ^= (uint16_t) bytes[i] << 8;
+        for (uint8_t bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+}
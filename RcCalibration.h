@@ -0,0 +1,90 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCCALIBRATION_H_
+#define RCCALIBRATION_H_
+
+#include <stdint.h>
+
+/**
+ * Calibration of the RC channels, which is stored in the EEPROM.
+ *
+ * The record holds the neutral point and both endpoints of the throttle and the steering channel in usec, a magic
+ * byte, a version and a CRC-16 (CCITT) over all other bytes. A record is only accepted if all of them match, so an
+ * erased EEPROM, a record of another firmware or an interrupted write lead to a new calibration at startup.
+ */
+class RcCalibration
+{
+public:
+    // address of the record within the EEPROM
+    static const int EEPROM_ADDRESS = 0;
+
+    // marks the start of a record
+    static const uint8_t MAGIC = 0xCA;
+
+    // version of the record layout, has to be increased with every change of Data_t
+    static const uint8_t VERSION = 1;
+
+    /**
+     * calibration of a single channel, all pulse widths in usec
+     */
+    typedef struct
+    {
+        uint16_t neutral;
+        uint16_t min;
+        uint16_t max;
+    } Channel_t;
+
+    /**
+     * record stored in the EEPROM, has no padding on the AVR and on the host
+     */
+    typedef struct
+    {
+        uint8_t magic;
+        uint8_t version;
+        Channel_t throttle;
+        Channel_t steering;
+        uint16_t crc;
+    } Data_t;
+
+    /**
+     * reads the record from the EEPROM
+     *
+     * @param pData receives the record, its content is undefined if the record is not valid
+     * @return true if the record is valid
+     */
+    static bool load(Data_t &pData);
+
+    /**
+     * writes the record with magic, version and CRC to the EEPROM. Only bytes which differ are written to save write
+     * cycles of the EEPROM.
+     *
+     * @param pThrottle calibration of the throttle channel
+     * @param pSteering calibration of the steering channel
+     */
+    static void save(const Channel_t &pThrottle, const Channel_t &pSteering);
+
+    /**
+     * @return CRC-16 (CCITT, initial value 0xFFFF) of the record without its CRC
+     */
+    static uint16_t calculateCrc(const Data_t &pData);
+};
+
+#endif /* RCCALIBRATION_H_ */
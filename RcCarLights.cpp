@@ -21,438 +21,455 @@
 #include "Arduino.h"
 //#include <Adafruit_NeoPixel.h>
 #include "RcCarLights.h"
-#include "XenonLightSwitchBehaviour.h"
-
-// pin 7 for pwm input
-const int gPinThrottle = 7;
-
-// pin 8 for pwm input
-const int gPinSteering = 8;
-
-// pin 9 for pwm input
-const int gPin3rdChannel = 9;
-
-const int gPinParkingLight = 2;
-const int gPinHeadingLight = 3;
-const int gPinNeoPixel = 4;
-
-const int gPinEmergencyLightSwitch = 10;
-const int gPinSireneSwitch = 11;
-const int gPinTrafficBarSwitch = 12;
-
-#define DEBUG 1
-
-#define THROTTLE_REVERSE    true
-XenonLightSwitchBehaviour gHeadlightBehaviour;
 
 /**
- * Constructor
+ * Constructor, all state is held by the instance, so several instances can run side by side (e.g. on the host, each
+ * with its own emulated board). The pins of the adapter and the light controller are taken from the vehicle
+ * configuration.
  */
-RcCarLights::RcCarLights() :
-        mRemoteControlCarAdapter(gPinThrottle, THROTTLE_REVERSE, gPinSteering,
-                gPin3rdChannel), mLightController(gPinParkingLight,
-                gPinHeadingLight, gPinNeoPixel), mLightSwitchCondition(*this), mLightSwitch(
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::BasicRcCarLights(void) :
+        mLightSwitchCondition(*this), mLightSwitch(
                 mLightSwitchCondition, SWITCH_LIGHT_DURATION,
                 SWITCH_LIGHT_COOL_DOWN), mSireneSwitchCondition(*this), mSireneSwitch(
                 mSireneSwitchCondition, SWITCH_SIREN_DURATION,
                 SWITCH_SIREN_COOL_DOWN), mEmergencySwitchCondition(*this), mEmergencyLightBarSwitch(
                 mEmergencySwitchCondition), mTrafficLightSwitchCondition(*this), mTrafficLightBarSwitch(
-                mTrafficLightSwitchCondition)
+                mTrafficLightSwitchCondition), mTelemetry(TELEMETRY_INTERVAL)
 {
-    // is true if parking light is on, false otherwise
+    // all lights are off at startup
     mLightStatus.parkingLight = 0;
-
-    misLightSwitchPressed = false;
-
-    // is true if dimmed headlights are on, false otherwise
-
     mLightStatus.headlight = 0;
-
-    // is true if break light is on, false otherwise
     mLightStatus.brakeLight = 0;
-
-    // initialize timestamp when brakes switched on with 0
-    mBrakeLightsOnTimestamp = 0;
-
-    // is true if back up light is on, false otherwise
     mLightStatus.backUpLight = 0;
-
-    // blinkers are off
     mLightStatus.rightBlinker = 0;
     mLightStatus.leftBlinker = 0;
 
-    // last timestamp of blinker switch;
-    mLastBlinkTimestamp = 0;
+    // no frame is calculated before the first loop has published the inputs
+    misInputsChanged = false;
+    misRuleDeadlineActive = false;
+    mRuleDeadline = 0;
+#ifdef PROFILE_STAGES
+    mNextProfileDump = 0;
+#endif
+}
 
-    // no blinking at startup
-    misBlinkingOn = false;
+/**
+ * Destructor, stops the frames
+ */
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::~BasicRcCarLights()
+{
+    FrameClock::stop();
 }
 
 /**
  * configure the input and output pins of
  */
-void RcCarLights::setup(void)
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::setup(void)
 {
-    Serial.begin(9600);
+    Serial.begin(SERIAL_BAUD_RATE);
     mRemoteControlCarAdapter.setupPins();
+#ifdef RECORD_RC_TRACE
+    mRemoteControlCarAdapter.setTraceRecorder(&mTraceRecorder);
+#endif
 
     mLightController.setupPins();
     mLightController.addBehaviour(AbstractRcCarLightController::HEADLIGHT,
-            &gHeadlightBehaviour);
-#ifdef DEBUG
-    Serial.print("\nSetup.");
-#endif
+            &mHeadlightBehaviour);
     mLightSwitch.setup();
     mEmergencyLightBarSwitch.setup();
     mSireneSwitch.setup();
     mTrafficLightBarSwitch.setup();
 
+    // the first loop does a complete pass
+    mScheduler.schedule(INPUT_TIMEOUT_TIMER, millis());
+#ifdef PROFILE_STAGES
+    mNextProfileDump = millis() + PROFILE_INTERVAL;
+#endif
+
+    FrameClock::start(this);
 }
 
 /**
- * handles the light control:
+ * shows the frame calculated last by the light controller, while no RC pulse is measured, and handles the inputs of
+ * the light control:
  * 1. rerfresh the information read from RC
- * 2. calculates the new light status
- * 3. set the lights according to the light status
+ * 2. publishes the inputs to the frames, which calculate the light status and set the lights
+ * 3. sends telemetry
+ * 4. schedules the deadlines, at which the inputs may change without new RC pulses
+ *
+ * All of this depends on the RC pulses and the time only, so the pass is skipped if neither new pulses arrived nor a
+ * deadline is due. With PROFILE_STAGES the stages are measured by the stage profiler.
  */
-void RcCarLights::loop(void)
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::loop(void)
 {
-    mRemoteControlCarAdapter.refresh();
-
-    // Switch refresh
-    mLightSwitch.refresh();
-    mEmergencyLightBarSwitch.refresh();
-    mSireneSwitch.refresh();
-    mTrafficLightBarSwitch.refresh();
-
-    updateLightStatus();
-#ifdef DEBUG
-
-    Serial.print("\nLights : ");
-    Serial.print(mLightStatus.parkingLight);
-
-    Serial.print("   Headlights : ");
-    Serial.print(mLightStatus.headlight);
-
-    Serial.print("   BackUpLights : ");
-    Serial.print(mLightStatus.backUpLight);
+    unsigned long now = millis();
 
-    Serial.print("   Brakelights : ");
-    Serial.print(mLightStatus.brakeLight);
-
-    Serial.print("   Blinking : ");
-    Serial.print(misBlinkingOn);
-
-    if (mLightStatus.leftBlinker)
+    // showing the frame blocks the interrupts, so it is done outside of the frame interrupt and between the pulses
+    if (mRemoteControlCarAdapter.isInputQuiet(TController::SHOW_MICROS))
     {
-        Serial.print(" (L)");
+        mLightController.showFrame();
     }
-    else if (mLightStatus.rightBlinker)
+
+    if (!mRemoteControlCarAdapter.hasNewInputs() && !mScheduler.isDue(now))
     {
-        Serial.print(" (R)");
+        mScheduler.countPass(now, true);
+        flushSerial();
+        return;
     }
-    else
+    mScheduler.countPass(now, false);
+
     {
-        Serial.print(" (  )");
+        PROFILE_STAGE(mProfiler, ADAPTER_STAGE);
+        mRemoteControlCarAdapter.refresh();
     }
 
-    Serial.print("  Throttle : ");
-    Serial.print(mRemoteControlCarAdapter.getThrottle());
-
-    Serial.print("  Throttle Switch : ");
-    Serial.print(mRemoteControlCarAdapter.getThrottleSwitch());
-
-    Serial.print("     Acceleration : ");
-    Serial.print(mRemoteControlCarAdapter.getAcceleration());
-
-    Serial.print("  Steering : ");
-    Serial.print(mRemoteControlCarAdapter.getSteering());
-
-    Serial.print("  Steering : ");
-    Serial.print(mRemoteControlCarAdapter.getSteeringSwitch());
-
-    Serial.print("  Light : ");
-    Serial.print(mLightSwitch.getState());
+    // Switch refresh
+    {
+        PROFILE_STAGE(mProfiler, SWITCHES_STAGE);
+        mLightSwitch.refresh();
+        mEmergencyLightBarSwitch.refresh();
+        mSireneSwitch.refresh();
+        mTrafficLightBarSwitch.refresh();
+    }
 
-    Serial.print("  Emergency light : ");
-    Serial.print(mEmergencyLightBarSwitch.getState());
+    {
+        PROFILE_STAGE(mProfiler, PUBLISH_STAGE);
+        publishInputs();
+    }
 
-    Serial.print("  Traffic light : ");
-    Serial.print(mTrafficLightBarSwitch.getState());
+    {
+        PROFILE_STAGE(mProfiler, TELEMETRY_STAGE);
+        sendTelemetry();
+    }
 
-    Serial.print("  Siren : ");
-    Serial.print(mSireneSwitch.getState());
+#ifdef PROFILE_STAGES
+    dumpProfile(now);
 #endif
 
-    setLights();
-
+    scheduleDeadlines(now);
 }
 
 /**
- * updates the light status of the different lights
+ * calculates a frame: applies the light rules and sets the lights. Called by the frame clock from the timer
+ * interrupt. The frame is skipped if neither new inputs were published nor a light rule or a behaviour may change.
  */
-void RcCarLights::updateLightStatus()
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::onFrame(void)
 {
-    // switch light (in general) on and off
-    handleLightSwitch();
+    unsigned long now = millis();
 
-    // switch headlights on or off
-    handleHeadlight();
-
-    // switch on/off back-up lights
-    handleBackUpLights();
-
-    // swicth on off brake lights
-    handleBrakeLights();
-
-    // no blinker if steering is neutral
-    handleBlinkerSwitch();
+    if (misInputsChanged)
+    {
+        misInputsChanged = false;
+    }
+    else if (!(misRuleDeadlineActive && 0 <= (long) (now - mRuleDeadline)) && mLightController.isSteady())
+    {
+        return;
+    }
 
-    // switch blinker on and off
-    doBlinking();
-}
+    {
+        PROFILE_STAGE(mProfiler, LIGHT_RULES_STAGE);
+        updateLightStatus(now);
+    }
 
-/**
- * switches lights output pin(s) according to the current status
- */
-void RcCarLights::setLights()
-{
-    mLightController.loop(mLightStatus);
+    {
+        PROFILE_STAGE(mProfiler, SET_LIGHTS_STAGE);
+        setLights();
+    }
 }
 
 /**
- * handles the general light switch
+ * returns the time until an impulse switch may change, which has a condition based on the duration of a RC switch.
+ * This is the case when the hold time or the hold time plus cool down time is reached.
  *
- * The lights can be switched on and off by the so called throttle switch. When the throttle switch was set to FORWARD
- * for at least SWITCH_DURATION_LIGHTS, the lights will be switched on or off.
+ * @param pDuration duration in msec of the current RC switch position
+ * @param pHoldDuration hold time of the impulse switch
+ * @param pCoolDown cool down time of the impulse switch
+ * @return time in msec until the switch may change, 0 if it cannot change anymore
  */
-void RcCarLights::handleLightSwitch()
+static unsigned long getSwitchHoldTimeToChange(unsigned long pDuration, unsigned long pHoldDuration,
+                                               unsigned long pCoolDown)
 {
-    mLightStatus.parkingLight = (Switch::ON == mLightSwitch.getState()) ? 1 : 0;
+    if (pDuration <= pHoldDuration)
+    {
+        return pHoldDuration + 1 - pDuration;
+    }
+    if (pDuration <= pHoldDuration + pCoolDown)
+    {
+        return pHoldDuration + pCoolDown + 1 - pDuration;
+    }
+    return 0;
 }
 
 /**
- * handles the headlights
+ * schedules all deadlines, at which the inputs may change without new RC pulses. Changes of the lights without new
+ * inputs are handled by the frames.
  *
- * The headlights are turned on, when the car starts moving (forward or backward)
+ * @param pNow timestamp of the current pass in msec
  */
-void RcCarLights::handleHeadlight()
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::scheduleDeadlines(unsigned long pNow)
 {
-    // switch headlights on or off
-    if (mLightStatus.parkingLight)
+    // a lost RC signal is detected by the pulse capture timeout, no edge arrives in this case
+    mScheduler.schedule(INPUT_TIMEOUT_TIMER, pNow + PulseCapture::PULSE_TIMEOUT / 1000 + 1);
+
+    mScheduler.schedule(ACCELERATION_TIMER, mRemoteControlCarAdapter.getNextAccelerationTimestamp());
+
+    // light switch is held by throttle switch FORWARD, siren switch by steering switch LEFT
+    unsigned long holdTime = 0;
+    if (RemoteControlCarAdapter::FORWARD == mRemoteControlCarAdapter.getThrottleSwitch())
     {
-        // headlights will be switched on when car starts moving and the throttle switch is not FORWARD
-        if (RemoteControlCarAdapter::FORWARD
-                != mRemoteControlCarAdapter.getThrottleSwitch())
+        holdTime = getSwitchHoldTimeToChange(mRemoteControlCarAdapter.getDurationOfThrottleSwitch(),
+                                             SWITCH_LIGHT_DURATION, SWITCH_LIGHT_COOL_DOWN);
+    }
+    if (RemoteControlCarAdapter::LEFT == mRemoteControlCarAdapter.getSteeringSwitch())
+    {
+        unsigned long sirenHoldTime = getSwitchHoldTimeToChange(
+                mRemoteControlCarAdapter.getDurationOfSteeringSwitch(), SWITCH_SIREN_DURATION,
+                SWITCH_SIREN_COOL_DOWN);
+        if (0 == holdTime || (0 != sirenHoldTime && sirenHoldTime < holdTime))
         {
-            // lights are switched on let's test for any movement
-            if (RemoteControlCarAdapter::STOP
-                    != mRemoteControlCarAdapter.getThrottle())
-            {
-                // switch the lights on, we are on the road
-                mLightStatus.headlight = 1;
-            }
-            else
-            {
-                // switch back to parking lights after delay
-                if (DIM_HEADLIGHTS_TO_PARKING_DELAY
-                        < mRemoteControlCarAdapter.getDurationOfThrottleSwitch())
-                {
-                    // look's we are parking: DIM THE LIGHTS...
-                    mLightStatus.headlight = 0;
-                }
-            }
+            holdTime = sirenHoldTime;
         }
     }
+    if (0 != holdTime)
+    {
+        mScheduler.schedule(SWITCH_HOLD_TIMER, pNow + holdTime);
+    }
     else
     {
-        mLightStatus.headlight = 0;
+        mScheduler.cancel(SWITCH_HOLD_TIMER);
+    }
+
+    if (mTelemetry.isEnabled())
+    {
+        mScheduler.schedule(TELEMETRY_TIMER, mTelemetry.getNextFrameTimestamp());
     }
+#ifdef PROFILE_STAGES
+    mScheduler.schedule(PROFILE_TIMER, mNextProfileDump);
+#endif
 }
 
 /**
- * handles brake lights
- *
- * Brake lights will be switched if acceleration is below a specific threshold
+ * sends a telemetry frame with light status, RC inputs and switch states if the telemetry interval has elapsed and
+ * passes queued telemetry data to the serial port without blocking
  */
-void RcCarLights::handleBrakeLights()
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::sendTelemetry()
 {
-//    Serial.print( "    ");
-//    Serial.print( BREAK_ACCELERATION_LEVEL );
-//    Serial.print( "    ");
-//    Serial.print( mRemoteControlCarAdapter.getAcceleration() );
-//    Serial.print( "  Cond  ");
-//    Serial.print( BREAK_ACCELERATION_LEVEL > mRemoteControlCarAdapter.getAcceleration() );
-
-// switch on/off brake lights
-    if (BREAK_ACCELERATION_LEVEL > mRemoteControlCarAdapter.getAcceleration())
+    if (mTelemetry.isDue(millis()))
     {
-        // brake lights on and store timestamp
-        mLightStatus.brakeLight = 1;
-        mBrakeLightsOnTimestamp = millis();
-    }
-    else
-    {
-        if (RemoteControlCarAdapter::STOP
-                == mRemoteControlCarAdapter.getThrottle())
-        {
-            // if brake lights are on switch them off with a delay
-            if (mLightStatus.brakeLight
-                    && (BREAK_LIGHTS_OFF_STAND_STILL_DELAY
-                            < millis() - mBrakeLightsOnTimestamp))
-            {
-                mLightStatus.brakeLight = 0;
-            }
-        }
-        else
-        {
-            // if brake lights are on switch them off with a delay
-            if (mLightStatus.brakeLight
-                    && (BREAK_LIGHTS_OFF_DELAY
-                            < millis() - mBrakeLightsOnTimestamp))
-            {
-                mLightStatus.brakeLight = 0;
-            }
-        }
+        TelemetryFrame frame;
+
+        // the light status is written by the frames
+        noInterrupts();
+        AbstractRcCarLightController::CarLightsStatus_t lightStatus = mLightStatus;
+        bool isBlinkingOn = mLightRules.template getRule<BlinkerRule_t>().isBlinkingOn();
+        interrupts();
+
+        frame.timestamp = millis();
+        frame.lightStatus = (lightStatus.parkingLight ? TelemetryFrame::PARKING_LIGHT_BIT : 0)
+                | (lightStatus.headlight ? TelemetryFrame::HEADLIGHT_BIT : 0)
+                | (lightStatus.rightBlinker ? TelemetryFrame::RIGHT_BLINKER_BIT : 0)
+                | (lightStatus.leftBlinker ? TelemetryFrame::LEFT_BLINKER_BIT : 0)
+                | (lightStatus.backUpLight ? TelemetryFrame::BACKUP_LIGHT_BIT : 0)
+                | (lightStatus.brakeLight ? TelemetryFrame::BRAKE_LIGHT_BIT : 0)
+                | (isBlinkingOn ? TelemetryFrame::BLINKING_ON_BIT : 0);
+        frame.throttle = mRemoteControlCarAdapter.getThrottle();
+        frame.throttleSwitch = mRemoteControlCarAdapter.getThrottleSwitch();
+        frame.steering = mRemoteControlCarAdapter.getSteering();
+        frame.steeringSwitch = mRemoteControlCarAdapter.getSteeringSwitch();
+        frame.acceleration = mRemoteControlCarAdapter.getAcceleration();
+        frame.throttleValue = mRemoteControlCarAdapter.getRawThrottleValue();
+        frame.steeringValue = mRemoteControlCarAdapter.getRawSteeringValue();
+        frame.thirdChannelValue = mRemoteControlCarAdapter.getRaw3rdChannelValue();
+        frame.switches = ((Switch::ON == mLightSwitch.getState()) ? TelemetryFrame::LIGHT_SWITCH_BIT : 0)
+                | ((Switch::ON == mEmergencyLightBarSwitch.getState()) ?
+                        TelemetryFrame::EMERGENCY_LIGHT_BAR_SWITCH_BIT : 0)
+                | ((Switch::ON == mTrafficLightBarSwitch.getState()) ?
+                        TelemetryFrame::TRAFFIC_LIGHT_BAR_SWITCH_BIT : 0)
+                | ((Switch::ON == mSireneSwitch.getState()) ? TelemetryFrame::SIREN_SWITCH_BIT : 0)
+                | (mRemoteControlCarAdapter.isFailsafe() ? TelemetryFrame::FAILSAFE_BIT : 0);
+
+        mTelemetry.send(frame);
     }
+
+    flushSerial();
 }
 
 /**
- * handles backup lights
- *
- * Backup lights will be turned on when car moves backwards
+ * passes queued telemetry (or trace) data to the serial port without blocking
  */
-void RcCarLights::handleBackUpLights()
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::flushSerial()
 {
-    // switch on/off back-up lights
-    mLightStatus.backUpLight = (RemoteControlCarAdapter::BACKWARD
-            == mRemoteControlCarAdapter.getThrottle());
+    mTelemetry.flush();
+#ifdef RECORD_RC_TRACE
+    mTraceRecorder.flush();
+#endif
 }
 
+#ifdef PROFILE_STAGES
 /**
- * handles blinker switch
+ * prints the stage profile over the serial port and clears it, if the profile interval has elapsed. Printing blocks
+ * the loop until the text is passed to the serial port, so the profile is cleared afterwards.
  *
- * The blinker will be turned on whenever the car did not move but the steering is left or right. When steering goes
- * back to neutral, the blinke is switched off. During movement no blinker will be switched on again.
+ * @param pNow timestamp of the current pass in msec
  */
-void RcCarLights::handleBlinkerSwitch()
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::dumpProfile(unsigned long pNow)
 {
-    // no blinker if steering is neutral
-    if (RemoteControlCarAdapter::NEUTRAL
-            == mRemoteControlCarAdapter.getSteering())
+    if (0 <= (long) (pNow - mNextProfileDump))
     {
-        misBlinkingOn = false;
-        mLightStatus.leftBlinker = false;
-        mLightStatus.rightBlinker = false;
+        mProfiler.dump(Serial);
+        mProfiler.reset();
+        mNextProfileDump = pNow + PROFILE_INTERVAL;
     }
-    else
+}
+#endif
+
+/**
+ * reads the inputs once into a snapshot and passes it to the frames. A deceleration is seen by a single refresh only
+ * (the throttle is STOP with the next one), so a snapshot, which was not taken by a frame yet, passes its deceleration
+ * on if it is stronger. Otherwise a pulse of another channel shortly after the throttle pulse would hide it.
+ */
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::publishInputs(void)
+{
+    LightRuleInputs_t inputs;
+
+    inputs.throttle = mRemoteControlCarAdapter.getThrottle();
+    inputs.throttleSwitch = mRemoteControlCarAdapter.getThrottleSwitch();
+    inputs.steering = mRemoteControlCarAdapter.getSteering();
+    inputs.durationOfThrottleSwitch = mRemoteControlCarAdapter.getDurationOfThrottleSwitch();
+    inputs.acceleration = mRemoteControlCarAdapter.getAcceleration();
+    inputs.isLightSwitchOn = (Switch::ON == mLightSwitch.getState());
+    inputs.isFailsafe = mRemoteControlCarAdapter.isFailsafe();
+    inputs.now = millis();
+
+    noInterrupts();
+    if (misInputsChanged && mInputs.acceleration < inputs.acceleration)
     {
-        // handle blinker logic, blinker will be switched on if car stand still (throttle is STOP) for a while.
-        if ((RemoteControlCarAdapter::STOP
-                == mRemoteControlCarAdapter.getThrottle())
-                && (BLINKING_ON_DELAY
-                        < mRemoteControlCarAdapter.getDurationOfThrottleSwitch()))
-        {
-            misBlinkingOn = true;
-        }
+        inputs.acceleration = mInputs.acceleration;
     }
+    mInputs = inputs;
+    misInputsChanged = true;
+    interrupts();
 }
 
 /**
- * flashes the blinker
+ * updates the light status of the different lights
+ *
+ * The light rules (see LightRules_t) are applied in order to the input snapshot of the last loop pass. The throttle
+ * switch keeps its position until the next pass, so its duration is advanced to the time of the frame.
  *
- * The blinker left or right will be switched on or off depending on the blink duration
+ * @param pNow timestamp of the frame in msec
  */
-void RcCarLights::doBlinking()
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::updateLightStatus(unsigned long pNow)
 {
-    // switch blinker on and off
-    if (misBlinkingOn)
-    {
-        if (RemoteControlCarAdapter::LEFT
-                == mRemoteControlCarAdapter.getSteering())
-        {
-            mLightStatus.rightBlinker = false;
-            if ((BLINKING_DURATION < millis() - mLastBlinkTimestamp))
-            {
-                mLightStatus.leftBlinker ^= 1;
-                mLastBlinkTimestamp = millis();
-            }
-        }
-        else if (RemoteControlCarAdapter::RIGHT
-                == mRemoteControlCarAdapter.getSteering())
-        {
-            mLightStatus.leftBlinker = false;
-            if (BLINKING_DURATION < millis() - mLastBlinkTimestamp)
-            {
-                mLightStatus.rightBlinker ^= 1;
-                mLastBlinkTimestamp = millis();
-            }
-        }
-    }
+    LightRuleInputs_t inputs = mInputs;
+
+    inputs.durationOfThrottleSwitch += pNow - inputs.now;
+    inputs.now = pNow;
+
+    mLightRules.update(mLightStatus, inputs);
+
+    unsigned long timeToChange = mLightRules.getTimeToChange(mLightStatus, inputs);
+    misRuleDeadlineActive = (LIGHT_RULE_NO_CHANGE != timeToChange);
+    mRuleDeadline = pNow + timeToChange;
+}
+
+/**
+ * switches lights output pin(s) according to the current status
+ */
+template<typename TConfig, typename TController>
+void BasicRcCarLights<TConfig, TController>::setLights()
+{
+    mLightController.loop(mLightStatus);
 }
 
-RcCarLights::LightSwitchCondition::LightSwitchCondition(
-        RcCarLights & pRcCarLights) :
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::LightSwitchCondition::LightSwitchCondition(
+        BasicRcCarLights & pRcCarLights) :
         mRcCarLights(pRcCarLights)
 {
 }
 
-RcCarLights::LightSwitchCondition::~LightSwitchCondition()
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::LightSwitchCondition::~LightSwitchCondition()
 {
 }
 
-bool RcCarLights::LightSwitchCondition::operator ()()
+template<typename TConfig, typename TController>
+bool BasicRcCarLights<TConfig, TController>::LightSwitchCondition::operator ()()
 {
     return RemoteControlCarAdapter::FORWARD
             == mRcCarLights.mRemoteControlCarAdapter.getThrottleSwitch();
 }
 
-RcCarLights::SireneSwitchCondition::SireneSwitchCondition(
-        RcCarLights & pRcCarLights) :
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::SireneSwitchCondition::SireneSwitchCondition(
+        BasicRcCarLights & pRcCarLights) :
         mRcCarLights(pRcCarLights)
 {
 }
 
-RcCarLights::SireneSwitchCondition::~SireneSwitchCondition()
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::SireneSwitchCondition::~SireneSwitchCondition()
 {
 }
 
-bool RcCarLights::SireneSwitchCondition::operator ()()
+template<typename TConfig, typename TController>
+bool BasicRcCarLights<TConfig, TController>::SireneSwitchCondition::operator ()()
 {
     return (Switch::ON == mRcCarLights.mEmergencyLightBarSwitch.getState())
             && (RemoteControlCarAdapter::LEFT
                     == mRcCarLights.mRemoteControlCarAdapter.getSteeringSwitch());
 }
 
-RcCarLights::EmergencySwitchCondition::EmergencySwitchCondition(
-        RcCarLights & pRcCarLights) :
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::EmergencySwitchCondition::EmergencySwitchCondition(
+        BasicRcCarLights & pRcCarLights) :
         mRcCarLights(pRcCarLights)
 {
 }
 
-RcCarLights::EmergencySwitchCondition::~EmergencySwitchCondition()
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::EmergencySwitchCondition::~EmergencySwitchCondition()
 {
 }
 
-bool RcCarLights::EmergencySwitchCondition::operator ()()
+template<typename TConfig, typename TController>
+bool BasicRcCarLights<TConfig, TController>::EmergencySwitchCondition::operator ()()
 {
     return (1500 > mRcCarLights.mRemoteControlCarAdapter.get3rdChannelValue()) ?
             true : false;
 }
 
-RcCarLights::TrafficlightSwitchCondition::TrafficlightSwitchCondition(
-        RcCarLights & pRcCarLights) :
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::TrafficlightSwitchCondition::TrafficlightSwitchCondition(
+        BasicRcCarLights & pRcCarLights) :
         mRcCarLights(pRcCarLights)
 {
 }
 
-RcCarLights::TrafficlightSwitchCondition::~TrafficlightSwitchCondition()
+template<typename TConfig, typename TController>
+BasicRcCarLights<TConfig, TController>::TrafficlightSwitchCondition::~TrafficlightSwitchCondition()
 {
 }
 
-bool RcCarLights::TrafficlightSwitchCondition::operator ()()
+template<typename TConfig, typename TController>
+bool BasicRcCarLights<TConfig, TController>::TrafficlightSwitchCondition::operator ()()
 {
         return (Switch::ON == mRcCarLights.mEmergencyLightBarSwitch.getState())
                 && (RemoteControlCarAdapter::RIGHT
                         == mRcCarLights.mRemoteControlCarAdapter.getSteeringSwitch());
  }
+
+// the light controller of the vehicle of this build
+template class BasicRcCarLights<VehicleConfig>;
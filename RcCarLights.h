@@ -23,79 +23,194 @@
 
 #include "RemoteControlCarAdapter.h"
 #include "CamaroRcCarLightController.h"
+#include "XenonLightSwitchBehaviour.h"
 #include "rccarswitches/ConditionSwitch.h"
 #include "rccarswitches/ImpulseSwitch.h"
+#include "TelemetryStream.h"
+#include "LightRuleEngine.h"
+#include "DeadlineScheduler.h"
+#include "FrameClock.h"
+#include "RcTraceRecorder.h"
+#include "StageProfiler.h"
+#include "VehicleConfig.h"
+
+// define RECORD_RC_TRACE to stream a trace of the raw RC inputs (see RcTrace) over the serial port instead of the
+// telemetry, e.g. to replay a field session on a PC
+//#define RECORD_RC_TRACE
+
+#if defined(RECORD_RC_TRACE) && defined(PROFILE_STAGES)
+#error "RECORD_RC_TRACE and PROFILE_STAGES both need the serial port"
+#endif
 
-class RcCarLights
+/**
+ * The light controller of the car.
+ *
+ * The main loop reads the RC inputs and publishes them as input snapshot. The light rules, the light behaviours and
+ * the outputs are calculated by the frames of the FrameClock, so blinking and fading keep their timing even if a
+ * loop pass is slow. Outputs blocking the interrupts, like the NeoPixel strip, are shown by the main loop in the gap
+ * between the RC pulses, so they neither delay the pulse capture nor stretch a polled pulse.
+ *
+ * The wiring and the thresholds are taken from the vehicle configuration TConfig (see VehicleConfig.h), which is
+ * passed on to the adapter of the RC inputs and the light controller. The light controller TController (see
+ * AbstractRcCarLightController) is called without a virtual function. The sketch uses RcCarLights, which is
+ * instantiated with the vehicle configuration of the build and the controller of the Camaro.
+ */
+template<typename TConfig = VehicleConfig, typename TController = BasicCamaroRcCarLightController<TConfig> >
+class BasicRcCarLights: public FrameListener
 {
 public:
 
-    RcCarLights();
+    /**
+     * adapter of the RC inputs
+     */
+    typedef BasicRemoteControlCarAdapter<RcInput_t, TConfig> RemoteControlCarAdapter_t;
+
+    /**
+     * light controller
+     */
+    typedef TController LightController_t;
+
+    BasicRcCarLights(void);
+
+    virtual ~BasicRcCarLights();
 
     void setup(void);
 
     void loop(void);
 
+    /**
+     * replaces the RC pins by another input source, e.g. the replay of a recorded trace. Has to be called before
+     * setup.
+     *
+     * @param pInputSource input source or NULL to read the pins
+     */
+    inline void setInputSource(RcInputSource *pInputSource)
+    {
+        mRemoteControlCarAdapter.setInputSource(pInputSource);
+    }
+
+    /**
+     * @return the adapter of the RC inputs, e.g. for the diagnostic counters of the channels
+     */
+    inline RemoteControlCarAdapter_t &getRemoteControlCarAdapter(void)
+    {
+        return mRemoteControlCarAdapter;
+    }
+
+    /**
+     * @return the light controller, e.g. for the frame counters of the outputs
+     */
+    inline LightController_t &getLightController(void)
+    {
+        return mLightController;
+    }
+
+    /**
+     * @return number of loop passes within the last second, which were skipped because neither new RC pulses
+     * arrived nor any deadline was due
+     */
+    inline unsigned long getSkippedPassesPerSecond(void)
+    {
+        return mScheduler.getSkippedPerSecond();
+    }
+
+    /**
+     * @return number of loop passes within the last second, which refreshed inputs and lights
+     */
+    inline unsigned long getExecutedPassesPerSecond(void)
+    {
+        return mScheduler.getExecutedPerSecond();
+    }
+
+#ifdef PROFILE_STAGES
+    /**
+     * @return execution times of the stages since the last dump of the profile
+     */
+    inline const StageProfiler &getProfiler(void)
+    {
+        return mProfiler;
+    }
+#endif
+
 private:
 
+    /**
+     * timers of the deadline scheduler
+     */
+    typedef enum
+    {
+        INPUT_TIMEOUT_TIMER, // the RC signal may be lost without any further edge
+        ACCELERATION_TIMER,  // next acceleration measurement of the adapter
+        SWITCH_HOLD_TIMER,   // hold and cool down time of the impulse switches
+        TELEMETRY_TIMER,     // next telemetry frame
+        PROFILE_TIMER        // next dump of the stage profile (PROFILE_STAGES only)
+    } Timer_t;
+
     class LightSwitchCondition: public Condition
     {
     public:
-        LightSwitchCondition(RcCarLights & pRcCarLights);
+        LightSwitchCondition(BasicRcCarLights & pRcCarLights);
         virtual ~LightSwitchCondition();
 
         virtual bool operator()();
 
     private:
-        RcCarLights & mRcCarLights;
+        BasicRcCarLights & mRcCarLights;
     };
 
     class SireneSwitchCondition: public Condition
     {
     public:
-        SireneSwitchCondition(RcCarLights & pRcCarLights);
+        SireneSwitchCondition(BasicRcCarLights & pRcCarLights);
         virtual ~SireneSwitchCondition();
 
         virtual bool operator()();
 
     private:
-        RcCarLights & mRcCarLights;
+        BasicRcCarLights & mRcCarLights;
     };
 
     class EmergencySwitchCondition: public Condition
     {
     public:
-        EmergencySwitchCondition(RcCarLights & pRcCarLights);
+        EmergencySwitchCondition(BasicRcCarLights & pRcCarLights);
         virtual ~EmergencySwitchCondition();
 
         virtual bool operator()();
 
     private:
-        RcCarLights & mRcCarLights;
+        BasicRcCarLights & mRcCarLights;
     };
 
     class TrafficlightSwitchCondition: public Condition
     {
     public:
-        TrafficlightSwitchCondition(RcCarLights & pRcCarLights);
+        TrafficlightSwitchCondition(BasicRcCarLights & pRcCarLights);
         virtual ~TrafficlightSwitchCondition();
 
         virtual bool operator()();
 
     private:
-        RcCarLights & mRcCarLights;
+        BasicRcCarLights & mRcCarLights;
     };
 
-    void updateLightStatus();
+    virtual void onFrame(void);
+
+    void publishInputs(void);
+
+    void updateLightStatus(unsigned long pNow);
 
     void setLights();
 
-    void handleLightSwitch();
-    void handleHeadlight();
-    void handleBackUpLights();
-    void handleBrakeLights();
-    void handleBlinkerSwitch();
-    void doBlinking();
+    void sendTelemetry();
+
+    void flushSerial();
+
+#ifdef PROFILE_STAGES
+    void dumpProfile(unsigned long pNow);
+#endif
+
+    void scheduleDeadlines(unsigned long pNow);
 
     // duration in msec to switch on/off lights
     static const long SWITCH_LIGHT_DURATION = 1000;
@@ -113,43 +228,112 @@ private:
     static const unsigned long DIM_HEADLIGHTS_TO_PARKING_DELAY = 1500;
 
     // duration of blinker (on or off) in msec
-    static const long BLINKING_DURATION = 600;
+    static const unsigned long BLINKING_DURATION = 600;
 
     // delay in msec before blinking starts when stands still and steering is LEFT or RIGHT
     static const unsigned long BLINKING_ON_DELAY = 300;
 
+    // duration of the hazard lights (on or off) in msec, which blink while the RC signal is lost
+    static const unsigned long HAZARD_BLINKING_DURATION = 400;
+
     // switch of delay for breaks to decrease flickering
     static const unsigned long BREAK_LIGHTS_OFF_DELAY = 200;
 
     // switch of delay for breaks when stand still
-    static const long BREAK_LIGHTS_OFF_STAND_STILL_DELAY = 1800;
+    static const unsigned long BREAK_LIGHTS_OFF_STAND_STILL_DELAY = 1800;
 
     // switch of delay for breaks when stand still
     static const long BREAK_LIGHTS_OFF__STAND_STILL_DELAY = 700;
 
-    // acceleration threshold for brake lights
-    static const long BREAK_ACCELERATION_LEVEL = -20;
-
     static const unsigned long THRESHOLD_3RD_CHANNEL = 512;
 
-    // flag if light is switched is currently pressed (needed to suppress toggling the lights)
-    bool misLightSwitchPressed;
+    // interval in msec between two telemetry frames, 0 switches telemetry off. With RECORD_RC_TRACE the serial
+    // port is used by the trace recorder instead, which needs a faster line to record every executed pass, with
+    // PROFILE_STAGES by the dumps of the stage profile.
+#if defined(RECORD_RC_TRACE) || defined(PROFILE_STAGES)
+    static const unsigned long TELEMETRY_INTERVAL = 0;
+
+    // baud rate of the serial port
+    static const unsigned long SERIAL_BAUD_RATE = 115200;
+#else
+    static const unsigned long TELEMETRY_INTERVAL = 50;
+
+    // baud rate of the serial port
+    static const unsigned long SERIAL_BAUD_RATE = 9600;
+#endif
+
+#ifdef PROFILE_STAGES
+    // interval in msec between two dumps of the stage profile, the profile is cleared after every dump
+    static const unsigned long PROFILE_INTERVAL = 10000;
+#endif
+
+public:
+
+    // the throttle switch is not FORWARD (FORWARD operates the light switch)
+    typedef Not<ThrottleSwitchIs<RemoteControlCarAdapter::FORWARD> > ThrottleSwitchNotForward;
+
+    // car is moving while the lights are on
+    typedef And<LightIsOn<ParkingLightTarget>, And<ThrottleSwitchNotForward,
+            Not<ThrottleIs<RemoteControlCarAdapter::STOP> > > > HeadlightOnCondition;
+
+    // lights are off or the car is parking for a while
+    typedef Or<Not<LightIsOn<ParkingLightTarget> >, And<ThrottleSwitchNotForward,
+            And<ThrottleIs<RemoteControlCarAdapter::STOP>,
+                    ThrottleSwitchHeldLongerThan<DIM_HEADLIGHTS_TO_PARKING_DELAY> > > > HeadlightOffCondition;
+
+    // car stands still for a while
+    typedef And<ThrottleIs<RemoteControlCarAdapter::STOP>, ThrottleSwitchHeldLongerThan<BLINKING_ON_DELAY> >
+            BlinkingOnCondition;
+
+    typedef BlinkerRule<BlinkingOnCondition, SteeringIs<RemoteControlCarAdapter::NEUTRAL>,
+            SteeringIs<RemoteControlCarAdapter::LEFT>, SteeringIs<RemoteControlCarAdapter::RIGHT>,
+            BLINKING_DURATION> BlinkerRule_t;
+
+    typedef HazardRule<FailsafeIsActive, HAZARD_BLINKING_DURATION> HazardRule_t;
+
+    /**
+     * light rules, evaluated in this order:
+     * - parking light follows the light switch
+     * - headlights are turned on when the car starts moving and dimmed to parking light when it stops for a while
+     * - back-up lights are on while moving backwards
+     * - brake lights are on while decelerating and switched off with a delay (longer when stand still)
+     * - blinker starts when the car stands still and steers left or right and stops when steering is neutral
+     * - hazard lights blink while the RC signal is lost (failsafe), overriding the blinker
+     */
+    typedef LightRuleEngine<
+            FollowRule<LightSwitchIsOn, ParkingLightTarget>,
+            LatchRule<HeadlightOnCondition, HeadlightOffCondition, HeadlightTarget>,
+            FollowRule<ThrottleIs<RemoteControlCarAdapter::BACKWARD>, BackUpLightTarget>,
+            ReleaseDelayRule<AccelerationBelow<TConfig::BREAK_ACCELERATION_LEVEL>,
+                    StandStillDelay<BREAK_LIGHTS_OFF_STAND_STILL_DELAY, BREAK_LIGHTS_OFF_DELAY>, BrakeLightTarget>,
+            BlinkerRule_t,
+            HazardRule_t> LightRules_t;
 
-    // timestamp when brake lights are switched on
-    long mBrakeLightsOnTimestamp;
+private:
 
-    // last timestamp then blinker was switched on or off
-    long mLastBlinkTimestamp;
+    LightRules_t mLightRules;
 
-    // is true if blinker is switched on, false otherwise
-    bool misBlinkingOn;
+    RemoteControlCarAdapter_t mRemoteControlCarAdapter;
 
-    RemoteControlCarAdapter mRemoteControlCarAdapter;
+    TController mLightController;
 
-    CamaroRcCarLightController mLightController;
+    XenonLightSwitchBehaviour mHeadlightBehaviour;
 
+    // light status, written by the frames only
     AbstractRcCarLightController::CarLightsStatus_t mLightStatus;
 
+    // input snapshot of the last loop pass, passed to the frames with interrupts disabled
+    LightRuleInputs_t mInputs;
+
+    // true if the loop published new inputs since the last frame
+    bool misInputsChanged;
+
+    // true if the light rules may change at mRuleDeadline without new inputs
+    bool misRuleDeadlineActive;
+
+    // next timestamp in msec, at which the light rules may change
+    unsigned long mRuleDeadline;
+
     LightSwitchCondition mLightSwitchCondition;
     ImpulseSwitch mLightSwitch;
 
@@ -161,7 +345,24 @@ private:
 
     TrafficlightSwitchCondition mTrafficLightSwitchCondition;
     ConditionSwitch mTrafficLightBarSwitch;
+
+    TelemetryStream mTelemetry;
+
+#ifdef RECORD_RC_TRACE
+    RcTraceRecorder mTraceRecorder;
+#endif
+
+#ifdef PROFILE_STAGES
+    StageProfiler mProfiler;
+
+    // timestamp in msec of the next dump of the stage profile
+    unsigned long mNextProfileDump;
+#endif
+
+    DeadlineScheduler mScheduler;
 };
 
+typedef BasicRcCarLights<VehicleConfig> RcCarLights;
+
 #endif
 
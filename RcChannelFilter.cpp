@@ -0,0 +1,135 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "RcChannelFilter.h"
+
+/**
+ * constructor
+ *
+ * @param pType type of the filter
+ * @param pIirShift shift of the IIR filter (1 .. 6)
+ */
+RcChannelFilter::RcChannelFilter(Type_t pType, uint8_t pIirShift)
+{
+    setType(pType, pIirShift);
+}
+
+/**
+ * changes the filter and restarts it
+ *
+ * @param pType type of the filter
+ * @param pIirShift shift of the IIR filter (1 .. 6)
+ */
+void RcChannelFilter::setType(Type_t pType, uint8_t pIirShift)
+{
+    mType = pType;
+    mIirShift = pIirShift;
+    reset();
+}
+
+/**
+ * restarts the filter, the next width is passed unchanged and fills the history
+ */
+void RcChannelFilter::reset(void)
+{
+    misStarted = false;
+    mLastWidth = 0;
+    mPreviousWidth = 0;
+    mOutput = 0;
+    mLastSampleTimestamp = 0;
+}
+
+/**
+ * filters the width of a pulse
+ *
+ * @param pWidth pulse width in usec as read
+ * @param pNow timestamp of the read in msec
+ * @return filtered pulse width in usec
+ */
+unsigned long RcChannelFilter::filter(unsigned long pWidth, unsigned long pNow)
+{
+    if (NO_FILTER == mType)
+    {
+        return pWidth;
+    }
+    if (0 == pWidth || 0xFFFF < pWidth)
+    {
+        reset();
+        return pWidth;
+    }
+
+    uint16_t width = pWidth;
+    if (!misStarted)
+    {
+        misStarted = true;
+        mLastWidth = width;
+        mPreviousWidth = width;
+        mOutput = (MEDIAN_FILTER == mType) ? width : (uint32_t) width << IIR_FRACTION_BITS;
+        mLastSampleTimestamp = pNow;
+    }
+    else if (width != mLastWidth || SAMPLE_PERIOD <= pNow - mLastSampleTimestamp)
+    {
+        if (MEDIAN_FILTER == mType)
+        {
+            mOutput = getMedian(mPreviousWidth, mLastWidth, width);
+        }
+        else
+        {
+            // the state moves by a fraction of the difference, both directions are shifted as positive values
+            uint32_t input = (uint32_t) width << IIR_FRACTION_BITS;
+            if (input > mOutput)
+            {
+                mOutput += (input - mOutput) >> mIirShift;
+            }
+            else
+            {
+                mOutput -= (mOutput - input) >> mIirShift;
+            }
+        }
+        mPreviousWidth = mLastWidth;
+        mLastWidth = width;
+        mLastSampleTimestamp = pNow;
+    }
+
+    if (MEDIAN_FILTER == mType)
+    {
+        return mOutput;
+    }
+    return (mOutput + (1 << (IIR_FRACTION_BITS - 1))) >> IIR_FRACTION_BITS;
+}
+
+/**
+ * @return median of three widths
+ */
+uint16_t RcChannelFilter::getMedian(uint16_t pFirst, uint16_t pSecond, uint16_t pThird)
+{
+    if (pFirst > pSecond)
+    {
+        uint16_t swap = pFirst;
+        pFirst = pSecond;
+        pSecond = swap;
+    }
+    // pFirst <= pSecond
+    if (pThird >= pSecond)
+    {
+        return pSecond;
+    }
+    return (pThird > pFirst) ? pThird : pFirst;
+}
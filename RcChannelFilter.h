@@ -0,0 +1,118 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCCHANNELFILTER_H_
+#define RCCHANNELFILTER_H_
+
+#include <stdint.h>
+
+/**
+ * Integer noise filter for the pulse widths of a RC channel, applied before the widths are classified.
+ *
+ * - MEDIAN_FILTER: median of the last 3 pulses. A single noisy pulse is removed completely, a real change is delayed
+ *   by one pulse (20 msec).
+ * - IIR_FILTER: exponential smoothing y += (x - y) / 2^shift in fixed point. Reduces the jitter of every pulse, but
+ *   delays a change by several pulses and lets a large spike through partly.
+ * - NO_FILTER: passes the pulse widths unchanged.
+ *
+ * The inputs are read whenever a pulse of any channel arrives, so the same pulse of a channel may be read several
+ * times. A read is therefore only taken as new sample if the width differs from the last sample or at least
+ * SAMPLE_PERIOD has elapsed since. A width of 0 (no signal) is passed unfiltered and restarts the filter.
+ */
+class RcChannelFilter
+{
+public:
+    typedef enum
+    {
+        NO_FILTER, MEDIAN_FILTER, IIR_FILTER
+    } Type_t;
+
+    // minimal time in msec between two samples of the same width, shorter than the 20 msec between two pulses but
+    // longer than the gap between the pulses of the channels within a frame
+    static const unsigned long SAMPLE_PERIOD = 10;
+
+    // default shift of the IIR filter, i.e. a new pulse contributes 1/4
+    static const uint8_t DEFAULT_IIR_SHIFT = 2;
+
+    /**
+     * constructor
+     *
+     * @param pType type of the filter
+     * @param pIirShift shift of the IIR filter (1 .. 6)
+     */
+    RcChannelFilter(Type_t pType = MEDIAN_FILTER, uint8_t pIirShift = DEFAULT_IIR_SHIFT);
+
+    /**
+     * changes the filter and restarts it
+     *
+     * @param pType type of the filter
+     * @param pIirShift shift of the IIR filter (1 .. 6)
+     */
+    void setType(Type_t pType, uint8_t pIirShift = DEFAULT_IIR_SHIFT);
+
+    /**
+     * @return type of the filter
+     */
+    inline Type_t getType(void) const
+    {
+        return mType;
+    }
+
+    /**
+     * restarts the filter, the next width is passed unchanged and fills the history
+     */
+    void reset(void);
+
+    /**
+     * filters the width of a pulse
+     *
+     * @param pWidth pulse width in usec as read
+     * @param pNow timestamp of the read in msec
+     * @return filtered pulse width in usec
+     */
+    unsigned long filter(unsigned long pWidth, unsigned long pNow);
+
+private:
+    // fractional bits of the IIR filter state
+    static const uint8_t IIR_FRACTION_BITS = 4;
+
+    static uint16_t getMedian(uint16_t pFirst, uint16_t pSecond, uint16_t pThird);
+
+    Type_t mType;
+
+    uint8_t mIirShift;
+
+    // true if the history is filled
+    bool misStarted;
+
+    // last sample
+    uint16_t mLastWidth;
+
+    // sample before the last one
+    uint16_t mPreviousWidth;
+
+    // timestamp of the last sample in msec
+    unsigned long mLastSampleTimestamp;
+
+    // filtered width, for the IIR filter with IIR_FRACTION_BITS fractional bits
+    uint32_t mOutput;
+};
+
+#endif /* RCCHANNELFILTER_H_ */
@@ -0,0 +1,92 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "RcChannelHealth.h"
+
+/**
+ * constructor, the channel is not lost and all counters are 0
+ */
+RcChannelHealth::RcChannelHealth(void)
+{
+    reset();
+}
+
+/**
+ * clears the state and the counters
+ */
+void RcChannelHealth::reset(void)
+{
+    misLost = false;
+    mRecoveryCount = 0;
+    mLastValidWidth = 0;
+    mLastValidTimestamp = 0;
+    mLastPollTimestamp = 0;
+    mTimeoutCount = 0;
+    mOutOfRangeCount = 0;
+    mLossCount = 0;
+}
+
+/**
+ * checks the width of a read and updates the state and the counters
+ *
+ * @param pWidth pulse width in usec as read, 0 if no pulse was seen
+ * @param pNow timestamp of the read in msec
+ * @param pIsNewPulse false if the read returned the same pulse as the previous read
+ * @return true if the width is valid
+ */
+bool RcChannelHealth::check(unsigned long pWidth, unsigned long pNow, bool pIsNewPulse)
+{
+    if (MIN_PULSE_WIDTH <= pWidth && pWidth <= MAX_PULSE_WIDTH)
+    {
+        mLastValidWidth = pWidth;
+        mLastValidTimestamp = pNow;
+        mLastPollTimestamp = pNow;
+        // the same pulse read again does not count for the recovery
+        if (misLost && pIsNewPulse && RECOVERY_PULSES <= ++mRecoveryCount)
+        {
+            misLost = false;
+        }
+        return true;
+    }
+
+    // a lost channel, which was not polled, reads 0
+    if (0 == pWidth && !isPollDue(pNow))
+    {
+        return false;
+    }
+
+    mLastPollTimestamp = pNow;
+    mRecoveryCount = 0;
+    if (0 == pWidth)
+    {
+        ++mTimeoutCount;
+    }
+    else
+    {
+        ++mOutOfRangeCount;
+    }
+
+    if (!misLost && SIGNAL_LOSS_TIME <= pNow - mLastValidTimestamp)
+    {
+        misLost = true;
+        ++mLossCount;
+    }
+    return false;
+}
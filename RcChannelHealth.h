@@ -0,0 +1,151 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCCHANNELHEALTH_H_
+#define RCCHANNELHEALTH_H_
+
+#include <stdint.h>
+
+/**
+ * Tracks the health of a RC channel from the pulse widths read.
+ *
+ * A read is valid if its width is within MIN_PULSE_WIDTH and MAX_PULSE_WIDTH. A width of 0 is counted as timeout
+ * (no pulse, e.g. the channel is unplugged or the transmitter is off), any other invalid width as out of range. The
+ * channel is lost, if there was no valid read for SIGNAL_LOSS_TIME, and recovers after RECOVERY_PULSES valid pulses in
+ * a row. The inputs are read whenever a pulse of any channel arrives, so a read, which returns the same pulse of the
+ * channel again, does not count for the recovery; otherwise a single stray pulse read three times would recover it.
+ *
+ * A lost channel only needs to be polled every LOST_POLL_INTERVAL (see isPollDue), so a blocking measurement like
+ * pulseIn does not wait for the timeout of a dead channel in every loop. A read of 0 between two polls is taken as a
+ * skipped poll and is not counted.
+ *
+ * All timestamps are in msec and may wrap around.
+ */
+class RcChannelHealth
+{
+public:
+    // shortest valid pulse width in usec
+    static const unsigned long MIN_PULSE_WIDTH = 800;
+
+    // longest valid pulse width in usec
+    static const unsigned long MAX_PULSE_WIDTH = 2200;
+
+    // time in msec without a valid read, after which the channel is lost
+    static const unsigned long SIGNAL_LOSS_TIME = 100;
+
+    // number of new valid pulses in a row, after which a lost channel recovers
+    static const uint8_t RECOVERY_PULSES = 3;
+
+    // interval in msec, in which a lost channel is polled
+    static const unsigned long LOST_POLL_INTERVAL = 500;
+
+    /**
+     * constructor, the channel is not lost and all counters are 0
+     */
+    RcChannelHealth(void);
+
+    /**
+     * clears the state and the counters
+     */
+    void reset(void);
+
+    /**
+     * checks the width of a read and updates the state and the counters
+     *
+     * @param pWidth pulse width in usec as read, 0 if no pulse was seen
+     * @param pNow timestamp of the read in msec
+     * @param pIsNewPulse false if the read returned the same pulse as the previous read
+     * @return true if the width is valid
+     */
+    bool check(unsigned long pWidth, unsigned long pNow, bool pIsNewPulse = true);
+
+    /**
+     * @return true if the channel is lost
+     */
+    inline bool isLost(void) const
+    {
+        return misLost;
+    }
+
+    /**
+     * @param pNow current timestamp in msec
+     * @return false if the channel is lost and was polled within the last LOST_POLL_INTERVAL, true otherwise
+     */
+    inline bool isPollDue(unsigned long pNow) const
+    {
+        return !misLost || LOST_POLL_INTERVAL <= pNow - mLastPollTimestamp;
+    }
+
+    /**
+     * @return last valid pulse width in usec, 0 if there was none yet
+     */
+    inline unsigned long getLastValidWidth(void) const
+    {
+        return mLastValidWidth;
+    }
+
+    /**
+     * @return number of reads without a pulse
+     */
+    inline unsigned long getTimeoutCount(void) const
+    {
+        return mTimeoutCount;
+    }
+
+    /**
+     * @return number of reads with a pulse width out of range
+     */
+    inline unsigned long getOutOfRangeCount(void) const
+    {
+        return mOutOfRangeCount;
+    }
+
+    /**
+     * @return number of times the channel was lost
+     */
+    inline unsigned long getLossCount(void) const
+    {
+        return mLossCount;
+    }
+
+private:
+    // true if the channel is lost
+    bool misLost;
+
+    // number of new valid pulses in a row while the channel is lost
+    uint8_t mRecoveryCount;
+
+    // last valid pulse width in usec
+    uint16_t mLastValidWidth;
+
+    // timestamp of the last valid read in msec
+    unsigned long mLastValidTimestamp;
+
+    // timestamp of the last counted read in msec
+    unsigned long mLastPollTimestamp;
+
+    unsigned long mTimeoutCount;
+
+    unsigned long mOutOfRangeCount;
+
+    unsigned long mLossCount;
+};
+
+#endif /* RCCHANNELHEALTH_H_ */
@@ -0,0 +1,126 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "RcFrameDecoder.h"
+
+/**
+ * constructor
+ *
+ * @param pThrottleChannel index of the throttle channel within a frame
+ * @param pSteeringChannel index of the steering channel within a frame
+ * @param p3rdChannel index of the 3rd channel within a frame
+ */
+RcFrameDecoder::RcFrameDecoder(uint8_t pThrottleChannel, uint8_t pSteeringChannel, uint8_t p3rdChannel) :
+        mThrottleChannel(pThrottleChannel), mSteeringChannel(pSteeringChannel), m3rdChannel(p3rdChannel),
+        mNumChannels(0), mFrameMicros(0), mFrameCount(0), mErrorCount(0), mReadFrameCount(0)
+{
+    for (uint8_t i = 0; i < MAX_CHANNELS; ++i)
+    {
+        mWidths[i] = 0;
+    }
+}
+
+/**
+ * reads the pulse widths of throttle, steering and 3rd channel of the last frame
+ *
+ * @param pThrottle receives the throttle pulse width in usec, 0 if there is no valid frame
+ * @param pSteering receives the steering pulse width in usec, 0 if there is no valid frame
+ * @param p3rdChannel receives the 3rd channel pulse width in usec, 0 if there is no valid frame
+ * @return timestamp of the read in msec
+ */
+unsigned long RcFrameDecoder::read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+{
+    // the frame may be published by an interrupt
+    noInterrupts();
+    pThrottle = getChannel(mThrottleChannel);
+    pSteering = getChannel(mSteeringChannel);
+    p3rdChannel = getChannel(m3rdChannel);
+    unsigned long frameMicros = mFrameMicros;
+    mReadFrameCount = mFrameCount;
+    interrupts();
+
+    if (0 == mReadFrameCount || FRAME_TIMEOUT < micros() - frameMicros)
+    {
+        pThrottle = 0;
+        pSteering = 0;
+        p3rdChannel = 0;
+    }
+
+    return millis();
+}
+
+/**
+ * @return true if a frame was completed since the last read
+ */
+bool RcFrameDecoder::hasNewInputs(void)
+{
+    return getFrameCount() != mReadFrameCount;
+}
+
+/**
+ * @param pChannel index of the channel within a frame
+ * @return pulse width in usec of the channel in the last frame, 0 if the frame has no such channel
+ */
+uint16_t RcFrameDecoder::getChannel(uint8_t pChannel) const
+{
+    return (pChannel < mNumChannels) ? mWidths[pChannel] : 0;
+}
+
+/**
+ * @return number of complete frames
+ */
+unsigned long RcFrameDecoder::getFrameCount(void) const
+{
+    noInterrupts();
+    unsigned long frameCount = mFrameCount;
+    interrupts();
+    return frameCount;
+}
+
+/**
+ * @return timestamp in usec of the completion of the last frame
+ */
+unsigned long RcFrameDecoder::getFrameMicros(void) const
+{
+    noInterrupts();
+    unsigned long frameMicros = mFrameMicros;
+    interrupts();
+    return frameMicros;
+}
+
+/**
+ * publishes a complete frame, may be called from an interrupt
+ *
+ * @param pWidths pulse widths of the channels in usec
+ * @param pNumChannels number of channels
+ * @param pMicros timestamp of the completion of the frame in usec
+ */
+void RcFrameDecoder::publishFrame(const uint16_t *pWidths, uint8_t pNumChannels, unsigned long pMicros)
+{
+    for (uint8_t i = 0; i < pNumChannels; ++i)
+    {
+        mWidths[i] = pWidths[i];
+    }
+    mNumChannels = pNumChannels;
+    mFrameMicros = pMicros;
+    ++mFrameCount;
+}
@@ -0,0 +1,140 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCFRAMEDECODER_H_
+#define RCFRAMEDECODER_H_
+
+#include <stdint.h>
+
+#include "RcInputSource.h"
+
+/**
+ * Base of the decoders of single wire receivers (PPM sum signal, SBUS), which deliver all channels in one frame.
+ *
+ * A decoder is fed incrementally, e.g. from an interrupt or with the bytes of a UART, and publishes the pulse widths of
+ * all channels at once when a frame is complete. As input source of RemoteControlCarAdapter it passes three of the
+ * channels to the adapter without blocking and reports new inputs only if a new frame arrived since the last read.
+ * Without a frame for FRAME_TIMEOUT all widths are read as 0, like a lost PWM signal.
+ */
+class RcFrameDecoder : public RcInputSource
+{
+public:
+    /**
+     * maximum number of channels of a frame
+     */
+    static const uint8_t MAX_CHANNELS = 16;
+
+    /**
+     * time in usec after which the last frame is outdated (signal lost)
+     */
+    static const unsigned long FRAME_TIMEOUT = 50000;
+
+    /**
+     * constructor
+     *
+     * @param pThrottleChannel index of the throttle channel within a frame
+     * @param pSteeringChannel index of the steering channel within a frame
+     * @param p3rdChannel index of the 3rd channel within a frame
+     */
+    RcFrameDecoder(uint8_t pThrottleChannel, uint8_t pSteeringChannel, uint8_t p3rdChannel);
+
+    /**
+     * reads the pulse widths of throttle, steering and 3rd channel of the last frame
+     *
+     * @param pThrottle receives the throttle pulse width in usec, 0 if there is no valid frame
+     * @param pSteering receives the steering pulse width in usec, 0 if there is no valid frame
+     * @param p3rdChannel receives the 3rd channel pulse width in usec, 0 if there is no valid frame
+     * @return timestamp of the read in msec
+     */
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel);
+
+    /**
+     * @return true if a frame was completed since the last read
+     */
+    virtual bool hasNewInputs(void);
+
+    /**
+     * @param pChannel index of the channel within a frame
+     * @return pulse width in usec of the channel in the last frame, 0 if the frame has no such channel
+     */
+    uint16_t getChannel(uint8_t pChannel) const;
+
+    /**
+     * @return number of channels of the last frame
+     */
+    inline uint8_t getNumChannels(void) const
+    {
+        return mNumChannels;
+    }
+
+    /**
+     * @return number of complete frames
+     */
+    unsigned long getFrameCount(void) const;
+
+    /**
+     * @return number of frames, which were dropped because of a format error
+     */
+    inline unsigned long getErrorCount(void) const
+    {
+        return mErrorCount;
+    }
+
+    /**
+     * @return timestamp in usec of the completion of the last frame
+     */
+    unsigned long getFrameMicros(void) const;
+
+protected:
+    /**
+     * publishes a complete frame, may be called from an interrupt
+     *
+     * @param pWidths pulse widths of the channels in usec
+     * @param pNumChannels number of channels
+     * @param pMicros timestamp of the completion of the frame in usec
+     */
+    void publishFrame(const uint16_t *pWidths, uint8_t pNumChannels, unsigned long pMicros);
+
+    /**
+     * counts a frame with a format error
+     */
+    inline void countError(void)
+    {
+        ++mErrorCount;
+    }
+
+private:
+    // indices of the channels passed to the adapter
+    uint8_t mThrottleChannel;
+    uint8_t mSteeringChannel;
+    uint8_t m3rdChannel;
+
+    // last complete frame, written by publishFrame
+    volatile uint16_t mWidths[MAX_CHANNELS];
+    volatile uint8_t mNumChannels;
+    volatile unsigned long mFrameMicros;
+    volatile unsigned long mFrameCount;
+    volatile unsigned long mErrorCount;
+
+    // frame count at the last read
+    unsigned long mReadFrameCount;
+};
+
+#endif /* RCFRAMEDECODER_H_ */
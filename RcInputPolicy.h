@@ -0,0 +1,426 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCINPUTPOLICY_H_
+#define RCINPUTPOLICY_H_
+
+#include <stdint.h>
+
+#include "Arduino.h"
+#include "PulseCapture.h"
+#include "PulsePoller.h"
+#include "RcTrace.h"
+
+/**
+ * Base of the input policies of BasicRemoteControlCarAdapter (CRTP).
+ *
+ * An input policy delivers the raw pulse widths of throttle, steering and 3rd channel. The adapter holds the policy
+ * by value and calls it without a virtual function, so the read is inlined into the adapter. A policy derives from
+ * RcInputPolicy<Policy> and defines
+ *
+ *     void readChannels(uint8_t pPollMask, unsigned long &pThrottle, unsigned long &pSteering,
+ *                       unsigned long &p3rdChannel)
+ *
+ * and, where the defaults below do not fit, IS_BLOCKING, setupChannels, hasNewPulses, getNewPulseMask,
+ * areChannelsQuiet and getTimestamp. pPollMask has
+ * the bit of every channel set, which should be measured; a blocking policy skips the other channels (0), so a lost
+ * channel does not slow down the loop. A policy, which does not block, always gets ALL_CHANNELS.
+ */
+template<typename TInput>
+class RcInputPolicy
+{
+public:
+    // channel numbers used for the poll mask and the pulse capture
+    static const uint8_t THROTTLE_CHANNEL = 0;
+    static const uint8_t STEERING_CHANNEL = 1;
+    static const uint8_t THIRD_CHANNEL = 2;
+
+    /**
+     * mask, which polls all channels
+     */
+    static const uint8_t ALL_CHANNELS = 0x07;
+
+    /**
+     * true if a read waits for the pulses, the adapter calculates the poll mask only for a blocking policy
+     */
+    static const bool IS_BLOCKING = false;
+
+    /**
+     * prepares the measurement of the channels
+     *
+     * @param pPinThrottle pin of the throttle channel
+     * @param pPinSteering pin of the steering channel
+     * @param pPin3rdChannel pin of the 3rd channel
+     */
+    inline void setup(int pPinThrottle, int pPinSteering, int pPin3rdChannel)
+    {
+        self().setupChannels(pPinThrottle, pPinSteering, pPin3rdChannel);
+    }
+
+    /**
+     * @return true if the policy has inputs, which were not read yet
+     */
+    inline bool hasNewInputs(void)
+    {
+        return self().hasNewPulses();
+    }
+
+    /**
+     * @return mask of the channels, whose width returned by the last read belongs to a pulse, which was not read
+     * before. A policy, which measures within the read, always returns new pulses.
+     */
+    inline uint8_t getNewPulses(void)
+    {
+        return self().getNewPulseMask();
+    }
+
+    /**
+     * checks if the interrupts may be disabled for a duration without corrupting a pulse measurement
+     *
+     * @param pDuration duration in usec
+     * @return true if no pulse is measured within the duration
+     */
+    inline bool isQuiet(unsigned long pDuration)
+    {
+        return self().areChannelsQuiet(pDuration);
+    }
+
+    /**
+     * reads the pulse widths of all channels
+     *
+     * @param pPollMask channels to measure, a blocking policy returns 0 for the others
+     * @param pThrottle receives the throttle pulse width in usec
+     * @param pSteering receives the steering pulse width in usec
+     * @param p3rdChannel receives the 3rd channel pulse width in usec
+     * @return timestamp of the read in msec
+     */
+    inline unsigned long read(uint8_t pPollMask, unsigned long &pThrottle, unsigned long &pSteering,
+                              unsigned long &p3rdChannel)
+    {
+        self().readChannels(pPollMask, pThrottle, pSteering, p3rdChannel);
+        return self().getTimestamp();
+    }
+
+protected:
+    // defaults, a policy hides them by its own methods
+
+    inline void setupChannels(int /* pPinThrottle */, int /* pPinSteering */, int /* pPin3rdChannel */)
+    {
+    }
+
+    inline bool hasNewPulses(void)
+    {
+        return true;
+    }
+
+    inline uint8_t getNewPulseMask(void)
+    {
+        return ALL_CHANNELS;
+    }
+
+    // a policy measuring within the read is quiet outside of it
+    inline bool areChannelsQuiet(unsigned long /* pDuration */)
+    {
+        return true;
+    }
+
+    inline unsigned long getTimestamp(void)
+    {
+        return millis();
+    }
+
+private:
+    inline TInput &self(void)
+    {
+        return static_cast<TInput &>(*this);
+    }
+};
+
+/**
+ * Measures the channels with pin change interrupts (see PulseCapture). The read returns immediately.
+ */
+class PulseCaptureInput : public RcInputPolicy<PulseCaptureInput>
+{
+public:
+    PulseCaptureInput(void) :
+            mLastPulseCount(0), mNewPulseMask(0)
+    {
+        mLastChannelPulseCounts[THROTTLE_CHANNEL] = 0;
+        mLastChannelPulseCounts[STEERING_CHANNEL] = 0;
+        mLastChannelPulseCounts[THIRD_CHANNEL] = 0;
+    }
+
+    inline void setupChannels(int pPinThrottle, int pPinSteering, int pPin3rdChannel)
+    {
+        PulseCapture::attach(THROTTLE_CHANNEL, pPinThrottle);
+        PulseCapture::attach(STEERING_CHANNEL, pPinSteering);
+        PulseCapture::attach(THIRD_CHANNEL, pPin3rdChannel);
+    }
+
+    inline bool hasNewPulses(void)
+    {
+        return PulseCapture::getPulseCount() != mLastPulseCount;
+    }
+
+    inline uint8_t getNewPulseMask(void)
+    {
+        return mNewPulseMask;
+    }
+
+    inline bool areChannelsQuiet(unsigned long pDuration)
+    {
+        return PulseCapture::isQuiet(pDuration);
+    }
+
+    inline void readChannels(uint8_t /* pPollMask */, unsigned long &pThrottle, unsigned long &pSteering,
+                             unsigned long &p3rdChannel)
+    {
+        mLastPulseCount = PulseCapture::getPulseCount();
+        mNewPulseMask = 0;
+        for (uint8_t channel = 0; channel < PulseCapture::MAX_CHANNELS; ++channel)
+        {
+            uint8_t pulseCount = PulseCapture::getPulseCount(channel);
+            if (pulseCount != mLastChannelPulseCounts[channel])
+            {
+                mLastChannelPulseCounts[channel] = pulseCount;
+                mNewPulseMask |= bit(channel);
+            }
+        }
+        pThrottle = PulseCapture::getPulseWidth(THROTTLE_CHANNEL);
+        pSteering = PulseCapture::getPulseWidth(STEERING_CHANNEL);
+        p3rdChannel = PulseCapture::getPulseWidth(THIRD_CHANNEL);
+    }
+
+private:
+    // pulse counter of the pulse capture at the last read
+    uint8_t mLastPulseCount;
+
+    // pulse counters of the channels at the last read
+    uint8_t mLastChannelPulseCounts[PulseCapture::MAX_CHANNELS];
+
+    // channels with a new pulse at the last read
+    uint8_t mNewPulseMask;
+};
+
+/**
+ * Measures all channels at once in a busy loop (see PulsePoller), which returns within one RC frame.
+ */
+class PolledInput : public RcInputPolicy<PolledInput>
+{
+public:
+    static const bool IS_BLOCKING = true;
+
+    inline void setupChannels(int pPinThrottle, int pPinSteering, int pPin3rdChannel)
+    {
+        mPulsePoller.attach(THROTTLE_CHANNEL, pPinThrottle);
+        mPulsePoller.attach(STEERING_CHANNEL, pPinSteering);
+        mPulsePoller.attach(THIRD_CHANNEL, pPin3rdChannel);
+    }
+
+    inline void readChannels(uint8_t pPollMask, unsigned long &pThrottle, unsigned long &pSteering,
+                             unsigned long &p3rdChannel)
+    {
+        mPulsePoller.measure(pPollMask);
+        pThrottle = mPulsePoller.getPulseWidth(THROTTLE_CHANNEL);
+        pSteering = mPulsePoller.getPulseWidth(STEERING_CHANNEL);
+        p3rdChannel = mPulsePoller.getPulseWidth(THIRD_CHANNEL);
+    }
+
+private:
+    // measures all channels at once
+    PulsePoller mPulsePoller;
+};
+
+/**
+ * Measures the channels one after the other with pulseIn, which takes up to a frame per channel.
+ */
+class PulseInInput : public RcInputPolicy<PulseInInput>
+{
+public:
+    static const bool IS_BLOCKING = true;
+
+    // timeout of pulseIn in usec
+    static const unsigned long PULSE_IN_TIMEOUT = 20000;
+
+    PulseInInput(void) :
+            mPinThrottle(0), mPinSteering(0), mPin3rdChannel(0)
+    {
+    }
+
+    inline void setupChannels(int pPinThrottle, int pPinSteering, int pPin3rdChannel)
+    {
+        mPinThrottle = pPinThrottle;
+        mPinSteering = pPinSteering;
+        mPin3rdChannel = pPin3rdChannel;
+    }
+
+    inline void readChannels(uint8_t pPollMask, unsigned long &pThrottle, unsigned long &pSteering,
+                             unsigned long &p3rdChannel)
+    {
+        pThrottle = (pPollMask & bit(THROTTLE_CHANNEL)) ? pulseIn(mPinThrottle, HIGH, PULSE_IN_TIMEOUT) : 0;
+        pSteering = (pPollMask & bit(STEERING_CHANNEL)) ? pulseIn(mPinSteering, HIGH, PULSE_IN_TIMEOUT) : 0;
+        p3rdChannel = (pPollMask & bit(THIRD_CHANNEL)) ? pulseIn(mPin3rdChannel, HIGH, PULSE_IN_TIMEOUT) : 0;
+    }
+
+private:
+    int mPinThrottle;
+    int mPinSteering;
+    int mPin3rdChannel;
+};
+
+/**
+ * Generates the inputs without a receiver, e.g. to try the lights on the bench or to drive the adapter on the host.
+ * Throttle and steering move in triangles around the neutral point, the 3rd channel holds its width. A period of 0
+ * holds a channel in neutral position.
+ */
+class SyntheticInput : public RcInputPolicy<SyntheticInput>
+{
+public:
+    // neutral pulse width in usec
+    static const uint16_t NEUTRAL = 1500;
+
+    /**
+     * constructor
+     *
+     * @param pThrottlePeriod period of the throttle triangle in msec
+     * @param pSteeringPeriod period of the steering triangle in msec
+     * @param pAmplitude deflection at the ends of the triangles in usec
+     * @param p3rdChannel pulse width of the 3rd channel in usec
+     */
+    SyntheticInput(uint16_t pThrottlePeriod = 0, uint16_t pSteeringPeriod = 0, uint16_t pAmplitude = 400,
+                   uint16_t p3rdChannel = 1000) :
+            mThrottlePeriod(pThrottlePeriod), mSteeringPeriod(pSteeringPeriod), mAmplitude(pAmplitude),
+            m3rdChannel(p3rdChannel)
+    {
+    }
+
+    inline void readChannels(uint8_t /* pPollMask */, unsigned long &pThrottle, unsigned long &pSteering,
+                             unsigned long &p3rdChannel)
+    {
+        unsigned long now = millis();
+        pThrottle = triangle(now, mThrottlePeriod);
+        pSteering = triangle(now, mSteeringPeriod);
+        p3rdChannel = m3rdChannel;
+    }
+
+private:
+    /**
+     * @return pulse width in usec of a triangle, which starts in neutral position and moves to the upper end first
+     */
+    inline uint16_t triangle(unsigned long pNow, uint16_t pPeriod) const
+    {
+        if (0 == pPeriod)
+        {
+            return NEUTRAL;
+        }
+        // phase shifted by a quarter period, so the triangle starts in neutral position
+        long phase = (pNow + pPeriod / 4) % pPeriod;
+        long half = pPeriod / 2;
+        long position = (phase < half) ? phase : pPeriod - phase;
+        return NEUTRAL - mAmplitude + (uint16_t) (position * 2 * mAmplitude / half);
+    }
+
+    uint16_t mThrottlePeriod;
+    uint16_t mSteeringPeriod;
+    uint16_t mAmplitude;
+    uint16_t m3rdChannel;
+};
+
+/**
+ * Replays a recorded trace (see RcTrace) from memory, e.g. to repeat a drive on the bench or to drive the adapter on
+ * the host. Every read returns the next record with its timestamp, at the end of the trace the last record is
+ * repeated.
+ */
+class TraceReplayInput : public RcInputPolicy<TraceReplayInput>
+{
+public:
+    /**
+     * constructor
+     *
+     * @param pTrace recorded trace including the magic bytes, has to live as long as the policy
+     * @param pSize size of the trace in bytes
+     */
+    TraceReplayInput(const uint8_t *pTrace = NULL, uint32_t pSize = 0) :
+            mTrace(pTrace), mSize(pSize), mPosition(RcTrace::MAGIC_SIZE)
+    {
+        mCurrent.timestamp = 0;
+        for (uint8_t i = 0; i < RcTrace::NUM_CHANNELS; ++i)
+        {
+            mCurrent.widths[i] = 0;
+        }
+        if (!isValid())
+        {
+            mPosition = mSize;
+        }
+    }
+
+    /**
+     * @return true if the trace starts with the magic bytes
+     */
+    inline bool isValid(void) const
+    {
+        return mTrace && RcTrace::MAGIC_SIZE <= mSize && RcTrace::isMagic(mTrace);
+    }
+
+    /**
+     * @return true if the trace has records, which were not read yet
+     */
+    inline bool hasNewPulses(void) const
+    {
+        return mPosition < mSize;
+    }
+
+    inline void readChannels(uint8_t /* pPollMask */, unsigned long &pThrottle, unsigned long &pSteering,
+                             unsigned long &p3rdChannel)
+    {
+        if (mPosition < mSize)
+        {
+            RcTrace::Record_t record;
+            bool isAbsolute;
+            uint8_t size = RcTrace::decode(mCurrent, mTrace + mPosition, mSize - mPosition, record, isAbsolute);
+            // a truncated record ends the trace
+            mPosition = (0 != size) ? mPosition + size : mSize;
+            if (0 != size)
+            {
+                mCurrent = record;
+            }
+        }
+        pThrottle = mCurrent.widths[0];
+        pSteering = mCurrent.widths[1];
+        p3rdChannel = mCurrent.widths[2];
+    }
+
+    inline unsigned long getTimestamp(void) const
+    {
+        return mCurrent.timestamp;
+    }
+
+private:
+    const uint8_t *mTrace;
+    uint32_t mSize;
+
+    // position of the next record
+    uint32_t mPosition;
+
+    // last record returned by a read
+    RcTrace::Record_t mCurrent;
+};
+
+#endif /* RCINPUTPOLICY_H_ */
@@ -0,0 +1,59 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCINPUTSOURCE_H_
+#define RCINPUTSOURCE_H_
+
+/**
+ * Alternative source of the raw RC inputs for RemoteControlCarAdapter, e.g. the replay of a recorded trace or the
+ * decoder of a single wire receiver (see RcFrameDecoder). Without input source the adapter reads the inputs from the
+ * pins.
+ */
+class RcInputSource
+{
+public:
+    /**
+     * destructor
+     */
+    virtual ~RcInputSource()
+    {
+    }
+
+    /**
+     * reads the next values of all RC channels
+     *
+     * @param pThrottle receives the throttle pulse width in usec
+     * @param pSteering receives the steering pulse width in usec
+     * @param p3rdChannel receives the 3rd channel pulse width in usec
+     * @return timestamp of the read in msec
+     */
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel) = 0;
+
+    /**
+     * @return true if the source has inputs, which were not read yet. A source, which can not tell, always has new
+     * inputs, so the adapter reads it with every refresh.
+     */
+    virtual bool hasNewInputs(void)
+    {
+        return true;
+    }
+};
+
+#endif /* RCINPUTSOURCE_H_ */
@@ -0,0 +1,229 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCTRACE_H_
+#define RCTRACE_H_
+
+#include <stdint.h>
+
+/**
+ * Binary format of a raw RC input trace.
+ *
+ * A trace holds one record for every read of the RC inputs (RemoteControlCarAdapter::readInputs): the timestamp in
+ * msec and the pulse widths of throttle, steering and 3rd channel in usec. The trace starts with the 4 magic bytes
+ * MAGIC_1 .. MAGIC_4 followed by the records. All numbers are unsigned LEB128 varints (7 bits per byte, least
+ * significant group first, bit 7 set if another byte follows).
+ *
+ * Every record starts with a header varint: bits 0..2 flag the channels, which follow as zigzag encoded difference to
+ * the previous record, bits 4.. hold the time in msec since the previous record. If bit 3 (ABSOLUTE_FLAG) is set,
+ * the header is followed by the absolute timestamp and the absolute widths of all channels instead. Absolute records
+ * start the trace and follow any gap (e.g. dropped data).
+ *
+ * A typical record during driving is a single byte. The header is used by the sketch and by host tools, so it must
+ * not depend on the arduino core.
+ */
+class RcTrace
+{
+public:
+    static const uint8_t NUM_CHANNELS = 3;
+
+    static const uint8_t MAGIC_1 = 'R';
+    static const uint8_t MAGIC_2 = 'C';
+    static const uint8_t MAGIC_3 = 'T';
+    static const uint8_t MAGIC_4 = '1';
+
+    static const uint8_t MAGIC_SIZE = 4;
+
+    // header flag of an absolute record
+    static const uint8_t ABSOLUTE_FLAG = 0x08;
+
+    // maximal size of an encoded record (absolute: header, 32 bit timestamp and 3 16 bit widths)
+    static const uint8_t MAX_RECORD_SIZE = 1 + 5 + NUM_CHANNELS * 3;
+
+    /**
+     * single read of the RC inputs
+     */
+    typedef struct
+    {
+        uint32_t timestamp;                 // msec
+        uint16_t widths[NUM_CHANNELS];      // usec, throttle, steering, 3rd channel
+    } Record_t;
+
+    /**
+     * writes the magic bytes
+     *
+     * @param pBuffer buffer of at least MAGIC_SIZE bytes
+     */
+    static void writeMagic(uint8_t *pBuffer)
+    {
+        pBuffer[0] = MAGIC_1;
+        pBuffer[1] = MAGIC_2;
+        pBuffer[2] = MAGIC_3;
+        pBuffer[3] = MAGIC_4;
+    }
+
+    /**
+     * @param pBuffer buffer of at least MAGIC_SIZE bytes
+     * @return true if the buffer starts with the magic bytes
+     */
+    static bool isMagic(const uint8_t *pBuffer)
+    {
+        return MAGIC_1 == pBuffer[0] && MAGIC_2 == pBuffer[1] && MAGIC_3 == pBuffer[2] && MAGIC_4 == pBuffer[3];
+    }
+
+    /**
+     * encodes a record relative to the previous one
+     *
+     * @param pPrevious previous record (ignored for absolute records)
+     * @param pRecord record to encode
+     * @param pIsAbsolute true to write an absolute record
+     * @param pBuffer buffer of at least MAX_RECORD_SIZE bytes
+     * @return number of bytes written
+     */
+    static uint8_t encode(const Record_t &pPrevious, const Record_t &pRecord, bool pIsAbsolute, uint8_t *pBuffer)
+    {
+        uint32_t deltaT = pRecord.timestamp - pPrevious.timestamp;
+
+        // the time difference has to fit beside the flags
+        if (pIsAbsolute || 0x0FFFFFFFUL < deltaT)
+        {
+            uint8_t size = writeVarint(ABSOLUTE_FLAG | ((1 << NUM_CHANNELS) - 1), pBuffer);
+            size += writeVarint(pRecord.timestamp, pBuffer + size);
+            for (uint8_t i = 0; i < NUM_CHANNELS; ++i)
+            {
+                size += writeVarint(pRecord.widths[i], pBuffer + size);
+            }
+            return size;
+        }
+
+        uint8_t changedChannels = 0;
+        for (uint8_t i = 0; i < NUM_CHANNELS; ++i)
+        {
+            if (pRecord.widths[i] != pPrevious.widths[i])
+            {
+                changedChannels |= 1 << i;
+            }
+        }
+
+        uint8_t size = writeVarint((deltaT << 4) | changedChannels, pBuffer);
+        for (uint8_t i = 0; i < NUM_CHANNELS; ++i)
+        {
+            if (changedChannels & (1 << i))
+            {
+                int32_t delta = (int32_t) pRecord.widths[i] - (int32_t) pPrevious.widths[i];
+                size += writeVarint(((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31), pBuffer + size);
+            }
+        }
+        return size;
+    }
+
+    /**
+     * decodes a record
+     *
+     * @param pPrevious previous record (ignored for absolute records)
+     * @param pBuffer encoded data
+     * @param pSize number of available bytes
+     * @param pRecord receives the decoded record
+     * @param pIsAbsolute receives true if the record was an absolute record
+     * @return number of bytes consumed or 0 if the available bytes do not hold a complete record
+     */
+    static uint8_t decode(const Record_t &pPrevious, const uint8_t *pBuffer, uint32_t pSize, Record_t &pRecord,
+                          bool &pIsAbsolute)
+    {
+        uint32_t header;
+        uint8_t size = readVarint(pBuffer, pSize, header);
+        if (0 == size)
+        {
+            return 0;
+        }
+
+        pIsAbsolute = (0 != (header & ABSOLUTE_FLAG));
+        if (pIsAbsolute)
+        {
+            uint32_t value;
+            uint8_t valueSize = readVarint(pBuffer + size, pSize - size, value);
+            if (0 == valueSize)
+            {
+                return 0;
+            }
+            size += valueSize;
+            pRecord.timestamp = value;
+
+            for (uint8_t i = 0; i < NUM_CHANNELS; ++i)
+            {
+                valueSize = readVarint(pBuffer + size, pSize - size, value);
+                if (0 == valueSize)
+                {
+                    return 0;
+                }
+                size += valueSize;
+                pRecord.widths[i] = value;
+            }
+            return size;
+        }
+
+        pRecord.timestamp = pPrevious.timestamp + (header >> 4);
+        for (uint8_t i = 0; i < NUM_CHANNELS; ++i)
+        {
+            pRecord.widths[i] = pPrevious.widths[i];
+            if (header & (1 << i))
+            {
+                uint32_t value;
+                uint8_t valueSize = readVarint(pBuffer + size, pSize - size, value);
+                if (0 == valueSize)
+                {
+                    return 0;
+                }
+                size += valueSize;
+                pRecord.widths[i] += (int32_t) (value >> 1) ^ -(int32_t) (value & 1);
+            }
+        }
+        return size;
+    }
+
+private:
+    static uint8_t writeVarint(uint32_t pValue, uint8_t *pBuffer)
+    {
+        uint8_t size = 0;
+        while (0x7F < pValue)
+        {
+            pBuffer[size++] = (pValue & 0x7F) | 0x80;
+            pValue >>= 7;
+        }
+        pBuffer[size++] = pValue;
+        return size;
+    }
+
+    static uint8_t readVarint(const uint8_t *pBuffer, uint32_t pSize, uint32_t &pValue)
+    {
+        pValue = 0;
+        for (uint8_t i = 0; i < 5 && i < pSize; ++i)
+        {
+            pValue |= (uint32_t) (pBuffer[i] & 0x7F) << (7 * i);
+            if (!(pBuffer[i] & 0x80))
+            {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+};
+
+#endif /* RCTRACE_H_ */
@@ -0,0 +1,121 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "RcTraceRecorder.h"
+
+/**
+ * limits a pulse width to the 16 bits stored in the trace
+ */
+static uint16_t toTraceWidth(unsigned long pWidth)
+{
+    return (0xFFFF < pWidth) ? 0xFFFF : pWidth;
+}
+
+/**
+ * constructor
+ */
+RcTraceRecorder::RcTraceRecorder(void) :
+        misAbsoluteRequired(true), misStarted(false), mHead(0), mCount(0), mDroppedRecords(0)
+{
+    mPrevious.timestamp = 0;
+    for (uint8_t i = 0; i < RcTrace::NUM_CHANNELS; ++i)
+    {
+        mPrevious.widths[i] = 0;
+    }
+}
+
+/**
+ * records a read of the RC inputs. The trace starts with the magic bytes and an absolute record. If the ring buffer
+ * is full, the record is dropped and the next record is written as absolute record.
+ *
+ * @param pTimestamp timestamp of the read in msec
+ * @param pThrottle throttle pulse width in usec
+ * @param pSteering steering pulse width in usec
+ * @param p3rdChannel 3rd channel pulse width in usec
+ */
+void RcTraceRecorder::record(unsigned long pTimestamp, unsigned long pThrottle, unsigned long pSteering,
+                             unsigned long p3rdChannel)
+{
+    if (!misStarted)
+    {
+        uint8_t magic[RcTrace::MAGIC_SIZE];
+        RcTrace::writeMagic(magic);
+        push(magic, RcTrace::MAGIC_SIZE);
+        misStarted = true;
+    }
+
+    RcTrace::Record_t record;
+    record.timestamp = pTimestamp;
+    record.widths[0] = toTraceWidth(pThrottle);
+    record.widths[1] = toTraceWidth(pSteering);
+    record.widths[2] = toTraceWidth(p3rdChannel);
+
+    uint8_t encoded[RcTrace::MAX_RECORD_SIZE];
+    uint8_t size = RcTrace::encode(mPrevious, record, misAbsoluteRequired, encoded);
+
+    if (BUFFER_SIZE - mCount < size)
+    {
+        ++mDroppedRecords;
+        misAbsoluteRequired = true;
+        return;
+    }
+
+    push(encoded, size);
+    mPrevious = record;
+    misAbsoluteRequired = false;
+}
+
+/**
+ * passes as many queued bytes to the serial port as fit into its transmit buffer, so Serial.write never waits
+ */
+void RcTraceRecorder::flush(void)
+{
+    int available = Serial.availableForWrite();
+
+    while (0 < mCount && 0 < available)
+    {
+        Serial.write(mBuffer[mHead]);
+        if (++mHead == BUFFER_SIZE)
+        {
+            mHead = 0;
+        }
+        --mCount;
+        --available;
+    }
+}
+
+/**
+ * appends bytes to the ring buffer, the caller has checked the free space
+ */
+void RcTraceRecorder::push(const uint8_t *pData, uint8_t pSize)
+{
+    uint8_t tail = (mHead + mCount) % BUFFER_SIZE;
+    for (uint8_t i = 0; i < pSize; ++i)
+    {
+        mBuffer[tail] = pData[i];
+        if (++tail == BUFFER_SIZE)
+        {
+            tail = 0;
+        }
+    }
+    mCount += pSize;
+}
@@ -0,0 +1,96 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCTRACERECORDER_H_
+#define RCTRACERECORDER_H_
+
+#include "RcTrace.h"
+
+/**
+ * Streams a trace of the raw RC inputs (see RcTrace) over the serial port without blocking the loop.
+ *
+ * Records are encoded into a small ring buffer, which is drained only as far as the transmit buffer of the serial
+ * port has room. If a record does not fit, it is dropped and the next record is written as absolute record, so the
+ * replay continues after the gap.
+ */
+class RcTraceRecorder
+{
+public:
+    /**
+     * constructor
+     */
+    RcTraceRecorder(void);
+
+    /**
+     * records a read of the RC inputs
+     *
+     * @param pTimestamp timestamp of the read in msec
+     * @param pThrottle throttle pulse width in usec
+     * @param pSteering steering pulse width in usec
+     * @param p3rdChannel 3rd channel pulse width in usec
+     */
+    void record(unsigned long pTimestamp, unsigned long pThrottle, unsigned long pSteering,
+                unsigned long p3rdChannel);
+
+    /**
+     * passes as many queued bytes to the serial port as fit without blocking. Has to be called every loop.
+     */
+    void flush(void);
+
+    /**
+     * @return number of records dropped because the ring buffer was full
+     */
+    inline unsigned long getDroppedRecords(void)
+    {
+        return mDroppedRecords;
+    }
+
+private:
+    /**
+     * appends bytes to the ring buffer
+     */
+    void push(const uint8_t *pData, uint8_t pSize);
+
+    // size of the ring buffer
+    static const uint8_t BUFFER_SIZE = 64;
+
+    // last record written to the ring buffer
+    RcTrace::Record_t mPrevious;
+
+    // true if the next record has to be an absolute record (start of trace or after a gap)
+    bool misAbsoluteRequired;
+
+    // true after the magic bytes were written
+    bool misStarted;
+
+    // ring buffer for encoded records
+    uint8_t mBuffer[BUFFER_SIZE];
+
+    // index of the next byte to send
+    uint8_t mHead;
+
+    // number of bytes in the ring buffer
+    uint8_t mCount;
+
+    // number of dropped records
+    unsigned long mDroppedRecords;
+};
+
+#endif /* RCTRACERECORDER_H_ */
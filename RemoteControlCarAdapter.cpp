@@ -22,22 +22,19 @@
 #include "Arduino.h"
 
 #include "RemoteControlCarAdapter.h"
-
-#define NUM_CALIBRATION_ITERATION    20
+#include "RcTraceRecorder.h"
+#include "FootprintBudget.h"
 
 /**
  * Constructor
  *
  * Initialize the adapter with the start values.
  *
- * @param pPinThrottle specifies the arduino board pin number used for throttle
- * @param pThrottleReverse
- * @param pPinSteering specifies the arduino board pin number used for steering
+ * @param pInput input policy, which delivers the pulse widths
  */
-RemoteControlCarAdapter::RemoteControlCarAdapter(int pPinThrottle, bool pThrottleReverse, int pPinSteering,
-                                                 int pPin3rdChannel) :
+template<typename TInput, typename TConfig>
+BasicRemoteControlCarAdapter<TInput, TConfig>::BasicRemoteControlCarAdapter(const TInput &pInput) :
         mThrottle(STOP), // Engine is stopped at start
-        mThrottleReverse(pThrottleReverse), // controls, whether throttle channel is reverse or not
         mDurationOfThrottle(0), // duration of current throttle is 0
         mThrottleSwitch(STOP), // Position for throttle switch is STOP
         mDurationOfThrottleSwitch(0), // duration of current switch is 0
@@ -45,83 +42,279 @@ RemoteControlCarAdapter::RemoteControlCarAdapter(int pPinThrottle, bool pThrottl
         mSteeringSwitch(NEUTRAL), // Position for steering switch is NEUTRAL
         mDurationOfSteeringSwitch(0), // duration of current switch is 0
         mAcceleration(0), // no acceleration at start
-        mRCThrottleNullValue(0), // Let's start with 0, 0 means uninitialized
         mRCThrottleValue(0), //
-        mPreviousThrottleRCValue(0), //
-        mRCSteeringNullValue(0), // let's start with 0, 0 means uninitialized
         mRCSteeringValue(0), //
         mRC3rdChannelValue(0), //
+        mRawThrottleValue(0), //
+        mRawSteeringValue(0), //
+        mRaw3rdChannelValue(0), //
         mLastReadTimestamp(0L), //
-        mLastAccelerationTimestamp(0L), //
         mIsCalibrated(false), //
-        mPinThrottle(pPinThrottle), // store pins used for input
-        mPinSteering(pPinSteering), //store pins used for input
-        mPin3rdChannel(pPin3rdChannel) // third channel used for emergency bar
+        mIsCalibrationStored(false), //
+        mInput(pInput), //
+        mInputSource(NULL), //
+        mTraceRecorder(NULL) //
 {
+    // uncalibrated, 0 means uninitialized
+    mThrottleCalibration.neutral = 0;
+    setNominalEndpoints(mThrottleCalibration);
+    mSteeringCalibration.neutral = 0;
+    setNominalEndpoints(mSteeringCalibration);
+    calculateLimits(mThrottleCalibration, EPLSILON_NULL_THROTTLE, DELTA_THROTTLE_SWITCH, mThrottleLimits);
+    calculateLimits(mSteeringCalibration, EPLSILON_NULL_STEERING, DELTA_STEERING_SWITCH, mSteeringLimits);
 }
 
 /**
  * configure pins to read throttle and steering
  *
- * This method configures 2 pins of the arduino board as input for throttle and
- * steering
+ * This method configures the 3 pins of the vehicle configuration as input for throttle,
+ * steering and the 3rd channel and passes them to the input policy. The pulse capture belongs to the board, so the
+ * input policy is left alone if the inputs are taken from an input source.
  */
-void RemoteControlCarAdapter::setupPins(void)
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::setupPins(void)
 {
-    pinMode(mPinThrottle, INPUT);
-    pinMode(mPinSteering, INPUT);
-    pinMode(mPin3rdChannel, INPUT);
+    pinMode(TConfig::PIN_THROTTLE, INPUT);
+    pinMode(TConfig::PIN_STEERING, INPUT);
+    pinMode(TConfig::PIN_3RD_CHANNEL, INPUT);
+
+    if (!mInputSource)
+    {
+        mInput.setup(TConfig::PIN_THROTTLE, TConfig::PIN_STEERING, TConfig::PIN_3RD_CHANNEL);
+    }
 }
 
 /**
- * before we startup the system the remote controller has to be calibrated
+ * calibrates the system and has to be called once before calling refresh in a loop. A valid calibration stored in
+ * the EEPROM is used as soon as the receiver delivers pulses. Otherwise only the neutral points are sampled, which
+ * takes about 400 msec. If the steering is held at an end at power-on, the calibration mode learns the neutral
+ * points and the endpoints and stores them in the EEPROM (see runCalibrationMode).
  */
-void RemoteControlCarAdapter::calibrate(void)
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::calibrate(void)
 {
 #ifdef DEBUG
     Serial.println("calibrate");
 #endif
 
-    // TODO check if we should implement a real calibrating functionality (check max throttle and steering values from
-    // remote control)
     if (!isCalibrated())
     {
-        mRCThrottleNullValue = 0;
-        mRCSteeringNullValue = 0;
+        unsigned long start = millis();
+        RcCalibration::Data_t data;
 
-        // delay calibration to allow remote controller to initialize
-        delay(200);
+        waitForInputs(start);
+        mLastReadTimestamp = readInputs();
 
-        for (int i = 0; i < NUM_CALIBRATION_ITERATION; ++i)
+        if (isCalibrationRequested())
         {
-            delay(10);
-            mLastReadTimestamp = readInputs();
-            mRCThrottleNullValue += mRCThrottleValue;
-            mRCSteeringNullValue += mRCSteeringValue;
+            runCalibrationMode();
+        }
+        else if (RcCalibration::load(data) && isValid(data.throttle) && isValid(data.steering))
+        {
+            mThrottleCalibration = data.throttle;
+            mSteeringCalibration = data.steering;
+            mIsCalibrationStored = true;
+        }
+        else
+        {
+            // delay calibration to allow remote controller to initialize
+            unsigned long elapsed = millis() - start;
+            if (elapsed < RECEIVER_STARTUP_TIME)
+            {
+                delay(RECEIVER_STARTUP_TIME - elapsed);
+            }
+
+            sampleNeutral();
+            setNominalEndpoints(mThrottleCalibration);
+            setNominalEndpoints(mSteeringCalibration);
         }
 
-        mRCThrottleNullValue /= NUM_CALIBRATION_ITERATION;
-        mRCSteeringNullValue /= NUM_CALIBRATION_ITERATION;
-
-        mPreviousThrottleRCValue = mRCThrottleValue;
+        calculateLimits(mThrottleCalibration, EPLSILON_NULL_THROTTLE, DELTA_THROTTLE_SWITCH, mThrottleLimits);
+        calculateLimits(mSteeringCalibration, EPLSILON_NULL_STEERING, DELTA_STEERING_SWITCH, mSteeringLimits);
 
         mAcceleration = 0;
-        mLastAccelerationTimestamp = mLastReadTimestamp;
+        mThrottleSlope.reset();
+        mThrottleSlope.add(mLastReadTimestamp, mRCThrottleValue);
 
         mIsCalibrated = true;
 
 #ifdef DEBUG
         Serial.println("\nCalibration done.");
-        Serial.print("   mPreviousThrottleRCValue: ");
-        Serial.print(mPreviousThrottleRCValue);
-        Serial.print("   mRCThrottleNullValue: ");
-        Serial.print(mRCThrottleNullValue);
-        Serial.print("  mRCSteeringNullValue: ");
-        Serial.print(mRCSteeringNullValue);
+        Serial.print("   throttle: ");
+        Serial.print(mThrottleCalibration.min);
+        Serial.print(" / ");
+        Serial.print(mThrottleCalibration.neutral);
+        Serial.print(" / ");
+        Serial.print(mThrottleCalibration.max);
+        Serial.print("  steering: ");
+        Serial.print(mSteeringCalibration.min);
+        Serial.print(" / ");
+        Serial.print(mSteeringCalibration.neutral);
+        Serial.print(" / ");
+        Serial.println(mSteeringCalibration.max);
 #endif
     }
 }
 
+/**
+ * waits until the receiver delivers pulses, at most RECEIVER_STARTUP_TIME
+ *
+ * @param pStart timestamp of the start of the calibration in msec
+ */
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::waitForInputs(unsigned long pStart)
+{
+    while (!hasNewInputs() && millis() - pStart < RECEIVER_STARTUP_TIME)
+    {
+        delay(1);
+    }
+}
+
+/**
+ * @return true if the steering is deflected at power-on, which requests the calibration mode
+ */
+template<typename TInput, typename TConfig>
+bool BasicRemoteControlCarAdapter<TInput, TConfig>::isCalibrationRequested(void)
+{
+    // without a signal the steering is 0, which is no request
+    return 0 != mRCSteeringValue
+            && (mRCSteeringValue + CALIBRATION_REQUEST_DEFLECTION < NOMINAL_NEUTRAL
+                    || NOMINAL_NEUTRAL + CALIBRATION_REQUEST_DEFLECTION < mRCSteeringValue);
+}
+
+/**
+ * samples the neutral points of throttle and steering, the sticks have to be in neutral position
+ */
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::sampleNeutral(void)
+{
+    unsigned long throttleSum = 0;
+    unsigned long steeringSum = 0;
+
+    for (int i = 0; i < NUM_CALIBRATION_ITERATION; ++i)
+    {
+        delay(10);
+        mLastReadTimestamp = readInputs();
+        throttleSum += mRCThrottleValue;
+        steeringSum += mRCSteeringValue;
+    }
+
+    mThrottleCalibration.neutral = throttleSum / NUM_CALIBRATION_ITERATION;
+    mSteeringCalibration.neutral = steeringSum / NUM_CALIBRATION_ITERATION;
+}
+
+/**
+ * learns the neutral points and the endpoints of throttle and steering. After the steering is released and the
+ * neutral points are sampled, both sticks have to be moved to all of their ends within CALIBRATION_SWEEP_TIME.
+ * The calibration is stored in the EEPROM if every direction has a travel of at least MIN_TRAVEL, otherwise the
+ * nominal endpoints are used and the EEPROM is left alone.
+ */
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::runCalibrationMode(void)
+{
+    unsigned long start = millis();
+    while (isCalibrationRequested() && millis() - start < CALIBRATION_RELEASE_TIMEOUT)
+    {
+        delay(10);
+        mLastReadTimestamp = readInputs();
+    }
+    delay(CALIBRATION_SETTLE_TIME);
+
+    sampleNeutral();
+    mThrottleCalibration.min = mThrottleCalibration.max = mThrottleCalibration.neutral;
+    mSteeringCalibration.min = mSteeringCalibration.max = mSteeringCalibration.neutral;
+
+    start = millis();
+    while (millis() - start < CALIBRATION_SWEEP_TIME)
+    {
+        delay(10);
+        mLastReadTimestamp = readInputs();
+
+        // a missing pulse is no endpoint
+        if (0 != mRCThrottleValue)
+        {
+            updateEndpoints(mThrottleCalibration, mRCThrottleValue);
+        }
+        if (0 != mRCSteeringValue)
+        {
+            updateEndpoints(mSteeringCalibration, mRCSteeringValue);
+        }
+    }
+
+    if (isValid(mThrottleCalibration) && isValid(mSteeringCalibration))
+    {
+        RcCalibration::save(mThrottleCalibration, mSteeringCalibration);
+        mIsCalibrationStored = true;
+    }
+    else
+    {
+        setNominalEndpoints(mThrottleCalibration);
+        setNominalEndpoints(mSteeringCalibration);
+    }
+}
+
+/**
+ * extends the endpoints of a channel to a pulse width
+ *
+ * @param pChannel calibration of the channel
+ * @param pWidth pulse width in usec
+ */
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::updateEndpoints(RcCalibration::Channel_t &pChannel,
+                                                                    unsigned long pWidth)
+{
+    if (pWidth < pChannel.min)
+    {
+        pChannel.min = pWidth;
+    }
+    if (pChannel.max < pWidth)
+    {
+        pChannel.max = pWidth;
+    }
+}
+
+/**
+ * sets the endpoints of a channel NOMINAL_TRAVEL apart from its neutral point
+ */
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::setNominalEndpoints(RcCalibration::Channel_t &pChannel)
+{
+    pChannel.min = (NOMINAL_TRAVEL < pChannel.neutral) ? pChannel.neutral - NOMINAL_TRAVEL : 0;
+    pChannel.max = pChannel.neutral + NOMINAL_TRAVEL;
+}
+
+/**
+ * @return true if both directions of the channel have a travel of at least MIN_TRAVEL
+ */
+template<typename TInput, typename TConfig>
+bool BasicRemoteControlCarAdapter<TInput, TConfig>::isValid(const RcCalibration::Channel_t &pChannel)
+{
+    return pChannel.min + MIN_TRAVEL <= pChannel.neutral && pChannel.neutral + MIN_TRAVEL <= pChannel.max;
+}
+
+/**
+ * calculates the limits of the states of a channel. The nominal epsilon and delta are scaled by the travel of each
+ * direction, so they keep the same proportion of the stick movement as with NOMINAL_TRAVEL.
+ *
+ * @param pChannel calibration of the channel
+ * @param pEpsilon epsilon for the null point with NOMINAL_TRAVEL in usec
+ * @param pDelta delta to border the switch with NOMINAL_TRAVEL in usec
+ * @param pLimits receives the limits
+ */
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::calculateLimits(const RcCalibration::Channel_t &pChannel,
+                                                                    unsigned long pEpsilon, unsigned long pDelta,
+                                                                    Limits_t &pLimits)
+{
+    unsigned long lowTravel = pChannel.neutral - pChannel.min;
+    unsigned long highTravel = pChannel.max - pChannel.neutral;
+
+    pLimits.switchLow = pChannel.neutral - pDelta * lowTravel / NOMINAL_TRAVEL;
+    pLimits.nullLow = pChannel.neutral - pEpsilon * lowTravel / NOMINAL_TRAVEL;
+    pLimits.nullHigh = pChannel.neutral + pEpsilon * highTravel / NOMINAL_TRAVEL;
+    pLimits.switchHigh = pChannel.neutral + pDelta * highTravel / NOMINAL_TRAVEL;
+}
+
 /**
  * Determines duration of a remote control signal based on the old and the new value of the signal. If the values are
  * equal the last duration is increased by the passed delta. otherwise it's set to 0.
@@ -133,8 +326,10 @@ void RemoteControlCarAdapter::calibrate(void)
  *
  * @return new duration in milliseconds
  */
-unsigned long RemoteControlCarAdapter::determineDuration(int pOldValue, int pNewValue, unsigned long pPreviousDuration,
-                                                         unsigned long pDeltaT)
+template<typename TInput, typename TConfig>
+unsigned long BasicRemoteControlCarAdapter<TInput, TConfig>::determineDuration(int pOldValue, int pNewValue,
+                                                                               unsigned long pPreviousDuration,
+                                                                               unsigned long pDeltaT)
 {
     // handle/increase duration
     if (pOldValue != pNewValue)
@@ -152,7 +347,8 @@ unsigned long RemoteControlCarAdapter::determineDuration(int pOldValue, int pNew
  * status has changed the duration was reseted to zero, otherwise it will be increased.
  * @param pDeltaT in milliseconds between last refresh and current refresh
  */
-void RemoteControlCarAdapter::refreshThrottle(unsigned long pDeltaT)
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::refreshThrottle(unsigned long pDeltaT)
 {
     // determine current throttle
     Throttle_t newThrottle = calculateThrottle();
@@ -166,7 +362,8 @@ void RemoteControlCarAdapter::refreshThrottle(unsigned long pDeltaT)
  * status has changed the duration was reseted to zero, otherwise it will be increased.
  * @param pDeltaT in milliseconds between last refresh and current refresh
  */
-void RemoteControlCarAdapter::refreshThrottleSwitch(unsigned long pDeltaT)
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::refreshThrottleSwitch(unsigned long pDeltaT)
 {
     // determine current throttle switch
     Throttle_t newThrottleSwitch = calculateThrottleSwitch();
@@ -181,7 +378,8 @@ void RemoteControlCarAdapter::refreshThrottleSwitch(unsigned long pDeltaT)
  * status has changed the duration was reseted to zero, otherwise it will be increased.
  * @param pDeltaT in milliseconds between last refresh and current refresh
  */
-void RemoteControlCarAdapter::refreshSteeringSwitch(unsigned long pDeltaT)
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::refreshSteeringSwitch(unsigned long pDeltaT)
 {
     // determine current throttle switch
     Steering_t newSteeringSwitch = calculateSteeringSwitch();
@@ -192,34 +390,41 @@ void RemoteControlCarAdapter::refreshSteeringSwitch(unsigned long pDeltaT)
 }
 
 /**
- * refreshes the acceleration attribute from the remote control throttle setting. For measurement of the acceleration an individual
- * acceleration interval is used. The current acceleration value is calculated as a difference between the current throttle and
- * the throttle value from the last acceleration measuring point. The sign of the value is negative when the car slows down,
- * independent if car is moving forward or backward.
+ * refreshes the acceleration attribute from the remote control throttle setting. With every refresh the
+ * acceleration is calculated as slope of the throttle over a sliding window (see SlopeEstimator). The sign of the
+ * value is negative when the car slows down, independent if car is moving forward or backward. A steep slope over a
+ * short window is limited to +/- MAX_ACCELERATION.
  * @param pDeltaT  in milliseconds between last refresh and current refresh
  */
-void RemoteControlCarAdapter::refreshAcceleration(unsigned long pDeltaT)
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::refreshAcceleration(unsigned long pDeltaT)
 {
-    if (ACCELERATION_MEASURE_INTERVAL < mLastReadTimestamp + pDeltaT - mLastAccelerationTimestamp)
+    mThrottleSlope.add(mLastReadTimestamp + pDeltaT, mRCThrottleValue);
+    long acceleration = -mThrottleSlope.getSlope() * calcAccelerationFactor();
+    if (MAX_ACCELERATION < acceleration)
+    {
+        acceleration = MAX_ACCELERATION;
+    }
+    else if (-MAX_ACCELERATION > acceleration)
     {
-        mAcceleration = (mPreviousThrottleRCValue - mRCThrottleValue) * calcAccelerationFactor();
-        mPreviousThrottleRCValue = mRCThrottleValue;
-        mLastAccelerationTimestamp = mLastReadTimestamp + pDeltaT;
+        acceleration = -MAX_ACCELERATION;
     }
+    mAcceleration = (short) acceleration;
 }
 
 /**
- * returns a factor to correct the algebraic sign of the acceleration value. In case the car moves forward, it returns -1 if
- * car moves backwards it returns 1 otherwise 0.
+ * returns a factor to correct the algebraic sign of the acceleration value. In case the car moves forward, it returns 1 if
+ * car moves backwards it returns -1 otherwise 0.
  * @return the acceleration factor (-1, 0 or 1)
  */
-int RemoteControlCarAdapter::calcAccelerationFactor()
+template<typename TInput, typename TConfig>
+int BasicRemoteControlCarAdapter<TInput, TConfig>::calcAccelerationFactor()
 {
-    if ((mThrottleReverse ? BACKWARD : FORWARD) == mThrottle)
+    if ((TConfig::IS_THROTTLE_REVERSE ? BACKWARD : FORWARD) == mThrottle)
     {
         return 1;
     }
-    else if ((mThrottleReverse ? FORWARD : BACKWARD) == mThrottle)
+    else if ((TConfig::IS_THROTTLE_REVERSE ? FORWARD : BACKWARD) == mThrottle)
     {
         return -1;
     }
@@ -230,12 +435,15 @@ int RemoteControlCarAdapter::calcAccelerationFactor()
  * refresh the values for throttle and steering from remote controller and calculate
  * all dependent values like, switch position for throttle and steering, acceleration, etc
  */
-void RemoteControlCarAdapter::refresh(void)
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::refresh(void)
 {
     if (!isCalibrated())
         calibrate();
 
     unsigned long lReadTimestamp = readInputs();
+    checkInputs(lReadTimestamp);
+    filterInputs(lReadTimestamp);
 
     unsigned long lDeltaT = lReadTimestamp - mLastReadTimestamp;
 
@@ -261,35 +469,117 @@ void RemoteControlCarAdapter::refresh(void)
 /**
  * Reads input values from configured pins
  *
- * This method reads the values provided by the remote controller to the arduino board
- * at the configured pins for throttle and steering
+ * This method reads the values provided by the remote controller to the arduino board from the input policy,
+ * which measures only the channels whose health allows a poll. If an input source is set, the values and the
+ * timestamp are taken from the input source instead. Every read is passed to the trace recorder, if any. The raw
+ * widths are kept, the health check and the filter work on a copy of them.
+ *
+ * @return timestamp of the read in milliseconds
+ */
+template<typename TInput, typename TConfig>
+unsigned long BasicRemoteControlCarAdapter<TInput, TConfig>::readInputs(void)
+{
+    unsigned long readTimestamp;
+
+    if (mInputSource)
+    {
+        readTimestamp = mInputSource->read(mRawThrottleValue, mRawSteeringValue, mRaw3rdChannelValue);
+    }
+    else
+    {
+        // a blocking policy polls a lost channel at a reduced rate, so its timeout does not slow down the loop
+        uint8_t pollMask = TInput::ALL_CHANNELS;
+        if (TInput::IS_BLOCKING)
+        {
+            unsigned long now = millis();
+            pollMask = (mThrottleHealth.isPollDue(now) ? bit(TInput::THROTTLE_CHANNEL) : 0)
+                    | (mSteeringHealth.isPollDue(now) ? bit(TInput::STEERING_CHANNEL) : 0)
+                    | (m3rdChannelHealth.isPollDue(now) ? bit(TInput::THIRD_CHANNEL) : 0);
+        }
+        readTimestamp = mInput.read(pollMask, mRawThrottleValue, mRawSteeringValue, mRaw3rdChannelValue);
+    }
+
+    if (mTraceRecorder)
+    {
+        mTraceRecorder->record(readTimestamp, mRawThrottleValue, mRawSteeringValue, mRaw3rdChannelValue);
+    }
+
+    // health check and filter work on a copy, the raw widths are kept for the telemetry
+    mRCThrottleValue = mRawThrottleValue;
+    mRCSteeringValue = mRawSteeringValue;
+    mRC3rdChannelValue = mRaw3rdChannelValue;
+
+    return readTimestamp;
+}
+
+/**
+ * checks the values read from the channels. An invalid value is replaced by the last valid one, the value of a
+ * lost throttle or steering channel by its neutral point. Only the new pulses reported by the input policy count for
+ * the recovery of a lost channel, the values of an input source are taken as new pulses.
+ *
+ * @param pReadTimestamp timestamp of the read in milliseconds
+ */
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::checkInputs(unsigned long pReadTimestamp)
+{
+    uint8_t newPulses = mInputSource ? TInput::ALL_CHANNELS : mInput.getNewPulses();
+
+    mRCThrottleValue = checkChannel(mThrottleHealth, mRCThrottleValue, pReadTimestamp,
+                                    newPulses & bit(TInput::THROTTLE_CHANNEL), mThrottleCalibration.neutral);
+    mRCSteeringValue = checkChannel(mSteeringHealth, mRCSteeringValue, pReadTimestamp,
+                                    newPulses & bit(TInput::STEERING_CHANNEL), mSteeringCalibration.neutral);
+    mRC3rdChannelValue = checkChannel(m3rdChannelHealth, mRC3rdChannelValue, pReadTimestamp,
+                                      newPulses & bit(TInput::THIRD_CHANNEL), m3rdChannelHealth.getLastValidWidth());
+}
+
+/**
+ * checks the value read from a channel
+ *
+ * @param pHealth health of the channel
+ * @param pWidth pulse width in usec as read
+ * @param pReadTimestamp timestamp of the read in milliseconds
+ * @param pIsNewPulse false if the read returned the same pulse as the previous read
+ * @param pFailsafeWidth pulse width in usec, which replaces the value of a lost channel
+ * @return pulse width in usec to use
  */
-unsigned long RemoteControlCarAdapter::readInputs(void)
+template<typename TInput, typename TConfig>
+unsigned long BasicRemoteControlCarAdapter<TInput, TConfig>::checkChannel(RcChannelHealth &pHealth,
+                                                                          unsigned long pWidth,
+                                                                          unsigned long pReadTimestamp,
+                                                                          bool pIsNewPulse,
+                                                                          unsigned long pFailsafeWidth)
 {
-    mRCThrottleValue = pulseIn(mPinThrottle, HIGH, 20000);
-    mRCSteeringValue = pulseIn(mPinSteering, HIGH, 20000);
-    mRC3rdChannelValue = pulseIn(mPin3rdChannel, HIGH, 20000);
-
-//#ifdef DEBUG
-//    Serial.print ("\nThrottle value: ");
-//    Serial.print (mRCThrottleValue);
-//    Serial.print ("    Steering value: ");
-//    Serial.println (mRCSteeringValue);
-//#endif
-
-    return millis();
+    if (pHealth.check(pWidth, pReadTimestamp, pIsNewPulse) && !pHealth.isLost())
+    {
+        return pWidth;
+    }
+    return pHealth.isLost() ? pFailsafeWidth : pHealth.getLastValidWidth();
+}
+
+/**
+ * replaces the values read from the channels by the output of the noise filters
+ *
+ * @param pReadTimestamp timestamp of the read in milliseconds
+ */
+template<typename TInput, typename TConfig>
+void BasicRemoteControlCarAdapter<TInput, TConfig>::filterInputs(unsigned long pReadTimestamp)
+{
+    mRCThrottleValue = mThrottleFilter.filter(mRCThrottleValue, pReadTimestamp);
+    mRCSteeringValue = mSteeringFilter.filter(mRCSteeringValue, pReadTimestamp);
+    mRC3rdChannelValue = m3rdChannelFilter.filter(mRC3rdChannelValue, pReadTimestamp);
 }
 
 /**
  *
  * @return current throttle value (FORWARD, STOP or BACKWARD)
  */
-RemoteControlCarAdapter::Throttle_t RemoteControlCarAdapter::calculateThrottle(void)
+template<typename TInput, typename TConfig>
+RemoteControlCarStates::Throttle_t BasicRemoteControlCarAdapter<TInput, TConfig>::calculateThrottle(void)
 {
-    if (mRCThrottleNullValue + EPLSILON_NULL_THROTTLE < mRCThrottleValue)
-        return (mThrottleReverse ? FORWARD : BACKWARD);
-    else if (mRCThrottleNullValue - EPLSILON_NULL_THROTTLE > mRCThrottleValue)
-        return (mThrottleReverse ? BACKWARD : FORWARD);
+    if (mThrottleLimits.nullHigh < mRCThrottleValue)
+        return (TConfig::IS_THROTTLE_REVERSE ? FORWARD : BACKWARD);
+    else if (mThrottleLimits.nullLow > mRCThrottleValue)
+        return (TConfig::IS_THROTTLE_REVERSE ? BACKWARD : FORWARD);
     else
         return STOP;
 }
@@ -299,20 +589,20 @@ RemoteControlCarAdapter::Throttle_t RemoteControlCarAdapter::calculateThrottle(v
  * @return current throttle switch value (FORWARD, STOP, BACKWARD or UNDEFINED_THROTTLE if throttle value is
  * out of throttle switch range)
  */
-RemoteControlCarAdapter::Throttle_t RemoteControlCarAdapter::calculateThrottleSwitch(void)
+template<typename TInput, typename TConfig>
+RemoteControlCarStates::Throttle_t BasicRemoteControlCarAdapter<TInput, TConfig>::calculateThrottleSwitch(void)
 {
-    if (mRCThrottleValue < mRCThrottleNullValue - DELTA_THROTTLE_SWITCH
-            || mRCThrottleNullValue + DELTA_THROTTLE_SWITCH < mRCThrottleValue)
+    if (mRCThrottleValue < mThrottleLimits.switchLow || mThrottleLimits.switchHigh < mRCThrottleValue)
     {
         return UNDEFINED_THROTTLE;
     }
-    else if (mRCThrottleNullValue + EPLSILON_NULL_THROTTLE < mRCThrottleValue)
+    else if (mThrottleLimits.nullHigh < mRCThrottleValue)
     {
-        return (mThrottleReverse ? FORWARD : BACKWARD);
+        return (TConfig::IS_THROTTLE_REVERSE ? FORWARD : BACKWARD);
     }
-    else if (mRCThrottleNullValue - EPLSILON_NULL_THROTTLE > mRCThrottleValue)
+    else if (mThrottleLimits.nullLow > mRCThrottleValue)
     {
-        return (mThrottleReverse ? BACKWARD : FORWARD);
+        return (TConfig::IS_THROTTLE_REVERSE ? BACKWARD : FORWARD);
     }
 
     return STOP;
@@ -322,11 +612,12 @@ RemoteControlCarAdapter::Throttle_t RemoteControlCarAdapter::calculateThrottleSw
  *
  * @return current steering value (LEFT, NEUTRAL or RIGHT)
  */
-RemoteControlCarAdapter::Steering_t RemoteControlCarAdapter::calculateSteering(void)
+template<typename TInput, typename TConfig>
+RemoteControlCarStates::Steering_t BasicRemoteControlCarAdapter<TInput, TConfig>::calculateSteering(void)
 {
-    if (mRCSteeringNullValue + EPLSILON_NULL_STEERING < mRCSteeringValue)
+    if (mSteeringLimits.nullHigh < mRCSteeringValue)
         return LEFT;
-    else if (mRCSteeringNullValue - EPLSILON_NULL_STEERING > mRCSteeringValue)
+    else if (mSteeringLimits.nullLow > mRCSteeringValue)
         return RIGHT;
     else
         return NEUTRAL;
@@ -337,18 +628,18 @@ RemoteControlCarAdapter::Steering_t RemoteControlCarAdapter::calculateSteering(v
  * @return current steering switch value (LEFT, NEUTRAL, RIGHT or UNDEFINED_STEERING if steering value is
  * out of steering switch range)
  */
-RemoteControlCarAdapter::Steering_t RemoteControlCarAdapter::calculateSteeringSwitch(void)
+template<typename TInput, typename TConfig>
+RemoteControlCarStates::Steering_t BasicRemoteControlCarAdapter<TInput, TConfig>::calculateSteeringSwitch(void)
 {
-    if (mRCSteeringValue < mRCSteeringNullValue - DELTA_STEERING_SWITCH
-            || mRCSteeringNullValue + DELTA_STEERING_SWITCH < mRCSteeringValue)
+    if (mRCSteeringValue < mSteeringLimits.switchLow || mSteeringLimits.switchHigh < mRCSteeringValue)
     {
         return UNDEFINED_STEERING;
     }
-    else if (mRCSteeringNullValue + EPLSILON_NULL_STEERING < mRCSteeringValue)
+    else if (mSteeringLimits.nullHigh < mRCSteeringValue)
     {
         return LEFT;
     }
-    else if (mRCSteeringNullValue - EPLSILON_NULL_STEERING > mRCSteeringValue)
+    else if (mSteeringLimits.nullLow > mRCSteeringValue)
     {
         return RIGHT;
     }
@@ -356,3 +647,17 @@ RemoteControlCarAdapter::Steering_t RemoteControlCarAdapter::calculateSteeringSw
     return NEUTRAL;
 }
 
+// the adapter with the input policy selected by USE_POLLED_INPUT or USE_PULSEIN_INPUT, the sketch needs no other one
+template class BasicRemoteControlCarAdapter<RcInput_t, VehicleConfig>;
+
+#if !defined(__AVR__)
+// the unit tests and the simulator drive the adapter with generated and recorded inputs
+template class BasicRemoteControlCarAdapter<SyntheticInput, VehicleConfig>;
+template class BasicRemoteControlCarAdapter<TraceReplayInput, VehicleConfig>;
+#endif
+
+// the adapter with the input policy of this build is embedded in RcCarLights
+#ifdef CHECK_FOOTPRINT_BUDGET
+static_assert(sizeof(RemoteControlCarAdapter) <= FootprintBudget::REMOTE_CONTROL_CAR_ADAPTER,
+              "RemoteControlCarAdapter exceeds its RAM budget, see FootprintBudget.h");
+#endif
@@ -21,7 +21,31 @@
 #ifndef RemoteControlCarAdapter_h
 #define RemoteControlCarAdapter_h
 
-class RemoteControlCarAdapter
+#include "RcCalibration.h"
+#include "RcInputPolicy.h"
+#include "RcInputSource.h"
+#include "RcChannelFilter.h"
+#include "RcChannelHealth.h"
+#include "SlopeEstimator.h"
+#include "VehicleConfig.h"
+
+class RcTraceRecorder;
+
+// the RC channels of RemoteControlCarAdapter are measured by pin change interrupts (see PulseCaptureInput). Define
+// USE_POLLED_INPUT to measure all channels at once in a blocking loop (see PolledInput), e.g. if the pins have no pin
+// change interrupt, or USE_PULSEIN_INPUT to fall back to the blocking measurement of one channel after the other with
+// pulseIn (see PulseInInput).
+//#define USE_POLLED_INPUT
+//#define USE_PULSEIN_INPUT
+
+#if defined(USE_POLLED_INPUT) && defined(USE_PULSEIN_INPUT)
+#error "USE_POLLED_INPUT and USE_PULSEIN_INPUT exclude each other"
+#endif
+
+/**
+ * states of throttle and steering, common to the adapters of all input policies
+ */
+class RemoteControlCarStates
 {
 public:
     typedef enum
@@ -33,24 +57,92 @@ public:
     {
         LEFT, NEUTRAL, RIGHT, UNDEFINED_STEERING
     } Steering_t;
+};
 
+/**
+ * Adapter of the RC receiver, which classifies throttle and steering and derives the virtual switches and the
+ * acceleration. The raw pulse widths are delivered by the input policy TInput (see RcInputPolicy), which is called
+ * without a virtual function. The pins and the direction of the throttle are taken from the vehicle configuration
+ * TConfig (see VehicleConfig.h). The adapter of the sketch is RemoteControlCarAdapter, its policy is selected by
+ * USE_POLLED_INPUT and USE_PULSEIN_INPUT.
+ */
+template<typename TInput, typename TConfig = VehicleConfig>
+class BasicRemoteControlCarAdapter : public RemoteControlCarStates
+{
+public:
     /**
      * Constructor
-     * @param pinThrottle defines the (digital) arduino pin, which is used to read the throttle channel
-     * @param pinSteering defines the (digital) arduino pin, which is used to read the steering value
+     * @param pInput input policy, which delivers the pulse widths
      */
-    RemoteControlCarAdapter(int pinThrottle, bool pThrottleReverse, int pinSteering, int pPin3rdChannel);
+    BasicRemoteControlCarAdapter(const TInput &pInput = TInput());
 
     /**
-     * configure the arduino board to use specified pins for throttle and steering
+     * configure the arduino board to use the pins of the vehicle configuration for throttle, steering and 3rd
+     * channel and sets up the input policy
      */
     void setupPins(void);
 
     /**
-     * claibrates the system and has to be called once before calling refresh in a loop
+     * @return input policy, which delivers the pulse widths
+     */
+    inline TInput &getInput(void)
+    {
+        return mInput;
+    }
+
+    /**
+     * replaces the input policy by another input source at runtime (e.g. the replay of a trace on the host). Has to
+     * be called before setupPins.
+     *
+     * @param pInputSource input source or NULL to read the input policy
+     */
+    inline void setInputSource(RcInputSource *pInputSource)
+    {
+        mInputSource = pInputSource;
+    }
+
+    /**
+     * sets a recorder, which gets every read of the RC inputs including the reads during calibration
+     *
+     * @param pTraceRecorder recorder or NULL to stop recording
+     */
+    inline void setTraceRecorder(RcTraceRecorder *pTraceRecorder)
+    {
+        mTraceRecorder = pTraceRecorder;
+    }
+
+    /**
+     * calibrates the system and has to be called once before calling refresh in a loop. A valid calibration stored in
+     * the EEPROM is used as soon as the receiver delivers pulses. Otherwise only the neutral points are sampled, which
+     * takes about 400 msec. If the steering is held at an end at power-on, the calibration mode learns the neutral
+     * points and the endpoints and stores them in the EEPROM (see runCalibrationMode).
      */
     void calibrate(void);
 
+    /**
+     * @return true if the calibration was taken from the EEPROM or stored there by the calibration mode
+     */
+    inline bool isCalibrationStored(void)
+    {
+        return mIsCalibrationStored;
+    }
+
+    /**
+     * @return neutral point and endpoints of the throttle channel in usec
+     */
+    inline const RcCalibration::Channel_t &getThrottleCalibration(void)
+    {
+        return mThrottleCalibration;
+    }
+
+    /**
+     * @return neutral point and endpoints of the steering channel in usec
+     */
+    inline const RcCalibration::Channel_t &getSteeringCalibration(void)
+    {
+        return mSteeringCalibration;
+    }
+
     /**
      * refresh the values for throttle and steering from remote controller and calculate
      * all dependent values like, switch position for throttle and steering, acceleration, etc
@@ -108,7 +200,9 @@ public:
     }
 
     /**
-     * @return the current acceleration of the throttle (measured between the last and the current throttle position)
+     * @return the current acceleration: the slope of the throttle pulse width (see SlopeEstimator) measured over the
+     * acceleration window up to the last refresh and scaled to 200 msec, multiplied by the acceleration factor (see
+     * calcAccelerationFactor) and limited to +/- MAX_ACCELERATION. It is negative when the car slows down.
      */
     inline short getAcceleration(void)
     {
@@ -122,20 +216,264 @@ public:
      }
      */
 
+    /**
+     * @return the filtered throttle pulse width in microseconds
+     */
+    inline unsigned long getThrottleValue(void)
+    {
+        return mRCThrottleValue;
+    }
+
+    /**
+     * @return the filtered steering pulse width in microseconds
+     */
+    inline unsigned long getSteeringValue(void)
+    {
+        return mRCSteeringValue;
+    }
+
+    /**
+     * @return the filtered 3rd channel pulse width in microseconds
+     */
     inline unsigned long get3rdChannelValue(void)
     {
         return mRC3rdChannelValue;
     }
 
+    /**
+     * @return the throttle pulse width in microseconds as read, before health check and filter
+     */
+    inline unsigned long getRawThrottleValue(void)
+    {
+        return mRawThrottleValue;
+    }
+
+    /**
+     * @return the steering pulse width in microseconds as read, before health check and filter
+     */
+    inline unsigned long getRawSteeringValue(void)
+    {
+        return mRawSteeringValue;
+    }
+
+    /**
+     * @return the 3rd channel pulse width in microseconds as read, before health check and filter
+     */
+    inline unsigned long getRaw3rdChannelValue(void)
+    {
+        return mRaw3rdChannelValue;
+    }
+
+    /**
+     * @return noise filter of the throttle channel, applied before the throttle is classified (median by default)
+     */
+    inline RcChannelFilter &getThrottleFilter(void)
+    {
+        return mThrottleFilter;
+    }
+
+    /**
+     * @return noise filter of the steering channel, applied before the steering is classified (median by default)
+     */
+    inline RcChannelFilter &getSteeringFilter(void)
+    {
+        return mSteeringFilter;
+    }
+
+    /**
+     * @return noise filter of the 3rd channel (median by default)
+     */
+    inline RcChannelFilter &get3rdChannelFilter(void)
+    {
+        return m3rdChannelFilter;
+    }
+
+    /**
+     * @return health and diagnostic counters of the throttle channel
+     */
+    inline const RcChannelHealth &getThrottleHealth(void)
+    {
+        return mThrottleHealth;
+    }
+
+    /**
+     * @return health and diagnostic counters of the steering channel
+     */
+    inline const RcChannelHealth &getSteeringHealth(void)
+    {
+        return mSteeringHealth;
+    }
+
+    /**
+     * @return health and diagnostic counters of the 3rd channel
+     */
+    inline const RcChannelHealth &get3rdChannelHealth(void)
+    {
+        return m3rdChannelHealth;
+    }
+
+    /**
+     * @return true if the throttle or the steering channel is lost. Both channels are in neutral position then.
+     */
+    inline bool isFailsafe(void)
+    {
+        return mThrottleHealth.isLost() || mSteeringHealth.isLost();
+    }
+
+    /**
+     * @return true if the input policy or the input source has inputs, which were not read yet (a blocking policy
+     * always has new inputs)
+     */
+    inline bool hasNewInputs(void)
+    {
+        if (mInputSource)
+        {
+            return mInputSource->hasNewInputs();
+        }
+        return mInput.hasNewInputs();
+    }
+
+    /**
+     * checks if the interrupts may be disabled for a duration without corrupting a pulse measurement of the input
+     * policy. An input source measures nothing on the board.
+     *
+     * @param pDuration duration in usec
+     * @return true if no pulse is measured within the duration
+     */
+    inline bool isInputQuiet(unsigned long pDuration)
+    {
+        return mInputSource || mInput.isQuiet(pDuration);
+    }
+
+    /**
+     * @return timestamp in milliseconds from which on a refresh may measure another acceleration without a change of
+     * the throttle
+     */
+    inline unsigned long getNextAccelerationTimestamp(void)
+    {
+        return mThrottleSlope.getNextChangeTimestamp();
+    }
+
+    /**
+     * sets the length of the window, over which the acceleration is measured. A shorter window reacts faster to a
+     * release of the throttle, a longer one is less sensitive to noise.
+     *
+     * @param pWindow window length in milliseconds
+     */
+    inline void setAccelerationWindow(unsigned long pWindow)
+    {
+        mThrottleSlope.setWindow(pWindow);
+    }
+
 private:
+    /**
+     * pulse widths in usec, which separate the states of a channel
+     */
+    typedef struct
+    {
+        // below switchLow or above switchHigh the switch of the channel is undefined
+        uint16_t switchLow;
+        // between nullLow and nullHigh the channel is in neutral position
+        uint16_t nullLow;
+        uint16_t nullHigh;
+        uint16_t switchHigh;
+    } Limits_t;
+
+    /**
+     * waits until the receiver delivers pulses, at most RECEIVER_STARTUP_TIME
+     *
+     * @param pStart timestamp of the start of the calibration in msec
+     */
+    void waitForInputs(unsigned long pStart);
+
+    /**
+     * @return true if the steering is deflected at power-on, which requests the calibration mode
+     */
+    bool isCalibrationRequested(void);
+
+    /**
+     * samples the neutral points of throttle and steering, the sticks have to be in neutral position
+     */
+    void sampleNeutral(void);
+
+    /**
+     * learns the neutral points and the endpoints of throttle and steering. After the steering is released and the
+     * neutral points are sampled, both sticks have to be moved to all of their ends within CALIBRATION_SWEEP_TIME.
+     * The calibration is stored in the EEPROM if every direction has a travel of at least MIN_TRAVEL, otherwise the
+     * nominal endpoints are used and the EEPROM is left alone.
+     */
+    void runCalibrationMode(void);
+
+    /**
+     * extends the endpoints of a channel to a pulse width
+     *
+     * @param pChannel calibration of the channel
+     * @param pWidth pulse width in usec
+     */
+    static void updateEndpoints(RcCalibration::Channel_t &pChannel, unsigned long pWidth);
+
+    /**
+     * sets the endpoints of a channel NOMINAL_TRAVEL apart from its neutral point
+     */
+    static void setNominalEndpoints(RcCalibration::Channel_t &pChannel);
+
+    /**
+     * @return true if both directions of the channel have a travel of at least MIN_TRAVEL
+     */
+    static bool isValid(const RcCalibration::Channel_t &pChannel);
+
+    /**
+     * calculates the limits of the states of a channel. The nominal epsilon and delta are scaled by the travel of each
+     * direction, so they keep the same proportion of the stick movement as with NOMINAL_TRAVEL.
+     *
+     * @param pChannel calibration of the channel
+     * @param pEpsilon epsilon for the null point with NOMINAL_TRAVEL in usec
+     * @param pDelta delta to border the switch with NOMINAL_TRAVEL in usec
+     * @param pLimits receives the limits
+     */
+    static void calculateLimits(const RcCalibration::Channel_t &pChannel, unsigned long pEpsilon, unsigned long pDelta,
+                                Limits_t &pLimits);
+
     /**
      * Reads input values from configured pins
      *
-     * This method reads the values provided by the remote controller to the arduino board
-     * at the configured pins for throttle and steering
+     * This method reads the values provided by the remote controller to the arduino board from the input policy,
+     * which measures only the channels whose health allows a poll. If an input source is set, the values and the
+     * timestamp are taken from the input source instead. Every read is passed to the trace recorder, if any.
+     *
+     * @return timestamp of the read in milliseconds
      */
     unsigned long readInputs(void);
 
+    /**
+     * checks the values read from the channels. An invalid value is replaced by the last valid one, the value of a
+     * lost throttle or steering channel by its neutral point. Only the new pulses reported by the input policy count
+     * for the recovery of a lost channel, the values of an input source are taken as new pulses.
+     *
+     * @param pReadTimestamp timestamp of the read in milliseconds
+     */
+    void checkInputs(unsigned long pReadTimestamp);
+
+    /**
+     * checks the value read from a channel
+     *
+     * @param pHealth health of the channel
+     * @param pWidth pulse width in usec as read
+     * @param pReadTimestamp timestamp of the read in milliseconds
+     * @param pIsNewPulse false if the read returned the same pulse as the previous read
+     * @param pFailsafeWidth pulse width in usec, which replaces the value of a lost channel
+     * @return pulse width in usec to use
+     */
+    static unsigned long checkChannel(RcChannelHealth &pHealth, unsigned long pWidth, unsigned long pReadTimestamp,
+                                      bool pIsNewPulse, unsigned long pFailsafeWidth);
+
+    /**
+     * replaces the values read from the channels by the output of the noise filters
+     *
+     * @param pReadTimestamp timestamp of the read in milliseconds
+     */
+    void filterInputs(unsigned long pReadTimestamp);
+
     /**
      *
      * @return if remote controller is calibrated
@@ -201,10 +539,10 @@ private:
      */
     void refreshSteeringSwitch(unsigned long pDeltaT);
     /**
-     * refreshes the acceleration attribute from the remote control throttle setting. For measurement of the acceleration an individual
-     * acceleration interval is used. The current acceleration value is calculated as a difference between the current throttle and
-     * the throttle value from the last acceleration measuring point. The sign of the value is negative when the car slows down,
-     * independent if car is moving forward or backward.
+     * refreshes the acceleration attribute from the remote control throttle setting. With every refresh the
+     * acceleration is calculated as slope of the throttle over a sliding window (see SlopeEstimator). The sign of the
+     * value is negative when the car slows down, independent if car is moving forward or backward. A steep slope over
+     * a short window is limited to +/- MAX_ACCELERATION.
      * @param pDeltaT  in milliseconds between last refresh and current refresh
      */
     void refreshAcceleration(unsigned long pDeltaT);
@@ -213,29 +551,54 @@ private:
      * car moves backwards it returns -1 otherwise 0.
      * @return the acceleration factor (-1, 0 or 1)
      */
-int calcAccelerationFactor();
+    int calcAccelerationFactor();
 
 private:
-    // measure interval between to values of throttle to determine acceleration
-    static const unsigned long ACCELERATION_MEASURE_INTERVAL = 200;
-
-    // epsilon for the null point of throttle
+    // epsilon for the null point of throttle with NOMINAL_TRAVEL
     static const unsigned long EPLSILON_NULL_THROTTLE = 25;
 
-    // epsilon for the null point of steering
+    // epsilon for the null point of steering with NOMINAL_TRAVEL
     static const unsigned long EPLSILON_NULL_STEERING = 25;
 
-    // delta to border the switch on the throttle channel
+    // delta to border the switch on the throttle channel with NOMINAL_TRAVEL
     static const unsigned long DELTA_THROTTLE_SWITCH = 60;
 
-    // delta to border the switch on the steering channel
+    // delta to border the switch on the steering channel with NOMINAL_TRAVEL
     static const unsigned long DELTA_STEERING_SWITCH = 60;
 
+    // number of reads to sample the neutral points
+    static const int NUM_CALIBRATION_ITERATION = 20;
+
+    // nominal neutral pulse width of a RC channel in usec
+    static const unsigned long NOMINAL_NEUTRAL = 1500;
+
+    // nominal travel between the neutral point and an endpoint in usec
+    static const unsigned long NOMINAL_TRAVEL = 500;
+
+    // minimal travel of every direction of a learned calibration in usec
+    static const unsigned long MIN_TRAVEL = 150;
+
+    // deflection of the steering in usec at power-on, which requests the calibration mode
+    static const unsigned long CALIBRATION_REQUEST_DEFLECTION = 250;
+
+    // time in msec to allow the remote controller to initialize
+    static const unsigned long RECEIVER_STARTUP_TIME = 200;
+
+    // time in msec to wait for the release of the steering in calibration mode
+    static const unsigned long CALIBRATION_RELEASE_TIMEOUT = 10000;
+
+    // time in msec after the release of the steering until the neutral points are sampled
+    static const unsigned long CALIBRATION_SETTLE_TIME = 500;
+
+    // time in msec to move the sticks to their endpoints in calibration mode
+    static const unsigned long CALIBRATION_SWEEP_TIME = 5000;
+
+    // limit of the acceleration, a steep throttle slope over a short window exceeds a short
+    static const long MAX_ACCELERATION = 32767;
+
     // status of throttle, could be FORWARD, STOP or BACKWARD
     Throttle_t mThrottle;
 
-    bool mThrottleReverse;
-
     // duration of the current throttle in milli seconds
     unsigned long mDurationOfThrottle;
 
@@ -267,47 +630,83 @@ private:
     //    and slow down when driving backward
     //  - negative values mean that the car speed up when driving backward
     //    and slow down when driving forward
-    int mAcceleration;
+    short mAcceleration;
 
     // holds the number of seconds the car stand still since last motion
     // short mDurationOfStop;
 
-    // throttle value read from pulseIn
-    unsigned long mRCThrottleNullValue;
+    // neutral point and endpoints of the throttle
+    RcCalibration::Channel_t mThrottleCalibration;
 
-    // throttle value read from pulseIn
-    unsigned long mRCThrottleValue;
+    // neutral point and endpoints of the steering
+    RcCalibration::Channel_t mSteeringCalibration;
+
+    // limits of the throttle states, calculated from the calibration
+    Limits_t mThrottleLimits;
 
-    // throttle value stored from pulseIn read mPreviousThrottleDelay
-    unsigned long mPreviousThrottleRCValue;
+    // limits of the steering states, calculated from the calibration
+    Limits_t mSteeringLimits;
 
-    // steering null value read from pulseIn
-    unsigned long mRCSteeringNullValue;
+    // health checked and filtered throttle pulse width, used by the light logic
+    unsigned long mRCThrottleValue;
 
-    // steering value read from pulseIn
+    // health checked and filtered steering pulse width, used by the light logic
     unsigned long mRCSteeringValue;
 
+    // health checked and filtered 3rd channel pulse width, used by the light logic
     unsigned long mRC3rdChannelValue;
 
+    // throttle pulse width as read, sent in the telemetry
+    unsigned long mRawThrottleValue;
+
+    // steering pulse width as read, sent in the telemetry
+    unsigned long mRawSteeringValue;
+
+    // 3rd channel pulse width as read, sent in the telemetry
+    unsigned long mRaw3rdChannelValue;
+
     // timestamp when the pins were read the last time in milli seconds
     unsigned long mLastReadTimestamp;
 
-    // timestamp when the last acceleration was calculated milli seconds
-    unsigned long mLastAccelerationTimestamp;
+    // slope of the throttle values, which determines the acceleration
+    SlopeEstimator mThrottleSlope;
 
     // is false at start and true after system is calibrated
     bool mIsCalibrated;
 
-    // pin used for pwm input for throttle
-    int mPinThrottle;
+    // is true if the calibration was loaded from or stored to the EEPROM
+    bool mIsCalibrationStored;
 
-    // pin used for pwm input for steering
-    int mPinSteering;
+    // delivers the pulse widths
+    TInput mInput;
 
-    // pin used for pwm input for 3rd channel (emergency bar)
-    int mPin3rdChannel;
+    // health of the channels
+    RcChannelHealth mThrottleHealth;
+    RcChannelHealth mSteeringHealth;
+    RcChannelHealth m3rdChannelHealth;
 
+    // noise filters of the channels
+    RcChannelFilter mThrottleFilter;
+    RcChannelFilter mSteeringFilter;
+    RcChannelFilter m3rdChannelFilter;
+
+    // alternative input source, NULL to read the input policy
+    RcInputSource *mInputSource;
+
+    // recorder of all reads, may be NULL
+    RcTraceRecorder *mTraceRecorder;
 };
 
+// input policy of the sketch
+#if defined(USE_POLLED_INPUT)
+typedef PolledInput RcInput_t;
+#elif defined(USE_PULSEIN_INPUT)
+typedef PulseInInput RcInput_t;
+#else
+typedef PulseCaptureInput RcInput_t;
+#endif
+
+typedef BasicRemoteControlCarAdapter<RcInput_t> RemoteControlCarAdapter;
+
 #endif
 
@@ -0,0 +1,116 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "SbusDecoder.h"
+
+// footer of SBUS, SBUS2 receivers send 0x04, 0x14, 0x24 or 0x34
+static const uint8_t FOOTER = 0x00;
+static const uint8_t SBUS2_FOOTER_MASK = 0xCF;
+static const uint8_t SBUS2_FOOTER = 0x04;
+
+// bits per channel
+static const uint8_t CHANNEL_BITS = 11;
+static const uint16_t CHANNEL_MASK = (1 << CHANNEL_BITS) - 1;
+
+/**
+ * constructor, the channel order of most car transmitters is steering, throttle, 3rd channel
+ *
+ * @param pThrottleChannel index of the throttle channel within a frame
+ * @param pSteeringChannel index of the steering channel within a frame
+ * @param p3rdChannel index of the 3rd channel within a frame
+ */
+SbusDecoder::SbusDecoder(uint8_t pThrottleChannel, uint8_t pSteeringChannel, uint8_t p3rdChannel) :
+        RcFrameDecoder(pThrottleChannel, pSteeringChannel, p3rdChannel), mIndex(0), mLastByteMicros(0),
+        mLostFrameCount(0), mFailsafeCount(0)
+{
+}
+
+/**
+ * handles a received byte, may be called from an interrupt. The footer of a frame takes about 125 usec on a 16 MHz
+ * AVR, every other byte a few usec.
+ *
+ * @param pByte received byte
+ * @param pMicros timestamp of the byte in usec
+ */
+void SbusDecoder::feed(uint8_t pByte, unsigned long pMicros)
+{
+    if (RESYNC_GAP < pMicros - mLastByteMicros)
+    {
+        mIndex = 0;
+    }
+    mLastByteMicros = pMicros;
+
+    if (0 == mIndex && HEADER != pByte)
+    {
+        // wait for the header of the next frame
+        return;
+    }
+
+    mFrame[mIndex++] = pByte;
+    if (FRAME_SIZE == mIndex)
+    {
+        mIndex = 0;
+        decodeFrame(pMicros);
+    }
+}
+
+/**
+ * checks the footer, unpacks and publishes the channels of a complete frame
+ *
+ * @param pMicros timestamp of the last byte in usec
+ */
+void SbusDecoder::decodeFrame(unsigned long pMicros)
+{
+    uint8_t footer = mFrame[FRAME_SIZE - 1];
+    if (FOOTER != footer && SBUS2_FOOTER != (footer & SBUS2_FOOTER_MASK))
+    {
+        countError();
+        return;
+    }
+
+    uint8_t flags = mFrame[FRAME_SIZE - 2];
+    if (flags & FRAME_LOST_FLAG)
+    {
+        ++mLostFrameCount;
+    }
+    if (flags & FAILSAFE_FLAG)
+    {
+        ++mFailsafeCount;
+        return;
+    }
+
+    uint16_t widths[NUM_CHANNELS];
+    const uint8_t *data = mFrame + 1;
+    uint32_t bits = 0;
+    uint8_t bitCount = 0;
+    for (uint8_t i = 0; i < NUM_CHANNELS; ++i)
+    {
+        while (CHANNEL_BITS > bitCount)
+        {
+            bits |= (uint32_t) *data++ << bitCount;
+            bitCount += 8;
+        }
+        widths[i] = toPulseWidth(bits & CHANNEL_MASK);
+        bits >>= CHANNEL_BITS;
+        bitCount -= CHANNEL_BITS;
+    }
+
+    publishFrame(widths, NUM_CHANNELS, pMicros);
+}
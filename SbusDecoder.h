@@ -0,0 +1,137 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef SBUSDECODER_H_
+#define SBUSDECODER_H_
+
+#include <stdint.h>
+
+#include "RcFrameDecoder.h"
+
+/**
+ * Decoder of SBUS, the serial protocol of Futaba and compatible receivers (100000 baud, 8E2, inverted signal).
+ *
+ * A frame of 25 bytes is sent every 7 or 14 msec: header 0x0F, 16 channels with 11 bits each (little endian, bit
+ * packed), a flags byte and a footer. The decoder is fed with every received byte and only stores the bytes before
+ * the footer. The footer unpacks and publishes all 16 channels: on a 16 MHz AVR this takes about 2000 cycles or
+ * 125 usec (mostly the variable shifts of the 32 bit accumulator), as long as receiving a byte. Called from the UART
+ * RX interrupt, the footer delays the other interrupts by this time; the next header follows after a gap of at least
+ * 4 msec, so no byte is lost. Raw values are scaled to pulse widths (172 - 1811 to 987 - 2011 usec). A pause of
+ * RESYNC_GAP between two bytes starts a new frame, without timestamps the decoder finds the next frame by its header.
+ * A frame, which reports the failsafe of the receiver, is not published, so the adapter loses the channels after
+ * FRAME_TIMEOUT.
+ */
+class SbusDecoder : public RcFrameDecoder
+{
+public:
+    /**
+     * size of a frame in bytes
+     */
+    static const uint8_t FRAME_SIZE = 25;
+
+    /**
+     * first byte of a frame
+     */
+    static const uint8_t HEADER = 0x0F;
+
+    /**
+     * pause in usec between two bytes, which starts a new frame (a byte takes 120 usec)
+     */
+    static const unsigned long RESYNC_GAP = 1000;
+
+    /**
+     * number of channels of a frame
+     */
+    static const uint8_t NUM_CHANNELS = 16;
+
+    /**
+     * flag of a frame, which the receiver did not get from the transmitter
+     */
+    static const uint8_t FRAME_LOST_FLAG = 0x04;
+
+    /**
+     * flag of the failsafe of the receiver
+     */
+    static const uint8_t FAILSAFE_FLAG = 0x08;
+
+    /**
+     * constructor, the channel order of most car transmitters is steering, throttle, 3rd channel
+     *
+     * @param pThrottleChannel index of the throttle channel within a frame
+     * @param pSteeringChannel index of the steering channel within a frame
+     * @param p3rdChannel index of the 3rd channel within a frame
+     */
+    SbusDecoder(uint8_t pThrottleChannel = 1, uint8_t pSteeringChannel = 0, uint8_t p3rdChannel = 2);
+
+    /**
+     * handles a received byte, may be called from an interrupt. The footer of a frame takes about 125 usec on a
+     * 16 MHz AVR, every other byte a few usec.
+     *
+     * @param pByte received byte
+     * @param pMicros timestamp of the byte in usec
+     */
+    void feed(uint8_t pByte, unsigned long pMicros);
+
+    /**
+     * @return number of frames with the frame lost flag
+     */
+    inline unsigned long getLostFrameCount(void) const
+    {
+        return mLostFrameCount;
+    }
+
+    /**
+     * @return number of frames with the failsafe flag
+     */
+    inline unsigned long getFailsafeCount(void) const
+    {
+        return mFailsafeCount;
+    }
+
+    /**
+     * converts a raw channel value to a pulse width
+     *
+     * @param pValue raw value (0 - 2047)
+     * @return pulse width in usec
+     */
+    static inline uint16_t toPulseWidth(uint16_t pValue)
+    {
+        // 992 is the center (1500 usec), 8 raw steps are 5 usec
+        return 880 + ((pValue * 5) >> 3);
+    }
+
+private:
+    /**
+     * checks the footer, unpacks and publishes the channels of a complete frame
+     *
+     * @param pMicros timestamp of the last byte in usec
+     */
+    void decodeFrame(unsigned long pMicros);
+
+    // bytes of the running frame
+    uint8_t mFrame[FRAME_SIZE];
+    uint8_t mIndex;
+
+    unsigned long mLastByteMicros;
+    unsigned long mLostFrameCount;
+    unsigned long mFailsafeCount;
+};
+
+#endif /* SBUSDECODER_H_ */
@@ -23,7 +23,6 @@
 #include "SimpleRcCarLightController.h"
 #include "XenonLightSwitchBehaviour.h"
 
-static float HEAD_LIGHT_ANALOG_WRITE_FACTOR = 2.55;
 /**
  * constructor
  * @param pinParkingLight specifies pin used for parking light
@@ -33,7 +32,8 @@ static float HEAD_LIGHT_ANALOG_WRITE_FACTOR = 2.55;
  * @param pinBackUpLight specifies pin used for back up  light
  * @param pinBrakeLight specifies pin used for brake light
  */
-SimpleRcCarLightController::SimpleRcCarLightController(int pPinParkingLight,
+template<typename TBehaviour>
+BasicSimpleRcCarLightController<TBehaviour>::BasicSimpleRcCarLightController(int pPinParkingLight,
         int pPinHeadlight, int pPinRightBlinker, int pPinLeftBlinker,
         int pPinBackUpLight, int pPinBrakeLight)
 {
@@ -52,7 +52,8 @@ SimpleRcCarLightController::SimpleRcCarLightController(int pPinParkingLight,
  *
  * The method has to be called during setup
  */
-void SimpleRcCarLightController::setupPins(void)
+template<typename TBehaviour>
+void BasicSimpleRcCarLightController<TBehaviour>::setupPins(void)
 {
     pinMode(mPinParkingLight, OUTPUT);
     pinMode(mPinHeadlight, OUTPUT);
@@ -62,8 +63,9 @@ void SimpleRcCarLightController::setupPins(void)
     pinMode(mPinBrakeLight, OUTPUT);
 }
 
-void SimpleRcCarLightController::addBehaviour(LightType_t pLightType,
-        LightSwitchBehaviour *pLightSwitchBehaviour)
+template<typename TBehaviour>
+void BasicSimpleRcCarLightController<TBehaviour>::addBehaviour(LightType_t pLightType,
+        TBehaviour *pLightSwitchBehaviour)
 {
     // only for headlights a special behaviour was supported by this controller
     if (HEADLIGHT == pLightType)
@@ -75,16 +77,15 @@ void SimpleRcCarLightController::addBehaviour(LightType_t pLightType,
 /**
  * Set set
  */
-void SimpleRcCarLightController::setHeadlights(bool pHeadlightStatus)
+template<typename TBehaviour>
+void BasicSimpleRcCarLightController<TBehaviour>::setHeadlights(bool pHeadlightStatus)
 {
     if (mHeadlightBehaviour)
     {
         mHeadlightBehaviour->setLightStatus(
                 pHeadlightStatus ?
                         LightSwitchBehaviour::ON : LightSwitchBehaviour::OFF);
-        analogWrite(mPinHeadlight,
-                HEAD_LIGHT_ANALOG_WRITE_FACTOR
-                        * mHeadlightBehaviour->getBrightness());
+        analogWrite(mPinHeadlight, mHeadlightBehaviour->getBrightness());
     }
     else
     {
@@ -97,7 +98,8 @@ void SimpleRcCarLightController::setHeadlights(bool pHeadlightStatus)
  *
  *   @param pLightStatus current light status of all the lights
  */
-void SimpleRcCarLightController::loop(CarLightsStatus_t pLightStatus)
+template<typename TBehaviour>
+void BasicSimpleRcCarLightController<TBehaviour>::loop(CarLightsStatus_t pLightStatus)
 {
     digitalWrite(mPinParkingLight, pLightStatus.parkingLight ? HIGH : LOW);
 
@@ -109,3 +111,15 @@ void SimpleRcCarLightController::loop(CarLightsStatus_t pLightStatus)
     digitalWrite(mPinRightBlinker, pLightStatus.rightBlinker ? HIGH : LOW);
     digitalWrite(mPinLeftBlinker, pLightStatus.leftBlinker ? HIGH : LOW);
 }
+
+/**
+ * @return true if the headlight behaviour (if any) is steady
+ */
+template<typename TBehaviour>
+bool BasicSimpleRcCarLightController<TBehaviour>::isSteady(void)
+{
+    return !mHeadlightBehaviour || mHeadlightBehaviour->isSteady();
+}
+
+// the controller with keyframe behaviours
+template class BasicSimpleRcCarLightController<KeyframeLightSwitchBehaviour>;
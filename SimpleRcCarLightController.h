@@ -22,7 +22,7 @@
 #define SIMPLERCCARLIGHTCONTROLLER_H_
 
 #include "AbstractRcCarLightController.h"
-#include "LightSwitchBehaviour.h"
+#include "KeyframeLightSwitchBehaviour.h"
 
 /**
  * Simple implementation of a RcCarLight output class
@@ -30,11 +30,16 @@
  * This class uses 6 pins to control the lights for parking, headlights, brake, backup light, right and left blinker.
  *
  * The used pins have to passed in the right order to the constructor and the loop method will set these pins to HIGH
- * according the light status passed.
+ * according the light status passed. The headlight behaviour is of the type TBehaviour and called without a virtual
+ * function.
  */
-class SimpleRcCarLightController : public AbstractRcCarLightController
+template<typename TBehaviour = KeyframeLightSwitchBehaviour>
+class BasicSimpleRcCarLightController : public AbstractRcCarLightController
 {
 public:
+    // duration in microseconds, for which showing the lights blocks the interrupts: the pins are set by loop
+    static const unsigned long SHOW_MICROS = 0;
+
     /**
      * Constructor
      * @param pinParkingLight specifies pin used for parking light
@@ -44,8 +49,8 @@ public:
      * @param pinBackUpLight specifies pin used for back up  light
      * @param pinBrakeLight specifies pin used for brake light
      */
-    SimpleRcCarLightController(int pPinParkingLight, int pPinHeadlight, int pPinRightBlinker, int pPinLeftBlinker,
-                           int pPinBackUpLight, int pPinBrakeLight);
+    BasicSimpleRcCarLightController(int pPinParkingLight, int pPinHeadlight, int pPinRightBlinker,
+                                    int pPinLeftBlinker, int pPinBackUpLight, int pPinBrakeLight);
 
     /**
      * configures the required pins for OUTPUT.
@@ -60,7 +65,7 @@ public:
      * @param pLightType lights type where a behavior should be assigned
      * @param pLightSwitchBehaviour behavior, which influences the light switching
      */
-    void addBehaviour(LightType_t pLightType, LightSwitchBehaviour *pLightSwitchBehaviour);
+    void addBehaviour(LightType_t pLightType, TBehaviour *pLightSwitchBehaviour);
 
     /**
      *  sets the configured pins according to the light status
@@ -68,6 +73,18 @@ public:
      */
     void loop(CarLightsStatus_t pLightStatus);
 
+    /**
+     * nothing to show, the pins are set by loop
+     */
+    inline void showFrame(void)
+    {
+    }
+
+    /**
+     * @return true if the headlight behaviour (if any) is steady
+     */
+    bool isSteady(void);
+
 private:
     /**
      * set the headlights depending on the given light status
@@ -95,7 +112,9 @@ private:
     // pin or brake lights
     int mPinBrakeLight;
 
-    LightSwitchBehaviour *mHeadlightBehaviour;
+    TBehaviour *mHeadlightBehaviour;
 };
 
+typedef BasicSimpleRcCarLightController<KeyframeLightSwitchBehaviour> SimpleRcCarLightController;
+
 #endif /* SIMPLERCCARLIGHTCONTROLLER_H_ */
@@ -0,0 +1,127 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "SlopeEstimator.h"
+
+/**
+ * constructor
+ *
+ * @param pWindow length of the window in msec (at least NUM_SLOTS)
+ */
+SlopeEstimator::SlopeEstimator(unsigned long pWindow)
+{
+    setWindow(pWindow);
+}
+
+/**
+ * changes the length of the window and clears the history
+ *
+ * @param pWindow length of the window in msec (at least NUM_SLOTS)
+ */
+void SlopeEstimator::setWindow(unsigned long pWindow)
+{
+    mWindow = (pWindow < NUM_SLOTS) ? NUM_SLOTS : pWindow;
+    mSpacing = mWindow / NUM_SLOTS;
+    reset();
+}
+
+/**
+ * clears the history, the slope is 0 until the next samples
+ */
+void SlopeEstimator::reset(void)
+{
+    mOldest = 0;
+    mCount = 0;
+    mSlope = 0;
+    mLastTimestamp = 0;
+    mLastValue = 0;
+}
+
+/**
+ * adds a sample and updates the slope
+ *
+ * @param pTimestamp timestamp of the sample in msec, not before the previous one
+ * @param pValue value of the sample
+ */
+void SlopeEstimator::add(unsigned long pTimestamp, long pValue)
+{
+    // the start of the window is the newest sample, which is at least one window old
+    while (1 < mCount && mWindow <= pTimestamp - mSamples[getSlot(1)].timestamp)
+    {
+        mOldest = getSlot(1);
+        --mCount;
+    }
+
+    // a shorter span would amplify the noise, so the slope is 0 until the history covers a window
+    unsigned long duration = mCount ? pTimestamp - mSamples[mOldest].timestamp : 0;
+    if (duration < mWindow)
+    {
+        mSlope = 0;
+    }
+    else
+    {
+        mSlope = (pValue - mSamples[mOldest].value) * SLOPE_INTERVAL / (long) duration;
+    }
+    mLastTimestamp = pTimestamp;
+    mLastValue = pValue;
+
+    // if the reads are not aligned to the spacing, a full history may not cover the window yet, so the sample is
+    // dropped instead of the start of the window
+    if (0 == mCount || (NUM_SLOTS > mCount && mSpacing <= pTimestamp - mSamples[getSlot(mCount - 1)].timestamp))
+    {
+        Sample_t &sample = mSamples[getSlot(mCount)];
+        sample.timestamp = pTimestamp;
+        sample.value = pValue;
+        ++mCount;
+    }
+}
+
+/**
+ * @return timestamp in msec from which on the next sample may move the start of the window, i.e. the slope may
+ * change even without a change of the signal
+ */
+unsigned long SlopeEstimator::getNextChangeTimestamp(void) const
+{
+    if (0 == mCount)
+    {
+        return mLastTimestamp + mSpacing;
+    }
+
+    // the slope of a constant signal does not change when the window moves
+    bool isConstant = true;
+    for (uint8_t i = 0; i < mCount && isConstant; ++i)
+    {
+        isConstant = (mLastValue == mSamples[getSlot(i)].value);
+    }
+    if (isConstant)
+    {
+        return mLastTimestamp + mWindow;
+    }
+
+    if (mLastTimestamp - mSamples[mOldest].timestamp < mWindow)
+    {
+        return mSamples[mOldest].timestamp + mWindow;
+    }
+    if (1 < mCount)
+    {
+        return mSamples[getSlot(1)].timestamp + mWindow;
+    }
+    return mLastTimestamp + mSpacing;
+}
@@ -0,0 +1,132 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef SLOPEESTIMATOR_H_
+#define SLOPEESTIMATOR_H_
+
+#include <stdint.h>
+
+/**
+ * Estimates the rate of change of a signal over a sliding time window in integer arithmetic.
+ *
+ * The history keeps at most NUM_SLOTS samples, which are at least 1 / NUM_SLOTS of the window apart; samples in
+ * between only update the current value. The slope is the difference between the current value and the newest
+ * sample of the history, which is at least one window old, scaled to SLOPE_INTERVAL. The slope is 0 until the
+ * history covers a whole window. Adding a sample and
+ * calculating the slope take constant time, so every refresh gets a fresh slope.
+ *
+ * All timestamps are in msec and may wrap around.
+ */
+class SlopeEstimator
+{
+public:
+    // number of samples of the history
+    static const uint8_t NUM_SLOTS = 8;
+
+    // interval in msec to which the slope is scaled, i.e. the slope is the change within this interval
+    static const long SLOPE_INTERVAL = 200;
+
+    // default length of the window in msec
+    static const unsigned long DEFAULT_WINDOW = 100;
+
+    /**
+     * constructor
+     *
+     * @param pWindow length of the window in msec (at least NUM_SLOTS)
+     */
+    SlopeEstimator(unsigned long pWindow = DEFAULT_WINDOW);
+
+    /**
+     * changes the length of the window and clears the history
+     *
+     * @param pWindow length of the window in msec (at least NUM_SLOTS)
+     */
+    void setWindow(unsigned long pWindow);
+
+    /**
+     * @return length of the window in msec
+     */
+    inline unsigned long getWindow(void) const
+    {
+        return mWindow;
+    }
+
+    /**
+     * clears the history, the slope is 0 until the next samples
+     */
+    void reset(void);
+
+    /**
+     * adds a sample and updates the slope
+     *
+     * @param pTimestamp timestamp of the sample in msec, not before the previous one
+     * @param pValue value of the sample
+     */
+    void add(unsigned long pTimestamp, long pValue);
+
+    /**
+     * @return change of the signal within SLOPE_INTERVAL, measured over the window up to the last sample
+     */
+    inline long getSlope(void) const
+    {
+        return mSlope;
+    }
+
+    /**
+     * @return timestamp in msec from which on the next sample may move the start of the window, i.e. the slope may
+     * change even without a change of the signal
+     */
+    unsigned long getNextChangeTimestamp(void) const;
+
+private:
+    typedef struct
+    {
+        unsigned long timestamp;
+        long value;
+    } Sample_t;
+
+    inline uint8_t getSlot(uint8_t pIndex) const
+    {
+        return (mOldest + pIndex) % NUM_SLOTS;
+    }
+
+    // history, mCount samples starting at mOldest
+    Sample_t mSamples[NUM_SLOTS];
+
+    uint8_t mOldest;
+
+    uint8_t mCount;
+
+    // length of the window in msec
+    unsigned long mWindow;
+
+    // minimal time in msec between two samples of the history
+    unsigned long mSpacing;
+
+    // timestamp of the last sample in msec
+    unsigned long mLastTimestamp;
+
+    // value of the last sample
+    long mLastValue;
+
+    long mSlope;
+};
+
+#endif /* SLOPEESTIMATOR_H_ */
@@ -0,0 +1,179 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include <string.h>
+#if !defined(__AVR__)
+#include <chrono>
+#endif
+
+#include "Arduino.h"
+
+#include "StageProfiler.h"
+
+// saturation values of the counters (the limit macros of stdint.h are not available in C++ on every platform)
+static const uint16_t MAX_COUNT_16 = 0xFFFF;
+static const uint32_t MAX_COUNT_32 = 0xFFFFFFFF;
+
+// names of the stages, padded to the same width
+static const char * const sStageNames[StageProfiler::NUM_STAGES] =
+{
+    "adapter    ",
+    "switches   ",
+    "publish    ",
+    "telemetry  ",
+    "light rules",
+    "set lights "
+};
+
+/**
+ * constructor, all statistics are empty
+ */
+StageProfiler::StageProfiler(void)
+{
+    reset();
+}
+
+/**
+ * adds a run of a stage to its statistics
+ *
+ * @param pStage stage
+ * @param pDuration duration of the run in ticks
+ */
+void StageProfiler::record(Stage_t pStage, unsigned long pDuration)
+{
+    Statistics_t &statistics = mStatistics[pStage];
+    Duration_t duration = (pDuration < MAX_DURATION) ? pDuration : MAX_DURATION;
+
+    if (MAX_COUNT_32 == statistics.count)
+    {
+        return;
+    }
+    if (0 == statistics.count || duration < statistics.min)
+    {
+        statistics.min = duration;
+    }
+    if (duration > statistics.max)
+    {
+        statistics.max = duration;
+    }
+    ++statistics.count;
+    statistics.sum = (MAX_COUNT_32 - statistics.sum > pDuration) ? statistics.sum + pDuration : MAX_COUNT_32;
+
+    uint16_t &bucket = statistics.buckets[getBucket(pDuration)];
+    if (MAX_COUNT_16 != bucket)
+    {
+        ++bucket;
+    }
+}
+
+/**
+ * copies the statistics of a stage, which may be recorded by an interrupt at the same time
+ *
+ * @param pStage stage
+ * @param pStatistics receives the statistics
+ */
+void StageProfiler::getStatistics(Stage_t pStage, Statistics_t &pStatistics) const
+{
+    noInterrupts();
+    pStatistics = mStatistics[pStage];
+    interrupts();
+}
+
+/**
+ * clears the statistics of all stages
+ */
+void StageProfiler::reset(void)
+{
+    noInterrupts();
+    memset(mStatistics, 0, sizeof(mStatistics));
+    interrupts();
+}
+
+/**
+ * prints the statistics as text table, one row per stage with name, count, min, mean, max and the buckets
+ *
+ * @param pSerial serial port
+ */
+void StageProfiler::dump(HardwareSerial &pSerial) const
+{
+    pSerial.print("stage       count min mean max [ticks of ");
+    pSerial.print(TICK_NSEC);
+    pSerial.println(" nsec] buckets");
+
+    for (uint8_t stage = 0; stage < NUM_STAGES; ++stage)
+    {
+        Statistics_t statistics;
+        getStatistics((Stage_t) stage, statistics);
+
+        pSerial.print(sStageNames[stage]);
+        pSerial.print(' ');
+        pSerial.print(statistics.count);
+        pSerial.print(' ');
+        pSerial.print((unsigned long) statistics.min);
+        pSerial.print(' ');
+        pSerial.print(statistics.count ? statistics.sum / statistics.count : 0);
+        pSerial.print(' ');
+        pSerial.print((unsigned long) statistics.max);
+        for (uint8_t bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+        {
+            pSerial.print(' ');
+            pSerial.print(statistics.buckets[bucket]);
+        }
+        pSerial.println();
+    }
+}
+
+/**
+ * @param pStage stage
+ * @return name of the stage
+ */
+const char *StageProfiler::getStageName(Stage_t pStage)
+{
+    return sStageNames[pStage];
+}
+
+/**
+ * @return current time of the profiler clock in ticks
+ */
+unsigned long StageProfiler::getTicks(void)
+{
+#if defined(__AVR__)
+    return micros();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @param pDuration duration in ticks
+ * @return bucket of the histograms counting the duration
+ */
+uint8_t StageProfiler::getBucket(unsigned long pDuration)
+{
+    uint8_t bucket = 0;
+
+    while (pDuration > 1 && bucket < NUM_BUCKETS - 1)
+    {
+        pDuration >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
@@ -0,0 +1,178 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef STAGEPROFILER_H_
+#define STAGEPROFILER_H_
+
+#include <stdint.h>
+
+// define PROFILE_STAGES to measure the stages of RcCarLights and print their statistics over the serial port instead
+// of the telemetry
+//#define PROFILE_STAGES
+
+class HardwareSerial;
+
+/**
+ * Measures the execution times of the stages of the loop and the frames.
+ *
+ * For every stage the number of runs, the minimum, maximum and sum of the durations and a histogram with
+ * logarithmic buckets are kept in a fixed block of RAM (36 bytes per stage on the board). Bucket 0 counts durations
+ * below 2 ticks, bucket n the durations from 2^n to 2^(n+1) - 1 ticks, the last bucket all longer ones. Counters
+ * saturate instead of wrapping around.
+ *
+ * A tick is 1 usec on the board (micros(), 4 usec resolution on a 16 MHz board). On the host the virtual clock of the
+ * mock does not advance within a stage, therefore the wall clock of the host is used with a tick of 1 nsec. Minimum
+ * and maximum (Duration_t) hold 65 msec on the board and 4 sec on the host.
+ * Durations include interrupts, which occur within a stage, e.g. a frame interrupting a loop stage.
+ *
+ * The stages are only measured if PROFILE_STAGES is defined, otherwise PROFILE_STAGE expands to nothing.
+ */
+class StageProfiler
+{
+public:
+    /**
+     * profiled stages
+     */
+    typedef enum
+    {
+        ADAPTER_STAGE,       // refresh of the RC adapter
+        SWITCHES_STAGE,      // refresh of the 4 switches
+        PUBLISH_STAGE,       // publishing the inputs to the frames
+        TELEMETRY_STAGE,     // telemetry (or trace) and serial output
+        LIGHT_RULES_STAGE,   // update of the light status within a frame
+        SET_LIGHTS_STAGE,    // setting the lights within a frame
+        NUM_STAGES
+    } Stage_t;
+
+    // number of buckets of the histograms
+    static const uint8_t NUM_BUCKETS = 12;
+
+    // nsec per tick of the profiler clock and duration in ticks as kept by the minimum and maximum
+#if defined(__AVR__)
+    static const unsigned long TICK_NSEC = 1000;
+    typedef uint16_t Duration_t;
+#else
+    static const unsigned long TICK_NSEC = 1;
+    typedef uint32_t Duration_t;
+#endif
+
+    // longest duration kept by the minimum and maximum, longer ones saturate
+    static const Duration_t MAX_DURATION = (Duration_t) 0xFFFFFFFF;
+
+    /**
+     * statistics of a stage, all durations in ticks
+     */
+    typedef struct
+    {
+        uint32_t count;                 // number of runs
+        uint32_t sum;                   // sum of all durations
+        Duration_t min;                 // shortest duration
+        Duration_t max;                 // longest duration
+        uint16_t buckets[NUM_BUCKETS];  // histogram
+    } Statistics_t;
+
+    /**
+     * Measures the duration of a stage from its construction to its destruction.
+     */
+    class Scope
+    {
+    public:
+        inline Scope(StageProfiler &pProfiler, Stage_t pStage) :
+                mProfiler(pProfiler), mStage(pStage), mStart(StageProfiler::getTicks())
+        {
+        }
+
+        inline ~Scope()
+        {
+            mProfiler.record(mStage, StageProfiler::getTicks() - mStart);
+        }
+
+    private:
+        StageProfiler &mProfiler;
+        Stage_t mStage;
+        unsigned long mStart;
+    };
+
+    /**
+     * constructor, all statistics are empty
+     */
+    StageProfiler(void);
+
+    /**
+     * adds a run of a stage to its statistics
+     *
+     * @param pStage stage
+     * @param pDuration duration of the run in ticks
+     */
+    void record(Stage_t pStage, unsigned long pDuration);
+
+    /**
+     * copies the statistics of a stage, which may be recorded by an interrupt at the same time
+     *
+     * @param pStage stage
+     * @param pStatistics receives the statistics
+     */
+    void getStatistics(Stage_t pStage, Statistics_t &pStatistics) const;
+
+    /**
+     * clears the statistics of all stages
+     */
+    void reset(void);
+
+    /**
+     * prints the statistics as text table, one row per stage with name, count, min, mean, max and the buckets
+     *
+     * @param pSerial serial port
+     */
+    void dump(HardwareSerial &pSerial) const;
+
+    /**
+     * @param pStage stage
+     * @return name of the stage
+     */
+    static const char *getStageName(Stage_t pStage);
+
+    /**
+     * @param pBucket bucket of a histogram
+     * @return shortest duration in ticks counted by the bucket
+     */
+    static inline unsigned long getBucketStart(uint8_t pBucket)
+    {
+        return (0 == pBucket) ? 0 : 1UL << pBucket;
+    }
+
+    /**
+     * @return current time of the profiler clock in ticks
+     */
+    static unsigned long getTicks(void);
+
+private:
+    static uint8_t getBucket(unsigned long pDuration);
+
+    Statistics_t mStatistics[NUM_STAGES];
+};
+
+#ifdef PROFILE_STAGES
+#define PROFILE_STAGE(pProfiler, pStage) StageProfiler::Scope profileScope(pProfiler, StageProfiler::pStage)
+#else
+#define PROFILE_STAGE(pProfiler, pStage)
+#endif
+
+#endif /* STAGEPROFILER_H_ */
@@ -0,0 +1,163 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef TELEMETRYFRAME_H_
+#define TELEMETRYFRAME_H_
+
+#include <stdint.h>
+
+/**
+ * Content and binary encoding of a single telemetry frame.
+ *
+ * A frame has a fixed size of SIZE bytes, all multi byte values are little endian:
+ *
+ *  offset  size  content
+ *       0     2  sync bytes SYNC_1, SYNC_2
+ *       2     1  sequence number (detects lost frames)
+ *       3     4  timestamp in msec
+ *       7     1  light status bits (see LightBit_t)
+ *       8     1  throttle, throttle switch, steering and steering switch (2 bits each, from bit 0)
+ *       9     2  acceleration (signed)
+ *      11     2  raw throttle pulse width in usec
+ *      13     2  raw steering pulse width in usec
+ *      15     2  raw 3rd channel pulse width in usec
+ *      17     1  switch states and failsafe (see SwitchBit_t)
+ *      18     1  checksum, sum of the bytes 2 to 17
+ *
+ * The header is used by the sketch and by the host decoder, so it must not depend on the arduino core.
+ */
+class TelemetryFrame
+{
+public:
+    static const uint8_t SIZE = 19;
+
+    static const uint8_t SYNC_1 = 0xA5;
+    static const uint8_t SYNC_2 = 0x5A;
+
+    /**
+     * bits of the light status
+     */
+    typedef enum
+    {
+        PARKING_LIGHT_BIT = 0x01,
+        HEADLIGHT_BIT = 0x02,
+        RIGHT_BLINKER_BIT = 0x04,
+        LEFT_BLINKER_BIT = 0x08,
+        BACKUP_LIGHT_BIT = 0x10,
+        BRAKE_LIGHT_BIT = 0x20,
+        BLINKING_ON_BIT = 0x40
+    } LightBit_t;
+
+    /**
+     * bits of the switch states
+     */
+    typedef enum
+    {
+        LIGHT_SWITCH_BIT = 0x01,
+        EMERGENCY_LIGHT_BAR_SWITCH_BIT = 0x02,
+        TRAFFIC_LIGHT_BAR_SWITCH_BIT = 0x04,
+        SIREN_SWITCH_BIT = 0x08,
+        FAILSAFE_BIT = 0x10     // the RC signal is lost
+    } SwitchBit_t;
+
+    uint8_t sequence;
+    uint32_t timestamp;
+    uint8_t lightStatus;
+    uint8_t throttle;
+    uint8_t throttleSwitch;
+    uint8_t steering;
+    uint8_t steeringSwitch;
+    int16_t acceleration;
+    uint16_t throttleValue;
+    uint16_t steeringValue;
+    uint16_t thirdChannelValue;
+    uint8_t switches;
+
+    /**
+     * writes the frame into a buffer
+     *
+     * @param pBuffer buffer of at least SIZE bytes
+     */
+    void encode(uint8_t *pBuffer) const
+    {
+        pBuffer[0] = SYNC_1;
+        pBuffer[1] = SYNC_2;
+        pBuffer[2] = sequence;
+        pBuffer[3] = timestamp;
+        pBuffer[4] = timestamp >> 8;
+        pBuffer[5] = timestamp >> 16;
+        pBuffer[6] = timestamp >> 24;
+        pBuffer[7] = lightStatus;
+        pBuffer[8] = (throttle & 0x03) | ((throttleSwitch & 0x03) << 2) | ((steering & 0x03) << 4)
+                | ((steeringSwitch & 0x03) << 6);
+        pBuffer[9] = (uint16_t) acceleration;
+        pBuffer[10] = (uint16_t) acceleration >> 8;
+        pBuffer[11] = throttleValue;
+        pBuffer[12] = throttleValue >> 8;
+        pBuffer[13] = steeringValue;
+        pBuffer[14] = steeringValue >> 8;
+        pBuffer[15] = thirdChannelValue;
+        pBuffer[16] = thirdChannelValue >> 8;
+        pBuffer[17] = switches;
+        pBuffer[18] = checksum(pBuffer);
+    }
+
+    /**
+     * reads the frame from a buffer
+     *
+     * @param pBuffer buffer of at least SIZE bytes, starting with the sync bytes
+     * @return true if sync bytes and checksum are valid, false otherwise
+     */
+    bool decode(const uint8_t *pBuffer)
+    {
+        if (SYNC_1 != pBuffer[0] || SYNC_2 != pBuffer[1] || checksum(pBuffer) != pBuffer[18])
+        {
+            return false;
+        }
+
+        sequence = pBuffer[2];
+        timestamp = (uint32_t) pBuffer[3] | ((uint32_t) pBuffer[4] << 8) | ((uint32_t) pBuffer[5] << 16)
+                | ((uint32_t) pBuffer[6] << 24);
+        lightStatus = pBuffer[7];
+        throttle = pBuffer[8] & 0x03;
+        throttleSwitch = (pBuffer[8] >> 2) & 0x03;
+        steering = (pBuffer[8] >> 4) & 0x03;
+        steeringSwitch = (pBuffer[8] >> 6) & 0x03;
+        acceleration = (int16_t) (pBuffer[9] | (pBuffer[10] << 8));
+        throttleValue = pBuffer[11] | (pBuffer[12] << 8);
+        steeringValue = pBuffer[13] | (pBuffer[14] << 8);
+        thirdChannelValue = pBuffer[15] | (pBuffer[16] << 8);
+        switches = pBuffer[17];
+        return true;
+    }
+
+private:
+    static uint8_t checksum(const uint8_t *pBuffer)
+    {
+        uint8_t sum = 0;
+        for (uint8_t i = 2; i < SIZE - 1; ++i)
+        {
+            sum += pBuffer[i];
+        }
+        return sum;
+    }
+};
+
+#endif /* TELEMETRYFRAME_H_ */
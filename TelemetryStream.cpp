@@ -0,0 +1,99 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "Arduino.h"
+
+#include "TelemetryStream.h"
+
+/**
+ * constructor
+ *
+ * @param pInterval minimal interval in msec between two frames, 0 disables the telemetry
+ */
+TelemetryStream::TelemetryStream(unsigned long pInterval) :
+        mInterval(pInterval), mLastFrameTimestamp(0), mSequence(0), mHead(0), mCount(0), mDroppedFrames(0)
+{
+}
+
+/**
+ * checks if the next frame is due and restarts the interval in this case
+ *
+ * @param pNow current timestamp in msec
+ * @return true if a frame should be sent now
+ */
+bool TelemetryStream::isDue(unsigned long pNow)
+{
+    if (0 == mInterval || mInterval > pNow - mLastFrameTimestamp)
+    {
+        return false;
+    }
+
+    mLastFrameTimestamp = pNow;
+    return true;
+}
+
+/**
+ * sets the sequence number of the frame and queues it for sending. If the ring buffer is full, the frame is dropped.
+ *
+ * @param pFrame frame to send
+ */
+void TelemetryStream::send(TelemetryFrame &pFrame)
+{
+    pFrame.sequence = mSequence++;
+
+    if (BUFFER_SIZE - mCount < TelemetryFrame::SIZE)
+    {
+        ++mDroppedFrames;
+        return;
+    }
+
+    uint8_t encoded[TelemetryFrame::SIZE];
+    pFrame.encode(encoded);
+
+    uint8_t tail = (mHead + mCount) % BUFFER_SIZE;
+    for (uint8_t i = 0; i < TelemetryFrame::SIZE; ++i)
+    {
+        mBuffer[tail] = encoded[i];
+        if (++tail == BUFFER_SIZE)
+        {
+            tail = 0;
+        }
+    }
+    mCount += TelemetryFrame::SIZE;
+}
+
+/**
+ * passes as many queued bytes to the serial port as fit into its transmit buffer, so Serial.write never waits
+ */
+void TelemetryStream::flush(void)
+{
+    int available = Serial.availableForWrite();
+
+    while (0 < mCount && 0 < available)
+    {
+        Serial.write(mBuffer[mHead]);
+        if (++mHead == BUFFER_SIZE)
+        {
+            mHead = 0;
+        }
+        --mCount;
+        --available;
+    }
+}
@@ -0,0 +1,113 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef TELEMETRYSTREAM_H_
+#define TELEMETRYSTREAM_H_
+
+#include "TelemetryFrame.h"
+
+/**
+ * Sends telemetry frames over the serial port without ever blocking the loop.
+ *
+ * Frames are encoded into a small ring buffer, which is drained only as far as the transmit buffer of the serial
+ * port has room. A frame which does not fit into the ring buffer is dropped and counted, the sequence number in the
+ * frames allows the receiver to detect the gap.
+ */
+class TelemetryStream
+{
+public:
+    /**
+     * constructor
+     *
+     * @param pInterval minimal interval in msec between two frames, 0 disables the telemetry
+     */
+    TelemetryStream(unsigned long pInterval);
+
+    /**
+     * checks if the next frame is due and restarts the interval in this case
+     *
+     * @param pNow current timestamp in msec
+     * @return true if a frame should be sent now
+     */
+    bool isDue(unsigned long pNow);
+
+    /**
+     * sets the sequence number of the frame and queues it for sending
+     *
+     * @param pFrame frame to send
+     */
+    void send(TelemetryFrame &pFrame);
+
+    /**
+     * passes as many queued bytes to the serial port as fit without blocking. Has to be called every loop.
+     */
+    void flush(void);
+
+    /**
+     * @return true if the telemetry is enabled (interval is not 0)
+     */
+    inline bool isEnabled(void)
+    {
+        return 0 != mInterval;
+    }
+
+    /**
+     * @return timestamp in msec when the next frame is due
+     */
+    inline unsigned long getNextFrameTimestamp(void)
+    {
+        return mLastFrameTimestamp + mInterval;
+    }
+
+    /**
+     * @return number of frames dropped because the ring buffer was full
+     */
+    inline unsigned long getDroppedFrames(void)
+    {
+        return mDroppedFrames;
+    }
+
+private:
+    // size of the ring buffer, holds 3 frames
+    static const uint8_t BUFFER_SIZE = 3 * TelemetryFrame::SIZE;
+
+    // interval between two frames in msec
+    unsigned long mInterval;
+
+    // timestamp of the last frame in msec
+    unsigned long mLastFrameTimestamp;
+
+    // sequence number of the next frame
+    uint8_t mSequence;
+
+    // ring buffer for encoded frames
+    uint8_t mBuffer[BUFFER_SIZE];
+
+    // index of the next byte to send
+    uint8_t mHead;
+
+    // number of bytes in the ring buffer
+    uint8_t mCount;
+
+    // number of dropped frames
+    unsigned long mDroppedFrames;
+};
+
+#endif /* TELEMETRYSTREAM_H_ */
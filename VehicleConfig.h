@@ -0,0 +1,80 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef VEHICLECONFIG_H_
+#define VEHICLECONFIG_H_
+
+#include <stdint.h>
+
+/**
+ * Compile-time configuration of the Camaro, the car of the original board: wiring of the RC receiver and the lights
+ * and the thresholds of the light rules.
+ *
+ * RcCarLights, RemoteControlCarAdapter and the light controller are instantiated with the configuration of the
+ * vehicle, so every pin and threshold is an immediate operand instead of a member loaded from RAM. The configuration
+ * of another vehicle is a struct with the same members, which is selected with VEHICLE_CONFIG.
+ */
+struct CamaroVehicleConfig
+{
+    // pwm input of the throttle channel
+    static constexpr uint8_t PIN_THROTTLE = 7;
+
+    // true if the throttle channel is reversed
+    static constexpr bool IS_THROTTLE_REVERSE = true;
+
+    // pwm input of the steering channel
+    static constexpr uint8_t PIN_STEERING = 8;
+
+    // pwm input of the 3rd channel
+    static constexpr uint8_t PIN_3RD_CHANNEL = 9;
+
+    // output of the parking lights
+    static constexpr uint8_t PIN_PARKING_LIGHT = 2;
+
+    // output of the headlights (pwm)
+    static constexpr uint8_t PIN_HEADLIGHT = 3;
+
+    // data output of the NeoPixel strip
+    static constexpr uint8_t PIN_NEO_PIXEL = 4;
+
+    // output of the emergency light bar switch
+    static constexpr uint8_t PIN_EMERGENCY_LIGHT_SWITCH = 10;
+
+    // output of the siren switch
+    static constexpr uint8_t PIN_SIRENE_SWITCH = 11;
+
+    // output of the traffic light bar switch
+    static constexpr uint8_t PIN_TRAFFIC_BAR_SWITCH = 12;
+
+    // acceleration threshold for brake lights
+    static constexpr long BREAK_ACCELERATION_LEVEL = -20;
+};
+
+// define VEHICLE_CONFIG with the configuration of the vehicle to build, e.g. -DVEHICLE_CONFIG=CamaroVehicleConfig
+#ifndef VEHICLE_CONFIG
+#define VEHICLE_CONFIG CamaroVehicleConfig
+#endif
+
+/**
+ * configuration of the vehicle of this build
+ */
+typedef VEHICLE_CONFIG VehicleConfig;
+
+#endif /* VEHICLECONFIG_H_ */
@@ -22,13 +22,14 @@
 #ifndef XENONLIGHTSWITCHBEHAVIOUR_H_
 #define XENONLIGHTSWITCHBEHAVIOUR_H_
 
-#include "LightSwitchBehaviour.h"
+#include "KeyframeLightSwitchBehaviour.h"
 
 /**
  * class to change the bahaviour of the light switching and try to simulate a Xenon light, with flickering on startup and slow cooldown.
- * The brightness characteristics of a xenon light will be generated by interpolating over few values when switching on or off.
+ * The brightness characteristics of a xenon light are the keyframe curves of the XENON profile (see
+ * KeyframeLightSwitchBehaviour).
  */
-class XenonLightSwitchBehaviour : public LightSwitchBehaviour
+class XenonLightSwitchBehaviour : public KeyframeLightSwitchBehaviour
 {
 public:
     /**
@@ -39,33 +40,7 @@ public:
     /**
      * destructor
      */
-    virtual ~XenonLightSwitchBehaviour();
-
-    /**
-     * sets the lights status of the xenon light switch
-     *
-     * @param pLightStatus desired status of the controlled light
-     */
-    virtual void setLightStatus( LightStatus_t pLightStatus );
-
-    /**
-     * This method implements the startup flickering and the cooldown of a xenon light. It has to be call from the main loop and should
-     * be called as often as possible to get smooth brightness changes.
-     *
-     * @return the brightness of light
-     */
-    virtual unsigned short getBrightness( void );
-
-private:
-    /**
-     * timestamp used to store the timestamp when the light status changes
-     */
-    long _switchTimestamp;
-
-    /**
-     * index used for internal calculation of the interpolation algorithm to simulate the flickering and cooldown
-     */
-    short _interpolationIndex;
+    ~XenonLightSwitchBehaviour();
 };
 
 #endif /* XENONLIGHTSWITCHBEHAVIOUR_H_ */
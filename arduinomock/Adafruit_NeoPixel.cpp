@@ -0,0 +1,102 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "Arduino.h"
+#include "Adafruit_NeoPixel.h"
+
+// the strip type encodes the byte offsets of the colors like in the library
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t pNumPixels, uint8_t, neoPixelType pType) :
+        mNumPixels(pNumPixels), mRedOffset((pType >> 4) & 3), mGreenOffset((pType >> 2) & 3), mBlueOffset(pType & 3),
+        mPixels(new uint8_t[pNumPixels * 3]), mShownPixels(new uint8_t[pNumPixels * 3]), mShowCount(0)
+{
+    memset(mPixels, 0, pNumPixels * 3);
+    memset(mShownPixels, 0, pNumPixels * 3);
+}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel()
+{
+    if (this == ArduinoMock::getLastShownStrip())
+    {
+        ArduinoMock::setLastShownStrip(NULL);
+    }
+    delete[] mPixels;
+    delete[] mShownPixels;
+}
+
+void Adafruit_NeoPixel::begin(void)
+{
+}
+
+void Adafruit_NeoPixel::show(void)
+{
+    // the LEDs take over the colors after the transfer
+    ArduinoMock::blockInterrupts(mNumPixels * PIXEL_TRANSFER_MICROS);
+    memcpy(mShownPixels, mPixels, mNumPixels * 3);
+    ++mShowCount;
+    ArduinoMock::setLastShownStrip(this);
+    ArduinoMock::notifyOutputChange();
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t pIndex, uint32_t pColor)
+{
+    if (pIndex < mNumPixels)
+    {
+        uint8_t *pixel = &mPixels[pIndex * 3];
+        pixel[mRedOffset] = pColor >> 16;
+        pixel[mGreenOffset] = pColor >> 8;
+        pixel[mBlueOffset] = pColor;
+    }
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t pIndex, uint8_t pRed, uint8_t pGreen, uint8_t pBlue)
+{
+    setPixelColor(pIndex, Color(pRed, pGreen, pBlue));
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t pIndex) const
+{
+    return getColor(mPixels, pIndex);
+}
+
+void Adafruit_NeoPixel::setBrightness(uint8_t)
+{
+}
+
+uint32_t Adafruit_NeoPixel::getShownPixelColor(uint16_t pIndex) const
+{
+    return getColor(mShownPixels, pIndex);
+}
+
+uint32_t Adafruit_NeoPixel::getColor(const uint8_t *pPixels, uint16_t pIndex) const
+{
+    if (pIndex >= mNumPixels)
+    {
+        return 0;
+    }
+    const uint8_t *pixel = &pPixels[pIndex * 3];
+    return Color(pixel[mRedOffset], pixel[mGreenOffset], pixel[mBlueOffset]);
+}
+
+const Adafruit_NeoPixel * Adafruit_NeoPixel::getLastShownStrip(void)
+{
+    return ArduinoMock::getLastShownStrip();
+}
@@ -0,0 +1,119 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef ARDUINO_MOCK_ADAFRUIT_NEOPIXEL_H_
+#define ARDUINO_MOCK_ADAFRUIT_NEOPIXEL_H_
+
+#include <stdint.h>
+
+#define NEO_GRB     0x52
+#define NEO_RGB     0x06
+#define NEO_KHZ800  0x0000
+#define NEO_KHZ400  0x0100
+
+typedef uint16_t neoPixelType;
+
+/**
+ * Replacement of the Adafruit NeoPixel library for the host.
+ *
+ * The strip keeps the pixel colors in memory as bytes in the order of the strip type like the library, so getPixels()
+ * can be modified directly. show() copies them into the "shown" frame and counts the calls, so a test or simulation
+ * can check what the LEDs would display. Like the library, show() disables the interrupts during the transfer of the
+ * pixels (see ArduinoMock::blockInterrupts), which delays the interrupts of the board.
+ */
+class Adafruit_NeoPixel
+{
+public:
+    /**
+     * duration in usec of the transfer of a pixel at 800 kHz, during which the interrupts are disabled
+     */
+    static const unsigned long PIXEL_TRANSFER_MICROS = 30;
+
+    Adafruit_NeoPixel(uint16_t pNumPixels, uint8_t pPin, neoPixelType pType = NEO_GRB + NEO_KHZ800);
+
+    ~Adafruit_NeoPixel();
+
+    void begin(void);
+
+    void show(void);
+
+    void setPixelColor(uint16_t pIndex, uint32_t pColor);
+
+    void setPixelColor(uint16_t pIndex, uint8_t pRed, uint8_t pGreen, uint8_t pBlue);
+
+    uint32_t getPixelColor(uint16_t pIndex) const;
+
+    void setBrightness(uint8_t pBrightness);
+
+    uint16_t numPixels(void) const
+    {
+        return mNumPixels;
+    }
+
+    uint8_t *getPixels(void) const
+    {
+        return mPixels;
+    }
+
+    static uint32_t Color(uint8_t pRed, uint8_t pGreen, uint8_t pBlue)
+    {
+        return ((uint32_t) pRed << 16) | ((uint32_t) pGreen << 8) | pBlue;
+    }
+
+    // ---- mock interface ----
+
+    /**
+     * @return the color of a pixel as it was sent by the last call of show()
+     */
+    uint32_t getShownPixelColor(uint16_t pIndex) const;
+
+    /**
+     * @return number of calls of show() of this strip
+     */
+    unsigned long getShowCount(void) const
+    {
+        return mShowCount;
+    }
+
+    /**
+     * @return the strip which called show() most recently on the selected board (see ArduinoMock) or NULL
+     */
+    static const Adafruit_NeoPixel * getLastShownStrip(void);
+
+private:
+    // strips own their pixel buffers and must not be copied
+    Adafruit_NeoPixel(const Adafruit_NeoPixel &);
+    Adafruit_NeoPixel & operator=(const Adafruit_NeoPixel &);
+
+    /**
+     * @return color of the pixel at pIndex within a pixel buffer
+     */
+    uint32_t getColor(const uint8_t *pPixels, uint16_t pIndex) const;
+
+    uint16_t mNumPixels;
+    uint8_t mRedOffset;
+    uint8_t mGreenOffset;
+    uint8_t mBlueOffset;
+    uint8_t *mPixels;
+    uint8_t *mShownPixels;
+    unsigned long mShowCount;
+};
+
+#endif /* ARDUINO_MOCK_ADAFRUIT_NEOPIXEL_H_ */
@@ -0,0 +1,114 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef ARDUINO_MOCK_ARDUINO_H_
+#define ARDUINO_MOCK_ARDUINO_H_
+
+/**
+ * Minimal replacement of the Arduino core API to compile and run the light controller on a host (e.g. Linux).
+ *
+ * Time, pins and the serial port are emulated by class ArduinoMock (see ArduinoMock.h), which also offers the hooks
+ * to drive the emulated inputs from a test or simulation.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "avr/pgmspace.h"
+
+#define HIGH    0x1
+#define LOW     0x0
+
+#define INPUT           0x0
+#define OUTPUT          0x1
+#define INPUT_PULLUP    0x2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define DEC 10
+#define HEX 16
+
+#define bit(b) (1UL << (b))
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// every pin is mapped to its own "port" with a single bit, so code reading port registers directly works as well
+#define NUM_DIGITAL_PINS                 ArduinoMock::NUM_PINS
+#define digitalPinToPort(pPin)           (pPin)
+#define digitalPinToBitMask(pPin)        ((uint8_t) 1)
+#define portInputRegister(pPort)         (&ArduinoMock::getPinLevels()[(pPort)])
+#define digitalPinToInterrupt(pPin)      (pPin)
+
+class ArduinoMock;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long pMilliseconds);
+void delayMicroseconds(unsigned int pMicroseconds);
+
+void pinMode(uint8_t pPin, uint8_t pMode);
+void digitalWrite(uint8_t pPin, uint8_t pValue);
+int digitalRead(uint8_t pPin);
+void analogWrite(uint8_t pPin, int pValue);
+int analogRead(uint8_t pPin);
+
+unsigned long pulseIn(uint8_t pPin, uint8_t pState, unsigned long pTimeout = 1000000L);
+
+void attachInterrupt(uint8_t pInterrupt, void (*pHandler)(void), int pMode);
+void detachInterrupt(uint8_t pInterrupt);
+
+void noInterrupts(void);
+void interrupts(void);
+
+/**
+ * emulation of the serial port. All written bytes are collected by ArduinoMock, nothing is printed.
+ */
+class HardwareSerial
+{
+public:
+    void begin(unsigned long pBaud);
+
+    int availableForWrite(void);
+
+    size_t write(uint8_t pByte);
+    size_t write(const uint8_t *pBuffer, size_t pSize);
+
+    size_t print(const char *pText);
+    size_t print(char pChar);
+    size_t print(int pValue, int pBase = DEC);
+    size_t print(unsigned int pValue, int pBase = DEC);
+    size_t print(long pValue, int pBase = DEC);
+    size_t print(unsigned long pValue, int pBase = DEC);
+    size_t print(double pValue, int pDigits = 2);
+
+    size_t println(void);
+    size_t println(const char *pText);
+    size_t println(long pValue, int pBase = DEC);
+    size_t println(unsigned long pValue, int pBase = DEC);
+};
+
+extern HardwareSerial Serial;
+
+#include "ArduinoMock.h"
+
+#endif /* ARDUINO_MOCK_ARDUINO_H_ */
@@ -0,0 +1,633 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "Arduino.h"
+#include "ArduinoMock.h"
+
+HardwareSerial Serial;
+
+thread_local ArduinoMock::Board *ArduinoMock::sBoard = NULL;
+thread_local ArduinoMock::Board ArduinoMock::sDefaultBoard;
+
+/**
+ * constructor, the board is in the state after reset
+ */
+ArduinoMock::Board::Board(void)
+{
+    memset(mEeprom, 0xFF, sizeof(mEeprom));
+    mEepromWriteCount = 0;
+    reset();
+}
+
+/**
+ * resets time, pins, signals, interrupt handlers and the serial output, the EEPROM keeps its content
+ */
+void ArduinoMock::Board::reset(void)
+{
+    mMicros = 0;
+    mMicrosStep = 0;
+    for (int i = 0; i < NUM_PINS; ++i)
+    {
+        mPinLevel[i] = LOW;
+        mDigitalOutput[i] = LOW;
+        mAnalogOutput[i] = 0;
+        mSignal[i].active = false;
+        mInterruptHandler[i].handler = NULL;
+        mInterruptHandler[i].mode = CHANGE;
+        mPendingInterrupt[i] = false;
+    }
+    mIsInterruptBlocked = false;
+    mSerialOutput.clear();
+    mSerialCapture = true;
+    mSerialByteCount = 0;
+    mSerialAvailableForWrite = 63;
+    mLastShownStrip = NULL;
+    mTimer.period = 0;
+    mTimer.handler = NULL;
+    mTimer.context = NULL;
+    mOutputListener = NULL;
+    mOutputContext = NULL;
+}
+
+/**
+ * resets time, pins, signals, interrupt handlers and the serial output of the selected board
+ */
+void ArduinoMock::reset(void)
+{
+    board().reset();
+}
+
+/**
+ * emulates micros(): returns the current time and advances the clock by the duration of the call
+ *
+ * @return current virtual time in microseconds
+ */
+unsigned long ArduinoMock::readMicros(void)
+{
+    Board &current = board();
+    unsigned long now = current.mMicros;
+    unsigned long step = current.mMicrosStep;
+
+    // interrupt handlers called on the way read the clock without a step
+    if (step)
+    {
+        current.mMicrosStep = 0;
+        advanceMicros(step);
+        current.mMicrosStep = step;
+    }
+    return now;
+}
+
+/**
+ * erases the EEPROM of the selected board
+ */
+void ArduinoMock::eraseEeprom(void)
+{
+    memset(board().mEeprom, 0xFF, EEPROM_SIZE);
+}
+
+/**
+ * @param pAddress address within the EEPROM
+ * @return byte of the EEPROM, 0xFF outside of the EEPROM
+ */
+uint8_t ArduinoMock::readEeprom(int pAddress)
+{
+    return (0 <= pAddress && pAddress < EEPROM_SIZE) ? board().mEeprom[pAddress] : 0xFF;
+}
+
+/**
+ * writes a byte to the EEPROM, addresses outside of the EEPROM are ignored
+ *
+ * @param pAddress address within the EEPROM
+ * @param pValue new value
+ */
+void ArduinoMock::writeEeprom(int pAddress, uint8_t pValue)
+{
+    if (0 <= pAddress && pAddress < EEPROM_SIZE)
+    {
+        board().mEeprom[pAddress] = pValue;
+        ++board().mEepromWriteCount;
+    }
+}
+
+/**
+ * advances the virtual clock to the given time and delivers all signal edges and timer interrupts on the way. Edges of
+ * different pins and timer interrupts are processed in chronological order, an edge first if both happen at the same
+ * time.
+ *
+ * @param pMicros new time in microseconds, times in the past are ignored
+ */
+void ArduinoMock::advanceTo(unsigned long pMicros)
+{
+    Board &current = board();
+
+    for (;;)
+    {
+        int nextPin = -1;
+        for (int i = 0; i < NUM_PINS; ++i)
+        {
+            if (current.mSignal[i].active && current.mSignal[i].nextEdge <= pMicros
+                    && (-1 == nextPin || current.mSignal[i].nextEdge < current.mSignal[nextPin].nextEdge))
+            {
+                nextPin = i;
+            }
+        }
+
+        // a timer interrupt within a section with disabled interrupts is delayed to its end
+        TimerInterrupt_t &timer = current.mTimer;
+        if (!current.mIsInterruptBlocked && 0 < timer.period && timer.nextTick <= pMicros
+                && (-1 == nextPin || timer.nextTick < current.mSignal[nextPin].nextEdge))
+        {
+            if (current.mMicros < timer.nextTick)
+            {
+                current.mMicros = timer.nextTick;
+            }
+            timer.nextTick += timer.period;
+            timer.handler(timer.context);
+            continue;
+        }
+
+        if (-1 == nextPin)
+        {
+            break;
+        }
+
+        current.mMicros = current.mSignal[nextPin].nextEdge;
+        processSignalEdge(nextPin);
+    }
+
+    if (pMicros > current.mMicros)
+    {
+        current.mMicros = pMicros;
+    }
+}
+
+/**
+ * sets an input pin to the given level at the given time.
+ *
+ * @param pPin input pin
+ * @param pLevel new level (HIGH or LOW)
+ * @param pMicros time of the edge in microseconds
+ */
+void ArduinoMock::injectEdge(uint8_t pPin, uint8_t pLevel, unsigned long pMicros)
+{
+    advanceTo(pMicros);
+    setLevel(pPin, pLevel);
+}
+
+/**
+ * drives an input pin with a periodic RC pulse
+ *
+ * @param pPin input pin
+ * @param pWidth high time in microseconds, 0 means no pulse
+ * @param pPeriod period of the signal in microseconds
+ * @param pPhase offset in microseconds of the first rising edge relative to the current time
+ */
+void ArduinoMock::setPulseSignal(uint8_t pPin, unsigned long pWidth, unsigned long pPeriod, unsigned long pPhase)
+{
+    PulseSignal_t &signal = board().mSignal[pPin];
+
+    signal.pendingWidth = pWidth;
+    signal.period = pPeriod;
+
+    if (!signal.active)
+    {
+        signal.active = true;
+        signal.width = pWidth;
+        signal.periodStart = board().mMicros + pPhase;
+        signal.nextEdge = signal.periodStart;
+        setLevel(pPin, LOW);
+    }
+}
+
+/**
+ * stops the periodic signal of an input pin
+ *
+ * @param pPin input pin
+ */
+void ArduinoMock::clearPulseSignal(uint8_t pPin)
+{
+    board().mSignal[pPin].active = false;
+    setLevel(pPin, LOW);
+}
+
+/**
+ * processes the next edge of a periodic signal
+ *
+ * @param pPin input pin
+ */
+void ArduinoMock::processSignalEdge(uint8_t pPin)
+{
+    PulseSignal_t &signal = board().mSignal[pPin];
+
+    if (signal.nextEdge == signal.periodStart)
+    {
+        // start of period, take over new width
+        signal.width = signal.pendingWidth;
+        if (0 < signal.width && signal.width < signal.period)
+        {
+            signal.nextEdge = signal.periodStart + signal.width;
+            setLevel(pPin, HIGH);
+            return;
+        }
+    }
+    else
+    {
+        setLevel(pPin, LOW);
+    }
+
+    signal.periodStart += signal.period;
+    signal.nextEdge = signal.periodStart;
+}
+
+/**
+ * sets the level of a pin and calls the interrupt handler if required
+ *
+ * @param pPin pin
+ * @param pLevel new level
+ */
+void ArduinoMock::setLevel(uint8_t pPin, uint8_t pLevel)
+{
+    Board &current = board();
+
+    if (current.mPinLevel[pPin] == pLevel)
+    {
+        return;
+    }
+
+    current.mPinLevel[pPin] = pLevel;
+
+    if (current.mIsInterruptBlocked)
+    {
+        current.mPendingInterrupt[pPin] = true;
+        return;
+    }
+
+    InterruptHandler_t &interrupt = current.mInterruptHandler[pPin];
+    if (interrupt.handler
+            && (CHANGE == interrupt.mode || (RISING == interrupt.mode && HIGH == pLevel)
+                    || (FALLING == interrupt.mode && LOW == pLevel)))
+    {
+        interrupt.handler();
+    }
+}
+
+/**
+ * advances the clock to the next edge of the given pin, but not beyond the deadline
+ *
+ * @return true if an edge was reached, false if the deadline was reached
+ */
+bool ArduinoMock::advanceToNextEdge(uint8_t pPin, unsigned long pDeadline)
+{
+    PulseSignal_t &signal = board().mSignal[pPin];
+
+    if (signal.active && signal.nextEdge <= pDeadline)
+    {
+        advanceTo(signal.nextEdge);
+        return true;
+    }
+
+    advanceTo(pDeadline);
+    return false;
+}
+
+/**
+ * emulates pulseIn: waits for the end of a running pulse, for the start of the next pulse and measures its length.
+ * The clock moves accordingly.
+ *
+ * @return pulse length in microseconds or 0 if timeout was reached
+ */
+unsigned long ArduinoMock::measurePulse(uint8_t pPin, uint8_t pState, unsigned long pTimeout)
+{
+    Board &current = board();
+    unsigned long deadline = current.mMicros + pTimeout;
+
+    while (pState == current.mPinLevel[pPin])
+    {
+        if (!advanceToNextEdge(pPin, deadline))
+            return 0;
+    }
+
+    while (pState != current.mPinLevel[pPin])
+    {
+        if (!advanceToNextEdge(pPin, deadline))
+            return 0;
+    }
+
+    unsigned long pulseStart = current.mMicros;
+
+    while (pState == current.mPinLevel[pPin])
+    {
+        if (!advanceToNextEdge(pPin, deadline))
+            return 0;
+    }
+
+    return current.mMicros - pulseStart;
+}
+
+/**
+ * starts, replaces or stops the periodic timer interrupt
+ *
+ * @param pPeriod period in microseconds, 0 stops the timer
+ * @param pHandler interrupt handler
+ * @param pContext argument passed to the handler
+ */
+void ArduinoMock::setTimerInterrupt(unsigned long pPeriod, void (*pHandler)(void *), void *pContext)
+{
+    TimerInterrupt_t &timer = board().mTimer;
+
+    timer.period = pHandler ? pPeriod : 0;
+    timer.nextTick = board().mMicros + pPeriod;
+    timer.handler = pHandler;
+    timer.context = pContext;
+}
+
+/**
+ * emulates a section with disabled interrupts, the pending interrupts are handled at its end
+ *
+ * @param pDuration duration of the section in microseconds
+ */
+void ArduinoMock::blockInterrupts(unsigned long pDuration)
+{
+    Board &current = board();
+
+    // a nested section (e.g. within an interrupt handler) ends with the outer one
+    if (current.mIsInterruptBlocked)
+    {
+        advanceMicros(pDuration);
+        return;
+    }
+
+    current.mIsInterruptBlocked = true;
+    advanceMicros(pDuration);
+    current.mIsInterruptBlocked = false;
+
+    // a pin change interrupt compares the levels, so it sees the level at the end of the section only
+    for (int i = 0; i < NUM_PINS; ++i)
+    {
+        if (current.mPendingInterrupt[i])
+        {
+            current.mPendingInterrupt[i] = false;
+            InterruptHandler_t &interrupt = current.mInterruptHandler[i];
+            uint8_t level = current.mPinLevel[i];
+            if (interrupt.handler
+                    && (CHANGE == interrupt.mode || (RISING == interrupt.mode && HIGH == level)
+                            || (FALLING == interrupt.mode && LOW == level)))
+            {
+                interrupt.handler();
+            }
+        }
+    }
+
+    // a delayed timer interrupt
+    advanceTo(current.mMicros);
+}
+
+/**
+ * registers a function, which is called whenever an output changes
+ *
+ * @param pListener function or NULL to remove the listener
+ * @param pContext argument passed to the listener
+ */
+void ArduinoMock::setOutputListener(void (*pListener)(void *), void *pContext)
+{
+    board().mOutputListener = pListener;
+    board().mOutputContext = pContext;
+}
+
+void ArduinoMock::notifyOutputChange(void)
+{
+    Board &current = board();
+
+    if (current.mOutputListener)
+    {
+        current.mOutputListener(current.mOutputContext);
+    }
+}
+
+uint8_t ArduinoMock::readPin(uint8_t pPin)
+{
+    return board().mPinLevel[pPin];
+}
+
+void ArduinoMock::writePin(uint8_t pPin, uint8_t pLevel)
+{
+    if (board().mDigitalOutput[pPin] != pLevel)
+    {
+        board().mDigitalOutput[pPin] = pLevel;
+        notifyOutputChange();
+    }
+}
+
+void ArduinoMock::writeAnalog(uint8_t pPin, int pValue)
+{
+    if (board().mAnalogOutput[pPin] != pValue)
+    {
+        board().mAnalogOutput[pPin] = pValue;
+        notifyOutputChange();
+    }
+}
+
+uint8_t ArduinoMock::getDigitalOutput(uint8_t pPin)
+{
+    return board().mDigitalOutput[pPin];
+}
+
+int ArduinoMock::getAnalogOutput(uint8_t pPin)
+{
+    return board().mAnalogOutput[pPin];
+}
+
+void ArduinoMock::setInterruptHandler(uint8_t pPin, void (*pHandler)(void), int pMode)
+{
+    InterruptHandler_t &interrupt = board().mInterruptHandler[pPin];
+    interrupt.handler = pHandler;
+    interrupt.mode = pMode;
+}
+
+void ArduinoMock::writeSerial(uint8_t pByte)
+{
+    Board &current = board();
+
+    ++current.mSerialByteCount;
+    if (current.mSerialCapture)
+    {
+        current.mSerialOutput.push_back(pByte);
+    }
+}
+
+// ---- emulated arduino core functions ----
+
+unsigned long millis(void)
+{
+    return ArduinoMock::getMicros() / 1000;
+}
+
+unsigned long micros(void)
+{
+    return ArduinoMock::readMicros();
+}
+
+void delay(unsigned long pMilliseconds)
+{
+    ArduinoMock::advanceMicros(pMilliseconds * 1000);
+}
+
+void delayMicroseconds(unsigned int pMicroseconds)
+{
+    ArduinoMock::advanceMicros(pMicroseconds);
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t pPin, uint8_t pValue)
+{
+    ArduinoMock::writePin(pPin, pValue);
+}
+
+int digitalRead(uint8_t pPin)
+{
+    return ArduinoMock::readPin(pPin);
+}
+
+void analogWrite(uint8_t pPin, int pValue)
+{
+    ArduinoMock::writeAnalog(pPin, pValue);
+}
+
+int analogRead(uint8_t)
+{
+    return 0;
+}
+
+unsigned long pulseIn(uint8_t pPin, uint8_t pState, unsigned long pTimeout)
+{
+    return ArduinoMock::measurePulse(pPin, pState, pTimeout);
+}
+
+void attachInterrupt(uint8_t pInterrupt, void (*pHandler)(void), int pMode)
+{
+    ArduinoMock::setInterruptHandler(pInterrupt, pHandler, pMode);
+}
+
+void detachInterrupt(uint8_t pInterrupt)
+{
+    ArduinoMock::setInterruptHandler(pInterrupt, NULL, CHANGE);
+}
+
+void noInterrupts(void)
+{
+}
+
+void interrupts(void)
+{
+}
+
+// ---- emulated serial port ----
+
+void HardwareSerial::begin(unsigned long)
+{
+}
+
+int HardwareSerial::availableForWrite(void)
+{
+    return ArduinoMock::getSerialAvailableForWrite();
+}
+
+size_t HardwareSerial::write(uint8_t pByte)
+{
+    ArduinoMock::writeSerial(pByte);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *pBuffer, size_t pSize)
+{
+    for (size_t i = 0; i < pSize; ++i)
+    {
+        ArduinoMock::writeSerial(pBuffer[i]);
+    }
+    return pSize;
+}
+
+size_t HardwareSerial::print(const char *pText)
+{
+    return write((const uint8_t *) pText, strlen(pText));
+}
+
+size_t HardwareSerial::print(char pChar)
+{
+    return write((uint8_t) pChar);
+}
+
+size_t HardwareSerial::print(int pValue, int pBase)
+{
+    return print((long) pValue, pBase);
+}
+
+size_t HardwareSerial::print(unsigned int pValue, int pBase)
+{
+    return print((unsigned long) pValue, pBase);
+}
+
+size_t HardwareSerial::print(long pValue, int pBase)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), (HEX == pBase) ? "%lx" : "%ld", pValue);
+    return print(buffer);
+}
+
+size_t HardwareSerial::print(unsigned long pValue, int pBase)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), (HEX == pBase) ? "%lx" : "%lu", pValue);
+    return print(buffer);
+}
+
+size_t HardwareSerial::print(double pValue, int pDigits)
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.*f", pDigits, pValue);
+    return print(buffer);
+}
+
+size_t HardwareSerial::println(void)
+{
+    return print("\r\n");
+}
+
+size_t HardwareSerial::println(const char *pText)
+{
+    return print(pText) + println();
+}
+
+size_t HardwareSerial::println(long pValue, int pBase)
+{
+    return print(pValue, pBase) + println();
+}
+
+size_t HardwareSerial::println(unsigned long pValue, int pBase)
+{
+    return print(pValue, pBase) + println();
+}
@@ -0,0 +1,365 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef ARDUINOMOCK_H_
+#define ARDUINOMOCK_H_
+
+#include <stdint.h>
+#include <vector>
+
+class Adafruit_NeoPixel;
+
+/**
+ * Control interface of the emulated arduino board.
+ *
+ * The board has a virtual clock in microseconds, which only moves when the sketch waits (delay, pulseIn) or when the
+ * test/simulation advances it. Input pins can either be driven by single edges (injectEdge) or by a periodic RC pulse
+ * signal (setPulseSignal). All edges are delivered in chronological order to the handlers registered with
+ * attachInterrupt, so interrupt driven code sees the same signal as pulseIn. A periodic timer interrupt
+ * (setTimerInterrupt) is fired at exact multiples of its period in the same chronological order, so the timing of
+ * interrupt driven output is deterministic.
+ *
+ * The state of a board is held by a Board object. The arduino functions and the static methods below work on the
+ * board selected for the calling thread, which is a default board per thread unless another board was selected. A
+ * host program can run many sketch instances, each on its own board, by selecting the board of an instance before
+ * calling it; instances on different threads do not share any state.
+ */
+class ArduinoMock
+{
+public:
+    /**
+     * period of a standard RC receiver signal in microseconds
+     */
+    static const unsigned long RC_SIGNAL_PERIOD = 20000;
+
+    /**
+     * number of emulated pins
+     */
+    static const uint8_t NUM_PINS = 20;
+
+    /**
+     * size of the emulated EEPROM in bytes (ATmega328)
+     */
+    static const uint16_t EEPROM_SIZE = 1024;
+
+    class Board;
+
+    /**
+     * selects the board used by the calling thread
+     *
+     * @param pBoard board or NULL for the default board of the thread
+     */
+    static void select(Board *pBoard)
+    {
+        sBoard = pBoard;
+    }
+
+    /**
+     * resets time, pins, signals, interrupt handlers and the serial output of the selected board
+     */
+    static void reset(void);
+
+    /**
+     * @return current virtual time in microseconds
+     */
+    static unsigned long getMicros(void)
+    {
+        return board().mMicros;
+    }
+
+    /**
+     * advances the virtual clock to the given time and delivers all signal edges on the way
+     *
+     * @param pMicros new time in microseconds, times in the past are ignored
+     */
+    static void advanceTo(unsigned long pMicros);
+
+    /**
+     * advances the virtual clock by the given duration and delivers all signal edges on the way
+     *
+     * @param pDeltaMicros duration in microseconds
+     */
+    static void advanceMicros(unsigned long pDeltaMicros)
+    {
+        advanceTo(board().mMicros + pDeltaMicros);
+    }
+
+    /**
+     * sets the virtual time, which every call of micros() takes. It emulates the duration of a busy loop, which polls
+     * the clock and the pins (e.g. PulsePoller), so the signal edges arrive while the loop is running. The default 0
+     * keeps the clock standing between two waits.
+     *
+     * @param pStep duration of a call of micros() in microseconds
+     */
+    static void setMicrosStep(unsigned long pStep)
+    {
+        board().mMicrosStep = pStep;
+    }
+
+    /**
+     * sets an input pin to the given level at the given time. The clock is advanced to the time of the edge and the
+     * interrupt handler of the pin is called, if the level changes.
+     *
+     * @param pPin input pin
+     * @param pLevel new level (HIGH or LOW)
+     * @param pMicros time of the edge in microseconds
+     */
+    static void injectEdge(uint8_t pPin, uint8_t pLevel, unsigned long pMicros);
+
+    /**
+     * drives an input pin with a periodic RC pulse. A running signal takes over the new width at the beginning of its
+     * next period, like a real receiver does. The pulses of several pins overlap if their phases are closer than
+     * their widths, e.g. all signals started at the same time rise together; a receiver, which sends the channels one
+     * after another, is emulated by phases at least one pulse width apart.
+     *
+     * @param pPin input pin
+     * @param pWidth high time in microseconds, 0 means no pulse at all (e.g. receiver without signal)
+     * @param pPeriod period of the signal in microseconds
+     * @param pPhase offset in microseconds of the first rising edge relative to the current time
+     */
+    static void setPulseSignal(uint8_t pPin, unsigned long pWidth, unsigned long pPeriod = RC_SIGNAL_PERIOD,
+                               unsigned long pPhase = 0);
+
+    /**
+     * stops the periodic signal of an input pin, the pin stays LOW
+     *
+     * @param pPin input pin
+     */
+    static void clearPulseSignal(uint8_t pPin);
+
+    /**
+     * starts, replaces or stops the periodic timer interrupt of the board. It replaces the timer registers of the
+     * real board.
+     *
+     * @param pPeriod period in microseconds, the first interrupt fires one period after the current time, 0 stops
+     * the timer
+     * @param pHandler interrupt handler
+     * @param pContext argument passed to the handler
+     */
+    static void setTimerInterrupt(unsigned long pPeriod, void (*pHandler)(void *), void *pContext);
+
+    /**
+     * emulates a section of the given duration with disabled interrupts, e.g. the transfer of a NeoPixel strip. The
+     * clock advances and the signals change their levels, but the interrupt handlers of the pins and the timer
+     * interrupt are called at the end of the section, like the pending interrupts of a real board: an edge is
+     * timestamped late, a pin, which changes twice, raises its interrupt once.
+     *
+     * @param pDuration duration of the section in microseconds
+     */
+    static void blockInterrupts(unsigned long pDuration);
+
+    /**
+     * registers a function, which is called whenever an output changes (digitalWrite or analogWrite with a new value,
+     * show of a NeoPixel strip). The current time is the exact time of the change, even within an interrupt handler.
+     *
+     * @param pListener function or NULL to remove the listener
+     * @param pContext argument passed to the listener
+     */
+    static void setOutputListener(void (*pListener)(void *), void *pContext);
+
+    /**
+     * @return the last value written with digitalWrite to the pin
+     */
+    static uint8_t getDigitalOutput(uint8_t pPin);
+
+    /**
+     * @return the last value written with analogWrite to the pin
+     */
+    static int getAnalogOutput(uint8_t pPin);
+
+    /**
+     * enables or disables collecting the serial output. Long simulations should disable it, the written bytes are
+     * counted anyway.
+     *
+     * @param pCapture true to collect all written bytes (default after reset), false to count them only
+     */
+    static void setSerialCapture(bool pCapture)
+    {
+        board().mSerialCapture = pCapture;
+    }
+
+    /**
+     * @return number of bytes written to the serial port since the last reset
+     */
+    static unsigned long getSerialByteCount(void)
+    {
+        return board().mSerialByteCount;
+    }
+
+    /**
+     * @return all bytes written to the serial port since the last reset or clearSerialOutput
+     */
+    static const std::vector<uint8_t> & getSerialOutput(void)
+    {
+        return board().mSerialOutput;
+    }
+
+    /**
+     * discards the collected serial output
+     */
+    static void clearSerialOutput(void)
+    {
+        board().mSerialOutput.clear();
+    }
+
+    /**
+     * defines the value returned by Serial.availableForWrite()
+     *
+     * @param pFree number of free bytes in the emulated transmit buffer
+     */
+    static void setSerialAvailableForWrite(int pFree)
+    {
+        board().mSerialAvailableForWrite = pFree;
+    }
+
+    /**
+     * erases the EEPROM of the selected board, all bytes are 0xFF afterwards. The EEPROM keeps its content on reset
+     * like on a real board, so a test can write it and power the board up again.
+     */
+    static void eraseEeprom(void);
+
+    /**
+     * @return number of writes to the EEPROM of the selected board since its creation (a real EEPROM cell endures
+     * about 100000 writes)
+     */
+    static unsigned long getEepromWriteCount(void)
+    {
+        return board().mEepromWriteCount;
+    }
+
+    // the rest of the interface is used by the emulated arduino functions
+
+    static unsigned long readMicros(void);
+    static uint8_t readEeprom(int pAddress);
+    static void writeEeprom(int pAddress, uint8_t pValue);
+
+    static uint8_t readPin(uint8_t pPin);
+    static void writePin(uint8_t pPin, uint8_t pLevel);
+    static void writeAnalog(uint8_t pPin, int pValue);
+    static unsigned long measurePulse(uint8_t pPin, uint8_t pState, unsigned long pTimeout);
+    static void setInterruptHandler(uint8_t pPin, void (*pHandler)(void), int pMode);
+    static void writeSerial(uint8_t pByte);
+    static void notifyOutputChange(void);
+    static int getSerialAvailableForWrite(void)
+    {
+        return board().mSerialAvailableForWrite;
+    }
+
+    // levels of all pins, accessed via portInputRegister()
+    static volatile uint8_t * getPinLevels(void)
+    {
+        return board().mPinLevel;
+    }
+
+    static const Adafruit_NeoPixel * getLastShownStrip(void)
+    {
+        return board().mLastShownStrip;
+    }
+
+    static void setLastShownStrip(const Adafruit_NeoPixel *pStrip)
+    {
+        board().mLastShownStrip = pStrip;
+    }
+
+private:
+    typedef struct
+    {
+        bool active;                 // true if pin is driven by a periodic signal
+        unsigned long width;         // high time of the current period
+        unsigned long pendingWidth;  // high time taken over at the next rising edge
+        unsigned long period;        // period of the signal
+        unsigned long periodStart;   // time of the current period start (rising edge)
+        unsigned long nextEdge;      // time of the next edge
+    } PulseSignal_t;
+
+    typedef struct
+    {
+        void (*handler)(void);
+        int mode;
+    } InterruptHandler_t;
+
+    typedef struct
+    {
+        unsigned long period;        // period of the timer, 0 if stopped
+        unsigned long nextTick;      // time of the next interrupt
+        void (*handler)(void *);
+        void *context;
+    } TimerInterrupt_t;
+
+public:
+    /**
+     * state of a single emulated board: clock, pins, signals, interrupt handlers and serial port. A new board is in
+     * the state after reset.
+     */
+    class Board
+    {
+    public:
+        Board(void);
+
+    private:
+        friend class ArduinoMock;
+
+        // boards hold the complete emulated hardware and must not be copied
+        Board(const Board &);
+        Board & operator=(const Board &);
+
+        void reset(void);
+
+        unsigned long mMicros;
+        unsigned long mMicrosStep;
+        volatile uint8_t mPinLevel[NUM_PINS];
+        PulseSignal_t mSignal[NUM_PINS];
+        InterruptHandler_t mInterruptHandler[NUM_PINS];
+        TimerInterrupt_t mTimer;
+        bool mIsInterruptBlocked;
+        bool mPendingInterrupt[NUM_PINS];
+        void (*mOutputListener)(void *);
+        void *mOutputContext;
+        uint8_t mDigitalOutput[NUM_PINS];
+        int mAnalogOutput[NUM_PINS];
+        std::vector<uint8_t> mSerialOutput;
+        bool mSerialCapture;
+        unsigned long mSerialByteCount;
+        int mSerialAvailableForWrite;
+        const Adafruit_NeoPixel *mLastShownStrip;
+
+        // the EEPROM is not changed by reset
+        uint8_t mEeprom[EEPROM_SIZE];
+        unsigned long mEepromWriteCount;
+    };
+
+private:
+    /**
+     * @return board selected for the calling thread
+     */
+    static Board & board(void)
+    {
+        return sBoard ? *sBoard : sDefaultBoard;
+    }
+
+    static void setLevel(uint8_t pPin, uint8_t pLevel);
+    static void processSignalEdge(uint8_t pPin);
+    static bool advanceToNextEdge(uint8_t pPin, unsigned long pDeadline);
+
+    static thread_local Board *sBoard;
+    static thread_local Board sDefaultBoard;
+};
+
+#endif /* ARDUINOMOCK_H_ */
@@ -0,0 +1,84 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef ARDUINO_MOCK_EEPROM_H_
+#define ARDUINO_MOCK_EEPROM_H_
+
+#include <stdint.h>
+
+#include "ArduinoMock.h"
+
+/**
+ * Replacement of the EEPROM library of the Arduino core for the host.
+ *
+ * The bytes are held by the selected board of the mock (see ArduinoMock::eraseEeprom), so every emulated board has
+ * its own EEPROM, which survives ArduinoMock::reset like a real one survives a power cycle.
+ */
+class EEPROMClass
+{
+public:
+    uint8_t read(int pAddress)
+    {
+        return ArduinoMock::readEeprom(pAddress);
+    }
+
+    void write(int pAddress, uint8_t pValue)
+    {
+        ArduinoMock::writeEeprom(pAddress, pValue);
+    }
+
+    // writes the byte only if it differs, which saves write cycles of the cell
+    void update(int pAddress, uint8_t pValue)
+    {
+        if (read(pAddress) != pValue)
+        {
+            write(pAddress, pValue);
+        }
+    }
+
+    uint16_t length(void)
+    {
+        return ArduinoMock::EEPROM_SIZE;
+    }
+
+    template<typename T> T &get(int pAddress, T &pValue)
+    {
+        uint8_t *bytes = (uint8_t *) &pValue;
+        for (unsigned int i = 0; i < sizeof(T); ++i)
+        {
+            bytes[i] = read(pAddress + i);
+        }
+        return pValue;
+    }
+
+    template<typename T> const T &put(int pAddress, const T &pValue)
+    {
+        const uint8_t *bytes = (const uint8_t *) &pValue;
+        for (unsigned int i = 0; i < sizeof(T); ++i)
+        {
+            update(pAddress + i, bytes[i]);
+        }
+        return pValue;
+    }
+};
+
+static EEPROMClass EEPROM;
+
+#endif /* ARDUINO_MOCK_EEPROM_H_ */
@@ -0,0 +1,78 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include <limits.h>
+
+#include "ArduinoMock.h"
+#include "PulseScript.h"
+
+/**
+ * constructor
+ *
+ * @param pSteps steps ordered by time, the array is not copied
+ * @param pNumSteps number of steps
+ * @param pRepeatPeriod period in milliseconds after which the script starts again, 0 to run it only once
+ */
+PulseScript::PulseScript(const Step_t *pSteps, size_t pNumSteps, unsigned long pRepeatPeriod) :
+        mSteps(pSteps), mNumSteps(pNumSteps), mRepeatPeriod(pRepeatPeriod), mCycleStart(0), mNextStep(0)
+{
+}
+
+/**
+ * starts the script at the current virtual time and applies all steps at time 0
+ */
+void PulseScript::start(void)
+{
+    mCycleStart = ArduinoMock::getMicros();
+    mNextStep = 0;
+    update();
+}
+
+/**
+ * applies all steps, which are due at the current virtual time
+ */
+void PulseScript::update(void)
+{
+    unsigned long now = ArduinoMock::getMicros();
+
+    while (getNextStepMicros() <= now)
+    {
+        const Step_t &step = mSteps[mNextStep];
+        ArduinoMock::setPulseSignal(step.pin, step.width);
+
+        if (++mNextStep >= mNumSteps && 0 < mRepeatPeriod)
+        {
+            mNextStep = 0;
+            mCycleStart += mRepeatPeriod * 1000;
+        }
+    }
+}
+
+/**
+ * @return the virtual time in microseconds of the next step or ULONG_MAX if the script has finished
+ */
+unsigned long PulseScript::getNextStepMicros(void) const
+{
+    if (mNextStep >= mNumSteps)
+    {
+        return ULONG_MAX;
+    }
+    return mCycleStart + mSteps[mNextStep].time * 1000;
+}
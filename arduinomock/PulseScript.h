@@ -0,0 +1,84 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef PULSESCRIPT_H_
+#define PULSESCRIPT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Scripted source of RC pulse widths for the emulated board.
+ *
+ * A script is a list of steps ordered by time. Every step changes the pulse width of one input pin at a time relative
+ * to the start of the script. Optionally the script repeats after a given period, which allows to simulate hours of
+ * driving with a short drive cycle.
+ */
+class PulseScript
+{
+public:
+    /**
+     * single step of a script
+     */
+    typedef struct
+    {
+        unsigned long time;     // time in milliseconds relative to the start of the script (or cycle)
+        uint8_t pin;            // input pin
+        unsigned long width;    // new pulse width in microseconds, 0 means no signal
+    } Step_t;
+
+    /**
+     * constructor
+     *
+     * @param pSteps steps ordered by time, the array is not copied
+     * @param pNumSteps number of steps
+     * @param pRepeatPeriod period in milliseconds after which the script starts again, 0 to run it only once
+     */
+    PulseScript(const Step_t *pSteps, size_t pNumSteps, unsigned long pRepeatPeriod = 0);
+
+    /**
+     * starts the script at the current virtual time and applies all steps at time 0
+     */
+    void start(void);
+
+    /**
+     * applies all steps, which are due at the current virtual time. Has to be called regularly, e.g. before each
+     * loop of the sketch.
+     */
+    void update(void);
+
+    /**
+     * @return the virtual time in microseconds of the next step or ULONG_MAX if the script has finished
+     */
+    unsigned long getNextStepMicros(void) const;
+
+private:
+    const Step_t *mSteps;
+    size_t mNumSteps;
+    unsigned long mRepeatPeriod;
+
+    // start time of the current cycle in microseconds
+    unsigned long mCycleStart;
+
+    // index of the next step
+    size_t mNextStep;
+};
+
+#endif /* PULSESCRIPT_H_ */
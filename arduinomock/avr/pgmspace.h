@@ -0,0 +1,37 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef ARDUINO_MOCK_AVR_PGMSPACE_H_
+#define ARDUINO_MOCK_AVR_PGMSPACE_H_
+
+/**
+ * On the host there is only one address space, data declared as PROGMEM is read directly.
+ */
+
+#include <stdint.h>
+
+#define PROGMEM
+
+#define pgm_read_byte(pAddress)     (*(const uint8_t *) (pAddress))
+#define pgm_read_word(pAddress)     (*(const uint16_t *) (pAddress))
+#define pgm_read_dword(pAddress)    (*(const uint32_t *) (pAddress))
+#define pgm_read_ptr(pAddress)      (*(const void * const *) (pAddress))
+
+#endif /* ARDUINO_MOCK_AVR_PGMSPACE_H_ */
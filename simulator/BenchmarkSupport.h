@@ -0,0 +1,141 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef BENCHMARKSUPPORT_H_
+#define BENCHMARKSUPPORT_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @return time stamp counter of the CPU or 0 if not available
+ */
+inline unsigned long long readCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * reads a whole file
+ *
+ * @return false if the file can not be read
+ */
+inline bool readFile(const char *pFileName, std::vector<uint8_t> &pData)
+{
+    FILE *file = fopen(pFileName, "rb");
+    if (!file)
+    {
+        perror(pFileName);
+        return false;
+    }
+
+    uint8_t buffer[4096];
+    size_t size;
+    while (0 < (size = fread(buffer, 1, sizeof(buffer), file)))
+    {
+        pData.insert(pData.end(), buffer, buffer + size);
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * result of a measurement
+ */
+typedef struct
+{
+    double seconds;
+    unsigned long long cycles;
+    unsigned long checksum;
+} Measurement_t;
+
+/**
+ * Takes the wall time and the time stamp counter of the CPU from its construction up to stop.
+ */
+class Stopwatch
+{
+public:
+    Stopwatch(void) :
+            mBegin(std::chrono::steady_clock::now()), mCycles(readCycles())
+    {
+    }
+
+    /**
+     * stores the elapsed time in the members seconds and cycles of a measurement
+     */
+    template<typename TMeasurement>
+    void stop(TMeasurement &pResult) const
+    {
+        pResult.cycles = readCycles() - mCycles;
+        pResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mBegin).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point mBegin;
+    unsigned long long mCycles;
+};
+
+/**
+ * runs a measurement several times
+ *
+ * @param pRepetitions number of runs
+ * @param pMeasure function object returning a measurement with the member seconds
+ * @return fastest measurement
+ */
+template<typename TMeasure>
+inline auto measureBest(int pRepetitions, TMeasure pMeasure) -> decltype(pMeasure())
+{
+    decltype(pMeasure()) best = pMeasure();
+    for (int i = 1; i < pRepetitions; ++i)
+    {
+        decltype(pMeasure()) result = pMeasure();
+        if (result.seconds < best.seconds)
+        {
+            best = result;
+        }
+    }
+    return best;
+}
+
+/**
+ * prints the time and cycles per unit of a measurement
+ *
+ * @param pName name of the measurement
+ * @param pUnit unit measured, e.g. "frame"
+ * @param pResult measurement
+ * @param pCount number of units measured
+ */
+inline void printMeasurement(const char *pName, const char *pUnit, const Measurement_t &pResult, unsigned long pCount)
+{
+    printf("%-18s: %.1f ns/%s, %.0f cycles/%s (checksum %lu)\n", pName, pResult.seconds * 1e9 / pCount, pUnit,
+           (double) pResult.cycles / pCount, pUnit, pResult.checksum);
+}
+
+#endif /* BENCHMARKSUPPORT_H_ */
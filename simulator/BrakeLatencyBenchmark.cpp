@@ -0,0 +1,455 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host benchmark of the brake light latency of the acceleration estimators.
+ *
+ * Drives RemoteControlCarAdapter through releases of the throttle from different levels with different ramp
+ * durations and at different phases. After every refresh the acceleration of the adapter (sliding window, see
+ * SlopeEstimator) and of a reference of the former estimator (difference of two samples every 200 msec) is compared
+ * with the brake threshold of RcCarLights. Reports the latency from the start of the release to the first brake
+ * detection and the extra detections, i.e. brakes detected while the throttle is held with jitter or detected again
+ * within the same release. The former estimator misses a release, if the throttle is back in neutral before its
+ * next measurement.
+ *
+ * With a recorded trace (see RcTraceReplay) the brake detections of both estimators within the trace are counted and
+ * the average time by which the sliding window detects a brake earlier.
+ *
+ * Usage: BrakeLatencyBenchmark [-w <window in msec>] [<trace file>]
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include "Arduino.h"
+#include "BenchmarkSupport.h"
+#include "RcTraceReplaySource.h"
+
+#include "../RemoteControlCarAdapter.h"
+
+// acceleration threshold for brake lights as in RcCarLights
+static const long BREAK_ACCELERATION_LEVEL = VehicleConfig::BREAK_ACCELERATION_LEVEL;
+
+// throttle in neutral position
+static const long NEUTRAL = 1500;
+
+// time in msec between two frames of the receiver
+static const unsigned long FRAME_PERIOD = 20;
+
+// the pulse capture reads the inputs once per pulse, i.e. 3 times per frame
+static const unsigned long READS_PER_FRAME = 3;
+
+// maximum jitter in usec of every pulse
+static const long JITTER = 4;
+
+// time in msec from the start of a scenario until the throttle is pressed, covers the calibration
+static const unsigned long PRESS_TIME = 1000;
+
+// a release, which is not detected within this time in msec, counts as missed
+static const unsigned long MAX_LATENCY = 1000;
+
+// longest time in msec between two brake detections of the estimators, which belong to the same release
+static const unsigned long MAX_DETECTION_OFFSET = 400;
+
+/**
+ * Former estimator of RemoteControlCarAdapter: the difference of two throttle values, measured every 200 msec.
+ */
+class IntervalAccelerationReference
+{
+public:
+    IntervalAccelerationReference(void) :
+            mAcceleration(0), mPreviousValue(0), mLastTimestamp(0), misStarted(false)
+    {
+    }
+
+    void refresh(unsigned long pTimestamp, long pValue, int pFactor)
+    {
+        if (!misStarted)
+        {
+            misStarted = true;
+            mPreviousValue = pValue;
+            mLastTimestamp = pTimestamp;
+        }
+        else if (ACCELERATION_MEASURE_INTERVAL < pTimestamp - mLastTimestamp)
+        {
+            mAcceleration = (mPreviousValue - pValue) * pFactor;
+            mPreviousValue = pValue;
+            mLastTimestamp = pTimestamp;
+        }
+    }
+
+    long getAcceleration(void) const
+    {
+        return mAcceleration;
+    }
+
+private:
+    static const unsigned long ACCELERATION_MEASURE_INTERVAL = 200;
+
+    long mAcceleration;
+    long mPreviousValue;
+    unsigned long mLastTimestamp;
+    bool misStarted;
+};
+
+/**
+ * Release of the throttle: the throttle is pressed to a level, held and released to neutral with a linear ramp. Every
+ * frame of the receiver gets a new jitter and is read READS_PER_FRAME times.
+ */
+class ReleaseSource: public RcInputSource
+{
+public:
+    ReleaseSource(long pLevel, unsigned long pReleaseTime, unsigned long pRampDuration, unsigned long pSeed) :
+            mLevel(pLevel), mReleaseTime(pReleaseTime), mRampDuration(pRampDuration), mReads(0), mRandom(pSeed),
+            mFrame(ULONG_MAX), mJitter(0)
+    {
+    }
+
+    unsigned long getTimestamp(void) const
+    {
+        return mReads / READS_PER_FRAME * FRAME_PERIOD + mReads % READS_PER_FRAME * 2;
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        unsigned long timestamp = getTimestamp();
+        if (timestamp / FRAME_PERIOD != mFrame)
+        {
+            mFrame = timestamp / FRAME_PERIOD;
+            mRandom = mRandom * 6364136223846793005ULL + 1442695040888963407ULL;
+            mJitter = (long) ((mRandom >> 33) % (2 * JITTER + 1)) - JITTER;
+        }
+
+        long throttle = NEUTRAL;
+        if (PRESS_TIME <= timestamp && timestamp < mReleaseTime)
+        {
+            throttle = mLevel;
+        }
+        else if (mReleaseTime <= timestamp && timestamp < mReleaseTime + mRampDuration)
+        {
+            throttle = mLevel + (NEUTRAL - mLevel) * (long) (timestamp - mReleaseTime) / (long) mRampDuration;
+        }
+
+        pThrottle = throttle + mJitter;
+        pSteering = NEUTRAL;
+        p3rdChannel = 1900;
+        ++mReads;
+        return timestamp;
+    }
+
+private:
+    long mLevel;
+    unsigned long mReleaseTime;
+    unsigned long mRampDuration;
+    unsigned long mReads;
+    unsigned long long mRandom;
+    unsigned long mFrame;
+    long mJitter;
+};
+
+/**
+ * Passes the reads of another source and keeps the timestamp of the last read.
+ */
+class TimestampSource: public RcInputSource
+{
+public:
+    TimestampSource(RcInputSource &pSource) :
+            mSource(pSource), mTimestamp(0)
+    {
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        mTimestamp = mSource.read(pThrottle, pSteering, p3rdChannel);
+        return mTimestamp;
+    }
+
+    unsigned long getTimestamp(void) const
+    {
+        return mTimestamp;
+    }
+
+private:
+    RcInputSource &mSource;
+    unsigned long mTimestamp;
+};
+
+/**
+ * returns a factor to correct the algebraic sign of the acceleration as RemoteControlCarAdapter does
+ */
+static int getAccelerationFactor(RemoteControlCarAdapter::Throttle_t pThrottle)
+{
+    if ((VehicleConfig::IS_THROTTLE_REVERSE ? RemoteControlCarAdapter::BACKWARD : RemoteControlCarAdapter::FORWARD)
+            == pThrottle)
+    {
+        return 1;
+    }
+    return ((VehicleConfig::IS_THROTTLE_REVERSE ? RemoteControlCarAdapter::FORWARD : RemoteControlCarAdapter::BACKWARD)
+            == pThrottle) ? -1 : 0;
+}
+
+/**
+ * brake detections of both estimators
+ */
+typedef struct
+{
+    std::vector<unsigned long> window;      // timestamps of the detections of the sliding window
+    std::vector<unsigned long> interval;    // timestamps of the detections of the former estimator
+} Detections_t;
+
+/**
+ * refreshes the adapter until the source ends and records the timestamps, at which the estimators start detecting
+ * a brake
+ */
+template<typename Source_t, typename HasNext_t>
+static Detections_t detectBrakes(Source_t &pSource, HasNext_t pHasNext, unsigned long pWindow)
+{
+    Detections_t detections;
+
+    ArduinoMock::reset();
+    TimestampSource source(pSource);
+    RemoteControlCarAdapter adapter;
+    adapter.setInputSource(&source);
+    adapter.setAccelerationWindow(pWindow);
+    adapter.setupPins();
+    adapter.refresh();
+
+    IntervalAccelerationReference reference;
+    bool isWindowBraking = false;
+    bool isIntervalBraking = false;
+    unsigned long timestamp = 0;
+
+    while (pHasNext(timestamp))
+    {
+        // the former estimator used the throttle of the previous refresh for the sign, like the adapter does
+        int factor = getAccelerationFactor(adapter.getThrottle());
+        adapter.refresh();
+        timestamp = source.getTimestamp();
+        reference.refresh(timestamp, adapter.getThrottleValue(), factor);
+
+        bool isBraking = BREAK_ACCELERATION_LEVEL > adapter.getAcceleration();
+        if (isBraking && !isWindowBraking)
+        {
+            detections.window.push_back(timestamp);
+        }
+        isWindowBraking = isBraking;
+
+        isBraking = BREAK_ACCELERATION_LEVEL > reference.getAcceleration();
+        if (isBraking && !isIntervalBraking)
+        {
+            detections.interval.push_back(timestamp);
+        }
+        isIntervalBraking = isBraking;
+    }
+    return detections;
+}
+
+/**
+ * latencies and extra detections of an estimator over all releases
+ */
+typedef struct
+{
+    unsigned long releases;
+    unsigned long missed;
+    unsigned long extraDetections;
+    unsigned long sumLatency;
+    unsigned long maxLatency;
+} Latency_t;
+
+/**
+ * adds the detections of a release to the latencies of an estimator
+ */
+static void addRelease(Latency_t &pLatency, const std::vector<unsigned long> &pDetections, unsigned long pReleaseTime)
+{
+    bool isDetected = false;
+    ++pLatency.releases;
+    for (size_t i = 0; i < pDetections.size(); ++i)
+    {
+        if (pDetections[i] < pReleaseTime || isDetected || pReleaseTime + MAX_LATENCY < pDetections[i])
+        {
+            ++pLatency.extraDetections;
+        }
+        else
+        {
+            isDetected = true;
+            unsigned long latency = pDetections[i] - pReleaseTime;
+            pLatency.sumLatency += latency;
+            pLatency.maxLatency = std::max(pLatency.maxLatency, latency);
+        }
+    }
+    pLatency.missed += !isDetected;
+}
+
+static void printLatency(const char *pName, const Latency_t &pLatency)
+{
+    unsigned long detected = pLatency.releases - pLatency.missed;
+    printf("%-18s: %5.1f ms mean, %3lu ms max, %lu of %lu missed, %lu extra\n", pName,
+           detected ? pLatency.sumLatency / (double) detected : 0.0, pLatency.maxLatency, pLatency.missed,
+           pLatency.releases, pLatency.extraDetections);
+}
+
+/**
+ * hasNext of a release scenario
+ */
+class ReleaseEnd
+{
+public:
+    ReleaseEnd(unsigned long pEnd) :
+            mEnd(pEnd)
+    {
+    }
+
+    bool operator()(unsigned long pTimestamp) const
+    {
+        return pTimestamp < mEnd;
+    }
+
+private:
+    unsigned long mEnd;
+};
+
+/**
+ * hasNext of a trace
+ */
+class TraceEnd
+{
+public:
+    TraceEnd(const RcTraceReplaySource &pSource) :
+            mSource(pSource)
+    {
+    }
+
+    bool operator()(unsigned long) const
+    {
+        return mSource.hasNext();
+    }
+
+private:
+    const RcTraceReplaySource &mSource;
+};
+
+/**
+ * compares the brake detections of both estimators within a recorded trace
+ */
+static int compareTrace(const char *pFileName, unsigned long pWindow)
+{
+    std::vector<uint8_t> trace;
+    if (!readFile(pFileName, trace))
+    {
+        return 1;
+    }
+    RcTraceReplaySource source(trace);
+    if (!source.isValid())
+    {
+        fprintf(stderr, "%s: not an RC trace\n", pFileName);
+        return 1;
+    }
+
+    Detections_t detections = detectBrakes(source, TraceEnd(source), pWindow);
+
+    // every detection of the former estimator is paired with the latest detection of the sliding window before it
+    unsigned long pairs = 0;
+    unsigned long sumLead = 0;
+    size_t window = 0;
+    for (size_t i = 0; i < detections.interval.size(); ++i)
+    {
+        while (window + 1 < detections.window.size() && detections.window[window + 1] <= detections.interval[i])
+        {
+            ++window;
+        }
+        if (window < detections.window.size() && detections.window[window] <= detections.interval[i]
+                && detections.interval[i] - detections.window[window] <= MAX_DETECTION_OFFSET)
+        {
+            ++pairs;
+            sumLead += detections.interval[i] - detections.window[window];
+        }
+    }
+
+    printf("trace             : %s, %lu records\n", pFileName, source.getRecords());
+    printf("brakes window     : %lu\n", (unsigned long) detections.window.size());
+    printf("brakes interval   : %lu\n", (unsigned long) detections.interval.size());
+    printf("earlier by        : %.1f ms mean over %lu common brakes\n", pairs ? sumLead / (double) pairs : 0.0, pairs);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long window = SlopeEstimator::DEFAULT_WINDOW;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "w:")))
+    {
+        switch (option)
+        {
+            case 'w':
+                window = atol(optarg);
+                break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+
+    if (optind + 1 < argc)
+    {
+        fprintf(stderr, "usage: %s [-w <window in msec>] [<trace file>]\n", argv[0]);
+        return 1;
+    }
+
+    printf("window            : %lu ms\n", window);
+    if (optind < argc)
+    {
+        return compareTrace(argv[optind], window);
+    }
+
+    static const long LEVELS[] = { 1150, 1300, 1400, 1600, 1700, 1850 };
+    static const unsigned long RAMPS[] = { 0, 50, 100, 200 };
+    static const unsigned long PHASES = 20;
+
+    Latency_t windowLatency = { 0, 0, 0, 0, 0 };
+    Latency_t intervalLatency = { 0, 0, 0, 0, 0 };
+    unsigned long seed = 1;
+
+    for (size_t level = 0; level < sizeof(LEVELS) / sizeof(LEVELS[0]); ++level)
+    {
+        for (size_t ramp = 0; ramp < sizeof(RAMPS) / sizeof(RAMPS[0]); ++ramp)
+        {
+            for (unsigned long phase = 0; phase < PHASES; ++phase)
+            {
+                // the throttle is held 2 sec plus a phase, which moves the release over the frames and the 200 msec
+                // of the former estimator
+                unsigned long releaseTime = PRESS_TIME + 2000 + phase * 11;
+                ReleaseSource source(LEVELS[level], releaseTime, RAMPS[ramp], seed++);
+                Detections_t detections = detectBrakes(source, ReleaseEnd(releaseTime + 2000), window);
+
+                addRelease(windowLatency, detections.window, releaseTime);
+                addRelease(intervalLatency, detections.interval, releaseTime);
+            }
+        }
+    }
+
+    printLatency("sliding window", windowLatency);
+    printLatency("200 ms interval", intervalLatency);
+    return 0;
+}
@@ -0,0 +1,288 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * End-to-end latency of the light controller from a movement of the sticks to the matching change of the NeoPixels.
+ *
+ * Every scenario runs the complete sketch (RcCarLights) on the arduino mock. After a preparation, e.g. driving
+ * forward, the pulse width of a channel steps at a precise virtual time. From trial to trial the step moves over the RC
+ * period and the receiver signal over the frame period, both by random phases from a seeded sequence of every
+ * scenario, so the end of the first pulse with the new width meets the frames at any phase. The output listener of
+ * the mock catches the show of the strip, which changes the observed pixel, and the latency is taken from the step and
+ * from the end of the first pulse with the new width (the first moment the board can know about the step).
+ *
+ * Scenarios:
+ * - brake: forward, throttle to neutral, back light turns to brake light
+ * - reverse: standing, throttle to backward, back-up light on
+ * - blinker: standing, steering right, front blinker on
+ *
+ * With -g the benchmark is a gate: it fails with exit code 2 if the maximum latency from the step of any scenario
+ * exceeds its budget.
+ *
+ * Usage: LatencyBenchmark [-n <trials per scenario>] [-l <loop duration in usec>] [-g]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include "Arduino.h"
+#include "Adafruit_NeoPixel.h"
+
+#include "../RcCarLights.h"
+
+// neutral position of throttle and steering and the 3rd channel in off position
+static const unsigned long NEUTRAL = 1500;
+static const unsigned long CHANNEL_3_OFF = 1900;
+
+// time in msec from setup until the step, long enough for every light rule delay
+static const unsigned long PREPARATION_TIME = 3000;
+
+// time in msec after the step, after which the pixel change counts as missed
+static const unsigned long MAX_WAIT = 2000;
+
+// seed of the random phases of the first scenario, the next scenarios take the following seeds
+static const unsigned long PHASE_SEED = 12345;
+
+/**
+ * a scenario: the pulse widths during the preparation, the step and the pixel observed
+ */
+typedef struct
+{
+    const char *name;
+    unsigned long throttle;                                 // throttle during the preparation
+    unsigned long steering;                                 // steering during the preparation
+    int stepPin;                                            // pin of the step
+    unsigned long stepWidth;                                // pulse width after the step
+    CamaroRcCarLightController::NeoPixelPosition_t pixel;   // observed pixel
+    unsigned long budget;                                   // maximum latency in usec from the step (-g)
+} Scenario_t;
+
+static const Scenario_t sScenarios[] =
+{
+    { "brake", 1800, NEUTRAL, 7, NEUTRAL, CamaroRcCarLightController::BACK_LIGHT_ONE_LEFT_PIXEL, 50000 },
+    { "reverse", NEUTRAL, NEUTRAL, 7, 1200, CamaroRcCarLightController::BACKUP_LIGHT_LEFT_PIXEL, 50000 },
+    { "blinker", NEUTRAL, NEUTRAL, 8, 1300, CamaroRcCarLightController::BLINKER_FRONT_RIGHT_PIXEL, 50000 }
+};
+
+/**
+ * observation of a pixel by the output listener
+ */
+typedef struct
+{
+    uint16_t pixel;
+    uint32_t color;             // color before the step
+    bool isStepped;             // true after the step
+    unsigned long changeMicros; // time of the first show with another color after the step, 0 if none yet
+} Observation_t;
+
+/**
+ * output listener, catches the first show after the step, which changes the observed pixel
+ *
+ * @param pContext Observation_t to update
+ */
+static void observePixel(void *pContext)
+{
+    Observation_t &observation = *static_cast<Observation_t *>(pContext);
+    const Adafruit_NeoPixel *strip = Adafruit_NeoPixel::getLastShownStrip();
+
+    if (observation.isStepped && 0 == observation.changeMicros && strip
+            && strip->getShownPixelColor(observation.pixel) != observation.color)
+    {
+        observation.changeMicros = ArduinoMock::getMicros();
+    }
+}
+
+/**
+ * latencies of a trial in usec
+ */
+typedef struct
+{
+    bool isMissed;
+    unsigned long fromStep;
+    unsigned long fromPulse;
+} Latency_t;
+
+/**
+ * @return next value of a simple deterministic random generator
+ *
+ * @param pState state of the generator
+ */
+static unsigned long nextRandom(unsigned long &pState)
+{
+    pState = pState * 1103515245UL + 12345UL;
+    return (pState >> 16) & 0x7FFF;
+}
+
+/**
+ * runs a trial of a scenario on a new board
+ *
+ * @param pStepPhase offset of the step in usec
+ * @param pSignalPhase offset of the receiver signal to the frame clock in usec
+ */
+static Latency_t runTrial(const Scenario_t &pScenario, unsigned long pStepPhase, unsigned long pSignalPhase,
+                          unsigned long pLoopMicros)
+{
+    ArduinoMock::reset();
+
+    // all signals start at pSignalPhase, so their periods start at pSignalPhase plus multiples of RC_SIGNAL_PERIOD
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_THROTTLE, NEUTRAL, ArduinoMock::RC_SIGNAL_PERIOD, pSignalPhase);
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_STEERING, NEUTRAL, ArduinoMock::RC_SIGNAL_PERIOD, pSignalPhase);
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_3RD_CHANNEL, CHANNEL_3_OFF, ArduinoMock::RC_SIGNAL_PERIOD,
+                                pSignalPhase);
+
+    RcCarLights rcCarLights;
+    rcCarLights.setup();
+
+    // the first loop calibrates the neutral positions, the preparation starts afterwards
+    rcCarLights.loop();
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_THROTTLE, pScenario.throttle);
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_STEERING, pScenario.steering);
+
+    Observation_t observation = { (uint16_t) pScenario.pixel, 0, false, 0 };
+    ArduinoMock::setOutputListener(observePixel, &observation);
+
+    unsigned long stepMicros = ArduinoMock::getMicros() + PREPARATION_TIME * 1000 + pStepPhase;
+    unsigned long endMicros = stepMicros + MAX_WAIT * 1000;
+
+    while (0 == observation.changeMicros && ArduinoMock::getMicros() < endMicros)
+    {
+        rcCarLights.loop();
+
+        unsigned long nextMicros = ArduinoMock::getMicros() + pLoopMicros;
+        if (!observation.isStepped && stepMicros <= nextMicros)
+        {
+            ArduinoMock::advanceTo(stepMicros);
+            const Adafruit_NeoPixel *strip = Adafruit_NeoPixel::getLastShownStrip();
+            observation.color = strip ? strip->getShownPixelColor(pScenario.pixel) : 0;
+            observation.isStepped = true;
+            ArduinoMock::setPulseSignal(pScenario.stepPin, pScenario.stepWidth);
+        }
+        ArduinoMock::advanceTo(nextMicros);
+    }
+    ArduinoMock::setOutputListener(NULL, NULL);
+
+    // the receiver takes over the new width with its next period
+    unsigned long period = ArduinoMock::RC_SIGNAL_PERIOD;
+    unsigned long pulseEndMicros = (stepMicros - pSignalPhase + period - 1) / period * period + pSignalPhase
+            + pScenario.stepWidth;
+
+    Latency_t latency = { 0 == observation.changeMicros, 0, 0 };
+    if (!latency.isMissed)
+    {
+        latency.fromStep = observation.changeMicros - stepMicros;
+        latency.fromPulse = (observation.changeMicros > pulseEndMicros) ? observation.changeMicros - pulseEndMicros : 0;
+    }
+    return latency;
+}
+
+/**
+ * @return percentile of sorted values
+ */
+static unsigned long getPercentile(const std::vector<unsigned long> &pSorted, unsigned int pPercent)
+{
+    return pSorted.empty() ? 0 : pSorted[(pSorted.size() - 1) * pPercent / 100];
+}
+
+/**
+ * prints min, median, 90th, 99th percentile and max in msec
+ */
+static void printDistribution(const char *pName, std::vector<unsigned long> &pValues)
+{
+    std::sort(pValues.begin(), pValues.end());
+    printf("  %-16s: min %5.1f  p50 %5.1f  p90 %5.1f  p99 %5.1f  max %5.1f ms\n", pName,
+           getPercentile(pValues, 0) / 1000.0, getPercentile(pValues, 50) / 1000.0,
+           getPercentile(pValues, 90) / 1000.0, getPercentile(pValues, 99) / 1000.0,
+           getPercentile(pValues, 100) / 1000.0);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long trials = 200;
+    unsigned long loopMicros = 1000;
+    bool isGate = false;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "n:l:g")))
+    {
+        switch (option)
+        {
+            case 'n':
+                trials = strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                loopMicros = strtoul(optarg, NULL, 10);
+                break;
+            case 'g':
+                isGate = true;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n <trials per scenario>] [-l <loop duration in usec>] [-g]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    bool isPassed = true;
+    printf("trials/scenario   : %lu\n", trials);
+    printf("loop duration     : %lu usec\n", loopMicros);
+
+    for (size_t i = 0; i < sizeof(sScenarios) / sizeof(sScenarios[0]); ++i)
+    {
+        const Scenario_t &scenario = sScenarios[i];
+        std::vector<unsigned long> fromStep;
+        std::vector<unsigned long> fromPulse;
+        unsigned long missed = 0;
+        unsigned long random = PHASE_SEED + i;
+
+        for (unsigned long trial = 0; trial < trials; ++trial)
+        {
+            unsigned long stepPhase = 1 + nextRandom(random) % ArduinoMock::RC_SIGNAL_PERIOD;
+            unsigned long signalPhase = nextRandom(random) % FrameClock::FRAME_PERIOD;
+            Latency_t latency = runTrial(scenario, stepPhase, signalPhase, loopMicros);
+            if (latency.isMissed)
+            {
+                ++missed;
+            }
+            else
+            {
+                fromStep.push_back(latency.fromStep);
+                fromPulse.push_back(latency.fromPulse);
+            }
+        }
+
+        printf("%-18s: %lu missed, budget %.1f ms\n", scenario.name, missed, scenario.budget / 1000.0);
+        printDistribution("from step", fromStep);
+        printDistribution("from pulse", fromPulse);
+
+        if (missed || (!fromStep.empty() && fromStep.back() > scenario.budget))
+        {
+            isPassed = false;
+        }
+    }
+
+    if (isGate)
+    {
+        printf("gate              : %s\n", isPassed ? "passed" : "FAILED");
+        return isPassed ? 0 : 2;
+    }
+    return 0;
+}
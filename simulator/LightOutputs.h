@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef LIGHTOUTPUTS_H_
+#define LIGHTOUTPUTS_H_
+
+#include "Arduino.h"
+#include "Adafruit_NeoPixel.h"
+
+#include "../RcCarLights.h"
+
+/**
+ * calculates a hash of the current output pins of the vehicle configuration of the selected board, which are set by
+ * the frames
+ */
+inline uint32_t hashPinOutputs(void)
+{
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ ArduinoMock::getDigitalOutput(VehicleConfig::PIN_PARKING_LIGHT)) * 16777619u;
+    hash = (hash ^ ArduinoMock::getDigitalOutput(VehicleConfig::PIN_HEADLIGHT)) * 16777619u;
+    hash = (hash ^ (uint32_t) ArduinoMock::getAnalogOutput(VehicleConfig::PIN_HEADLIGHT)) * 16777619u;
+    return hash;
+}
+
+/**
+ * calculates a hash of the current light outputs of the selected board (pins of the vehicle configuration and
+ * NeoPixels as sent by the last show)
+ */
+inline uint32_t hashLightOutputs(void)
+{
+    uint32_t hash = hashPinOutputs();
+
+    const Adafruit_NeoPixel *strip = Adafruit_NeoPixel::getLastShownStrip();
+    if (strip)
+    {
+        for (uint16_t i = 0; i < strip->numPixels(); ++i)
+        {
+            hash = (hash ^ strip->getShownPixelColor(i)) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+#endif /* LIGHTOUTPUTS_H_ */
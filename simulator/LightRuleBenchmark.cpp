@@ -0,0 +1,421 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host benchmark of the light rules.
+ *
+ * Runs the light rule table of RcCarLights and the former handle* methods (reproduced below) over the same
+ * pseudo random sequence of RC inputs, checks that both produce the same light status and reports the time per
+ * update and, on x86, the TSC cycles per update. The former methods query the adapter and millis() in every method, the rule engine works on a single
+ * input snapshot.
+ *
+ * Usage: LightRuleBenchmark [<number of updates>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "BenchmarkSupport.h"
+
+#include "../RcCarLights.h"
+
+// virtual time in msec between two updates
+static const unsigned long UPDATE_INTERVAL = 1;
+
+// number of repetitions of every measurement
+static const int REPETITIONS = 5;
+
+/**
+ * RC inputs of a single update
+ */
+typedef struct
+{
+    RemoteControlCarAdapter::Throttle_t throttle;
+    RemoteControlCarAdapter::Throttle_t throttleSwitch;
+    RemoteControlCarAdapter::Steering_t steering;
+    unsigned long durationOfThrottleSwitch;
+    short acceleration;
+    bool isLightSwitchOn;
+} InputSample_t;
+
+/**
+ * stands in for RemoteControlCarAdapter with the same inline getters
+ */
+class SampleAdapter
+{
+public:
+    inline RemoteControlCarAdapter::Throttle_t getThrottle(void)
+    {
+        return mSample->throttle;
+    }
+    inline RemoteControlCarAdapter::Throttle_t getThrottleSwitch(void)
+    {
+        return mSample->throttleSwitch;
+    }
+    inline unsigned long getDurationOfThrottleSwitch(void)
+    {
+        return mSample->durationOfThrottleSwitch;
+    }
+    inline RemoteControlCarAdapter::Steering_t getSteering(void)
+    {
+        return mSample->steering;
+    }
+    inline short getAcceleration(void)
+    {
+        return mSample->acceleration;
+    }
+
+    const InputSample_t *mSample;
+};
+
+/**
+ * the handle* methods of RcCarLights before the light rules, unchanged apart from the adapter and light switch
+ */
+class FormerLightLogic
+{
+public:
+    FormerLightLogic() :
+            mBrakeLightsOnTimestamp(0), mLastBlinkTimestamp(0), misBlinkingOn(false)
+    {
+        memset(&mLightStatus, 0, sizeof(mLightStatus));
+    }
+
+    void updateLightStatus()
+    {
+        handleLightSwitch();
+        handleHeadlight();
+        handleBackUpLights();
+        handleBrakeLights();
+        handleBlinkerSwitch();
+        doBlinking();
+    }
+
+    SampleAdapter mRemoteControlCarAdapter;
+    AbstractRcCarLightController::CarLightsStatus_t mLightStatus;
+
+private:
+    static const unsigned long DIM_HEADLIGHTS_TO_PARKING_DELAY = 1500;
+    static const long BLINKING_DURATION = 600;
+    static const unsigned long BLINKING_ON_DELAY = 300;
+    static const unsigned long BREAK_LIGHTS_OFF_DELAY = 200;
+    static const long BREAK_LIGHTS_OFF_STAND_STILL_DELAY = 1800;
+    static const long BREAK_ACCELERATION_LEVEL = -20;
+
+    void handleLightSwitch()
+    {
+        mLightStatus.parkingLight = mRemoteControlCarAdapter.mSample->isLightSwitchOn ? 1 : 0;
+    }
+
+    void handleHeadlight()
+    {
+        if (mLightStatus.parkingLight)
+        {
+            if (RemoteControlCarAdapter::FORWARD != mRemoteControlCarAdapter.getThrottleSwitch())
+            {
+                if (RemoteControlCarAdapter::STOP != mRemoteControlCarAdapter.getThrottle())
+                {
+                    mLightStatus.headlight = 1;
+                }
+                else
+                {
+                    if (DIM_HEADLIGHTS_TO_PARKING_DELAY < mRemoteControlCarAdapter.getDurationOfThrottleSwitch())
+                    {
+                        mLightStatus.headlight = 0;
+                    }
+                }
+            }
+        }
+        else
+        {
+            mLightStatus.headlight = 0;
+        }
+    }
+
+    void handleBrakeLights()
+    {
+        if (BREAK_ACCELERATION_LEVEL > mRemoteControlCarAdapter.getAcceleration())
+        {
+            mLightStatus.brakeLight = 1;
+            mBrakeLightsOnTimestamp = millis();
+        }
+        else
+        {
+            if (RemoteControlCarAdapter::STOP == mRemoteControlCarAdapter.getThrottle())
+            {
+                if (mLightStatus.brakeLight
+                        && (BREAK_LIGHTS_OFF_STAND_STILL_DELAY < millis() - mBrakeLightsOnTimestamp))
+                {
+                    mLightStatus.brakeLight = 0;
+                }
+            }
+            else
+            {
+                if (mLightStatus.brakeLight && (BREAK_LIGHTS_OFF_DELAY < millis() - mBrakeLightsOnTimestamp))
+                {
+                    mLightStatus.brakeLight = 0;
+                }
+            }
+        }
+    }
+
+    void handleBackUpLights()
+    {
+        mLightStatus.backUpLight = (RemoteControlCarAdapter::BACKWARD == mRemoteControlCarAdapter.getThrottle());
+    }
+
+    void handleBlinkerSwitch()
+    {
+        if (RemoteControlCarAdapter::NEUTRAL == mRemoteControlCarAdapter.getSteering())
+        {
+            misBlinkingOn = false;
+            mLightStatus.leftBlinker = false;
+            mLightStatus.rightBlinker = false;
+        }
+        else
+        {
+            if ((RemoteControlCarAdapter::STOP == mRemoteControlCarAdapter.getThrottle())
+                    && (BLINKING_ON_DELAY < mRemoteControlCarAdapter.getDurationOfThrottleSwitch()))
+            {
+                misBlinkingOn = true;
+            }
+        }
+    }
+
+    void doBlinking()
+    {
+        if (misBlinkingOn)
+        {
+            if (RemoteControlCarAdapter::LEFT == mRemoteControlCarAdapter.getSteering())
+            {
+                mLightStatus.rightBlinker = false;
+                if ((BLINKING_DURATION < millis() - mLastBlinkTimestamp))
+                {
+                    mLightStatus.leftBlinker ^= 1;
+                    mLastBlinkTimestamp = millis();
+                }
+            }
+            else if (RemoteControlCarAdapter::RIGHT == mRemoteControlCarAdapter.getSteering())
+            {
+                mLightStatus.leftBlinker = false;
+                if (BLINKING_DURATION < millis() - mLastBlinkTimestamp)
+                {
+                    mLightStatus.rightBlinker ^= 1;
+                    mLastBlinkTimestamp = millis();
+                }
+            }
+        }
+    }
+
+    long mBrakeLightsOnTimestamp;
+    long mLastBlinkTimestamp;
+    bool misBlinkingOn;
+};
+
+/**
+ * the light rules of RcCarLights with the input snapshot collected like RcCarLights::updateLightStatus() does
+ */
+class RuleLightLogic
+{
+public:
+    RuleLightLogic()
+    {
+        memset(&mLightStatus, 0, sizeof(mLightStatus));
+    }
+
+    void updateLightStatus()
+    {
+        LightRuleInputs_t inputs;
+
+        inputs.throttle = mRemoteControlCarAdapter.getThrottle();
+        inputs.throttleSwitch = mRemoteControlCarAdapter.getThrottleSwitch();
+        inputs.steering = mRemoteControlCarAdapter.getSteering();
+        inputs.durationOfThrottleSwitch = mRemoteControlCarAdapter.getDurationOfThrottleSwitch();
+        inputs.acceleration = mRemoteControlCarAdapter.getAcceleration();
+        inputs.isLightSwitchOn = mRemoteControlCarAdapter.mSample->isLightSwitchOn;
+        inputs.isFailsafe = false;
+        inputs.now = millis();
+
+        mLightRules.update(mLightStatus, inputs);
+    }
+
+    SampleAdapter mRemoteControlCarAdapter;
+    AbstractRcCarLightController::CarLightsStatus_t mLightStatus;
+
+private:
+    RcCarLights::LightRules_t mLightRules;
+};
+
+/**
+ * creates a pseudo random drive: throttle, steering and light switch change every few hundred msec
+ */
+static void createSamples(std::vector<InputSample_t> &pSamples, unsigned long pCount)
+{
+    static const RemoteControlCarAdapter::Throttle_t sThrottles[] = { RemoteControlCarAdapter::FORWARD,
+            RemoteControlCarAdapter::STOP, RemoteControlCarAdapter::BACKWARD, RemoteControlCarAdapter::STOP };
+    static const RemoteControlCarAdapter::Steering_t sSteerings[] = { RemoteControlCarAdapter::NEUTRAL,
+            RemoteControlCarAdapter::LEFT, RemoteControlCarAdapter::NEUTRAL, RemoteControlCarAdapter::RIGHT };
+
+    uint32_t random = 12345;
+    InputSample_t sample;
+    sample.throttle = RemoteControlCarAdapter::STOP;
+    sample.throttleSwitch = RemoteControlCarAdapter::STOP;
+    sample.steering = RemoteControlCarAdapter::NEUTRAL;
+    sample.durationOfThrottleSwitch = 0;
+    sample.acceleration = 0;
+    sample.isLightSwitchOn = true;
+
+    pSamples.resize(pCount);
+    for (unsigned long i = 0; i < pCount; ++i)
+    {
+        random = random * 1103515245 + 12345;
+        unsigned int event = (random >> 16) & 0xFF;
+
+        sample.durationOfThrottleSwitch += UPDATE_INTERVAL;
+        sample.acceleration = 0;
+        if (4 > event)
+        {
+            sample.throttle = sThrottles[(random >> 24) & 0x03];
+            sample.throttleSwitch = sample.throttle;
+            sample.durationOfThrottleSwitch = 0;
+            sample.acceleration = (RemoteControlCarAdapter::STOP == sample.throttle) ? -40 : 40;
+        }
+        else if (8 > event)
+        {
+            sample.steering = sSteerings[(random >> 24) & 0x03];
+        }
+        else if (9 > event)
+        {
+            sample.isLightSwitchOn = !sample.isLightSwitchOn;
+        }
+        pSamples[i] = sample;
+    }
+}
+
+/**
+ * runs the updates over all samples
+ *
+ * @param pWithUpdate false to run the virtual clock only, which measures the overhead of the mock
+ * @param pChecksum receives the sum of the bytes of all light status
+ * @return number of updates with light status different from the reference, if given
+ */
+template<typename TLogic>
+static unsigned long run(TLogic &pLogic, const std::vector<InputSample_t> &pSamples, unsigned long pStart,
+                         bool pWithUpdate, std::vector<AbstractRcCarLightController::CarLightsStatus_t> *pReference,
+                         unsigned long &pChecksum)
+{
+    unsigned long mismatches = 0;
+    pChecksum = 0;
+
+    for (size_t i = 0; i < pSamples.size(); ++i)
+    {
+        ArduinoMock::advanceTo((pStart + i * UPDATE_INTERVAL) * 1000);
+        if (pWithUpdate)
+        {
+            pLogic.mRemoteControlCarAdapter.mSample = &pSamples[i];
+            pLogic.updateLightStatus();
+            const uint8_t *status = reinterpret_cast<const uint8_t *>(&pLogic.mLightStatus);
+            for (size_t j = 0; j < sizeof(pLogic.mLightStatus); ++j)
+            {
+                pChecksum += status[j];
+            }
+            if (pReference && 0 != memcmp(&(*pReference)[i], &pLogic.mLightStatus, sizeof(pLogic.mLightStatus)))
+            {
+                ++mismatches;
+            }
+        }
+    }
+    return mismatches;
+}
+
+/**
+ * runs the updates over all samples with a new instance of the light logic
+ *
+ * @param pWithUpdate false to run the virtual clock only
+ */
+template<typename TLogic>
+static Measurement_t measure(const std::vector<InputSample_t> &pSamples, bool pWithUpdate)
+{
+    Measurement_t result = { 0, 0, 0 };
+    ArduinoMock::reset();
+    TLogic logic;
+
+    Stopwatch stopwatch;
+    run(logic, pSamples, 1, pWithUpdate, NULL, result.checksum);
+    stopwatch.stop(result);
+    return result;
+}
+
+/**
+ * removes the cost of the virtual clock from a measurement
+ */
+static void removeClock(Measurement_t &pResult, const Measurement_t &pClock)
+{
+    pResult.seconds -= pClock.seconds;
+    pResult.cycles = (pResult.cycles > pClock.cycles) ? pResult.cycles - pClock.cycles : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long count = (1 < argc) ? atol(argv[1]) : 2000000;
+
+    std::vector<InputSample_t> samples;
+    createSamples(samples, count);
+
+    // reference status of the former methods, compared against the light rules
+    std::vector<AbstractRcCarLightController::CarLightsStatus_t> reference(count);
+    {
+        ArduinoMock::reset();
+        FormerLightLogic former;
+        for (size_t i = 0; i < count; ++i)
+        {
+            ArduinoMock::advanceTo((1 + i * UPDATE_INTERVAL) * 1000);
+            former.mRemoteControlCarAdapter.mSample = &samples[i];
+            former.updateLightStatus();
+            reference[i] = former.mLightStatus;
+        }
+    }
+
+    unsigned long virtualDuration = count * UPDATE_INTERVAL;
+
+    // every measurement is repeated, the fastest run is least disturbed by the host
+    Measurement_t clock = measureBest(REPETITIONS, [&]() { return measure<FormerLightLogic>(samples, false); });
+    Measurement_t former = measureBest(REPETITIONS, [&]() { return measure<FormerLightLogic>(samples, true); });
+    Measurement_t rules = measureBest(REPETITIONS, [&]() { return measure<RuleLightLogic>(samples, true); });
+
+    ArduinoMock::reset();
+    RuleLightLogic checkedRules;
+    unsigned long checksum;
+    unsigned long mismatches = run(checkedRules, samples, 1, true, &reference, checksum);
+
+    // the virtual clock is advanced in every run, its cost is removed
+    removeClock(former, clock);
+    removeClock(rules, clock);
+
+    printf("updates           : %lu (%lu s virtual)\n", count, virtualDuration / 1000);
+    printMeasurement("former methods", "update", former, count);
+    printMeasurement("light rules", "update", rules, count);
+    printf("rule state        : %u bytes\n", (unsigned int) sizeof(RcCarLights::LightRules_t));
+    printf("mismatches        : %lu\n", mismatches);
+
+    return (0 == mismatches) ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host benchmark of the pixel behaviours of the Camaro light controller.
+ *
+ * Runs the controller at the frame rate over a repeating sequence of light status changes with an increasing number
+ * of animated pixels: none, the blinkers, all light types and a separate behaviour for every pixel. All behaviours
+ * are LED fades. The brightness of all pixels is evaluated in one pass per frame with a single read of the clock, so
+ * every animated pixel adds the same small cost to a frame, no matter how many behaviours are attached. The time and,
+ * on x86, the TSC cycles are reported per frame.
+ *
+ * Usage: PixelBehaviourBenchmark [<number of frames>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "BenchmarkSupport.h"
+
+#include "../CamaroRcCarLightController.h"
+#include "../KeyframeLightSwitchBehaviour.h"
+#include "../FrameClock.h"
+
+// number of repetitions of every measurement
+static const int REPETITIONS = 5;
+
+// maximal number of behaviours of a run
+static const unsigned int MAX_BEHAVIOURS = 32;
+
+// light types on the NeoPixel strip
+static const AbstractRcCarLightController::LightType_t PIXEL_LIGHT_TYPES[] =
+{
+    AbstractRcCarLightController::TAIL_LIGHT,
+    AbstractRcCarLightController::BRAKE_LIGHT,
+    AbstractRcCarLightController::BACKUP_LIGHT,
+    AbstractRcCarLightController::LEFT_BLINKER,
+    AbstractRcCarLightController::RIGHT_BLINKER
+};
+
+/**
+ * attached behaviours of a run
+ */
+typedef enum
+{
+    NO_BEHAVIOURS, BLINKER_BEHAVIOURS, LIGHT_TYPE_BEHAVIOURS, PIXEL_BEHAVIOURS
+} Setup_t;
+
+/**
+ * result of a run
+ */
+typedef struct
+{
+    double seconds;
+    unsigned long long cycles;
+    unsigned int animatedPixels;
+} PixelMeasurement_t;
+
+/**
+ * @return light status of a frame: blinking every 600 msec, brake, back up and tail lights change slower
+ */
+static AbstractRcCarLightController::CarLightsStatus_t getLightStatus(unsigned long pFrame)
+{
+    AbstractRcCarLightController::CarLightsStatus_t status;
+
+    status.parkingLight = (pFrame / 1000) % 2;
+    status.headlight = (pFrame / 1000) % 2;
+    status.leftBlinker = (pFrame / 1200) % 2 && (pFrame / 120) % 2;
+    status.rightBlinker = !((pFrame / 1200) % 2) && (pFrame / 120) % 2;
+    status.backUpLight = (pFrame / 500) % 3 == 2;
+    status.brakeLight = (pFrame / 300) % 2;
+    return status;
+}
+
+/**
+ * runs the controller for a number of frames
+ *
+ * @param pSetup behaviours to attach
+ * @param pFrames number of frames
+ * @param pWithLoop false to run the virtual clock only
+ * @return duration of the run and number of pixels with a behaviour
+ */
+static PixelMeasurement_t measure(Setup_t pSetup, unsigned long pFrames, bool pWithLoop)
+{
+    ArduinoMock::reset();
+    CamaroRcCarLightController controller;
+    controller.setupPins();
+
+    KeyframeLightSwitchBehaviour *behaviours[MAX_BEHAVIOURS];
+    unsigned int behaviourCount = 0;
+
+    if (BLINKER_BEHAVIOURS == pSetup)
+    {
+        behaviours[behaviourCount++] = new KeyframeLightSwitchBehaviour(&KeyframeLightSwitchBehaviour::LED_FADE);
+        controller.addBehaviour(AbstractRcCarLightController::LEFT_BLINKER, behaviours[behaviourCount - 1]);
+        behaviours[behaviourCount++] = new KeyframeLightSwitchBehaviour(&KeyframeLightSwitchBehaviour::LED_FADE);
+        controller.addBehaviour(AbstractRcCarLightController::RIGHT_BLINKER, behaviours[behaviourCount - 1]);
+    }
+    else if (LIGHT_TYPE_BEHAVIOURS == pSetup)
+    {
+        for (size_t i = 0; i < sizeof(PIXEL_LIGHT_TYPES) / sizeof(PIXEL_LIGHT_TYPES[0]); ++i)
+        {
+            behaviours[behaviourCount++] = new KeyframeLightSwitchBehaviour(&KeyframeLightSwitchBehaviour::LED_FADE);
+            controller.addBehaviour(PIXEL_LIGHT_TYPES[i], behaviours[behaviourCount - 1]);
+        }
+    }
+    else if (PIXEL_BEHAVIOURS == pSetup)
+    {
+        // the blinkers are attached last, so the back lights follow the blinkers
+        for (size_t i = 0; i < sizeof(PIXEL_LIGHT_TYPES) / sizeof(PIXEL_LIGHT_TYPES[0]); ++i)
+        {
+            uint16_t pixelMask = CamaroRcCarLightController::getPixelMask(PIXEL_LIGHT_TYPES[i]);
+            for (uint16_t pixel = 0; pixel < CamaroRcCarLightController::NEO_PIXEL_COUNT; ++pixel)
+            {
+                if ((pixelMask & (1U << pixel)) && behaviourCount < MAX_BEHAVIOURS)
+                {
+                    behaviours[behaviourCount] = new KeyframeLightSwitchBehaviour(
+                            &KeyframeLightSwitchBehaviour::LED_FADE);
+                    controller.addPixelBehaviour(PIXEL_LIGHT_TYPES[i], 1U << pixel, behaviours[behaviourCount]);
+                    ++behaviourCount;
+                }
+            }
+        }
+    }
+
+    PixelMeasurement_t result;
+    Stopwatch stopwatch;
+    for (unsigned long frame = 0; frame < pFrames; ++frame)
+    {
+        ArduinoMock::advanceMicros(FrameClock::FRAME_PERIOD);
+        if (pWithLoop)
+        {
+            controller.loop(getLightStatus(frame));
+            controller.showFrame();
+        }
+    }
+    stopwatch.stop(result);
+
+    result.animatedPixels = controller.getAnimatedPixelCount();
+
+    for (unsigned int i = 0; i < behaviourCount; ++i)
+    {
+        delete behaviours[i];
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long frames = (1 < argc) ? atol(argv[1]) : 1000000;
+
+    static const char *SETUP_NAMES[] = { "no behaviours", "blinkers", "light types", "every pixel" };
+
+    PixelMeasurement_t clock = measureBest(REPETITIONS, [&]() { return measure(NO_BEHAVIOURS, frames, false); });
+
+    printf("frames            : %lu (%lu s virtual)\n", frames, frames * FrameClock::FRAME_PERIOD / 1000000);
+    for (int setup = NO_BEHAVIOURS; setup <= PIXEL_BEHAVIOURS; ++setup)
+    {
+        // the fastest run is least disturbed by the host, the cost of the virtual clock is removed
+        PixelMeasurement_t best = measureBest(REPETITIONS, [&]() { return measure((Setup_t) setup, frames, true); });
+        unsigned long long cycles = (best.cycles > clock.cycles) ? best.cycles - clock.cycles : 0;
+        printf("%-18s: %.1f ns/frame, %.0f cycles/frame, %u animated pixels\n", SETUP_NAMES[setup],
+               (best.seconds - clock.seconds) * 1e9 / frames, (double) cycles / frames, best.animatedPixels);
+    }
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host benchmark of the NeoPixel output stage.
+ *
+ * Converts a full frame of the 14 pixels of the Camaro strip with the output stage (one lookup in the gamma table
+ * in flash per byte, scaled by the global brightness) and, for comparison, with gamma and brightness calculated per
+ * channel. Reports the time and, on x86, the TSC cycles per frame. On an AVR a lookup takes about 9 cycles per byte
+ * (load, index, load from flash, store), the brightness adds about 5 cycles (multiplication and add), i.e. roughly
+ * 590 cycles or 37 usec at 16 MHz per dimmed frame.
+ *
+ * Usage: PixelOutputStageBenchmark [<number of frames>]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "BenchmarkSupport.h"
+
+#include "../PixelOutputStage.h"
+
+// bytes of a frame of the Camaro strip
+static const uint16_t FRAME_SIZE = 14 * 3;
+
+// number of repetitions of every measurement
+static const int REPETITIONS = 5;
+
+/**
+ * gamma and brightness calculated per channel
+ */
+static void applyCalculated(uint8_t *pPixels, uint16_t pSize, uint8_t pBrightness)
+{
+    for (uint16_t i = 0; i < pSize; ++i)
+    {
+        float value = pPixels[i] * (pBrightness + 1) / 256 / 255.0f;
+        pPixels[i] = (uint8_t) (255.0f * powf(value, 2.5f) + 0.5f);
+    }
+}
+
+/**
+ * converts pFrames frames, every frame starts from a new pattern
+ *
+ * @param pIsCalculated true to calculate gamma and brightness per channel instead of the output stage
+ */
+static Measurement_t measure(const PixelOutputStage &pStage, unsigned long pFrames, bool pIsCalculated)
+{
+    Measurement_t result = { 0, 0, 0 };
+    uint8_t frame[FRAME_SIZE];
+
+    Stopwatch stopwatch;
+    for (unsigned long i = 0; i < pFrames; ++i)
+    {
+        for (uint16_t j = 0; j < FRAME_SIZE; ++j)
+        {
+            frame[j] = (uint8_t) (i + j * 37);
+        }
+        if (pIsCalculated)
+        {
+            applyCalculated(frame, FRAME_SIZE, pStage.getBrightness());
+        }
+        else
+        {
+            pStage.apply(frame, FRAME_SIZE);
+        }
+        result.checksum += frame[i % FRAME_SIZE];
+    }
+    stopwatch.stop(result);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long frames = (1 < argc) ? atol(argv[1]) : 2000000;
+
+    PixelOutputStage stage;
+    stage.setBrightness(200);
+
+    Measurement_t table = measureBest(REPETITIONS, [&]() { return measure(stage, frames, false); });
+    Measurement_t calculated = measureBest(REPETITIONS, [&]() { return measure(stage, frames, true); });
+
+    // the float calculation may differ by rounding, count the deviating bytes
+    unsigned long deviations = 0;
+    for (int value = 0; value < 256; ++value)
+    {
+        uint8_t byte = value;
+        applyCalculated(&byte, 1, stage.getBrightness());
+        deviations += (byte != stage.getLevel(value));
+    }
+
+    printf("frames            : %lu of %u bytes\n", frames, FRAME_SIZE);
+    printMeasurement("output stage", "frame", table, frames);
+    printMeasurement("calculated", "frame", calculated, frames);
+    printf("rounding diffs    : %lu of 256 values\n", deviations);
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host check of the RC pulse measurement while the NeoPixel strip is animated.
+ *
+ * Showing the strip blocks the interrupts for SHOW_MICROS of the light controller (see Adafruit_NeoPixel of the arduino
+ * mock), so an edge arriving meanwhile is seen late by the pulse capture and a polled pulse is stretched. The sketch
+ * therefore shows the strip from its main loop while no pulse is measured. This program runs the sketch with a
+ * flickering tail light, which changes the strip in almost every frame, and drives the channels with constant widths
+ * for short segments, alternately with simultaneous and with sequential pulses. The RC period is a multiple of the
+ * frame period, so the signals are restarted at a random offset to the frames for every segment. Once the pulses of a
+ * segment have settled, the widths read by the adapter are compared with the injected ones after every loop. The noise
+ * filters are switched off, so every deviation of a single pulse is seen.
+ *
+ * A width has to match exactly with the pulse capture, the pulse poller may be off by the duration of two polling
+ * passes. The program fails if a width deviates or if the strip was not animated. pulseIn misses pulses by design (see
+ * PulseInInput), so a build with USE_PULSEIN_INPUT is not covered.
+ *
+ * Usage: RcCaptureAccuracy [-t <minutes>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "Adafruit_NeoPixel.h"
+
+#include "../RcCarLights.h"
+
+// pins as used by RcCarLights
+static const uint8_t PIN_THROTTLE = VehicleConfig::PIN_THROTTLE;
+static const uint8_t PIN_STEERING = VehicleConfig::PIN_STEERING;
+static const uint8_t PIN_3RD_CHANNEL = VehicleConfig::PIN_3RD_CHANNEL;
+
+// neutral position of throttle and steering, 3rd channel in off position and throttle switch pressed
+static const unsigned long NEUTRAL = 1500;
+static const unsigned long CHANNEL_3_OFF = 1900;
+static const unsigned long THROTTLE_SWITCH = 1540;
+
+// virtual duration of a loop in usec
+static const unsigned long LOOP_MICROS = 1000;
+
+// duration of a segment with constant widths in msec
+static const unsigned long SEGMENT_DURATION = 200;
+
+// time in msec after the start of a segment, from which on the widths read have to match
+static const unsigned long SETTLE_TIME = 80;
+
+// offsets in usec of the pulses of steering and 3rd channel to the throttle pulse in a segment with sequential pulses
+static const unsigned long SEQUENTIAL_PHASE = 2500;
+
+#ifdef USE_POLLED_INPUT
+// duration of a pass of the polling loop of the pulse poller in usec
+static const unsigned long POLL_PASS_MICROS = 4;
+
+// allowed deviation of a width in usec: an edge is seen by the next polling pass
+static const unsigned long TOLERANCE = 2 * POLL_PASS_MICROS;
+#else
+static const unsigned long TOLERANCE = 0;
+#endif
+
+/**
+ * deviations of the widths read from the injected widths
+ */
+typedef struct
+{
+    unsigned long samples;
+    unsigned long mismatches;
+    unsigned long maxError;
+} Accuracy_t;
+
+/**
+ * @return next value of a simple deterministic random generator
+ */
+static unsigned long nextRandom(void)
+{
+    static unsigned long sState = 12345;
+    sState = sState * 1103515245UL + 12345UL;
+    return (sState >> 16) & 0x7FFF;
+}
+
+/**
+ * runs the loop of the sketch for a duration
+ *
+ * @param pRcCarLights sketch
+ * @param pDuration duration in msec
+ */
+static void run(RcCarLights &pRcCarLights, unsigned long pDuration)
+{
+    unsigned long end = ArduinoMock::getMicros() + pDuration * 1000;
+    while ((long) (ArduinoMock::getMicros() - end) < 0)
+    {
+        pRcCarLights.loop();
+        ArduinoMock::advanceMicros(LOOP_MICROS);
+    }
+}
+
+/**
+ * compares a width read with the injected width
+ */
+static void compare(Accuracy_t &pAccuracy, unsigned long pRead, unsigned long pInjected)
+{
+    unsigned long error = (pRead < pInjected) ? pInjected - pRead : pRead - pInjected;
+
+    ++pAccuracy.samples;
+    if (TOLERANCE < error)
+    {
+        ++pAccuracy.mismatches;
+    }
+    if (pAccuracy.maxError < error)
+    {
+        pAccuracy.maxError = error;
+    }
+}
+
+/**
+ * drives the channels with constant widths for a segment and compares the widths read after every loop
+ *
+ * @param pRcCarLights sketch
+ * @param pIsSequential true for sequential pulses, false for simultaneous ones
+ * @param pAccuracy accuracy to update
+ */
+static void runSegment(RcCarLights &pRcCarLights, bool pIsSequential, Accuracy_t &pAccuracy)
+{
+    // the throttle stays out of the throttle switch, so the lights stay on
+    unsigned long throttle = (nextRandom() & 1) ? 1000 + nextRandom() % 450 : 1650 + nextRandom() % 350;
+    unsigned long steering = 1000 + nextRandom() % 1000;
+    unsigned long thirdChannel = 1000 + nextRandom() % 1000;
+    unsigned long phase = nextRandom() % FrameClock::FRAME_PERIOD;
+
+    ArduinoMock::clearPulseSignal(PIN_THROTTLE);
+    ArduinoMock::clearPulseSignal(PIN_STEERING);
+    ArduinoMock::clearPulseSignal(PIN_3RD_CHANNEL);
+    ArduinoMock::setPulseSignal(PIN_THROTTLE, throttle, ArduinoMock::RC_SIGNAL_PERIOD, phase);
+    ArduinoMock::setPulseSignal(PIN_STEERING, steering, ArduinoMock::RC_SIGNAL_PERIOD,
+                                phase + (pIsSequential ? SEQUENTIAL_PHASE : 0));
+    ArduinoMock::setPulseSignal(PIN_3RD_CHANNEL, thirdChannel, ArduinoMock::RC_SIGNAL_PERIOD,
+                                phase + (pIsSequential ? 2 * SEQUENTIAL_PHASE : 0));
+
+    RcCarLights::RemoteControlCarAdapter_t &adapter = pRcCarLights.getRemoteControlCarAdapter();
+    unsigned long start = ArduinoMock::getMicros();
+    while (ArduinoMock::getMicros() - start < SEGMENT_DURATION * 1000)
+    {
+        pRcCarLights.loop();
+        ArduinoMock::advanceMicros(LOOP_MICROS);
+
+        if (SETTLE_TIME * 1000 <= ArduinoMock::getMicros() - start)
+        {
+            compare(pAccuracy, adapter.getThrottleValue(), throttle);
+            compare(pAccuracy, adapter.getSteeringValue(), steering);
+            compare(pAccuracy, adapter.get3rdChannelValue(), thirdChannel);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    double minutes = 1.0;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "t:")))
+    {
+        switch (option)
+        {
+            case 't':
+                minutes = atof(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t <minutes>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    ArduinoMock::reset();
+    ArduinoMock::setSerialCapture(false);
+#ifdef USE_POLLED_INPUT
+    ArduinoMock::setMicrosStep(POLL_PASS_MICROS);
+#endif
+    ArduinoMock::setPulseSignal(PIN_THROTTLE, NEUTRAL);
+    ArduinoMock::setPulseSignal(PIN_STEERING, NEUTRAL);
+    ArduinoMock::setPulseSignal(PIN_3RD_CHANNEL, CHANNEL_3_OFF);
+
+    RcCarLights rcCarLights;
+    rcCarLights.setup();
+
+    RcCarLights::RemoteControlCarAdapter_t &adapter = rcCarLights.getRemoteControlCarAdapter();
+    adapter.getThrottleFilter().setType(RcChannelFilter::NO_FILTER);
+    adapter.getSteeringFilter().setType(RcChannelFilter::NO_FILTER);
+    adapter.get3rdChannelFilter().setType(RcChannelFilter::NO_FILTER);
+
+    KeyframeLightSwitchBehaviour flicker(&KeyframeLightSwitchBehaviour::FLICKER);
+    rcCarLights.getLightController().addPixelBehaviour(
+            AbstractRcCarLightController::TAIL_LIGHT,
+            RcCarLights::LightController_t::getPixelMask(AbstractRcCarLightController::TAIL_LIGHT), &flicker);
+
+    // switch on the lights with the throttle switch
+    run(rcCarLights, 2000);
+    ArduinoMock::setPulseSignal(PIN_THROTTLE, THROTTLE_SWITCH);
+    run(rcCarLights, 1300);
+    ArduinoMock::setPulseSignal(PIN_THROTTLE, NEUTRAL);
+    run(rcCarLights, 1000);
+
+    unsigned long firstShow = Adafruit_NeoPixel::getLastShownStrip()->getShowCount();
+    Accuracy_t accuracy = { 0, 0, 0 };
+    unsigned long segments = (unsigned long) (minutes * 60000.0 / SEGMENT_DURATION);
+    for (unsigned long segment = 0; segment < segments; ++segment)
+    {
+        runSegment(rcCarLights, segment % 2, accuracy);
+    }
+    unsigned long shows = Adafruit_NeoPixel::getLastShownStrip()->getShowCount() - firstShow;
+
+    printf("segments          : %lu\n", segments);
+    printf("show duration     : %lu usec\n", RcCarLights::LightController_t::SHOW_MICROS);
+    printf("NeoPixel shows    : %lu\n", shows);
+    printf("compared widths   : %lu\n", accuracy.samples);
+    printf("mismatches        : %lu\n", accuracy.mismatches);
+    printf("max error         : %lu usec (tolerance %lu usec)\n", accuracy.maxError, TOLERANCE);
+
+    // without animation the strip does not block the interrupts and the check proves nothing
+    if (shows < segments)
+    {
+        printf("strip not animated\n");
+        return 1;
+    }
+    return accuracy.mismatches ? 1 : 0;
+}
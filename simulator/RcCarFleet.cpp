@@ -0,0 +1,265 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Randomized soak run of a fleet of independent cars on a host.
+ *
+ * Every car is an RcCarLights instance with its own emulated board (see ArduinoMock::Board) and its own random
+ * driver, which changes throttle, steering and 3rd channel at random times. The cars are distributed over a pool of
+ * worker threads; each worker takes the next car, runs it for the given virtual time and records its number of
+ * output changes and its output signature. The cars do not share any state, so the run scales with the number of
+ * cores and the fleet signature does not depend on the number of threads.
+ *
+ * Usage: RcCarFleet [-n <cars>] [-t <minutes per car>] [-j <threads>] [-s <seed>] [-l <loop duration in usec>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "Arduino.h"
+#include "LightOutputs.h"
+
+#include "../RcCarLights.h"
+
+/**
+ * random driver of a single car. Every RC frame the driver may pick a new position of one of the channels, the
+ * positions are chosen from the ranges, which trigger the different lights.
+ */
+class RandomDriverSource : public RcInputSource
+{
+public:
+    RandomDriverSource(uint32_t pSeed) :
+            mState(pSeed ? pSeed : 1), mNextChange(0), mThrottle(1500), mSteering(1500), m3rdChannel(1900)
+    {
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        unsigned long now = millis();
+
+        if (now >= mNextChange)
+        {
+            change();
+            mNextChange = now + 20 + nextRandom(3000);
+        }
+
+        pThrottle = mThrottle;
+        pSteering = mSteering;
+        p3rdChannel = m3rdChannel;
+        return now;
+    }
+
+private:
+    /**
+     * moves one of the channels to a new position
+     */
+    void change(void)
+    {
+        // throttle switch, forward, backward and neutral positions, steering left, right and neutral
+        static const uint16_t THROTTLE_POSITIONS[] = { 1500, 1500, 1540, 1600, 1800, 1900, 1200, 1100 };
+        static const uint16_t STEERING_POSITIONS[] = { 1500, 1500, 1300, 1700, 1100, 1900 };
+
+        uint32_t channel = nextRandom(8);
+        if (channel < 5)
+        {
+            mThrottle = THROTTLE_POSITIONS[nextRandom(sizeof(THROTTLE_POSITIONS) / sizeof(THROTTLE_POSITIONS[0]))]
+                    + nextRandom(11) - 5;
+        }
+        else if (channel < 7)
+        {
+            mSteering = STEERING_POSITIONS[nextRandom(sizeof(STEERING_POSITIONS) / sizeof(STEERING_POSITIONS[0]))]
+                    + nextRandom(11) - 5;
+        }
+        else
+        {
+            m3rdChannel = (1900 == m3rdChannel) ? 1000 : 1900;
+        }
+    }
+
+    /**
+     * xorshift32 pseudo random number
+     *
+     * @return number in the range 0 .. pLimit - 1
+     */
+    uint32_t nextRandom(uint32_t pLimit)
+    {
+        mState ^= mState << 13;
+        mState ^= mState >> 17;
+        mState ^= mState << 5;
+        return mState % pLimit;
+    }
+
+    uint32_t mState;
+    unsigned long mNextChange;
+    unsigned long mThrottle;
+    unsigned long mSteering;
+    unsigned long m3rdChannel;
+};
+
+/**
+ * result of a single car
+ */
+typedef struct
+{
+    unsigned long loops;
+    unsigned long outputChanges;
+    uint32_t signature;
+} CarResult_t;
+
+/**
+ * runs a single car on its own board
+ *
+ * @param pSeed seed of the random driver
+ * @param pDurationMicros virtual driving time
+ * @param pLoopMicros virtual duration of a loop
+ * @param pResult receives the result
+ */
+static void runCar(uint32_t pSeed, unsigned long pDurationMicros, unsigned long pLoopMicros, CarResult_t &pResult)
+{
+    ArduinoMock::Board board;
+    ArduinoMock::select(&board);
+    ArduinoMock::setSerialCapture(false);
+
+    {
+        RandomDriverSource driver(pSeed);
+        RcCarLights rcCarLights;
+        rcCarLights.setInputSource(&driver);
+        rcCarLights.setup();
+
+        pResult.loops = 0;
+        pResult.outputChanges = 0;
+        uint32_t lastOutputs = hashLightOutputs();
+        pResult.signature = lastOutputs;
+
+        while (ArduinoMock::getMicros() < pDurationMicros)
+        {
+            rcCarLights.loop();
+            ArduinoMock::advanceMicros(pLoopMicros);
+            ++pResult.loops;
+
+            uint32_t outputs = hashLightOutputs();
+            if (outputs != lastOutputs)
+            {
+                ++pResult.outputChanges;
+                lastOutputs = outputs;
+                pResult.signature = (pResult.signature ^ outputs ^ (uint32_t) millis()) * 16777619u;
+            }
+        }
+    }
+
+    // the car is gone, the board must not stay selected
+    ArduinoMock::select(NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long cars = 1000;
+    double minutes = 1.0;
+    unsigned long threads = std::thread::hardware_concurrency();
+    uint32_t seed = 1;
+    unsigned long loopMicros = 1000;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "n:t:j:s:l:")))
+    {
+        switch (option)
+        {
+            case 'n':
+                cars = strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                minutes = atof(optarg);
+                break;
+            case 'j':
+                threads = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                loopMicros = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n <cars>] [-t <minutes per car>] [-j <threads>] [-s <seed>] "
+                        "[-l <loop duration in usec>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (0 == threads)
+    {
+        threads = 1;
+    }
+
+    unsigned long durationMicros = (unsigned long) (minutes * 60.0 * 1000000.0);
+    std::vector<CarResult_t> results(cars);
+    std::atomic<unsigned long> nextCar(0);
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (unsigned long i = 0; i < threads; ++i)
+    {
+        workers.push_back(std::thread([&]()
+        {
+            unsigned long car;
+            while ((car = nextCar++) < cars)
+            {
+                runCar(seed * 2654435761u + car, durationMicros, loopMicros, results[car]);
+            }
+        }));
+    }
+    for (unsigned long i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // the signatures are combined in the order of the cars, so the result does not depend on the threads
+    unsigned long loops = 0;
+    unsigned long outputChanges = 0;
+    uint32_t signature = 2166136261u;
+    for (unsigned long i = 0; i < cars; ++i)
+    {
+        loops += results[i].loops;
+        outputChanges += results[i].outputChanges;
+        signature = (signature ^ results[i].signature) * 16777619u;
+    }
+
+    double virtualSeconds = cars * durationMicros / 1000000.0;
+
+    printf("cars              : %lu\n", cars);
+    printf("threads           : %lu\n", threads);
+    printf("virtual time      : %.1f h\n", virtualSeconds / 3600.0);
+    printf("wall time         : %.3f s\n", wallSeconds);
+    printf("loop iterations   : %lu\n", loops);
+    printf("iterations/s      : %.0f\n", loops / wallSeconds);
+    printf("speed up          : %.0fx\n", virtualSeconds / wallSeconds);
+    printf("output changes    : %lu\n", outputChanges);
+    printf("fleet signature   : %08x\n", signature);
+
+    return 0;
+}
@@ -0,0 +1,271 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Fast forward simulation of the light controller on a host.
+ *
+ * The sketch (RcCarLights::setup and loop) runs against the arduino mock on a virtual clock. The RC inputs are driven
+ * by a repeating drive cycle (PulseScript), every loop costs a configurable amount of virtual time. The light outputs
+ * are observed after every loop, each change is counted and folded into a signature. Two firmware versions behave
+ * identically for the drive cycle if their signatures are equal.
+ *
+ * In addition every single change of an output pin is observed when it happens (see ArduinoMock::setOutputListener)
+ * and its offset to the grid of the FrameClock is measured. As the pins are set by the frames only, the offset, i.e.
+ * the jitter of the light animations, is independent of the loop duration. It is 0 except for frames delayed by the
+ * main loop showing the NeoPixel strip, which blocks the interrupts for SHOW_MICROS of the light controller. The
+ * strip is shown by the main loop between the RC pulses and therefore not aligned to the frames.
+ *
+ * Usage: RcCarLightsSimulator [-t <hours>] [-l <loop duration in usec>] [-o <serial file>]
+ *
+ * -o writes everything the sketch sent over the serial port to a file: the telemetry stream or, if the sketch is built
+ * with RECORD_RC_TRACE, the RC trace of the run, which can be replayed by RcTraceReplay. If the sketch is built with
+ * PROFILE_STAGES, the execution times of its stages are printed in addition.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+
+#include "Arduino.h"
+#include "Adafruit_NeoPixel.h"
+#include "LightOutputs.h"
+#include "PulseScript.h"
+
+#include "../RcCarLights.h"
+
+// pins as used by RcCarLights
+static const uint8_t PIN_THROTTLE = VehicleConfig::PIN_THROTTLE;
+static const uint8_t PIN_STEERING = VehicleConfig::PIN_STEERING;
+static const uint8_t PIN_3RD_CHANNEL = VehicleConfig::PIN_3RD_CHANNEL;
+
+// neutral position of throttle and steering and the 3rd channel in off position
+static const unsigned long NEUTRAL = 1500;
+static const unsigned long CHANNEL_3_OFF = 1900;
+
+#ifdef USE_POLLED_INPUT
+// duration of a pass of the polling loop of the pulse poller in usec
+static const unsigned long POLL_PASS_MICROS = 4;
+#endif
+
+/**
+ * drive cycle of one minute: switch on lights, drive forward, brake, blink while standing, drive backward,
+ * blink to the other side, drive and switch on the emergency light bar
+ */
+static const PulseScript::Step_t sDriveCycle[] =
+{
+    { 0, PIN_THROTTLE, NEUTRAL },
+    { 0, PIN_STEERING, NEUTRAL },
+    { 0, PIN_3RD_CHANNEL, CHANNEL_3_OFF },
+    { 2000, PIN_THROTTLE, 1540 },           // throttle switch pressed to toggle lights
+    { 3300, PIN_THROTTLE, NEUTRAL },
+    { 5000, PIN_THROTTLE, 1800 },           // forward
+    { 12000, PIN_THROTTLE, NEUTRAL },       // release throttle, brake
+    { 16000, PIN_STEERING, 1300 },          // blink right while standing
+    { 22000, PIN_STEERING, NEUTRAL },
+    { 24000, PIN_THROTTLE, 1200 },          // backward
+    { 30000, PIN_THROTTLE, NEUTRAL },
+    { 32000, PIN_STEERING, 1700 },          // blink left while standing
+    { 36000, PIN_STEERING, NEUTRAL },
+    { 38000, PIN_THROTTLE, 1900 },          // full forward
+    { 45000, PIN_THROTTLE, 1600 },          // slow down
+    { 47000, PIN_THROTTLE, NEUTRAL },
+    { 50000, PIN_3RD_CHANNEL, 1000 },       // emergency light bar on
+    { 55000, PIN_3RD_CHANNEL, CHANNEL_3_OFF }
+};
+
+// duration of the drive cycle in msec
+static const unsigned long DRIVE_CYCLE_PERIOD = 60000;
+
+/**
+ * offsets of the output changes to the frame grid
+ */
+typedef struct
+{
+    unsigned long origin;
+    uint32_t lastOutputs;
+    unsigned long changes;
+    unsigned long offGridChanges;
+    unsigned long maxOffset;
+} FrameJitter_t;
+
+/**
+ * output listener, measures the offset of an output pin change to the last frame
+ *
+ * @param pContext FrameJitter_t to update
+ */
+static void measureFrameJitter(void *pContext)
+{
+    FrameJitter_t &jitter = *static_cast<FrameJitter_t *>(pContext);
+
+    uint32_t outputs = hashPinOutputs();
+    if (outputs != jitter.lastOutputs)
+    {
+        jitter.lastOutputs = outputs;
+        ++jitter.changes;
+
+        unsigned long offset = (ArduinoMock::getMicros() - jitter.origin) % FrameClock::FRAME_PERIOD;
+        if (0 != offset)
+        {
+            ++jitter.offGridChanges;
+        }
+        if (jitter.maxOffset < offset)
+        {
+            jitter.maxOffset = offset;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    double hours = 1.0;
+    unsigned long loopMicros = 1000;
+    const char *serialFileName = NULL;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "t:l:o:")))
+    {
+        switch (option)
+        {
+            case 't':
+                hours = atof(optarg);
+                break;
+            case 'l':
+                loopMicros = strtoul(optarg, NULL, 10);
+                break;
+            case 'o':
+                serialFileName = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t <hours>] [-l <loop duration in usec>] [-o <serial file>]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    ArduinoMock::reset();
+    ArduinoMock::setSerialCapture(NULL != serialFileName);
+#ifdef USE_POLLED_INPUT
+    ArduinoMock::setMicrosStep(POLL_PASS_MICROS);
+#endif
+
+    PulseScript script(sDriveCycle, sizeof(sDriveCycle) / sizeof(sDriveCycle[0]), DRIVE_CYCLE_PERIOD);
+    script.start();
+
+    RcCarLights rcCarLights;
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+    rcCarLights.setup();
+
+    // the outputs set by setup are not part of the animations, the frame clock is started at the end of setup
+    FrameJitter_t jitter = { ArduinoMock::getMicros(), hashPinOutputs(), 0, 0, 0 };
+    ArduinoMock::setOutputListener(measureFrameJitter, &jitter);
+
+    unsigned long endMicros = ArduinoMock::getMicros() + (unsigned long) (hours * 3600.0 * 1000000.0);
+    unsigned long iterations = 0;
+    unsigned long outputChanges = 0;
+    uint32_t lastOutputs = hashLightOutputs();
+    uint32_t signature = lastOutputs;
+    unsigned long lastSecond = ArduinoMock::getMicros() / 1000000;
+    unsigned long seconds = 0;
+    unsigned long skippedPasses = 0;
+    unsigned long executedPasses = 0;
+
+    while (ArduinoMock::getMicros() < endMicros)
+    {
+        script.update();
+        rcCarLights.loop();
+        ArduinoMock::advanceMicros(loopMicros);
+        ++iterations;
+
+        // the loop statistics are published once per second
+        if (ArduinoMock::getMicros() / 1000000 != lastSecond)
+        {
+            lastSecond = ArduinoMock::getMicros() / 1000000;
+            ++seconds;
+            skippedPasses += rcCarLights.getSkippedPassesPerSecond();
+            executedPasses += rcCarLights.getExecutedPassesPerSecond();
+        }
+
+        uint32_t outputs = hashLightOutputs();
+        if (outputs != lastOutputs)
+        {
+            ++outputChanges;
+            lastOutputs = outputs;
+            signature = (signature ^ outputs ^ (uint32_t) (ArduinoMock::getMicros() / 1000)) * 16777619u;
+        }
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    ArduinoMock::setOutputListener(NULL, NULL);
+    double virtualSeconds = ArduinoMock::getMicros() / 1000000.0;
+
+    if (serialFileName)
+    {
+        FILE *file = fopen(serialFileName, "wb");
+        if (!file)
+        {
+            perror(serialFileName);
+            return 1;
+        }
+        const std::vector<uint8_t> &output = ArduinoMock::getSerialOutput();
+        if (!output.empty())
+        {
+            fwrite(&output[0], 1, output.size(), file);
+        }
+        fclose(file);
+    }
+
+    printf("virtual time      : %.1f s\n", virtualSeconds);
+    printf("wall time         : %.3f s\n", wallSeconds);
+    printf("loop iterations   : %lu\n", iterations);
+    printf("iterations/s      : %.0f\n", iterations / wallSeconds);
+    printf("speed up          : %.0fx\n", virtualSeconds / wallSeconds);
+    printf("virtual usec/loop : %.1f\n", ArduinoMock::getMicros() / (double) iterations);
+    printf("serial bytes      : %lu\n", ArduinoMock::getSerialByteCount());
+    printf("NeoPixel shows    : %lu\n",
+           Adafruit_NeoPixel::getLastShownStrip() ? Adafruit_NeoPixel::getLastShownStrip()->getShowCount() : 0);
+    printf("executed passes/s : %.1f\n", seconds ? executedPasses / (double) seconds : 0.0);
+    printf("skipped passes/s  : %.1f\n", seconds ? skippedPasses / (double) seconds : 0.0);
+    printf("output changes    : %lu\n", outputChanges);
+    printf("output signature  : %08x\n", signature);
+    printf("frame period      : %lu usec\n", FrameClock::FRAME_PERIOD);
+    printf("show duration     : %lu usec\n", RcCarLights::LightController_t::SHOW_MICROS);
+    printf("timed changes     : %lu\n", jitter.changes);
+    printf("off frame changes : %lu\n", jitter.offGridChanges);
+    printf("max frame jitter  : %lu usec\n", jitter.maxOffset);
+
+#ifdef PROFILE_STAGES
+    // the profile is cleared by every dump of the sketch, so it covers the last profile interval only
+    printf("stage profile     : count, min/mean/max in nsec (wall clock)\n");
+    for (uint8_t stage = 0; stage < StageProfiler::NUM_STAGES; ++stage)
+    {
+        StageProfiler::Statistics_t statistics;
+        rcCarLights.getProfiler().getStatistics((StageProfiler::Stage_t) stage, statistics);
+        printf("  %s     : %lu, %lu/%lu/%lu\n", StageProfiler::getStageName((StageProfiler::Stage_t) stage),
+               (unsigned long) statistics.count, statistics.min * StageProfiler::TICK_NSEC,
+               statistics.count ? statistics.sum / statistics.count * StageProfiler::TICK_NSEC : 0,
+               statistics.max * StageProfiler::TICK_NSEC);
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,347 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host benchmark of the noise filters of the RC channels (see RcChannelFilter).
+ *
+ * Measures the time and, on x86, the TSC cycles per filtered sample of every filter type. Then it drives
+ * RemoteControlCarAdapter with noisy RC inputs and counts the changes of throttle, throttle switch, steering and
+ * steering switch for every filter type, compared with the same inputs without noise. The inputs are a built-in
+ * drive cycle, which holds the throttle close to the thresholds, or a recorded trace (see RcTraceReplay). Every
+ * 20 msec frame of the receiver gets new noise: a jitter of a few usec on every pulse and occasional spikes.
+ *
+ * Usage: RcChannelFilterBenchmark [-m <minutes>] [-s <seed>] [<trace file>]
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "BenchmarkSupport.h"
+#include "RcTraceReplaySource.h"
+
+#include "../RemoteControlCarAdapter.h"
+
+// time in msec between two frames of the receiver
+static const unsigned long FRAME_PERIOD = 20;
+
+// the pulse capture reads the inputs once per pulse, i.e. 3 times per frame
+static const unsigned long READS_PER_FRAME = 3;
+
+// maximum jitter in usec of every pulse
+static const long JITTER = 8;
+
+// one of SPIKE_RATE pulses is a spike
+static const long SPIKE_RATE = 50;
+
+// deviation of a spike in usec
+static const long SPIKE = 150;
+
+// number of repetitions of every measurement
+static const int REPETITIONS = 5;
+
+/**
+ * step of the built-in drive cycle
+ */
+typedef struct
+{
+    unsigned long time;         // start of the step in msec within the cycle
+    unsigned long throttle;     // throttle pulse width in usec
+    unsigned long steering;     // steering pulse width in usec
+} Step_t;
+
+/**
+ * drive cycle of 30 sec: the throttle switch is held close to its thresholds, the throttle is released slowly and the
+ * steering stays close to neutral while driving
+ */
+static const Step_t sDriveCycle[] =
+{
+    { 0, 1500, 1500 },
+    { 2000, 1530, 1500 },       // throttle switch close to the null epsilon
+    { 4000, 1555, 1500 },       // throttle switch close to the switch border
+    { 6000, 1500, 1500 },
+    { 8000, 1800, 1520 },       // forward, steering close to the null epsilon
+    { 14000, 1650, 1520 },
+    { 15000, 1520, 1500 },      // almost released
+    { 17000, 1500, 1300 },      // blink right
+    { 21000, 1500, 1500 },
+    { 23000, 1200, 1480 },      // backward
+    { 27000, 1500, 1500 },
+    { 30000, 0, 0 }             // end of the cycle
+};
+
+// number of steps including the end
+static const size_t NUM_STEPS = sizeof(sDriveCycle) / sizeof(sDriveCycle[0]);
+
+/**
+ * Repeats the built-in drive cycle, every frame of the receiver is read READS_PER_FRAME times.
+ */
+class DriveCycleSource: public RcInputSource
+{
+public:
+    DriveCycleSource(unsigned long pDuration) :
+            mDuration(pDuration), mReads(0)
+    {
+    }
+
+    bool hasNext(void) const
+    {
+        return getTimestamp() < mDuration;
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        unsigned long timestamp = getTimestamp();
+        unsigned long cycleTime = timestamp % sDriveCycle[NUM_STEPS - 1].time;
+        size_t step = 0;
+        while (sDriveCycle[step + 1].time <= cycleTime)
+        {
+            ++step;
+        }
+
+        pThrottle = sDriveCycle[step].throttle;
+        pSteering = sDriveCycle[step].steering;
+        p3rdChannel = 1900;
+        ++mReads;
+        return timestamp;
+    }
+
+private:
+    unsigned long getTimestamp(void) const
+    {
+        return mReads / READS_PER_FRAME * FRAME_PERIOD + mReads % READS_PER_FRAME * 2;
+    }
+
+    unsigned long mDuration;
+    unsigned long mReads;
+};
+
+/**
+ * Adds noise to the inputs of another source. The noise changes with every frame of the receiver, reads within the
+ * same frame return the same widths.
+ */
+class NoisySource: public RcInputSource
+{
+public:
+    NoisySource(RcInputSource &pSource, bool pIsNoisy, unsigned long pSeed) :
+            mSource(pSource), misNoisy(pIsNoisy), mRandom(pSeed), mFrame(ULONG_MAX)
+    {
+        mNoise[0] = mNoise[1] = mNoise[2] = 0;
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        unsigned long timestamp = mSource.read(pThrottle, pSteering, p3rdChannel);
+        if (misNoisy)
+        {
+            if (timestamp / FRAME_PERIOD != mFrame)
+            {
+                mFrame = timestamp / FRAME_PERIOD;
+                for (int i = 0; i < 3; ++i)
+                {
+                    mNoise[i] = (long) (nextRandom() % (2 * JITTER + 1)) - JITTER;
+                    if (0 == nextRandom() % SPIKE_RATE)
+                    {
+                        mNoise[i] += (nextRandom() & 1) ? SPIKE : -SPIKE;
+                    }
+                }
+            }
+            pThrottle = addNoise(pThrottle, mNoise[0]);
+            pSteering = addNoise(pSteering, mNoise[1]);
+            p3rdChannel = addNoise(p3rdChannel, mNoise[2]);
+        }
+        return timestamp;
+    }
+
+private:
+    static unsigned long addNoise(unsigned long pWidth, long pNoise)
+    {
+        // no signal stays no signal
+        return pWidth ? pWidth + pNoise : 0;
+    }
+
+    unsigned long nextRandom(void)
+    {
+        mRandom = mRandom * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (unsigned long) (mRandom >> 33);
+    }
+
+    RcInputSource &mSource;
+    bool misNoisy;
+    unsigned long long mRandom;
+    unsigned long mFrame;
+    long mNoise[3];
+};
+
+/**
+ * changes of the classified inputs
+ */
+typedef struct
+{
+    unsigned long throttle;
+    unsigned long throttleSwitch;
+    unsigned long steering;
+    unsigned long steeringSwitch;
+} Changes_t;
+
+/**
+ * drives the adapter with the inputs of a source until the end of the inputs
+ */
+static Changes_t countChanges(const char *pTraceFileName, const std::vector<uint8_t> &pTrace, unsigned long pMinutes,
+                              bool pIsNoisy, RcChannelFilter::Type_t pType, unsigned long pSeed)
+{
+    Changes_t changes = { 0, 0, 0, 0 };
+
+    ArduinoMock::reset();
+    DriveCycleSource driveCycle(pMinutes * 60000UL);
+    RcTraceReplaySource replay(pTrace);
+    RcInputSource &source = pTraceFileName ? (RcInputSource &) replay : (RcInputSource &) driveCycle;
+    NoisySource noisySource(source, pIsNoisy, pSeed);
+
+    RemoteControlCarAdapter adapter;
+    adapter.setInputSource(&noisySource);
+    adapter.getThrottleFilter().setType(pType);
+    adapter.getSteeringFilter().setType(pType);
+    adapter.get3rdChannelFilter().setType(pType);
+    adapter.setupPins();
+    adapter.refresh();
+
+    RemoteControlCarAdapter::Throttle_t throttle = adapter.getThrottle();
+    RemoteControlCarAdapter::Throttle_t throttleSwitch = adapter.getThrottleSwitch();
+    RemoteControlCarAdapter::Steering_t steering = adapter.getSteering();
+    RemoteControlCarAdapter::Steering_t steeringSwitch = adapter.getSteeringSwitch();
+
+    while (pTraceFileName ? replay.hasNext() : driveCycle.hasNext())
+    {
+        adapter.refresh();
+
+        changes.throttle += (throttle != adapter.getThrottle());
+        changes.throttleSwitch += (throttleSwitch != adapter.getThrottleSwitch());
+        changes.steering += (steering != adapter.getSteering());
+        changes.steeringSwitch += (steeringSwitch != adapter.getSteeringSwitch());
+
+        throttle = adapter.getThrottle();
+        throttleSwitch = adapter.getThrottleSwitch();
+        steering = adapter.getSteering();
+        steeringSwitch = adapter.getSteeringSwitch();
+    }
+    return changes;
+}
+
+/**
+ * filters all samples, every sample is a new pulse
+ */
+static Measurement_t measure(RcChannelFilter::Type_t pType, const std::vector<unsigned long> &pSamples)
+{
+    Measurement_t result = { 0, 0, 0 };
+    RcChannelFilter filter(pType);
+
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < pSamples.size(); ++i)
+    {
+        result.checksum += filter.filter(pSamples[i], i * FRAME_PERIOD);
+    }
+    stopwatch.stop(result);
+    return result;
+}
+
+static void printChanges(const char *pName, const Changes_t &pChanges)
+{
+    printf("%-18s: %6lu %6lu %6lu %6lu %7lu\n", pName, pChanges.throttle, pChanges.throttleSwitch, pChanges.steering,
+           pChanges.steeringSwitch,
+           pChanges.throttle + pChanges.throttleSwitch + pChanges.steering + pChanges.steeringSwitch);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long minutes = 10;
+    unsigned long seed = 1;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "m:s:")))
+    {
+        switch (option)
+        {
+            case 'm':
+                minutes = atol(optarg);
+                break;
+            case 's':
+                seed = atol(optarg);
+                break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+
+    if (optind + 1 < argc)
+    {
+        fprintf(stderr, "usage: %s [-m <minutes>] [-s <seed>] [<trace file>]\n", argv[0]);
+        return 1;
+    }
+
+    const char *traceFileName = (optind < argc) ? argv[optind] : NULL;
+    std::vector<uint8_t> trace;
+    if (traceFileName)
+    {
+        if (!readFile(traceFileName, trace))
+        {
+            return 1;
+        }
+        if (!RcTraceReplaySource(trace).isValid())
+        {
+            fprintf(stderr, "%s: not an RC trace\n", traceFileName);
+            return 1;
+        }
+    }
+
+    // noisy samples around the neutral position
+    std::vector<unsigned long> samples(1000000);
+    unsigned long long random = seed;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+        samples[i] = 1500 + (random >> 33) % 200;
+    }
+
+    static const RcChannelFilter::Type_t TYPES[] =
+    { RcChannelFilter::NO_FILTER, RcChannelFilter::MEDIAN_FILTER, RcChannelFilter::IIR_FILTER };
+    static const char * const NAMES[] = { "no filter", "median of 3", "IIR 1/4" };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        RcChannelFilter::Type_t type = TYPES[i];
+        printMeasurement(NAMES[i], "sample", measureBest(REPETITIONS, [&]() { return measure(type, samples); }),
+                         samples.size());
+    }
+
+    printf("\ninputs            : %s\n", traceFileName ? traceFileName : "built-in drive cycle");
+    printf("changes           : thrott switch  steer switch   total\n");
+    printChanges("without noise", countChanges(traceFileName, trace, minutes, false, RcChannelFilter::NO_FILTER, seed));
+    for (int i = 0; i < 3; ++i)
+    {
+        printChanges(NAMES[i], countChanges(traceFileName, trace, minutes, true, TYPES[i], seed));
+    }
+
+    return 0;
+}
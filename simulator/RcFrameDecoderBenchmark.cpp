@@ -0,0 +1,374 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host benchmark of the decoders of single wire receivers (see SbusDecoder and PpmDecoder).
+ *
+ * Builds the byte stream of a SBUS receiver (frames every 7 and 14 msec) and the edges of a PPM receiver (8 channels,
+ * 22.5 msec) for a drive cycle and measures the decode time per byte or edge and per frame. Then the sketch runs with
+ * every decoder as input source: the bytes and edges are fed at their timestamps up to the current time whenever the
+ * adapter looks for inputs, like an interrupt would have done. It reports the latency from the completion of a frame
+ * to the refresh of the adapter, which reads it, and the frames, which were replaced before they were read.
+ *
+ * A captured SBUS stream (raw bytes, e.g. from a logic analyzer or a second UART) is decoded instead of the built
+ * stream for the throughput measurement with -s.
+ *
+ * The first 2 seconds of the drive cycle hold the sticks in neutral for the calibration and are not measured.
+ *
+ * Usage: RcFrameDecoderBenchmark [-t <seconds>] [-l <loop duration in usec>] [-s <SBUS capture>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "BenchmarkSupport.h"
+
+#include "../PpmDecoder.h"
+#include "../RcCarLights.h"
+#include "../SbusDecoder.h"
+
+// duration of a SBUS byte in usec at 100000 baud 8E2
+static const unsigned long SBUS_BYTE_TIME = 120;
+
+// number of channels and period in usec of the PPM receiver
+static const uint8_t PPM_CHANNELS = 8;
+static const unsigned long PPM_PERIOD = 22500;
+
+// time in usec with the sticks in neutral at the start of the drive cycle, covers the calibration of the adapter
+static const unsigned long WARMUP_TIME = 2000000;
+
+// number of repetitions of every measurement
+static const int REPETITIONS = 5;
+
+/**
+ * byte of a SBUS stream or rising edge of a PPM signal
+ */
+typedef struct
+{
+    unsigned long micros;
+    uint8_t value;
+} Event_t;
+
+/**
+ * pulse widths in usec of the channels at the given time of the drive cycle: after the warm-up throttle and steering
+ * move in triangles, the 3rd channel toggles every 10 seconds
+ */
+static void getChannels(unsigned long pMicros, uint16_t pWidths[SbusDecoder::NUM_CHANNELS])
+{
+    for (uint8_t i = 0; i < SbusDecoder::NUM_CHANNELS; ++i)
+    {
+        pWidths[i] = 1500;
+    }
+    if (pMicros < WARMUP_TIME)
+    {
+        return;
+    }
+
+    unsigned long msec = (pMicros - WARMUP_TIME) / 1000;
+    long throttle = msec % 4000;
+    long steering = msec % 3000;
+    pWidths[0] = 1100 + ((steering < 1500) ? steering : 3000 - steering) * 800 / 1500;
+    pWidths[1] = 1100 + ((throttle < 2000) ? throttle : 4000 - throttle) * 800 / 2000;
+    pWidths[2] = ((msec / 10000) % 2) ? 2000 : 1000;
+}
+
+/**
+ * builds the byte stream of a SBUS receiver
+ */
+static void buildSbusStream(unsigned long pPeriod, unsigned long pDuration, std::vector<Event_t> &pEvents)
+{
+    uint16_t widths[SbusDecoder::NUM_CHANNELS];
+    uint8_t frame[SbusDecoder::FRAME_SIZE];
+    for (unsigned long start = 0; start + pPeriod <= pDuration; start += pPeriod)
+    {
+        getChannels(start, widths);
+        memset(frame, 0, sizeof(frame));
+        frame[0] = SbusDecoder::HEADER;
+        for (uint16_t bit = 0; bit < SbusDecoder::NUM_CHANNELS * 11; ++bit)
+        {
+            // inverse of SbusDecoder::toPulseWidth
+            uint16_t value = (widths[bit / 11] - 880) * 8 / 5;
+            if (value & (1 << (bit % 11)))
+            {
+                frame[1 + bit / 8] |= 1 << (bit % 8);
+            }
+        }
+        for (uint8_t i = 0; i < SbusDecoder::FRAME_SIZE; ++i)
+        {
+            Event_t event = { start + i * SBUS_BYTE_TIME, frame[i] };
+            pEvents.push_back(event);
+        }
+    }
+}
+
+/**
+ * builds the rising edges of a PPM receiver
+ */
+static void buildPpmStream(unsigned long pDuration, std::vector<Event_t> &pEvents)
+{
+    uint16_t widths[SbusDecoder::NUM_CHANNELS];
+    for (unsigned long start = 0; start + PPM_PERIOD <= pDuration; start += PPM_PERIOD)
+    {
+        getChannels(start, widths);
+        unsigned long edge = start;
+        for (uint8_t i = 0; i <= PPM_CHANNELS; ++i)
+        {
+            Event_t event = { edge, 0 };
+            pEvents.push_back(event);
+            edge += (i < PPM_CHANNELS) ? widths[i] : 0;
+        }
+    }
+}
+
+static inline void feed(SbusDecoder &pDecoder, const Event_t &pEvent)
+{
+    pDecoder.feed(pEvent.value, pEvent.micros);
+}
+
+static inline void feed(PpmDecoder &pDecoder, const Event_t &pEvent)
+{
+    pDecoder.handleEdge(pEvent.micros);
+}
+
+/**
+ * result of a measurement of a decoder
+ */
+typedef struct
+{
+    double seconds;
+    unsigned long long cycles;
+    unsigned long frames;
+    unsigned long errors;
+} DecoderMeasurement_t;
+
+/**
+ * decodes all events with a new decoder
+ */
+template<typename TDecoder>
+static DecoderMeasurement_t measure(const std::vector<Event_t> &pEvents)
+{
+    TDecoder decoder;
+
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < pEvents.size(); ++i)
+    {
+        feed(decoder, pEvents[i]);
+    }
+    DecoderMeasurement_t result;
+    stopwatch.stop(result);
+    result.frames = decoder.getFrameCount();
+    result.errors = decoder.getErrorCount();
+    return result;
+}
+
+/**
+ * prints the fastest of several measurements
+ */
+template<typename TDecoder>
+static void printThroughput(const char *pName, const char *pUnit, const std::vector<Event_t> &pEvents)
+{
+    DecoderMeasurement_t best = measureBest(REPETITIONS, [&]() { return measure<TDecoder>(pEvents); });
+    unsigned long frames = best.frames ? best.frames : 1;
+    printf("%-18s: %.1f ns/%s, %.0f cycles/%s, %.1f ns/frame (%lu frames, %lu errors)\n", pName,
+           best.seconds * 1e9 / pEvents.size(), pUnit, (double) best.cycles / pEvents.size(), pUnit,
+           best.seconds * 1e9 / frames, best.frames, best.errors);
+}
+
+/**
+ * Input source, which feeds the decoder with all events up to the current time before it is asked for inputs, and
+ * takes the latency of every frame it passes to the adapter.
+ */
+template<typename TDecoder>
+class ReceiverSource : public RcInputSource
+{
+public:
+    ReceiverSource(const std::vector<Event_t> &pEvents) :
+            mEvents(pEvents), mNext(0), mFrameCount(0), mReadFrames(0), mLatencySum(0), mMinLatency(~0UL),
+            mMaxLatency(0)
+    {
+    }
+
+    /**
+     * starts the statistics again, e.g. after the calibration, which reads the inputs at its own pace
+     */
+    void resetStatistics(void)
+    {
+        deliver();
+        // a frame, which is not read yet, belongs to the new statistics
+        mFrameCount = mDecoder.getFrameCount() - (mDecoder.hasNewInputs() ? 1 : 0);
+        mReadFrames = 0;
+        mLatencySum = 0;
+        mMinLatency = ~0UL;
+        mMaxLatency = 0;
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        deliver();
+        if (mDecoder.hasNewInputs())
+        {
+            unsigned long latency = micros() - mDecoder.getFrameMicros();
+            ++mReadFrames;
+            mLatencySum += latency;
+            mMinLatency = (latency < mMinLatency) ? latency : mMinLatency;
+            mMaxLatency = (latency > mMaxLatency) ? latency : mMaxLatency;
+        }
+        return mDecoder.read(pThrottle, pSteering, p3rdChannel);
+    }
+
+    virtual bool hasNewInputs(void)
+    {
+        deliver();
+        return mDecoder.hasNewInputs();
+    }
+
+    void print(const char *pName) const
+    {
+        unsigned long readFrames = mReadFrames ? mReadFrames : 1;
+        unsigned long frames = mDecoder.getFrameCount() - mFrameCount;
+        printf("%-18s: %5lu / %5lu / %5lu usec min / mean / max, %lu of %lu frames not read\n", pName, mMinLatency,
+               (unsigned long) (mLatencySum / readFrames), mMaxLatency, frames - mReadFrames, frames);
+    }
+
+private:
+    /**
+     * feeds all events up to the current time
+     */
+    void deliver(void)
+    {
+        unsigned long now = micros();
+        while (mNext < mEvents.size() && mEvents[mNext].micros <= now)
+        {
+            feed(mDecoder, mEvents[mNext++]);
+        }
+    }
+
+    TDecoder mDecoder;
+    const std::vector<Event_t> &mEvents;
+    size_t mNext;
+    unsigned long mFrameCount;
+    unsigned long mReadFrames;
+    unsigned long long mLatencySum;
+    unsigned long mMinLatency;
+    unsigned long mMaxLatency;
+};
+
+/**
+ * runs the sketch with a decoder as input source until the end of the events
+ */
+template<typename TDecoder>
+static void printLatency(const char *pName, const std::vector<Event_t> &pEvents, unsigned long pLoopMicros)
+{
+    ArduinoMock::reset();
+    ArduinoMock::setSerialCapture(false);
+
+    ReceiverSource<TDecoder> source(pEvents);
+    RcCarLights rcCarLights;
+    rcCarLights.setInputSource(&source);
+    rcCarLights.setup();
+
+    bool isWarmedUp = false;
+    unsigned long end = pEvents.back().micros;
+    while (ArduinoMock::getMicros() < end)
+    {
+        if (!isWarmedUp && WARMUP_TIME <= ArduinoMock::getMicros())
+        {
+            source.resetStatistics();
+            isWarmedUp = true;
+        }
+        rcCarLights.loop();
+        ArduinoMock::advanceMicros(pLoopMicros);
+    }
+
+    source.print(pName);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long seconds = 60;
+    unsigned long loopMicros = 1000;
+    const char *captureFileName = NULL;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "t:l:s:")))
+    {
+        switch (option)
+        {
+            case 't':
+                seconds = atol(optarg);
+                break;
+            case 'l':
+                loopMicros = atol(optarg);
+                break;
+            case 's':
+                captureFileName = optarg;
+                break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+
+    if (optind != argc || 0 == seconds || 0 == loopMicros)
+    {
+        fprintf(stderr, "usage: %s [-t <seconds>] [-l <loop duration in usec>] [-s <SBUS capture>]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Event_t> sbusFast;
+    std::vector<Event_t> sbusSlow;
+    std::vector<Event_t> ppm;
+    buildSbusStream(7000, seconds * 1000000UL, sbusFast);
+    buildSbusStream(14000, seconds * 1000000UL, sbusSlow);
+    buildPpmStream(seconds * 1000000UL, ppm);
+
+    if (captureFileName)
+    {
+        // a capture has no timestamps, the decoder finds the frames by their header and footer
+        std::vector<uint8_t> capture;
+        if (!readFile(captureFileName, capture))
+        {
+            return 1;
+        }
+        sbusFast.clear();
+        for (size_t i = 0; i < capture.size(); ++i)
+        {
+            Event_t event = { i * SBUS_BYTE_TIME, capture[i] };
+            sbusFast.push_back(event);
+        }
+        printThroughput<SbusDecoder>(captureFileName, "byte", sbusFast);
+    }
+    else
+    {
+        printThroughput<SbusDecoder>("SBUS", "byte", sbusFast);
+    }
+    printThroughput<PpmDecoder>("PPM", "edge", ppm);
+
+    printf("\nframe to refresh latency, loop duration %lu usec\n", loopMicros);
+    printLatency<SbusDecoder>("SBUS 7 msec", sbusFast.empty() ? sbusSlow : sbusFast, loopMicros);
+    printLatency<SbusDecoder>("SBUS 14 msec", sbusSlow, loopMicros);
+    printLatency<PpmDecoder>("PPM 22.5 msec", ppm, loopMicros);
+
+    return 0;
+}
@@ -0,0 +1,341 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host benchmark of the input policies of RemoteControlCarAdapter (see RcInputPolicy).
+ *
+ * Measures the time and, on x86, the TSC cycles of a read of the RC inputs from the pulse capture in three ways: the
+ * direct calls of the pulse capture written out in place, the PulseCaptureInput policy and a virtual call through
+ * RcInputSource. Then a whole refresh of the adapter is measured with the SyntheticInput policy and with the same
+ * generator as input source, and with a trace replayed by TraceReplayInput.
+ *
+ * The direct calls do the same work as the policy, so the policy must not be slower. Both are measured alternately in
+ * short runs; with -g it fails if the median ratio of the runs exceeds 1 by more than a noise margin of 3%, so it can
+ * be used as a gate.
+ *
+ * Usage: RcInputPolicyBenchmark [-n <reads>] [-g]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include "Arduino.h"
+#include "BenchmarkSupport.h"
+
+#include "../RemoteControlCarAdapter.h"
+
+// pins of the adapter
+static const int PIN_THROTTLE = VehicleConfig::PIN_THROTTLE;
+static const int PIN_STEERING = VehicleConfig::PIN_STEERING;
+static const int PIN_3RD_CHANNEL = VehicleConfig::PIN_3RD_CHANNEL;
+
+// number of repetitions of every measurement
+static const int REPETITIONS = 5;
+
+// the reads of the direct calls and the policy, which are compared with -g, are split into this number of runs
+static const int GATE_RUNS = 20;
+
+// noise of the median ratio of the runs, the policy may exceed the direct calls by this with -g
+static const double GATE_NOISE_MARGIN = 0.03;
+
+// time in usec between two refreshes of the adapter
+static const unsigned long REFRESH_PERIOD = 20000;
+
+/**
+ * state of a direct read, which the policy holds in its members
+ */
+typedef struct
+{
+    uint8_t lastPulseCount;
+    uint8_t lastChannelPulseCounts[PulseCapture::MAX_CHANNELS];
+    uint8_t newPulseMask;
+} DirectState_t;
+
+/**
+ * read of the adapter without the input policies: the pulse capture is called directly, including the new pulses
+ * of every channel, which the health check needs
+ */
+static inline unsigned long readDirect(DirectState_t &pState, unsigned long &pThrottle, unsigned long &pSteering,
+                                       unsigned long &p3rdChannel)
+{
+    pState.lastPulseCount = PulseCapture::getPulseCount();
+    pState.newPulseMask = 0;
+    for (uint8_t channel = 0; channel < PulseCapture::MAX_CHANNELS; ++channel)
+    {
+        uint8_t pulseCount = PulseCapture::getPulseCount(channel);
+        if (pulseCount != pState.lastChannelPulseCounts[channel])
+        {
+            pState.lastChannelPulseCounts[channel] = pulseCount;
+            pState.newPulseMask |= bit(channel);
+        }
+    }
+    pThrottle = PulseCapture::getPulseWidth(RcInputPolicy<PulseCaptureInput>::THROTTLE_CHANNEL);
+    pSteering = PulseCapture::getPulseWidth(RcInputPolicy<PulseCaptureInput>::STEERING_CHANNEL);
+    p3rdChannel = PulseCapture::getPulseWidth(RcInputPolicy<PulseCaptureInput>::THIRD_CHANNEL);
+    return millis();
+}
+
+/**
+ * the same read behind a virtual call
+ */
+class PulseCaptureSource : public RcInputSource
+{
+public:
+    PulseCaptureSource(void)
+    {
+        memset(&mState, 0, sizeof(mState));
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        return readDirect(mState, pThrottle, pSteering, p3rdChannel);
+    }
+
+    virtual bool hasNewInputs(void)
+    {
+        return PulseCapture::getPulseCount() != mState.lastPulseCount;
+    }
+
+private:
+    DirectState_t mState;
+};
+
+/**
+ * the generator of SyntheticInput as input source
+ */
+class SyntheticSource : public RcInputSource
+{
+public:
+    SyntheticSource(const SyntheticInput &pInput) :
+            mInput(pInput)
+    {
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        return mInput.read(SyntheticInput::ALL_CHANNELS, pThrottle, pSteering, p3rdChannel);
+    }
+
+private:
+    SyntheticInput mInput;
+};
+
+typedef enum
+{
+    DIRECT, POLICY, VIRTUAL
+} ReadMethod_t;
+
+/**
+ * reads the pulse capture pReads times, not inlined, so the code of every read method does not depend on the caller
+ */
+static Measurement_t __attribute__((noinline)) measureRead(ReadMethod_t pMethod, unsigned long pReads)
+{
+    Measurement_t result = { 0, 0, 0 };
+    unsigned long throttle, steering, thirdChannel;
+    DirectState_t state;
+    memset(&state, 0, sizeof(state));
+    PulseCaptureInput input;
+    PulseCaptureSource source;
+    // the compiler must not see the type of the source
+    RcInputSource * volatile sourcePointer = &source;
+    RcInputSource *virtualSource = sourcePointer;
+
+    Stopwatch stopwatch;
+    switch (pMethod)
+    {
+        case DIRECT:
+            for (unsigned long i = 0; i < pReads; ++i)
+            {
+                result.checksum += readDirect(state, throttle, steering, thirdChannel);
+                result.checksum += throttle + steering + thirdChannel + state.newPulseMask;
+                result.checksum += PulseCapture::getPulseCount() != state.lastPulseCount;
+            }
+            break;
+        case POLICY:
+            for (unsigned long i = 0; i < pReads; ++i)
+            {
+                result.checksum += input.read(PulseCaptureInput::ALL_CHANNELS, throttle, steering, thirdChannel);
+                result.checksum += throttle + steering + thirdChannel + input.getNewPulses();
+                result.checksum += input.hasNewInputs();
+            }
+            break;
+        case VIRTUAL:
+            for (unsigned long i = 0; i < pReads; ++i)
+            {
+                result.checksum += virtualSource->read(throttle, steering, thirdChannel);
+                result.checksum += throttle + steering + thirdChannel;
+                result.checksum += virtualSource->hasNewInputs();
+            }
+            break;
+    }
+    stopwatch.stop(result);
+    return result;
+}
+
+/**
+ * refreshes an adapter pRefreshes times, every refresh REFRESH_PERIOD after the previous one
+ */
+template<typename TInput>
+static Measurement_t measureRefresh(const TInput &pInput, RcInputSource *pSource, unsigned long pRefreshes)
+{
+    Measurement_t result = { 0, 0, 0 };
+    ArduinoMock::reset();
+    BasicRemoteControlCarAdapter<TInput> adapter(pInput);
+    adapter.setInputSource(pSource);
+    adapter.setupPins();
+    adapter.calibrate();
+
+    Stopwatch stopwatch;
+    for (unsigned long i = 0; i < pRefreshes; ++i)
+    {
+        ArduinoMock::advanceMicros(REFRESH_PERIOD);
+        adapter.refresh();
+        result.checksum += adapter.getThrottle() + adapter.getSteering() + adapter.getAcceleration();
+    }
+    stopwatch.stop(result);
+    return result;
+}
+
+/**
+ * encodes a trace of the drive of SyntheticInput
+ */
+static void buildTrace(const SyntheticInput &pInput, unsigned long pRecords, std::vector<uint8_t> &pTrace)
+{
+    SyntheticInput input(pInput);
+    RcTrace::Record_t previous = { 0, { 0, 0, 0 } };
+    uint8_t buffer[RcTrace::MAX_RECORD_SIZE];
+
+    ArduinoMock::reset();
+    pTrace.resize(RcTrace::MAGIC_SIZE);
+    RcTrace::writeMagic(&pTrace[0]);
+    for (unsigned long i = 0; i < pRecords; ++i)
+    {
+        unsigned long throttle, steering, thirdChannel;
+        RcTrace::Record_t record;
+        record.timestamp = input.read(SyntheticInput::ALL_CHANNELS, throttle, steering, thirdChannel);
+        record.widths[0] = throttle;
+        record.widths[1] = steering;
+        record.widths[2] = thirdChannel;
+        uint8_t size = RcTrace::encode(previous, record, 0 == i, buffer);
+        pTrace.insert(pTrace.end(), buffer, buffer + size);
+        previous = record;
+        ArduinoMock::advanceMicros(REFRESH_PERIOD);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long reads = 10000000;
+    bool isGate = false;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "n:g")))
+    {
+        switch (option)
+        {
+            case 'n':
+                reads = atol(optarg);
+                break;
+            case 'g':
+                isGate = true;
+                break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+
+    if (optind != argc || 0 == reads)
+    {
+        fprintf(stderr, "usage: %s [-n <reads>] [-g]\n", argv[0]);
+        return 1;
+    }
+
+    // the pulse capture holds the widths of a running receiver
+    ArduinoMock::reset();
+    PulseCaptureInput().setup(PIN_THROTTLE, PIN_STEERING, PIN_3RD_CHANNEL);
+    ArduinoMock::setPulseSignal(PIN_THROTTLE, 1500);
+    ArduinoMock::setPulseSignal(PIN_STEERING, 1400, ArduinoMock::RC_SIGNAL_PERIOD, 1500);
+    ArduinoMock::setPulseSignal(PIN_3RD_CHANNEL, 1000, ArduinoMock::RC_SIGNAL_PERIOD, 3000);
+    ArduinoMock::advanceTo(100000);
+
+    // the direct calls and the policy are measured alternately in short runs, so a disturbance of the host hits both
+    // alike, the gate takes the median of the ratios of the pairs
+    unsigned long gateReads = (reads + GATE_RUNS - 1) / GATE_RUNS;
+    Measurement_t direct = measureRead(DIRECT, gateReads);
+    Measurement_t policy = measureRead(POLICY, gateReads);
+    std::vector<double> ratios(1, policy.seconds / direct.seconds);
+    for (int i = 1; i < REPETITIONS * GATE_RUNS; ++i)
+    {
+        // the order is swapped every pair, so neither is favoured by running first
+        Measurement_t directRun, policyRun;
+        if (i % 2)
+        {
+            policyRun = measureRead(POLICY, gateReads);
+            directRun = measureRead(DIRECT, gateReads);
+        }
+        else
+        {
+            directRun = measureRead(DIRECT, gateReads);
+            policyRun = measureRead(POLICY, gateReads);
+        }
+        ratios.push_back(policyRun.seconds / directRun.seconds);
+        direct = (directRun.seconds < direct.seconds) ? directRun : direct;
+        policy = (policyRun.seconds < policy.seconds) ? policyRun : policy;
+    }
+    std::nth_element(ratios.begin(), ratios.begin() + ratios.size() / 2, ratios.end());
+    double ratio = ratios[ratios.size() / 2];
+    Measurement_t virtualCall = measureBest(REPETITIONS, [&]() { return measureRead(VIRTUAL, reads); });
+    printMeasurement("direct calls", "read", direct, gateReads);
+    printMeasurement("policy", "read", policy, gateReads);
+    printf("policy / direct   : %.3f (median of %d runs)\n", ratio, (int) ratios.size());
+    printMeasurement("virtual call", "read", virtualCall, reads);
+
+    // a refresh takes much longer than a read
+    unsigned long refreshes = reads / 10;
+    SyntheticInput synthetic(2000, 3000);
+    SyntheticSource syntheticSource(synthetic);
+    std::vector<uint8_t> trace;
+    buildTrace(synthetic, refreshes + 1000, trace);
+
+    printf("\n");
+    TraceReplayInput traceInput(&trace[0], trace.size());
+    printMeasurement("synthetic policy", "refresh",
+                     measureBest(REPETITIONS, [&]() { return measureRefresh(synthetic, NULL, refreshes); }),
+                     refreshes);
+    printMeasurement("synthetic source", "refresh",
+                     measureBest(REPETITIONS, [&]() { return measureRefresh(synthetic, &syntheticSource, refreshes); }),
+                     refreshes);
+    printMeasurement("trace policy", "refresh",
+                     measureBest(REPETITIONS, [&]() { return measureRefresh(traceInput, NULL, refreshes); }),
+                     refreshes);
+
+    if (isGate && ratio > 1 + GATE_NOISE_MARGIN)
+    {
+        printf("\npolicy is %.1f%% slower than the direct calls\n", (ratio - 1) * 100);
+        return 2;
+    }
+
+    return 0;
+}
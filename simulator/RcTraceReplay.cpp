@@ -0,0 +1,163 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Replay of a recorded RC trace (see RcTrace and RECORD_RC_TRACE in RcCarLights.h) on a host.
+ *
+ * The sketch runs against the arduino mock, the RC inputs are taken from the trace instead of the pins. Every record
+ * of the trace stands for an executed loop pass of the recording, so the replay runs one loop per record at the
+ * timestamp of the record as fast as the host allows. Like the simulator it counts the changes of the light outputs
+ * and folds them into a signature, which can be compared between firmware versions.
+ *
+ * Usage: RcTraceReplay [-c] [-o <telemetry file>] <trace file>
+ *
+ * -c prints every output change with its timestamp, -o writes the telemetry stream of the replay to a file, which can
+ * be read by tools/TelemetryDecoder.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <vector>
+
+#include "Arduino.h"
+#include "BenchmarkSupport.h"
+#include "LightOutputs.h"
+#include "RcTraceReplaySource.h"
+
+#include "../RcCarLights.h"
+
+// pins as used by RcCarLights
+
+int main(int argc, char *argv[])
+{
+    bool isChangeLogEnabled = false;
+    const char *telemetryFileName = NULL;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "co:")))
+    {
+        switch (option)
+        {
+            case 'c':
+                isChangeLogEnabled = true;
+                break;
+            case 'o':
+                telemetryFileName = optarg;
+                break;
+            default:
+                optind = argc + 1;
+                break;
+        }
+    }
+
+    if (optind + 1 != argc)
+    {
+        fprintf(stderr, "usage: %s [-c] [-o <telemetry file>] <trace file>\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> trace;
+    if (!readFile(argv[optind], trace))
+    {
+        return 1;
+    }
+
+    RcTraceReplaySource source(trace);
+    if (!source.isValid())
+    {
+        fprintf(stderr, "%s: not an RC trace\n", argv[optind]);
+        return 1;
+    }
+
+    ArduinoMock::reset();
+    ArduinoMock::setSerialCapture(NULL != telemetryFileName);
+
+    RcCarLights rcCarLights;
+    rcCarLights.setInputSource(&source);
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+    rcCarLights.setup();
+
+    unsigned long loops = 0;
+    unsigned long outputChanges = 0;
+    uint32_t lastOutputs = hashLightOutputs();
+    uint32_t signature = lastOutputs;
+
+    while (source.hasNext())
+    {
+        // the first pass calibrates the adapter and reads the calibration records, its delays move the clock forward
+        // like during the recording
+        unsigned long micros = source.peekTimestamp() * 1000UL;
+        if (0 < loops && ArduinoMock::getMicros() < micros)
+        {
+            ArduinoMock::advanceTo(micros);
+        }
+
+        rcCarLights.loop();
+        ++loops;
+
+        uint32_t outputs = hashLightOutputs();
+        if (outputs != lastOutputs)
+        {
+            ++outputChanges;
+            lastOutputs = outputs;
+            signature = (signature ^ outputs ^ (uint32_t) millis()) * 16777619u;
+
+            if (isChangeLogEnabled)
+            {
+                printf("%10lu ms  outputs %08x\n", millis(), outputs);
+            }
+        }
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    if (telemetryFileName)
+    {
+        FILE *file = fopen(telemetryFileName, "wb");
+        if (!file)
+        {
+            perror(telemetryFileName);
+            return 1;
+        }
+        const std::vector<uint8_t> &output = ArduinoMock::getSerialOutput();
+        if (!output.empty())
+        {
+            fwrite(&output[0], 1, output.size(), file);
+        }
+        fclose(file);
+    }
+
+    printf("trace bytes       : %lu\n", (unsigned long) trace.size());
+    printf("records           : %lu\n", source.getRecords());
+    printf("gaps              : %lu\n", source.getGaps());
+    printf("truncated         : %s\n", source.isTruncated() ? "yes" : "no");
+    printf("virtual time      : %.1f s\n", ArduinoMock::getMicros() / 1000000.0);
+    printf("wall time         : %.3f s\n", wallSeconds);
+    printf("loop passes       : %lu\n", loops);
+    printf("records/s         : %.0f\n", wallSeconds ? source.getRecords() / wallSeconds : 0.0);
+    printf("output changes    : %lu\n", outputChanges);
+    printf("output signature  : %08x\n", signature);
+
+    return 0;
+}
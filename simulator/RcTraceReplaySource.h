@@ -0,0 +1,188 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef RCTRACEREPLAYSOURCE_H_
+#define RCTRACEREPLAYSOURCE_H_
+
+#include <vector>
+
+#include "Arduino.h"
+
+#include "../RcInputSource.h"
+#include "../RcTrace.h"
+
+/**
+ * Input source, which replays a recorded RC trace (see RcTrace) on the virtual clock of the arduino mock.
+ *
+ * Every read returns the next record and moves the virtual clock forward to the timestamp of the record, so millis()
+ * in the sketch returns the same values as during the recording.
+ */
+class RcTraceReplaySource : public RcInputSource
+{
+public:
+    /**
+     * constructor
+     *
+     * @param pTrace recorded trace including the magic bytes
+     */
+    RcTraceReplaySource(const std::vector<uint8_t> &pTrace) :
+            mTrace(pTrace), mPosition(0), misNextAvailable(false), mRecords(0), mGaps(0), misValid(false)
+    {
+        mCurrent.timestamp = 0;
+        for (uint8_t i = 0; i < RcTrace::NUM_CHANNELS; ++i)
+        {
+            mCurrent.widths[i] = 0;
+        }
+        mNext = mCurrent;
+
+        if (RcTrace::MAGIC_SIZE <= mTrace.size() && RcTrace::isMagic(&mTrace[0]))
+        {
+            mPosition = RcTrace::MAGIC_SIZE;
+            misValid = true;
+            decodeNext();
+        }
+    }
+
+    /**
+     * @return true if the trace starts with the magic bytes
+     */
+    bool isValid(void) const
+    {
+        return misValid;
+    }
+
+    /**
+     * @return true if another record is available
+     */
+    bool hasNext(void) const
+    {
+        return misNextAvailable;
+    }
+
+    /**
+     * @return timestamp of the next record in msec
+     */
+    unsigned long peekTimestamp(void) const
+    {
+        return mNext.timestamp;
+    }
+
+    /**
+     * @return true if the trace ends with data, which is not a complete record
+     */
+    bool isTruncated(void) const
+    {
+        return misValid && mPosition < mTrace.size();
+    }
+
+    /**
+     * @return number of records read
+     */
+    unsigned long getRecords(void) const
+    {
+        return mRecords;
+    }
+
+    /**
+     * @return number of gaps in the trace, i.e. absolute records after the first one
+     */
+    unsigned long getGaps(void) const
+    {
+        return mGaps;
+    }
+
+    /**
+     * returns the next record and moves the virtual clock to its timestamp. At the end of the trace the last record
+     * is repeated.
+     */
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        if (misNextAvailable)
+        {
+            mCurrent = mNext;
+            ++mRecords;
+            decodeNext();
+
+            unsigned long micros = mCurrent.timestamp * 1000UL;
+            if (ArduinoMock::getMicros() < micros)
+            {
+                ArduinoMock::advanceTo(micros);
+            }
+        }
+
+        pThrottle = mCurrent.widths[0];
+        pSteering = mCurrent.widths[1];
+        p3rdChannel = mCurrent.widths[2];
+        return mCurrent.timestamp;
+    }
+
+private:
+    /**
+     * decodes the record following the current one
+     */
+    void decodeNext(void)
+    {
+        RcTrace::Record_t record;
+        bool isAbsolute = false;
+        uint8_t size = 0;
+
+        if (mPosition < mTrace.size())
+        {
+            size = RcTrace::decode(mCurrent, &mTrace[mPosition], mTrace.size() - mPosition, record, isAbsolute);
+        }
+
+        misNextAvailable = (0 != size);
+        if (misNextAvailable)
+        {
+            mNext = record;
+            mPosition += size;
+            if (isAbsolute && (size_t) (RcTrace::MAGIC_SIZE + size) < mPosition)
+            {
+                ++mGaps;
+            }
+        }
+    }
+
+    // recorded trace
+    const std::vector<uint8_t> &mTrace;
+
+    // position of the record following mNext
+    size_t mPosition;
+
+    // last record returned by read
+    RcTrace::Record_t mCurrent;
+
+    // record returned by the next read
+    RcTrace::Record_t mNext;
+
+    // true if mNext holds a record
+    bool misNextAvailable;
+
+    // number of records read
+    unsigned long mRecords;
+
+    // number of absolute records after the first one
+    unsigned long mGaps;
+
+    // true if the trace starts with the magic bytes
+    bool misValid;
+};
+
+#endif /* RCTRACEREPLAYSOURCE_H_ */
@@ -0,0 +1,163 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host benchmark of the xenon brightness calculation.
+ *
+ * Compares the fixed point XenonLightSwitchBehaviour with the former float curve over repeated switch on/off cycles
+ * and reports the time and, on x86, the TSC cycles per call and the maximal deviation. On a host with FPU the float version is not much slower,
+ * the benchmark mainly guards against regressions; the saving on an AVR without FPU is much larger.
+ *
+ * Usage: XenonBrightnessBenchmark [<number of cycles>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "BenchmarkSupport.h"
+
+#include "../XenonLightSwitchBehaviour.h"
+#include "../unittests/XenonFloatReference.h"
+
+// duration of a switch on/off cycle in msec, long enough to reach the end of both curves
+static const long CYCLE_ON_DURATION = 2200;
+static const long CYCLE_OFF_DURATION = 600;
+
+// number of repetitions of every measurement
+static const int REPETITIONS = 3;
+
+/**
+ * runs one switch on or off curve of the fixed point behaviour
+ *
+ * @param pWithBrightness false to run the virtual clock only, which measures the overhead of the mock
+ * @return sum of all brightness values
+ */
+static unsigned long runFixedPoint(XenonLightSwitchBehaviour &pBehaviour, bool pIsOn, long pDuration,
+                                   bool pWithBrightness)
+{
+    unsigned long sum = 0;
+
+    if (pWithBrightness)
+    {
+        pBehaviour.setLightStatus(pIsOn ? LightSwitchBehaviour::ON : LightSwitchBehaviour::OFF);
+    }
+    unsigned long start = millis();
+
+    for (long t = 0; t < pDuration; ++t)
+    {
+        ArduinoMock::advanceTo((start + t) * 1000);
+        if (pWithBrightness)
+        {
+            sum += pBehaviour.getBrightness();
+        }
+    }
+    ArduinoMock::advanceTo((start + pDuration) * 1000);
+    return sum;
+}
+
+/**
+ * runs the fixed point behaviour over switch on/off cycles
+ *
+ * @param pWithBrightness false to run the virtual clock only, which measures the overhead of the mock
+ */
+static Measurement_t measureFixedPoint(XenonLightSwitchBehaviour &pBehaviour, long pCycles, bool pWithBrightness)
+{
+    Measurement_t result = { 0, 0, 0 };
+
+    Stopwatch stopwatch;
+    for (long cycle = 0; cycle < pCycles; ++cycle)
+    {
+        for (int on = 1; on >= 0; --on)
+        {
+            result.checksum += runFixedPoint(pBehaviour, on, on ? CYCLE_ON_DURATION : CYCLE_OFF_DURATION,
+                                             pWithBrightness);
+        }
+    }
+    stopwatch.stop(result);
+    return result;
+}
+
+/**
+ * runs the float curve over switch on/off cycles
+ */
+static Measurement_t measureFloatReference(long pCycles)
+{
+    Measurement_t result = { 0, 0, 0 };
+
+    Stopwatch stopwatch;
+    for (long cycle = 0; cycle < pCycles; ++cycle)
+    {
+        for (int on = 1; on >= 0; --on)
+        {
+            long duration = on ? CYCLE_ON_DURATION : CYCLE_OFF_DURATION;
+            for (long t = 0; t < duration; ++t)
+            {
+                result.checksum += XenonFloatReference::getPwmValue(on, t);
+            }
+        }
+    }
+    stopwatch.stop(result);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    long cycles = (1 < argc) ? atol(argv[1]) : 2000;
+
+    ArduinoMock::reset();
+    XenonLightSwitchBehaviour behaviour;
+
+    // maximal deviation from the float curve
+    int maxDeviation = 0;
+    for (int on = 1; on >= 0; --on)
+    {
+        behaviour.setLightStatus(on ? LightSwitchBehaviour::ON : LightSwitchBehaviour::OFF);
+        unsigned long start = millis();
+        long duration = on ? CYCLE_ON_DURATION : CYCLE_OFF_DURATION;
+
+        for (long t = 0; t < duration; ++t)
+        {
+            ArduinoMock::advanceTo((start + t) * 1000);
+            int deviation = abs(behaviour.getBrightness() - XenonFloatReference::getPwmValue(on, t));
+            if (deviation > maxDeviation)
+            {
+                maxDeviation = deviation;
+            }
+        }
+        ArduinoMock::advanceTo((start + duration) * 1000);
+    }
+
+    Measurement_t clock = measureBest(REPETITIONS, [&]() { return measureFixedPoint(behaviour, cycles, false); });
+    Measurement_t fixed = measureBest(REPETITIONS, [&]() { return measureFixedPoint(behaviour, cycles, true); });
+    Measurement_t floatReference = measureBest(REPETITIONS, [&]() { return measureFloatReference(cycles); });
+
+    // the virtual clock is advanced in the fixed point run only, its cost is removed
+    fixed.seconds -= clock.seconds;
+    fixed.cycles = (fixed.cycles > clock.cycles) ? fixed.cycles - clock.cycles : 0;
+
+    unsigned long calls = cycles * (CYCLE_ON_DURATION + CYCLE_OFF_DURATION);
+    printf("calls             : %lu\n", calls);
+    printMeasurement("fixed point", "call", fixed, calls);
+    printMeasurement("float reference", "call", floatReference, calls);
+    printf("max deviation     : %d PWM units\n", maxDeviation);
+
+    return 0;
+}
@@ -0,0 +1,472 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host tool to break down the RAM and flash usage of the firmware by class and by symbol.
+ *
+ * The symbol table of the ELF file of the sketch (e.g. rccarlights.ino.elf in the build directory of the Arduino IDE,
+ * which is shown with verbose output during compilation) is read, every object and function is attributed to its
+ * class, which is taken from the demangled name. Static symbols without a class are attributed to their source file,
+ * global ones to <global>. Bytes of a section without a symbol (string literals, the vector table, padding) are listed
+ * as <unnamed> of the section. Writable sections take RAM, initialized ones (.data) flash for their initial values in
+ * addition. Heap and stack are not part of the ELF file, e.g. the pixel buffer of the NeoPixel strip (3 bytes per
+ * pixel) is allocated at runtime.
+ *
+ * Usage: ElfFootprint [-s] <elf file>
+ *
+ * -s lists every symbol in addition to the classes.
+ */
+
+#include <cxxabi.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// section holds writable data
+static const unsigned long SECTION_WRITE = 0x1;
+
+// section is part of the memory image
+static const unsigned long SECTION_ALLOC = 0x2;
+
+// section type of the symbol table
+static const unsigned long SECTION_SYMTAB = 2;
+
+// section type without data in the file, e.g. .bss
+static const unsigned long SECTION_NOBITS = 8;
+
+// symbol types of data objects, functions and source files
+static const uint8_t SYMBOL_OBJECT = 1;
+static const uint8_t SYMBOL_FUNC = 2;
+static const uint8_t SYMBOL_FILE = 4;
+
+// symbol binding of static symbols
+static const uint8_t BINDING_LOCAL = 0;
+
+// first reserved section index, symbols with a larger index are absolute or common
+static const unsigned long SECTION_INDEX_RESERVED = 0xff00;
+
+/**
+ * RAM and flash in bytes
+ */
+typedef struct
+{
+    unsigned long ram;
+    unsigned long flash;
+} Footprint_t;
+
+/**
+ * allocated section of the ELF file
+ */
+typedef struct
+{
+    std::string name;
+    unsigned long flags;
+    unsigned long type;
+    unsigned long size;
+    unsigned long attributed;
+} Section_t;
+
+/**
+ * RAM and flash usage of a symbol or class
+ */
+typedef struct
+{
+    std::string name;
+    Footprint_t footprint;
+} Entry_t;
+
+// content of the ELF file
+static std::vector<uint8_t> sImage;
+
+// true for ELF64 (host), false for ELF32 (AVR)
+static bool sIs64;
+
+/**
+ * reads a little endian word of the ELF file, exits on a truncated file
+ *
+ * @param pOffset offset in the file
+ * @param pSize size of the word in bytes (1, 2, 4 or 8)
+ */
+static unsigned long readWord(unsigned long pOffset, unsigned int pSize)
+{
+    if (sImage.size() < pOffset + pSize)
+    {
+        fprintf(stderr, "truncated ELF file\n");
+        exit(1);
+    }
+
+    unsigned long value = 0;
+    for (unsigned int i = pSize; 0 < i; --i)
+    {
+        value = (value << 8) | sImage[pOffset + i - 1];
+    }
+    return value;
+}
+
+/**
+ * reads a word, whose size depends on the ELF class (address, offset or size)
+ */
+static unsigned long readAddress(unsigned long pOffset)
+{
+    return readWord(pOffset, sIs64 ? 8 : 4);
+}
+
+/**
+ * @return zero terminated string at pOffset of the string table at pTableOffset
+ */
+static const char *getString(unsigned long pTableOffset, unsigned long pOffset)
+{
+    unsigned long offset = pTableOffset + pOffset;
+    if (sImage.size() <= offset || !memchr(&sImage[offset], 0, sImage.size() - offset))
+    {
+        return "";
+    }
+    return (const char *) &sImage[offset];
+}
+
+/**
+ * @return the RAM and flash used by pSize bytes of section pSection
+ */
+static Footprint_t getFootprint(const Section_t &pSection, unsigned long pSize)
+{
+    Footprint_t footprint = { 0, 0 };
+    if (pSection.flags & SECTION_WRITE)
+    {
+        footprint.ram = pSize;
+        // the initial values are copied from flash on startup
+        footprint.flash = (SECTION_NOBITS == pSection.type) ? 0 : pSize;
+    }
+    else
+    {
+        footprint.flash = pSize;
+    }
+    return footprint;
+}
+
+/**
+ * @return true for allocated sections, which are neither RAM nor flash of the controller (EEPROM, fuses, ...)
+ */
+static bool isForeignSection(const std::string &pName)
+{
+    return ".eeprom" == pName || ".fuse" == pName || ".lock" == pName || ".signature" == pName;
+}
+
+/**
+ * @return pSymbol demangled, or unchanged if it is no C++ symbol
+ */
+static std::string demangle(const char *pSymbol)
+{
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(pSymbol, NULL, NULL, &status);
+    if (!demangled)
+    {
+        return pSymbol;
+    }
+    std::string name(demangled);
+    free(demangled);
+    return name;
+}
+
+/**
+ * determines the class of a demangled symbol name, e.g. "BasicRcCarLights<CamaroVehicleConfig>" for
+ * "BasicRcCarLights<CamaroVehicleConfig>::loop()" or "vtable for BasicRcCarLights<CamaroVehicleConfig>"
+ *
+ * @return the class or an empty string for symbols outside a class
+ */
+static std::string getClassName(std::string pName)
+{
+    static const char *sClassPrefixes[] = { "vtable for ", "VTT for ", "typeinfo for ", "typeinfo name for " };
+    static const char *sSkippedPrefixes[] = { "guard variable for ", "non-virtual thunk to ", "virtual thunk to " };
+
+    for (size_t i = 0; i < sizeof(sClassPrefixes) / sizeof(sClassPrefixes[0]); ++i)
+    {
+        if (0 == pName.compare(0, strlen(sClassPrefixes[i]), sClassPrefixes[i]))
+        {
+            return pName.substr(strlen(sClassPrefixes[i]));
+        }
+    }
+    for (size_t i = 0; i < sizeof(sSkippedPrefixes) / sizeof(sSkippedPrefixes[0]); ++i)
+    {
+        if (0 == pName.compare(0, strlen(sSkippedPrefixes[i]), sSkippedPrefixes[i]))
+        {
+            pName.erase(0, strlen(sSkippedPrefixes[i]));
+        }
+    }
+
+    // the parentheses of an anonymous namespace are no parameter list
+    static const std::string ANONYMOUS = "(anonymous namespace)";
+    for (size_t position; std::string::npos != (position = pName.find(ANONYMOUS));)
+    {
+        pName.replace(position, ANONYMOUS.size(), "{anonymous}");
+    }
+
+    // the qualified name ends at the parameter list or at an operator, it starts behind the return type
+    size_t start = 0;
+    size_t scopeEnd = std::string::npos;
+    int depth = 0;
+    for (size_t i = 0; i < pName.size(); ++i)
+    {
+        char c = pName[i];
+        if (0 == depth && 0 == pName.compare(i, 8, "operator") && (0 == i || ':' == pName[i - 1]))
+        {
+            break;
+        }
+        if ('<' == c || '(' == c || '[' == c)
+        {
+            if (0 == depth && '(' == c)
+            {
+                break;
+            }
+            ++depth;
+        }
+        else if ('>' == c || ')' == c || ']' == c)
+        {
+            --depth;
+        }
+        else if (0 == depth && ' ' == c)
+        {
+            start = i + 1;
+            scopeEnd = std::string::npos;
+        }
+        else if (0 == depth && ':' == c && i + 1 < pName.size() && ':' == pName[i + 1])
+        {
+            scopeEnd = i;
+            ++i;
+        }
+    }
+
+    return (std::string::npos == scopeEnd) ? std::string() : pName.substr(start, scopeEnd - start);
+}
+
+/**
+ * adds pFootprint to the entry pName of pEntries
+ */
+static void addFootprint(std::map<std::string, Footprint_t> &pEntries, const std::string &pName,
+                         const Footprint_t &pFootprint)
+{
+    Footprint_t &entry = pEntries[pName];
+    entry.ram += pFootprint.ram;
+    entry.flash += pFootprint.flash;
+}
+
+/**
+ * orders entries by RAM, then by flash, both descending
+ */
+static bool isLarger(const Entry_t &pLeft, const Entry_t &pRight)
+{
+    if (pLeft.footprint.ram != pRight.footprint.ram)
+    {
+        return pLeft.footprint.ram > pRight.footprint.ram;
+    }
+    if (pLeft.footprint.flash != pRight.footprint.flash)
+    {
+        return pLeft.footprint.flash > pRight.footprint.flash;
+    }
+    return pLeft.name < pRight.name;
+}
+
+/**
+ * prints the entries sorted by RAM and flash
+ *
+ * @param pTitle heading of the name column
+ */
+static void printEntries(const std::map<std::string, Footprint_t> &pEntries, const char *pTitle)
+{
+    std::vector<Entry_t> entries;
+    for (std::map<std::string, Footprint_t>::const_iterator it = pEntries.begin(); it != pEntries.end(); ++it)
+    {
+        Entry_t entry = { it->first, it->second };
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), isLarger);
+
+    printf("\n#    RAM  flash  %s\n", pTitle);
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        printf("%8lu %6lu  %s\n", entries[i].footprint.ram, entries[i].footprint.flash, entries[i].name.c_str());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool isListingSymbols = false;
+
+    int option;
+    while (-1 != (option = getopt(argc, argv, "s")))
+    {
+        switch (option)
+        {
+            case 's':
+                isListingSymbols = true;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-s] <elf file>\n", argv[0]);
+                return 1;
+        }
+    }
+    if (optind + 1 != argc)
+    {
+        fprintf(stderr, "usage: %s [-s] <elf file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[optind], "rb");
+    if (!file)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    uint8_t buffer[4096];
+    size_t length;
+    while (0 < (length = fread(buffer, 1, sizeof(buffer), file)))
+    {
+        sImage.insert(sImage.end(), buffer, buffer + length);
+    }
+    fclose(file);
+
+    // only little endian files are supported, as used by AVR and x86
+    if (16 > sImage.size() || 0 != memcmp(&sImage[0], "\177ELF", 4) || 1 != sImage[5]
+            || (1 != sImage[4] && 2 != sImage[4]))
+    {
+        fprintf(stderr, "%s: no little endian ELF file\n", argv[optind]);
+        return 1;
+    }
+    sIs64 = (2 == sImage[4]);
+
+    unsigned long sectionHeaders = readAddress(sIs64 ? 0x28 : 0x20);
+    unsigned long sectionHeaderSize = readWord(sIs64 ? 0x3a : 0x2e, 2);
+    unsigned long sectionCount = readWord(sIs64 ? 0x3c : 0x30, 2);
+    unsigned long sectionNameIndex = readWord(sIs64 ? 0x3e : 0x32, 2);
+    unsigned long sectionNames = readAddress(sectionHeaders + sectionNameIndex * sectionHeaderSize + (sIs64 ? 24 : 16));
+
+    std::vector<Section_t> sections(sectionCount);
+    unsigned long symbolTable = 0;
+    unsigned long symbolTableSize = 0;
+    unsigned long symbolSize = 0;
+    unsigned long stringTable = 0;
+    for (unsigned long index = 0; index < sectionCount; ++index)
+    {
+        unsigned long header = sectionHeaders + index * sectionHeaderSize;
+        Section_t &section = sections[index];
+        section.name = getString(sectionNames, readWord(header, 4));
+        section.type = readWord(header + 4, 4);
+        section.flags = readAddress(header + 8);
+        section.size = readAddress(header + (sIs64 ? 32 : 20));
+        section.attributed = 0;
+
+        if (SECTION_SYMTAB == section.type)
+        {
+            symbolTable = readAddress(header + (sIs64 ? 24 : 16));
+            symbolTableSize = section.size;
+            symbolSize = readAddress(header + (sIs64 ? 56 : 36));
+            unsigned long link = readWord(header + (sIs64 ? 40 : 24), 4);
+            stringTable = readAddress(sectionHeaders + link * sectionHeaderSize + (sIs64 ? 24 : 16));
+        }
+    }
+    if (!symbolTable || !symbolSize)
+    {
+        fprintf(stderr, "%s: no symbol table, the file is stripped\n", argv[optind]);
+        return 1;
+    }
+
+    std::map<std::string, Footprint_t> classes;
+    std::map<std::string, Footprint_t> symbols;
+    // aliases (e.g. the complete and base object constructors) share their address
+    std::set<std::pair<unsigned long, unsigned long> > addresses;
+    std::string sourceFile;
+
+    for (unsigned long offset = symbolTable; offset + symbolSize <= symbolTable + symbolTableSize; offset += symbolSize)
+    {
+        unsigned long name = readWord(offset, 4);
+        uint8_t info = (uint8_t) readWord(offset + (sIs64 ? 4 : 12), 1);
+        unsigned long index = readWord(offset + (sIs64 ? 6 : 14), 2);
+        unsigned long value = readAddress(offset + (sIs64 ? 8 : 4));
+        unsigned long size = readAddress(offset + (sIs64 ? 16 : 8));
+        uint8_t type = info & 0xf;
+        uint8_t binding = info >> 4;
+
+        // static symbols follow the symbol of their source file
+        if (SYMBOL_FILE == type)
+        {
+            sourceFile = getString(stringTable, name);
+            continue;
+        }
+        if ((SYMBOL_OBJECT != type && SYMBOL_FUNC != type) || 0 == size || 0 == index || SECTION_INDEX_RESERVED <= index
+                || sections.size() <= index)
+        {
+            continue;
+        }
+        Section_t &section = sections[index];
+        if (!(section.flags & SECTION_ALLOC) || isForeignSection(section.name)
+                || !addresses.insert(std::make_pair(index, value)).second)
+        {
+            continue;
+        }
+
+        section.attributed += size;
+        Footprint_t footprint = getFootprint(section, size);
+        std::string symbol = demangle(getString(stringTable, name));
+        std::string className = getClassName(symbol);
+        if (className.empty())
+        {
+            className = (BINDING_LOCAL == binding && !sourceFile.empty()) ? sourceFile : "<global>";
+        }
+        addFootprint(classes, className, footprint);
+        addFootprint(symbols, symbol, footprint);
+    }
+
+    Footprint_t total = { 0, 0 };
+    printf("# RAM and flash usage of %s in bytes\n", argv[optind]);
+    printf("\n#    RAM  flash  section (unnamed bytes)\n");
+    for (size_t index = 0; index < sections.size(); ++index)
+    {
+        const Section_t &section = sections[index];
+        if (!(section.flags & SECTION_ALLOC) || isForeignSection(section.name) || 0 == section.size)
+        {
+            continue;
+        }
+        Footprint_t footprint = getFootprint(section, section.size);
+        total.ram += footprint.ram;
+        total.flash += footprint.flash;
+        unsigned long unnamed = (section.attributed < section.size) ? section.size - section.attributed : 0;
+        printf("%8lu %6lu  %s (%lu)\n", footprint.ram, footprint.flash, section.name.c_str(), unnamed);
+        if (unnamed)
+        {
+            addFootprint(classes, "<unnamed " + section.name + ">", getFootprint(section, unnamed));
+        }
+    }
+    printf("%8lu %6lu  total\n", total.ram, total.flash);
+
+    printEntries(classes, "class");
+    if (isListingSymbols)
+    {
+        printEntries(symbols, "symbol");
+    }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+/**
+ * Host tool to decode the binary telemetry stream of the light controller into readable rows.
+ *
+ * The stream is read from the given file (e.g. the serial device) or from stdin. The decoder resynchronizes on the
+ * sync bytes, skips frames with invalid checksum and reports lost frames detected by gaps in the sequence numbers.
+ *
+ * Usage: TelemetryDecoder [<file>]
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../TelemetryFrame.h"
+
+static const char *sThrottleNames[] = { "FORWARD", "STOP", "BACKWARD", "UNDEF" };
+static const char *sSteeringNames[] = { "LEFT", "NEUTRAL", "RIGHT", "UNDEF" };
+
+/**
+ * prints a decoded frame as a single row
+ */
+static void printFrame(const TelemetryFrame &pFrame)
+{
+    printf("%10u %3u  %c%c%c%c%c%c%c  %-8s %-8s %-7s %-7s %6d  %5u %5u %5u  %c%c%c%c%c\n", pFrame.timestamp,
+           pFrame.sequence, (pFrame.lightStatus & TelemetryFrame::PARKING_LIGHT_BIT) ? 'P' : '-',
+           (pFrame.lightStatus & TelemetryFrame::HEADLIGHT_BIT) ? 'H' : '-',
+           (pFrame.lightStatus & TelemetryFrame::LEFT_BLINKER_BIT) ? 'L' : '-',
+           (pFrame.lightStatus & TelemetryFrame::RIGHT_BLINKER_BIT) ? 'R' : '-',
+           (pFrame.lightStatus & TelemetryFrame::BACKUP_LIGHT_BIT) ? 'U' : '-',
+           (pFrame.lightStatus & TelemetryFrame::BRAKE_LIGHT_BIT) ? 'B' : '-',
+           (pFrame.lightStatus & TelemetryFrame::BLINKING_ON_BIT) ? '*' : '-', sThrottleNames[pFrame.throttle],
+           sThrottleNames[pFrame.throttleSwitch], sSteeringNames[pFrame.steering],
+           sSteeringNames[pFrame.steeringSwitch], pFrame.acceleration, pFrame.throttleValue, pFrame.steeringValue,
+           pFrame.thirdChannelValue, (pFrame.switches & TelemetryFrame::LIGHT_SWITCH_BIT) ? 'L' : '-',
+           (pFrame.switches & TelemetryFrame::EMERGENCY_LIGHT_BAR_SWITCH_BIT) ? 'E' : '-',
+           (pFrame.switches & TelemetryFrame::TRAFFIC_LIGHT_BAR_SWITCH_BIT) ? 'T' : '-',
+           (pFrame.switches & TelemetryFrame::SIREN_SWITCH_BIT) ? 'S' : '-',
+           (pFrame.switches & TelemetryFrame::FAILSAFE_BIT) ? 'F' : '-');
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *input = stdin;
+
+    if (1 < argc)
+    {
+        input = fopen(argv[1], "rb");
+        if (!input)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    printf("# timestamp seq  lights   throttle switch   steering switch   accel    thr   str   3rd  switches\n");
+    printf("#                PHLRUB*                                                               LETSF\n");
+
+    uint8_t buffer[TelemetryFrame::SIZE];
+    size_t filled = 0;
+    unsigned long frames = 0;
+    unsigned long lostFrames = 0;
+    unsigned long invalidFrames = 0;
+    bool hasLastSequence = false;
+    uint8_t lastSequence = 0;
+
+    int c;
+    while (EOF != (c = fgetc(input)))
+    {
+        buffer[filled++] = (uint8_t) c;
+
+        // wait for the sync bytes
+        if ((1 == filled && TelemetryFrame::SYNC_1 != buffer[0])
+                || (2 == filled && TelemetryFrame::SYNC_2 != buffer[1]))
+        {
+            filled = (TelemetryFrame::SYNC_1 == buffer[filled - 1]) ? 1 : 0;
+            buffer[0] = TelemetryFrame::SYNC_1;
+            continue;
+        }
+
+        if (TelemetryFrame::SIZE > filled)
+        {
+            continue;
+        }
+
+        TelemetryFrame frame;
+        if (frame.decode(buffer))
+        {
+            if (hasLastSequence)
+            {
+                lostFrames += (uint8_t) (frame.sequence - lastSequence - 1);
+            }
+            hasLastSequence = true;
+            lastSequence = frame.sequence;
+            ++frames;
+            printFrame(frame);
+            filled = 0;
+        }
+        else
+        {
+            // resynchronize behind the invalid sync bytes
+            ++invalidFrames;
+            size_t next = 1;
+            while (next < filled && TelemetryFrame::SYNC_1 != buffer[next])
+            {
+                ++next;
+            }
+            memmove(buffer, buffer + next, filled - next);
+            filled -= next;
+        }
+    }
+
+    fprintf(stderr, "frames: %lu  lost: %lu  invalid: %lu\n", frames, lostFrames, invalidFrames);
+
+    if (stdin != input)
+    {
+        fclose(input);
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+#include "Adafruit_NeoPixel.h"
+#include "../CamaroRcCarLightController.h"
+#include "../KeyframeLightSwitchBehaviour.h"
+
+// blinker color as shown by the LEDs after the gamma correction
+static const uint32_t BLINKER_COLOR = Adafruit_NeoPixel::Color(127, 127, 0);
+
+/**
+ * @return color of a pixel as shown last
+ */
+static uint32_t getShownColor(uint16_t pPixel)
+{
+    return Adafruit_NeoPixel::getLastShownStrip()->getShownPixelColor(pPixel);
+}
+
+/**
+ * @return red channel of a color
+ */
+static uint8_t getRed(uint32_t pColor)
+{
+    return (pColor >> 16) & 0xFF;
+}
+
+// Without behaviours the pixels switch hard
+TEST(CamaroRcCarLightControllerTest, HardSwitching) {
+    ArduinoMock::reset();
+    CamaroRcCarLightController controller;
+    controller.setupPins();
+
+    AbstractRcCarLightController::CarLightsStatus_t status = { 0, 0, 0, 0, 0, 0 };
+    controller.loop(status);
+    controller.showFrame();
+    EXPECT_EQ(0U, getShownColor(CamaroRcCarLightController::BLINKER_FRONT_LEFT));
+
+    status.leftBlinker = 1;
+    controller.loop(status);
+    controller.showFrame();
+    EXPECT_EQ(BLINKER_COLOR, getShownColor(CamaroRcCarLightController::BLINKER_FRONT_LEFT));
+    EXPECT_TRUE(controller.isSteady());
+}
+
+// The frame is calculated by loop and shown by showFrame only, a frame shown already is not sent again
+TEST(CamaroRcCarLightControllerTest, DeferredShow) {
+    ArduinoMock::reset();
+    CamaroRcCarLightController controller;
+    controller.setupPins();
+
+    AbstractRcCarLightController::CarLightsStatus_t status = { 0, 0, 0, 0, 0, 0 };
+    controller.loop(status);
+    controller.showFrame();
+    EXPECT_EQ(1UL, controller.getPushedFrameCount());
+
+    status.leftBlinker = 1;
+    controller.loop(status);
+    EXPECT_EQ(0U, getShownColor(CamaroRcCarLightController::BLINKER_FRONT_LEFT));
+    EXPECT_EQ(1UL, controller.getPushedFrameCount());
+
+    controller.showFrame();
+    EXPECT_EQ(BLINKER_COLOR, getShownColor(CamaroRcCarLightController::BLINKER_FRONT_LEFT));
+    EXPECT_EQ(2UL, controller.getPushedFrameCount());
+
+    controller.loop(status);
+    controller.showFrame();
+    EXPECT_EQ(2UL, controller.getPushedFrameCount());
+    EXPECT_EQ(1UL, controller.getSkippedFrameCount());
+}
+
+// A behaviour of a light type fades all its pixels between their colors with the light off and on
+TEST(CamaroRcCarLightControllerTest, FadingBlinker) {
+    ArduinoMock::reset();
+    CamaroRcCarLightController controller;
+    KeyframeLightSwitchBehaviour fade(&KeyframeLightSwitchBehaviour::LED_FADE);
+    controller.addBehaviour(AbstractRcCarLightController::LEFT_BLINKER, &fade);
+    controller.setupPins();
+    EXPECT_EQ(5, controller.getAnimatedPixelCount());
+
+    AbstractRcCarLightController::CarLightsStatus_t status = { 0, 0, 0, 0, 0, 0 };
+    controller.loop(status);
+    controller.showFrame();
+
+    status.leftBlinker = 1;
+    controller.loop(status);
+    controller.showFrame();
+    EXPECT_FALSE(controller.isSteady());
+
+    // the front blinker fades in from black, the side marker from its own color
+    uint8_t lastBlinkerRed = 0;
+    uint8_t lastMarkerRed = 32;
+    for (int frame = 0; frame < 60; ++frame)
+    {
+        ArduinoMock::advanceMicros(5000);
+        controller.loop(status);
+        controller.showFrame();
+
+        uint8_t blinkerRed = getRed(getShownColor(CamaroRcCarLightController::BLINKER_FRONT_LEFT));
+        uint8_t markerRed = getRed(getShownColor(CamaroRcCarLightController::POSITION_MARKER_FRONT_LEFT_PIXEL));
+        EXPECT_LE(lastBlinkerRed, blinkerRed);
+        EXPECT_LE(lastMarkerRed, markerRed);
+        lastBlinkerRed = blinkerRed;
+        lastMarkerRed = markerRed;
+    }
+
+    EXPECT_TRUE(controller.isSteady());
+    EXPECT_EQ(BLINKER_COLOR, getShownColor(CamaroRcCarLightController::BLINKER_FRONT_LEFT));
+    EXPECT_EQ(BLINKER_COLOR,
+              getShownColor(CamaroRcCarLightController::POSITION_MARKER_FRONT_LEFT_PIXEL));
+
+    // the right blinker has no behaviour
+    EXPECT_EQ(0U, getShownColor(CamaroRcCarLightController::BLINKER_FRONT_RIGHT_PIXEL));
+}
@@ -0,0 +1,78 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "../DeadlineScheduler.h"
+
+// Nothing is due without timers
+TEST(DeadlineSchedulerTest, NothingScheduled) {
+    DeadlineScheduler scheduler;
+
+    EXPECT_FALSE(scheduler.isDue(0));
+    EXPECT_FALSE(scheduler.isDue(123456));
+}
+
+// The earliest deadline counts, cancelled timers are ignored
+TEST(DeadlineSchedulerTest, EarliestDeadline) {
+    DeadlineScheduler scheduler;
+
+    scheduler.schedule(0, 500);
+    scheduler.schedule(1, 200);
+    EXPECT_FALSE(scheduler.isDue(199));
+    EXPECT_TRUE(scheduler.isDue(200));
+
+    scheduler.cancel(1);
+    EXPECT_FALSE(scheduler.isDue(499));
+    EXPECT_TRUE(scheduler.isDue(500));
+
+    // a new deadline replaces the old one of the same timer
+    scheduler.schedule(0, 800);
+    EXPECT_FALSE(scheduler.isDue(500));
+    EXPECT_TRUE(scheduler.isDue(800));
+}
+
+// Deadlines behind a wrap around of millis() are handled
+TEST(DeadlineSchedulerTest, WrapAround) {
+    DeadlineScheduler scheduler;
+
+    scheduler.schedule(0, (unsigned long) -16);
+    scheduler.schedule(1, 0x10);
+    EXPECT_FALSE(scheduler.isDue((unsigned long) -32));
+    EXPECT_TRUE(scheduler.isDue((unsigned long) -16));
+
+    scheduler.cancel(0);
+    EXPECT_FALSE(scheduler.isDue((unsigned long) -16));
+    EXPECT_TRUE(scheduler.isDue(0x10));
+}
+
+// Skipped and executed passes are published per second
+TEST(DeadlineSchedulerTest, PassStatistics) {
+    DeadlineScheduler scheduler;
+
+    for (unsigned long now = 1000; now < 2000; ++now)
+    {
+        scheduler.countPass(now, 0 != now % 4);
+    }
+    scheduler.countPass(2000, false);
+
+    EXPECT_EQ(750UL, scheduler.getSkippedPerSecond());
+    EXPECT_EQ(250UL, scheduler.getExecutedPerSecond());
+}
@@ -0,0 +1,64 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+
+#include "../FrameClock.h"
+
+/**
+ * listener, which records the time of its frames
+ */
+class FrameRecorder: public FrameListener
+{
+public:
+    virtual void onFrame(void)
+    {
+        mFrames.push_back(ArduinoMock::getMicros());
+    }
+
+    std::vector<unsigned long> mFrames;
+};
+
+// Frames are fired at exact multiples of the frame period, independent of the steps of the clock
+TEST(FrameClockTest, FramesOnGrid) {
+    ArduinoMock::reset();
+    FrameRecorder recorder;
+
+    FrameClock::start(&recorder);
+    ArduinoMock::advanceMicros(FrameClock::FRAME_PERIOD - 1);
+    EXPECT_TRUE(recorder.mFrames.empty());
+
+    ArduinoMock::advanceMicros(1);
+    ArduinoMock::advanceMicros(7 * FrameClock::FRAME_PERIOD + 123);
+    ASSERT_EQ(8U, recorder.mFrames.size());
+    for (size_t i = 0; i < recorder.mFrames.size(); ++i)
+    {
+        EXPECT_EQ((i + 1) * FrameClock::FRAME_PERIOD, recorder.mFrames[i]);
+    }
+
+    // no frames after stop
+    FrameClock::stop();
+    ArduinoMock::advanceMicros(10 * FrameClock::FRAME_PERIOD);
+    EXPECT_EQ(8U, recorder.mFrames.size());
+}
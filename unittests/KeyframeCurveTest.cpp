@@ -0,0 +1,111 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+#include "../KeyframeLightSwitchBehaviour.h"
+
+/**
+ * moves the virtual clock to pMillis msec after pStart
+ */
+static void advanceToMillis(unsigned long pStart, unsigned long pMillis)
+{
+    ArduinoMock::advanceTo((pStart + pMillis) * 1000);
+}
+
+// A looping curve repeats while the light is on and never becomes steady
+TEST(KeyframeCurveTest, StrobeLoops) {
+    ArduinoMock::reset();
+    KeyframeLightSwitchBehaviour strobe(&KeyframeLightSwitchBehaviour::STROBE);
+
+    strobe.setLightStatus(LightSwitchBehaviour::ON);
+    unsigned long start = millis();
+
+    for (unsigned long second = 0; second < 3; ++second)
+    {
+        advanceToMillis(start, second * 1000 + 20);
+        EXPECT_EQ(255, strobe.getBrightness()) << "first flash of second " << second;
+        advanceToMillis(start, second * 1000 + 80);
+        EXPECT_EQ(0, strobe.getBrightness()) << "pause of second " << second;
+        advanceToMillis(start, second * 1000 + 140);
+        EXPECT_EQ(255, strobe.getBrightness()) << "second flash of second " << second;
+        advanceToMillis(start, second * 1000 + 500);
+        EXPECT_EQ(0, strobe.getBrightness()) << "dark phase of second " << second;
+        EXPECT_FALSE(strobe.isSteady());
+    }
+
+    // switching off is immediate
+    strobe.setLightStatus(LightSwitchBehaviour::OFF);
+    ArduinoMock::advanceMicros(1000);
+    EXPECT_EQ(0, strobe.getBrightness());
+    EXPECT_TRUE(strobe.isSteady());
+}
+
+// Lights sharing a profile follow their own position in the curve
+TEST(KeyframeCurveTest, SharedProfile) {
+    ArduinoMock::reset();
+    KeyframeLightSwitchBehaviour first(&KeyframeLightSwitchBehaviour::LED_FADE);
+    KeyframeLightSwitchBehaviour second(&KeyframeLightSwitchBehaviour::LED_FADE);
+
+    first.setLightStatus(LightSwitchBehaviour::ON);
+    unsigned long start = millis();
+    advanceToMillis(start, 200);
+    second.setLightStatus(LightSwitchBehaviour::ON);
+
+    // the fade in is increasing, the first light is ahead
+    EXPECT_LT(second.getBrightness(), first.getBrightness());
+    EXPECT_EQ(0, second.getBrightness());
+
+    advanceToMillis(start, 300);
+    EXPECT_EQ(255, first.getBrightness());
+    EXPECT_TRUE(first.isSteady());
+    EXPECT_FALSE(second.isSteady());
+
+    advanceToMillis(start, 500);
+    EXPECT_EQ(255, second.getBrightness());
+    EXPECT_TRUE(second.isSteady());
+}
+
+// Curves end at the level of their last keyframe
+TEST(KeyframeCurveTest, HalogenEndsAtFinalLevel) {
+    ArduinoMock::reset();
+    KeyframeLightSwitchBehaviour halogen(&KeyframeLightSwitchBehaviour::HALOGEN);
+
+    EXPECT_EQ(0, halogen.getBrightness());
+    EXPECT_TRUE(halogen.isSteady());
+
+    halogen.setLightStatus(LightSwitchBehaviour::ON);
+    unsigned long start = millis();
+    int previous = -1;
+    for (unsigned long t = 0; t <= 300; t += 5)
+    {
+        advanceToMillis(start, t);
+        int brightness = halogen.getBrightness();
+        EXPECT_LE(previous, brightness) << "at " << t << " msec";
+        previous = brightness;
+    }
+    EXPECT_EQ(255, previous);
+
+    halogen.setLightStatus(LightSwitchBehaviour::OFF);
+    ArduinoMock::advanceMicros(400000);
+    EXPECT_EQ(0, halogen.getBrightness());
+    EXPECT_TRUE(halogen.isSteady());
+}
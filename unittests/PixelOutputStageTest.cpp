@@ -0,0 +1,74 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "../PixelOutputStage.h"
+
+// The gamma table keeps the ends and is monotonic
+TEST(PixelOutputStageTest, GammaTable) {
+    EXPECT_EQ(0, PixelOutputStage::getGamma(0));
+    EXPECT_EQ(255, PixelOutputStage::getGamma(255));
+    EXPECT_EQ(32, PixelOutputStage::getGamma(111));
+
+    for (int value = 1; value < 256; ++value)
+    {
+        EXPECT_LE(PixelOutputStage::getGamma(value - 1), PixelOutputStage::getGamma(value)) << "at " << value;
+    }
+}
+
+// The global brightness scales the perceived brightness before the gamma correction
+TEST(PixelOutputStageTest, Brightness) {
+    PixelOutputStage stage;
+    uint8_t pixels[] = { 0, 111, 255, 128, 64, 32 };
+
+    stage.apply(pixels, sizeof(pixels));
+    EXPECT_EQ(0, pixels[0]);
+    EXPECT_EQ(32, pixels[1]);
+    EXPECT_EQ(255, pixels[2]);
+
+    stage.setBrightness(127);
+    EXPECT_EQ(PixelOutputStage::getGamma(127), stage.getLevel(255));
+    EXPECT_EQ(PixelOutputStage::getGamma(64), stage.getLevel(128));
+
+    stage.setBrightness(0);
+    for (int value = 0; value < 256; ++value)
+    {
+        EXPECT_EQ(0, stage.getLevel(value));
+    }
+}
+
+// A dimmed frame is converted like its single values
+TEST(PixelOutputStageTest, DimmedFrame) {
+    PixelOutputStage stage;
+    stage.setBrightness(200);
+
+    uint8_t pixels[256];
+    for (int value = 0; value < 256; ++value)
+    {
+        pixels[value] = value;
+    }
+    stage.apply(pixels, sizeof(pixels));
+    for (int value = 0; value < 256; ++value)
+    {
+        EXPECT_EQ(stage.getLevel(value), pixels[value]) << "at " << value;
+        EXPECT_EQ(PixelOutputStage::getGamma(value * 201 / 256), pixels[value]) << "at " << value;
+    }
+}
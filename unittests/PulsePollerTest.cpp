@@ -0,0 +1,106 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+
+#include "../PulsePoller.h"
+
+// duration of a pass of the polling loop in usec, i.e. the resolution of the measurement
+static const unsigned long POLL_STEP = 4;
+
+class PulsePollerTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ArduinoMock::reset();
+        ArduinoMock::setMicrosStep(POLL_STEP);
+        for (uint8_t i = 0; i < PulsePoller::MAX_CHANNELS; ++i)
+        {
+            pinMode(i + 7, INPUT);
+            mPoller.attach(i, i + 7);
+        }
+    }
+
+    virtual void TearDown()
+    {
+        ArduinoMock::reset();
+    }
+
+    PulsePoller mPoller;
+};
+
+// a receiver, which sends all pulses at the same time, is measured within one frame
+TEST_F(PulsePollerTest, OverlappingPulses) {
+    ArduinoMock::setPulseSignal(7, 1100, ArduinoMock::RC_SIGNAL_PERIOD, 100);
+    ArduinoMock::setPulseSignal(8, 1500, ArduinoMock::RC_SIGNAL_PERIOD, 100);
+    ArduinoMock::setPulseSignal(9, 1900, ArduinoMock::RC_SIGNAL_PERIOD, 100);
+
+    mPoller.measure(7);
+
+    EXPECT_NEAR(1100, (long) mPoller.getPulseWidth(0), POLL_STEP);
+    EXPECT_NEAR(1500, (long) mPoller.getPulseWidth(1), POLL_STEP);
+    EXPECT_NEAR(1900, (long) mPoller.getPulseWidth(2), POLL_STEP);
+    EXPECT_GE(100 + 1900 + POLL_STEP, ArduinoMock::getMicros());
+}
+
+// a receiver, which sends the pulses one after another, is measured within one frame as well
+TEST_F(PulsePollerTest, SequentialPulses) {
+    ArduinoMock::setPulseSignal(7, 1200, ArduinoMock::RC_SIGNAL_PERIOD, 0);
+    ArduinoMock::setPulseSignal(8, 1800, ArduinoMock::RC_SIGNAL_PERIOD, 1200);
+    ArduinoMock::setPulseSignal(9, 1000, ArduinoMock::RC_SIGNAL_PERIOD, 3000);
+
+    // starts within the pulse of the first channel, which is skipped
+    ArduinoMock::advanceTo(500);
+    mPoller.measure(7);
+
+    EXPECT_NEAR(1200, (long) mPoller.getPulseWidth(0), POLL_STEP);
+    EXPECT_NEAR(1800, (long) mPoller.getPulseWidth(1), POLL_STEP);
+    EXPECT_NEAR(1000, (long) mPoller.getPulseWidth(2), POLL_STEP);
+    EXPECT_GE(ArduinoMock::RC_SIGNAL_PERIOD + 1200 + POLL_STEP, ArduinoMock::getMicros());
+}
+
+// a channel without a signal times out, an unselected channel is not measured
+TEST_F(PulsePollerTest, MissingAndUnselectedChannels) {
+    ArduinoMock::setPulseSignal(7, 1500);
+    ArduinoMock::setPulseSignal(9, 1500);
+
+    mPoller.measure(3);
+
+    EXPECT_NEAR(1500, (long) mPoller.getPulseWidth(0), POLL_STEP);
+    EXPECT_EQ(0U, mPoller.getPulseWidth(1));
+    EXPECT_EQ(0U, mPoller.getPulseWidth(2));
+    EXPECT_NEAR(PulsePoller::DEFAULT_TIMEOUT, ArduinoMock::getMicros(), POLL_STEP);
+}
+
+// pulseIn measures one channel after the other and needs a frame per channel
+TEST_F(PulsePollerTest, PulseInNeedsFramePerChannel) {
+    ArduinoMock::setPulseSignal(7, 1500, ArduinoMock::RC_SIGNAL_PERIOD, 100);
+    ArduinoMock::setPulseSignal(8, 1500, ArduinoMock::RC_SIGNAL_PERIOD, 100);
+    ArduinoMock::setPulseSignal(9, 1500, ArduinoMock::RC_SIGNAL_PERIOD, 100);
+    ArduinoMock::setMicrosStep(0);
+
+    pulseIn(7, HIGH, 25000);
+    pulseIn(8, HIGH, 25000);
+    pulseIn(9, HIGH, 25000);
+    EXPECT_LT(2 * ArduinoMock::RC_SIGNAL_PERIOD, ArduinoMock::getMicros());
+}
@@ -0,0 +1,179 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+#include "EEPROM.h"
+
+#include "../RcCalibration.h"
+#include "../RemoteControlCarAdapter.h"
+
+/**
+ * sticks of a transmitter, which follow a list of positions
+ */
+class TransmitterSource : public RcInputSource
+{
+public:
+    typedef struct
+    {
+        // time in msec from which on the position is held
+        unsigned long from;
+        unsigned long throttle;
+        unsigned long steering;
+    } Position_t;
+
+    TransmitterSource(const Position_t *pPositions, size_t pCount) :
+            mPositions(pPositions), mCount(pCount)
+    {
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        unsigned long now = millis();
+        size_t i = 0;
+        while (i + 1 < mCount && mPositions[i + 1].from <= now)
+        {
+            ++i;
+        }
+        pThrottle = mPositions[i].throttle;
+        pSteering = mPositions[i].steering;
+        p3rdChannel = 1000;
+        return now;
+    }
+
+private:
+    const Position_t *mPositions;
+    size_t mCount;
+};
+
+static const RcCalibration::Channel_t THROTTLE = { 1480, 1020, 1950 };
+static const RcCalibration::Channel_t STEERING = { 1510, 1100, 1900 };
+
+TEST(RcCalibrationTest, RoundTrip) {
+    ArduinoMock::reset();
+    ArduinoMock::eraseEeprom();
+    RcCalibration::Data_t data;
+
+    EXPECT_FALSE(RcCalibration::load(data));
+
+    RcCalibration::save(THROTTLE, STEERING);
+    ASSERT_TRUE(RcCalibration::load(data));
+    EXPECT_EQ(1480, data.throttle.neutral);
+    EXPECT_EQ(1020, data.throttle.min);
+    EXPECT_EQ(1950, data.throttle.max);
+    EXPECT_EQ(1510, data.steering.neutral);
+    EXPECT_EQ(1100, data.steering.min);
+    EXPECT_EQ(1900, data.steering.max);
+
+    // saving the same calibration again does not wear the EEPROM
+    unsigned long writes = ArduinoMock::getEepromWriteCount();
+    RcCalibration::save(THROTTLE, STEERING);
+    EXPECT_EQ(writes, ArduinoMock::getEepromWriteCount());
+}
+
+TEST(RcCalibrationTest, Corruption) {
+    ArduinoMock::reset();
+    ArduinoMock::eraseEeprom();
+    RcCalibration::Data_t data;
+
+    // a flipped bit of a value is detected by the CRC
+    RcCalibration::save(THROTTLE, STEERING);
+    EEPROM.write(RcCalibration::EEPROM_ADDRESS + 4, EEPROM.read(RcCalibration::EEPROM_ADDRESS + 4) ^ 0x10);
+    EXPECT_FALSE(RcCalibration::load(data));
+
+    // a record of another version is rejected, even with a matching CRC
+    RcCalibration::save(THROTTLE, STEERING);
+    EEPROM.get(RcCalibration::EEPROM_ADDRESS, data);
+    data.version = RcCalibration::VERSION + 1;
+    data.crc = RcCalibration::calculateCrc(data);
+    EEPROM.put(RcCalibration::EEPROM_ADDRESS, data);
+    EXPECT_FALSE(RcCalibration::load(data));
+}
+
+// with a stored calibration the adapter is ready immediately, without it samples the neutral points
+TEST(RcCalibrationTest, Startup) {
+    static const TransmitterSource::Position_t NEUTRAL[] = { { 0, 1480, 1510 } };
+
+    ArduinoMock::reset();
+    ArduinoMock::eraseEeprom();
+    {
+        TransmitterSource source(NEUTRAL, 1);
+        RemoteControlCarAdapter adapter;
+        adapter.setInputSource(&source);
+        adapter.calibrate();
+        EXPECT_LE(400UL, millis());
+        EXPECT_FALSE(adapter.isCalibrationStored());
+        EXPECT_EQ(1480, adapter.getThrottleCalibration().neutral);
+        EXPECT_EQ(980, adapter.getThrottleCalibration().min);
+    }
+
+    RcCalibration::save(THROTTLE, STEERING);
+    ArduinoMock::reset();
+    {
+        TransmitterSource source(NEUTRAL, 1);
+        RemoteControlCarAdapter adapter;
+        adapter.setInputSource(&source);
+        adapter.calibrate();
+        EXPECT_GT(10UL, millis());
+        EXPECT_TRUE(adapter.isCalibrationStored());
+        EXPECT_EQ(1950, adapter.getThrottleCalibration().max);
+    }
+}
+
+// holding the steering at power-on learns and stores the endpoints
+TEST(RcCalibrationTest, CalibrationMode) {
+    static const TransmitterSource::Position_t STICKS[] = { { 0, 1500, 1900 }, { 1000, 1500, 1500 }, {
+            3000, 1000, 1100 }, { 4000, 2000, 1950 }, { 5000, 1500, 1500 } };
+
+    ArduinoMock::reset();
+    ArduinoMock::eraseEeprom();
+    TransmitterSource source(STICKS, sizeof(STICKS) / sizeof(STICKS[0]));
+    RemoteControlCarAdapter adapter;
+    adapter.setInputSource(&source);
+    adapter.calibrate();
+
+    EXPECT_TRUE(adapter.isCalibrationStored());
+    RcCalibration::Data_t data;
+    ASSERT_TRUE(RcCalibration::load(data));
+    EXPECT_EQ(1500, data.throttle.neutral);
+    EXPECT_EQ(1000, data.throttle.min);
+    EXPECT_EQ(2000, data.throttle.max);
+    EXPECT_EQ(1500, data.steering.neutral);
+    EXPECT_EQ(1100, data.steering.min);
+    EXPECT_EQ(1950, data.steering.max);
+}
+
+// without a movement of the sticks the EEPROM is left alone
+TEST(RcCalibrationTest, CalibrationModeWithoutSweep) {
+    static const TransmitterSource::Position_t STICKS[] = { { 0, 1500, 1100 }, { 500, 1500, 1500 } };
+
+    ArduinoMock::reset();
+    ArduinoMock::eraseEeprom();
+    unsigned long writes = ArduinoMock::getEepromWriteCount();
+    TransmitterSource source(STICKS, sizeof(STICKS) / sizeof(STICKS[0]));
+    RemoteControlCarAdapter adapter;
+    adapter.setInputSource(&source);
+    adapter.calibrate();
+
+    EXPECT_FALSE(adapter.isCalibrationStored());
+    EXPECT_EQ(writes, ArduinoMock::getEepromWriteCount());
+    EXPECT_EQ(1000, adapter.getSteeringCalibration().min);
+}
@@ -0,0 +1,77 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "../RcChannelFilter.h"
+
+// a single spike is removed, a change passes after one more pulse
+TEST(RcChannelFilterTest, Median) {
+    RcChannelFilter filter(RcChannelFilter::MEDIAN_FILTER);
+
+    EXPECT_EQ(1500U, filter.filter(1500, 0));
+    EXPECT_EQ(1500U, filter.filter(1504, 20));
+    EXPECT_EQ(1504U, filter.filter(1700, 40));
+    EXPECT_EQ(1504U, filter.filter(1502, 60));
+
+    EXPECT_EQ(1503U, filter.filter(1503, 80));
+
+    EXPECT_EQ(1503U, filter.filter(1800, 100));
+    EXPECT_EQ(1800U, filter.filter(1800, 120));
+}
+
+// reads of the same pulse within the sample period are no new samples
+TEST(RcChannelFilterTest, RepeatedReads) {
+    RcChannelFilter filter(RcChannelFilter::MEDIAN_FILTER);
+
+    filter.filter(1500, 0);
+    filter.filter(1500, 20);
+    EXPECT_EQ(1500U, filter.filter(1700, 40));
+    EXPECT_EQ(1500U, filter.filter(1700, 42));
+    EXPECT_EQ(1500U, filter.filter(1700, 44));
+    EXPECT_EQ(1700U, filter.filter(1700, 60));
+}
+
+// the IIR filter approaches a step in fractions
+TEST(RcChannelFilterTest, Iir) {
+    RcChannelFilter filter(RcChannelFilter::IIR_FILTER, 2);
+
+    EXPECT_EQ(1500U, filter.filter(1500, 0));
+    EXPECT_EQ(1600U, filter.filter(1900, 20));
+    EXPECT_EQ(1675U, filter.filter(1900, 40));
+
+    unsigned long width = 0;
+    for (unsigned long time = 60; time < 1000; time += 20)
+    {
+        width = filter.filter(1900, time);
+    }
+    EXPECT_EQ(1900U, width);
+
+    // no signal is passed immediately and restarts the filter
+    EXPECT_EQ(0U, filter.filter(0, 1000));
+    EXPECT_EQ(1300U, filter.filter(1300, 1020));
+}
+
+TEST(RcChannelFilterTest, NoFilter) {
+    RcChannelFilter filter(RcChannelFilter::NO_FILTER);
+
+    EXPECT_EQ(1500U, filter.filter(1500, 0));
+    EXPECT_EQ(1700U, filter.filter(1700, 1));
+}
@@ -0,0 +1,191 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+
+#include "../RcChannelHealth.h"
+#include "../RemoteControlCarAdapter.h"
+
+// invalid reads are counted, the channel is lost after SIGNAL_LOSS_TIME and recovers after RECOVERY_PULSES
+TEST(RcChannelHealthTest, LossAndRecovery) {
+    RcChannelHealth health;
+
+    EXPECT_TRUE(health.check(1500, 0));
+    EXPECT_FALSE(health.check(0, 20));
+    EXPECT_FALSE(health.check(3000, 40));
+    EXPECT_FALSE(health.isLost());
+    EXPECT_EQ(1U, health.getTimeoutCount());
+    EXPECT_EQ(1U, health.getOutOfRangeCount());
+    EXPECT_EQ(1500U, health.getLastValidWidth());
+
+    EXPECT_FALSE(health.check(0, 100));
+    EXPECT_TRUE(health.isLost());
+    EXPECT_EQ(1U, health.getLossCount());
+
+    EXPECT_TRUE(health.check(1510, 120));
+    EXPECT_TRUE(health.check(1510, 140));
+    EXPECT_TRUE(health.isLost());
+    EXPECT_TRUE(health.check(1510, 160));
+    EXPECT_FALSE(health.isLost());
+    EXPECT_EQ(1U, health.getLossCount());
+}
+
+// a pulse read again does not count for the recovery
+TEST(RcChannelHealthTest, SamePulseReadAgain) {
+    RcChannelHealth health;
+
+    health.check(0, 0);
+    health.check(0, 100);
+    ASSERT_TRUE(health.isLost());
+
+    EXPECT_TRUE(health.check(1510, 120, true));
+    EXPECT_TRUE(health.check(1510, 125, false));
+    EXPECT_TRUE(health.check(1510, 130, false));
+    EXPECT_TRUE(health.isLost());
+
+    EXPECT_TRUE(health.check(1510, 140, true));
+    EXPECT_TRUE(health.isLost());
+    EXPECT_TRUE(health.check(1510, 160, true));
+    EXPECT_FALSE(health.isLost());
+}
+
+// a lost channel is polled every LOST_POLL_INTERVAL, skipped polls are not counted
+TEST(RcChannelHealthTest, ReducedPolling) {
+    RcChannelHealth health;
+
+    health.check(0, 0);
+    health.check(0, 100);
+    ASSERT_TRUE(health.isLost());
+    EXPECT_EQ(2U, health.getTimeoutCount());
+
+    EXPECT_FALSE(health.isPollDue(120));
+    EXPECT_FALSE(health.check(0, 120));
+    EXPECT_EQ(2U, health.getTimeoutCount());
+
+    EXPECT_TRUE(health.isPollDue(600));
+    health.check(0, 600);
+    EXPECT_EQ(3U, health.getTimeoutCount());
+    EXPECT_FALSE(health.isPollDue(700));
+
+    // a pulse is taken at any time
+    EXPECT_TRUE(health.check(1500, 700));
+}
+
+/**
+ * transmitter with all channels in neutral position, which can be switched off
+ */
+class SwitchableSource : public RcInputSource
+{
+public:
+    SwitchableSource() :
+            misOn(true)
+    {
+    }
+
+    virtual unsigned long read(unsigned long &pThrottle, unsigned long &pSteering, unsigned long &p3rdChannel)
+    {
+        pThrottle = misOn ? 1500 : 0;
+        pSteering = misOn ? 1500 : 0;
+        p3rdChannel = misOn ? 1000 : 0;
+        return millis();
+    }
+
+    bool misOn;
+};
+
+// without a signal the adapter holds the last values, then raises the failsafe with neutral positions
+TEST(RcChannelHealthTest, AdapterFailsafe) {
+    ArduinoMock::reset();
+    ArduinoMock::eraseEeprom();
+    SwitchableSource source;
+    RemoteControlCarAdapter adapter;
+    adapter.setInputSource(&source);
+    adapter.calibrate();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        delay(20);
+        adapter.refresh();
+    }
+    EXPECT_FALSE(adapter.isFailsafe());
+
+    source.misOn = false;
+    delay(20);
+    adapter.refresh();
+    EXPECT_FALSE(adapter.isFailsafe());
+    EXPECT_EQ(1500U, adapter.getThrottleValue());
+    EXPECT_EQ(1000U, adapter.get3rdChannelValue());
+    // the telemetry gets the widths as read
+    EXPECT_EQ(0U, adapter.getRawThrottleValue());
+    EXPECT_EQ(0U, adapter.getRaw3rdChannelValue());
+
+    for (int i = 0; i < 5; ++i)
+    {
+        delay(20);
+        adapter.refresh();
+    }
+    EXPECT_TRUE(adapter.isFailsafe());
+    EXPECT_EQ(RemoteControlCarAdapter::STOP, adapter.getThrottle());
+    EXPECT_EQ(RemoteControlCarAdapter::NEUTRAL, adapter.getSteering());
+    EXPECT_EQ(1000U, adapter.get3rdChannelValue());
+    EXPECT_EQ(1U, adapter.getThrottleHealth().getLossCount());
+    // the read after the loss is a skipped poll
+    EXPECT_EQ(5U, adapter.getSteeringHealth().getTimeoutCount());
+
+    source.misOn = true;
+    for (int i = 0; i < RcChannelHealth::RECOVERY_PULSES; ++i)
+    {
+        delay(20);
+        adapter.refresh();
+    }
+    EXPECT_FALSE(adapter.isFailsafe());
+}
+
+// a single stray pulse of a lost channel, which is read with the pulses of the other channels, does not recover it
+TEST(RcChannelHealthTest, AdapterStrayPulse) {
+    ArduinoMock::reset();
+    ArduinoMock::eraseEeprom();
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_THROTTLE, 1500);
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_STEERING, 1500, ArduinoMock::RC_SIGNAL_PERIOD, 5000);
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_3RD_CHANNEL, 1000, ArduinoMock::RC_SIGNAL_PERIOD, 10000);
+    RemoteControlCarAdapter adapter;
+    adapter.setupPins();
+    adapter.calibrate();
+
+    ArduinoMock::clearPulseSignal(VehicleConfig::PIN_THROTTLE);
+    for (int i = 0; i < 20; ++i)
+    {
+        delay(10);
+        adapter.refresh();
+    }
+    ASSERT_TRUE(adapter.getThrottleHealth().isLost());
+
+    ArduinoMock::injectEdge(VehicleConfig::PIN_THROTTLE, HIGH, ArduinoMock::getMicros() + 100);
+    ArduinoMock::injectEdge(VehicleConfig::PIN_THROTTLE, LOW, ArduinoMock::getMicros() + 1500);
+    for (int i = 0; i < 4; ++i)
+    {
+        delay(10);
+        adapter.refresh();
+    }
+    EXPECT_EQ(1500U, adapter.getThrottleHealth().getLastValidWidth());
+    EXPECT_TRUE(adapter.getThrottleHealth().isLost());
+}
@@ -0,0 +1,224 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+
+#include "../PpmDecoder.h"
+#include "../SbusDecoder.h"
+
+// duration of a byte at 100000 baud 8E2
+static const unsigned long SBUS_BYTE_TIME = 120;
+
+/**
+ * packs 16 raw channel values into a SBUS frame
+ */
+static void encodeSbusFrame(const uint16_t *pValues, uint8_t pFlags, uint8_t *pFrame)
+{
+    memset(pFrame, 0, SbusDecoder::FRAME_SIZE);
+    pFrame[0] = SbusDecoder::HEADER;
+    for (uint16_t bit = 0; bit < 16 * 11; ++bit)
+    {
+        if (pValues[bit / 11] & (1 << (bit % 11)))
+        {
+            pFrame[1 + bit / 8] |= 1 << (bit % 8);
+        }
+    }
+    pFrame[23] = pFlags;
+}
+
+/**
+ * feeds a frame byte by byte starting at the given time
+ *
+ * @return time of the last byte
+ */
+static unsigned long feedSbusFrame(SbusDecoder &pDecoder, const uint8_t *pFrame, unsigned long pMicros)
+{
+    for (uint8_t i = 0; i < SbusDecoder::FRAME_SIZE; ++i)
+    {
+        pDecoder.feed(pFrame[i], pMicros + i * SBUS_BYTE_TIME);
+    }
+    return pMicros + (SbusDecoder::FRAME_SIZE - 1) * SBUS_BYTE_TIME;
+}
+
+class RcFrameDecoderTest : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        ArduinoMock::reset();
+        for (uint16_t i = 0; i < SbusDecoder::NUM_CHANNELS; ++i)
+        {
+            mValues[i] = 172 + i * 100;
+        }
+        mValues[0] = 992;
+        mValues[1] = 1811;
+        mValues[2] = 172;
+    }
+
+    virtual void TearDown()
+    {
+        ArduinoMock::reset();
+    }
+
+    uint16_t mValues[SbusDecoder::NUM_CHANNELS];
+};
+
+// all channels of a frame are unpacked and published with its last byte
+TEST_F(RcFrameDecoderTest, SbusFrame) {
+    SbusDecoder decoder;
+    uint8_t frame[SbusDecoder::FRAME_SIZE];
+    encodeSbusFrame(mValues, 0, frame);
+
+    for (uint8_t i = 0; i < SbusDecoder::FRAME_SIZE - 1; ++i)
+    {
+        decoder.feed(frame[i], i * SBUS_BYTE_TIME);
+    }
+    EXPECT_EQ(0UL, decoder.getFrameCount());
+    EXPECT_FALSE(decoder.hasNewInputs());
+
+    decoder.feed(frame[SbusDecoder::FRAME_SIZE - 1], 3000);
+    EXPECT_EQ(1UL, decoder.getFrameCount());
+    EXPECT_EQ(3000UL, decoder.getFrameMicros());
+    EXPECT_TRUE(decoder.hasNewInputs());
+    for (uint8_t i = 0; i < SbusDecoder::NUM_CHANNELS; ++i)
+    {
+        EXPECT_EQ(SbusDecoder::toPulseWidth(mValues[i]), decoder.getChannel(i));
+    }
+
+    unsigned long throttle, steering, thirdChannel;
+    ArduinoMock::advanceTo(5000);
+    decoder.read(throttle, steering, thirdChannel);
+    EXPECT_EQ(2011UL, throttle);
+    EXPECT_EQ(1500UL, steering);
+    EXPECT_EQ(987UL, thirdChannel);
+    EXPECT_FALSE(decoder.hasNewInputs());
+}
+
+// after garbage or a broken frame the decoder finds the next frame
+TEST_F(RcFrameDecoderTest, SbusResync) {
+    SbusDecoder decoder;
+    uint8_t frame[SbusDecoder::FRAME_SIZE];
+    encodeSbusFrame(mValues, 0, frame);
+
+    // the pause after a truncated frame starts a new one
+    unsigned long now = 0;
+    for (uint8_t i = 0; i < 10; ++i)
+    {
+        decoder.feed(frame[i], now += SBUS_BYTE_TIME);
+    }
+    now = feedSbusFrame(decoder, frame, now + 5000);
+    EXPECT_EQ(1UL, decoder.getFrameCount());
+
+    // a frame with a wrong footer is dropped
+    frame[SbusDecoder::FRAME_SIZE - 1] = 0x55;
+    now = feedSbusFrame(decoder, frame, now + 5000);
+    EXPECT_EQ(1UL, decoder.getFrameCount());
+    EXPECT_EQ(1UL, decoder.getErrorCount());
+
+    // without timestamps garbage is skipped up to the next header
+    frame[SbusDecoder::FRAME_SIZE - 1] = 0x00;
+    decoder.feed(0xAA, now);
+    decoder.feed(0x55, now);
+    feedSbusFrame(decoder, frame, now);
+    EXPECT_EQ(2UL, decoder.getFrameCount());
+}
+
+// a failsafe frame is not published, the channels are lost after the frame timeout
+TEST_F(RcFrameDecoderTest, SbusFailsafe) {
+    SbusDecoder decoder;
+    uint8_t frame[SbusDecoder::FRAME_SIZE];
+    encodeSbusFrame(mValues, SbusDecoder::FRAME_LOST_FLAG, frame);
+    unsigned long now = feedSbusFrame(decoder, frame, 0);
+    EXPECT_EQ(1UL, decoder.getFrameCount());
+    EXPECT_EQ(1UL, decoder.getLostFrameCount());
+
+    encodeSbusFrame(mValues, SbusDecoder::FRAME_LOST_FLAG | SbusDecoder::FAILSAFE_FLAG, frame);
+    feedSbusFrame(decoder, frame, now + 7000);
+    EXPECT_EQ(1UL, decoder.getFrameCount());
+    EXPECT_EQ(1UL, decoder.getFailsafeCount());
+
+    unsigned long throttle, steering, thirdChannel;
+    ArduinoMock::advanceTo(now + 10000);
+    decoder.read(throttle, steering, thirdChannel);
+    EXPECT_EQ(2011UL, throttle);
+
+    ArduinoMock::advanceTo(now + RcFrameDecoder::FRAME_TIMEOUT + 1);
+    decoder.read(throttle, steering, thirdChannel);
+    EXPECT_EQ(0UL, throttle);
+    EXPECT_EQ(0UL, steering);
+    EXPECT_EQ(0UL, thirdChannel);
+}
+
+// the decoder starts with the first sync gap, the first complete frame is published at the next sync gap, later
+// frames with the edge of their last channel
+TEST_F(RcFrameDecoderTest, PpmFrames) {
+    static const unsigned long CHANNELS[] = { 1500, 1100, 1900, 1000, 2000, 1500 };
+    static const uint8_t NUM_CHANNELS = sizeof(CHANNELS) / sizeof(CHANNELS[0]);
+    static const unsigned long FRAME_COUNTS[] = { 0, 0, 2, 3 };
+    PpmDecoder decoder;
+
+    unsigned long now = 0;
+    for (uint8_t frame = 0; frame < 4; ++frame)
+    {
+        decoder.handleEdge(now);
+        for (uint8_t i = 0; i < NUM_CHANNELS; ++i)
+        {
+            now += CHANNELS[i];
+            decoder.handleEdge(now);
+        }
+        EXPECT_EQ(FRAME_COUNTS[frame], decoder.getFrameCount());
+        now += 22500 - 9000;
+    }
+
+    EXPECT_EQ(NUM_CHANNELS, decoder.getNumChannels());
+    EXPECT_EQ(3 * 22500UL + 9000, decoder.getFrameMicros());
+    for (uint8_t i = 0; i < NUM_CHANNELS; ++i)
+    {
+        EXPECT_EQ(CHANNELS[i], decoder.getChannel(i));
+    }
+    EXPECT_EQ(0, decoder.getChannel(NUM_CHANNELS));
+}
+
+// a frame with an interval out of range is dropped until the next sync gap
+TEST_F(RcFrameDecoderTest, PpmGlitch) {
+    PpmDecoder decoder;
+
+    unsigned long now = 0;
+    for (uint8_t frame = 0; frame < 4; ++frame)
+    {
+        decoder.handleEdge(now);
+        decoder.handleEdge(now += 1500);
+        // a spike within the second channel of the second frame
+        if (1 == frame)
+        {
+            decoder.handleEdge(now += 200);
+        }
+        decoder.handleEdge(now += 1500);
+        decoder.handleEdge(now += 1500);
+        decoder.handleEdge(now += 1500);
+        now += 10000;
+    }
+
+    EXPECT_EQ(1UL, decoder.getErrorCount());
+    EXPECT_EQ(2UL, decoder.getFrameCount());
+    EXPECT_EQ(4, decoder.getNumChannels());
+}
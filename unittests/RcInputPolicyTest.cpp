@@ -0,0 +1,114 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+
+#include "../RemoteControlCarAdapter.h"
+
+// the generator starts in neutral position and reaches the upper end after a quarter period
+TEST(RcInputPolicyTest, SyntheticTriangle) {
+    ArduinoMock::reset();
+    SyntheticInput input(2000, 0, 400, 1800);
+    unsigned long throttle, steering, thirdChannel;
+
+    EXPECT_EQ(0UL, input.read(SyntheticInput::ALL_CHANNELS, throttle, steering, thirdChannel));
+    EXPECT_EQ(1500UL, throttle);
+    EXPECT_EQ(1500UL, steering);
+    EXPECT_EQ(1800UL, thirdChannel);
+
+    ArduinoMock::advanceTo(500000);
+    input.read(SyntheticInput::ALL_CHANNELS, throttle, steering, thirdChannel);
+    EXPECT_EQ(1900UL, throttle);
+
+    ArduinoMock::advanceTo(1500000);
+    input.read(SyntheticInput::ALL_CHANNELS, throttle, steering, thirdChannel);
+    EXPECT_EQ(1100UL, throttle);
+    EXPECT_TRUE(input.hasNewInputs());
+}
+
+// the replay returns the records with their timestamps and repeats the last one
+TEST(RcInputPolicyTest, TraceReplay) {
+    static const RcTrace::Record_t RECORDS[] = { { 10, { 1500, 1500, 1000 } }, { 30, { 1600, 1450, 1000 } } };
+    uint8_t trace[RcTrace::MAGIC_SIZE + 2 * RcTrace::MAX_RECORD_SIZE];
+    RcTrace::writeMagic(trace);
+    uint32_t size = RcTrace::MAGIC_SIZE;
+    size += RcTrace::encode(RECORDS[0], RECORDS[0], true, trace + size);
+    size += RcTrace::encode(RECORDS[0], RECORDS[1], false, trace + size);
+
+    TraceReplayInput input(trace, size);
+    unsigned long throttle, steering, thirdChannel;
+    ASSERT_TRUE(input.isValid());
+    EXPECT_EQ(10UL, input.read(TraceReplayInput::ALL_CHANNELS, throttle, steering, thirdChannel));
+    EXPECT_EQ(1500UL, throttle);
+    EXPECT_TRUE(input.hasNewInputs());
+    EXPECT_EQ(30UL, input.read(TraceReplayInput::ALL_CHANNELS, throttle, steering, thirdChannel));
+    EXPECT_EQ(1600UL, throttle);
+    EXPECT_EQ(1450UL, steering);
+    EXPECT_FALSE(input.hasNewInputs());
+    EXPECT_EQ(30UL, input.read(TraceReplayInput::ALL_CHANNELS, throttle, steering, thirdChannel));
+
+    EXPECT_FALSE(TraceReplayInput(trace + 1, size - 1).isValid());
+}
+
+// an adapter with the generator as policy calibrates to its neutral position and follows the throttle
+TEST(RcInputPolicyTest, SyntheticAdapter) {
+    ArduinoMock::reset();
+    ArduinoMock::eraseEeprom();
+    BasicRemoteControlCarAdapter<SyntheticInput> adapter(SyntheticInput(4000));
+    adapter.setupPins();
+    adapter.calibrate();
+    EXPECT_EQ(1500, adapter.getSteeringCalibration().neutral);
+
+    // the calibration took about 400 msec of the period, the reversed throttle is at the upper end after a quarter
+    ArduinoMock::advanceTo(1000000);
+    for (int i = 0; i < 5; ++i)
+    {
+        ArduinoMock::advanceMicros(20000);
+        adapter.refresh();
+    }
+    EXPECT_EQ(RemoteControlCarAdapter::FORWARD, adapter.getThrottle());
+    EXPECT_EQ(RemoteControlCarAdapter::NEUTRAL, adapter.getSteering());
+}
+
+// the pulse capture is quiet between the end of a pulse and shortly before the next pulse may start
+TEST(RcInputPolicyTest, PulseCaptureQuiet) {
+    ArduinoMock::reset();
+    PulseCaptureInput input;
+    input.setup(VehicleConfig::PIN_THROTTLE, VehicleConfig::PIN_STEERING, VehicleConfig::PIN_3RD_CHANNEL);
+    ArduinoMock::setPulseSignal(VehicleConfig::PIN_THROTTLE, 1500, 20000, 1000);
+
+    ArduinoMock::advanceTo(500);
+    EXPECT_TRUE(input.isQuiet(420));
+
+    ArduinoMock::advanceTo(1100);
+    EXPECT_FALSE(input.isQuiet(420));
+
+    ArduinoMock::advanceTo(3000);
+    EXPECT_TRUE(input.isQuiet(420));
+    EXPECT_FALSE(input.isQuiet(PulseCapture::MIN_PULSE_PERIOD));
+
+    ArduinoMock::advanceTo(14700);
+    EXPECT_FALSE(input.isQuiet(420));
+
+    ArduinoMock::advanceTo(23000);
+    EXPECT_TRUE(input.isQuiet(420));
+}
@@ -0,0 +1,94 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+
+#include "gtest/gtest.h"
+
+#include "../RcTrace.h"
+
+static RcTrace::Record_t makeRecord(uint32_t pTimestamp, uint16_t pThrottle, uint16_t pSteering, uint16_t p3rdChannel)
+{
+    RcTrace::Record_t record;
+    record.timestamp = pTimestamp;
+    record.widths[0] = pThrottle;
+    record.widths[1] = pSteering;
+    record.widths[2] = p3rdChannel;
+    return record;
+}
+
+static void expectRecord(const RcTrace::Record_t &pExpected, const RcTrace::Record_t &pActual)
+{
+    EXPECT_EQ(pExpected.timestamp, pActual.timestamp);
+    for (uint8_t i = 0; i < RcTrace::NUM_CHANNELS; ++i)
+    {
+        EXPECT_EQ(pExpected.widths[i], pActual.widths[i]);
+    }
+}
+
+// An absolute record holds the timestamp and all widths
+TEST(RcTraceTest, AbsoluteRecord) {
+    RcTrace::Record_t previous = makeRecord(0, 0, 0, 0);
+    RcTrace::Record_t record = makeRecord(123456, 1500, 1520, 1900);
+    uint8_t buffer[RcTrace::MAX_RECORD_SIZE];
+
+    uint8_t size = RcTrace::encode(previous, record, true, buffer);
+    ASSERT_TRUE(size <= RcTrace::MAX_RECORD_SIZE);
+
+    RcTrace::Record_t decoded;
+    bool isAbsolute = false;
+    EXPECT_EQ(size, RcTrace::decode(previous, buffer, size, decoded, isAbsolute));
+    EXPECT_TRUE(isAbsolute);
+    expectRecord(record, decoded);
+}
+
+// Small steps with unchanged channels take a single byte, negative differences are restored
+TEST(RcTraceTest, DeltaRecords) {
+    RcTrace::Record_t previous = makeRecord(1000, 1500, 1500, 1900);
+    uint8_t buffer[RcTrace::MAX_RECORD_SIZE];
+    RcTrace::Record_t decoded;
+    bool isAbsolute = true;
+
+    RcTrace::Record_t unchanged = makeRecord(1005, 1500, 1500, 1900);
+    EXPECT_EQ(1, RcTrace::encode(previous, unchanged, false, buffer));
+    EXPECT_EQ(1, RcTrace::decode(previous, buffer, 1, decoded, isAbsolute));
+    EXPECT_FALSE(isAbsolute);
+    expectRecord(unchanged, decoded);
+
+    RcTrace::Record_t changed = makeRecord(1300, 1100, 1501, 1000);
+    uint8_t size = RcTrace::encode(previous, changed, false, buffer);
+    EXPECT_EQ(size, RcTrace::decode(previous, buffer, size, decoded, isAbsolute));
+    EXPECT_FALSE(isAbsolute);
+    expectRecord(changed, decoded);
+}
+
+// Incomplete data is not decoded
+TEST(RcTraceTest, IncompleteRecord) {
+    RcTrace::Record_t previous = makeRecord(0, 0, 0, 0);
+    RcTrace::Record_t record = makeRecord(70000, 2000, 1000, 1500);
+    uint8_t buffer[RcTrace::MAX_RECORD_SIZE];
+    RcTrace::Record_t decoded;
+    bool isAbsolute;
+
+    uint8_t size = RcTrace::encode(previous, record, true, buffer);
+    for (uint8_t i = 0; i < size; ++i)
+    {
+        EXPECT_EQ(0, RcTrace::decode(previous, buffer, i, decoded, isAbsolute));
+    }
+}
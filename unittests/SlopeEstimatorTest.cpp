@@ -0,0 +1,62 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include "gtest/gtest.h"
+
+#include "../SlopeEstimator.h"
+
+// the slope is 0 until the history covers a window, then it is the change within SLOPE_INTERVAL
+TEST(SlopeEstimatorTest, Ramp) {
+    SlopeEstimator estimator(100);
+
+    for (unsigned long time = 0; time < 100; time += 10)
+    {
+        estimator.add(time, 1500 + time);
+        EXPECT_EQ(0, estimator.getSlope());
+    }
+    for (unsigned long time = 100; time < 500; time += 10)
+    {
+        estimator.add(time, 1500 + time);
+        EXPECT_EQ(SlopeEstimator::SLOPE_INTERVAL * 1, estimator.getSlope());
+    }
+}
+
+// a step is seen with the next sample and leaves the window after its length
+TEST(SlopeEstimatorTest, Step) {
+    SlopeEstimator estimator(100);
+
+    for (unsigned long time = 0; time <= 200; time += 20)
+    {
+        estimator.add(time, 1800);
+    }
+    EXPECT_EQ(0, estimator.getSlope());
+    EXPECT_EQ(300UL, estimator.getNextChangeTimestamp());
+
+    estimator.add(220, 1500);
+    EXPECT_EQ(-300 * SlopeEstimator::SLOPE_INTERVAL / 100, estimator.getSlope());
+
+    unsigned long time = 220;
+    while (0 != estimator.getSlope())
+    {
+        time += 20;
+        estimator.add(time, 1500);
+    }
+    EXPECT_EQ(320UL, time);
+}
@@ -0,0 +1,112 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "Arduino.h"
+
+#include "../StageProfiler.h"
+
+// count, min, max, sum and the logarithmic buckets of a stage
+TEST(StageProfilerTest, Statistics) {
+    StageProfiler profiler;
+    StageProfiler::Statistics_t statistics;
+
+    profiler.record(StageProfiler::ADAPTER_STAGE, 1);
+    profiler.record(StageProfiler::ADAPTER_STAGE, 2);
+    profiler.record(StageProfiler::ADAPTER_STAGE, 3);
+    profiler.record(StageProfiler::ADAPTER_STAGE, 100);
+    profiler.record(StageProfiler::ADAPTER_STAGE, 100000);
+
+    profiler.getStatistics(StageProfiler::ADAPTER_STAGE, statistics);
+    EXPECT_EQ(5U, statistics.count);
+    EXPECT_EQ(100106U, statistics.sum);
+    EXPECT_EQ(1U, statistics.min);
+    EXPECT_EQ(100000U, statistics.max);
+    EXPECT_EQ(1U, statistics.buckets[0]);
+    EXPECT_EQ(2U, statistics.buckets[1]);
+    EXPECT_EQ(1U, statistics.buckets[6]);
+    EXPECT_EQ(1U, statistics.buckets[StageProfiler::NUM_BUCKETS - 1]);
+    EXPECT_EQ(64U, StageProfiler::getBucketStart(6));
+
+    // other stages are not touched
+    profiler.getStatistics(StageProfiler::SET_LIGHTS_STAGE, statistics);
+    EXPECT_EQ(0U, statistics.count);
+
+    profiler.reset();
+    profiler.getStatistics(StageProfiler::ADAPTER_STAGE, statistics);
+    EXPECT_EQ(0U, statistics.count);
+    EXPECT_EQ(0U, statistics.max);
+    EXPECT_EQ(0U, statistics.buckets[0]);
+}
+
+// on the host minimum and maximum hold durations of more than 65536 nsec and saturate at MAX_DURATION
+TEST(StageProfilerTest, LongDurations) {
+    StageProfiler profiler;
+    StageProfiler::Statistics_t statistics;
+
+    profiler.record(StageProfiler::LIGHT_RULES_STAGE, 70000);
+    profiler.record(StageProfiler::LIGHT_RULES_STAGE, 250000);
+    profiler.getStatistics(StageProfiler::LIGHT_RULES_STAGE, statistics);
+    EXPECT_EQ(70000U, statistics.min);
+    EXPECT_EQ(250000U, statistics.max);
+
+    if (sizeof(unsigned long) > sizeof(StageProfiler::Duration_t))
+    {
+        StageProfiler::Duration_t maxDuration = StageProfiler::MAX_DURATION;
+        profiler.record(StageProfiler::LIGHT_RULES_STAGE, maxDuration + 1UL);
+        profiler.getStatistics(StageProfiler::LIGHT_RULES_STAGE, statistics);
+        EXPECT_EQ(maxDuration, statistics.max);
+    }
+}
+
+// a scope records the duration from its construction to its end
+TEST(StageProfilerTest, Scope) {
+    StageProfiler profiler;
+    StageProfiler::Statistics_t statistics;
+
+    {
+        StageProfiler::Scope scope(profiler, StageProfiler::SWITCHES_STAGE);
+    }
+    profiler.getStatistics(StageProfiler::SWITCHES_STAGE, statistics);
+    EXPECT_EQ(1U, statistics.count);
+    EXPECT_EQ(statistics.min, statistics.max);
+}
+
+// one row per stage
+TEST(StageProfilerTest, Dump) {
+    ArduinoMock::reset();
+    StageProfiler profiler;
+    profiler.record(StageProfiler::PUBLISH_STAGE, 5);
+
+    profiler.dump(Serial);
+    const std::vector<uint8_t> &output = ArduinoMock::getSerialOutput();
+    std::string text(output.begin(), output.end());
+
+    EXPECT_NE(std::string::npos, text.find("publish     1 5 5 5 0 0 1 0 0 0 0 0 0 0 0 0"));
+    size_t rows = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        rows += ('\n' == text[i]);
+    }
+    EXPECT_EQ(StageProfiler::NUM_STAGES + 1U, rows);
+}
@@ -0,0 +1,71 @@
+/*--------------------------------------------------------------------
+ * This file is part of the RcCarLights arduino application.
+ *
+ * RcCarLights is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * RcCarLights is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with RcCarLights.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright: Jochen Schales 2015
+ *
+ * --------------------------------------------------------------------*/
+
+#ifndef XENONFLOATREFERENCE_H_
+#define XENONFLOATREFERENCE_H_
+
+/**
+ * Reference of the former floating point xenon curve (percentage tables, float interpolation, result truncated to
+ * percent and multiplied by 2.55 in the light controllers). Used to verify and benchmark the fixed point
+ * implementation of XenonLightSwitchBehaviour.
+ */
+class XenonFloatReference
+{
+public:
+    /**
+     * @param pIsOn true for the switch on curve, false for the switch off curve
+     * @param pMillis time in msec since switching
+     * @return PWM value as written by the light controllers before
+     */
+    static int getPwmValue(bool pIsOn, long pMillis)
+    {
+        static const float sSwitchOn[][2] = { { 0, 100 }, { 60, 100 }, { 65, 5 }, { 250, 10 }, { 400, 7 },
+                                              { 2000, 100 } };
+        static const float sSwitchOff[][2] = { { 0, 100 }, { 60, 50 }, { 110, 10 }, { 500, 0 } };
+
+        const float (*table)[2] = pIsOn ? sSwitchOn : sSwitchOff;
+        short steps = pIsOn ? 6 : 4;
+        short index = 0;
+        short value;
+
+        while (pMillis > table[index][0])
+        {
+            if (++index >= steps)
+            {
+                return (pIsOn ? 100 : 0) * 2.55;
+            }
+        }
+
+        if (0 == index)
+        {
+            value = table[0][1];
+        }
+        else
+        {
+            value = table[index - 1][1]
+                    + (table[index][1] - table[index - 1][1]) / (table[index][0] - table[index - 1][0])
+                            * (pMillis - table[index - 1][0]);
+        }
+
+        return value * 2.55;
+    }
+};
+
+#endif /* XENONFLOATREFERENCE_H_ */
@@ -18,12 +18,82 @@
  *
  * --------------------------------------------------------------------*/
 
+#include <stdlib.h>
+
 #include "gtest/gtest.h"
 
+#include "Arduino.h"
 #include "../XenonLightSwitchBehaviour.h"
+#include "XenonFloatReference.h"
+
+// maximal deviation of the fixed point curve from the former float curve. The float curve truncated to whole percent
+// (up to 2.55 PWM units) and truncated again after scaling, the fixed point curve rounds levels and interpolation.
+static const int MAX_PWM_DEVIATION = 4;
 
 // Tests Switch setState and getState.
 TEST(XenonLightSwitchBehaviourTest, SetGet) {
 }
 
+// Light which was never switched is off
+TEST(XenonLightSwitchBehaviourTest, InitiallyOff) {
+    ArduinoMock::reset();
+    XenonLightSwitchBehaviour behaviour;
+
+    EXPECT_EQ(LightSwitchBehaviour::OFF, behaviour.getLightStatus());
+    EXPECT_EQ(0, behaviour.getBrightness());
+}
+
+// Switching on follows the former float curve and ends at full brightness
+TEST(XenonLightSwitchBehaviourTest, SwitchOnMatchesFloatCurve) {
+    ArduinoMock::reset();
+    ArduinoMock::advanceMicros(1000000);
+    XenonLightSwitchBehaviour behaviour;
+
+    behaviour.setLightStatus(LightSwitchBehaviour::ON);
+    unsigned long start = millis();
+
+    for (long t = 0; t <= 2100; ++t)
+    {
+        ArduinoMock::advanceTo((start + t) * 1000);
+        int expected = XenonFloatReference::getPwmValue(true, t);
+        EXPECT_LE(abs(behaviour.getBrightness() - expected), MAX_PWM_DEVIATION) << "at " << t << " msec";
+    }
+    EXPECT_EQ(255, behaviour.getBrightness());
+}
+
+// Switching off follows the former float curve and ends dark
+TEST(XenonLightSwitchBehaviourTest, SwitchOffMatchesFloatCurve) {
+    ArduinoMock::reset();
+    XenonLightSwitchBehaviour behaviour;
 
+    behaviour.setLightStatus(LightSwitchBehaviour::ON);
+    ArduinoMock::advanceMicros(5000000);
+    EXPECT_EQ(255, behaviour.getBrightness());
+
+    behaviour.setLightStatus(LightSwitchBehaviour::OFF);
+    unsigned long start = millis();
+
+    for (long t = 0; t <= 600; ++t)
+    {
+        ArduinoMock::advanceTo((start + t) * 1000);
+        int expected = XenonFloatReference::getPwmValue(false, t);
+        EXPECT_LE(abs(behaviour.getBrightness() - expected), MAX_PWM_DEVIATION) << "at " << t << " msec";
+    }
+    EXPECT_EQ(0, behaviour.getBrightness());
+}
+
+// Light is not steady while the switch on curve runs and steady after it
+TEST(XenonLightSwitchBehaviourTest, SteadyAfterCurve) {
+    ArduinoMock::reset();
+    ArduinoMock::advanceMicros(1000000);
+    XenonLightSwitchBehaviour behaviour;
+
+    EXPECT_TRUE(behaviour.isSteady());
+
+    behaviour.setLightStatus(LightSwitchBehaviour::ON);
+    EXPECT_FALSE(behaviour.isSteady());
+
+    ArduinoMock::advanceMicros(10000000);
+    EXPECT_TRUE(behaviour.isSteady());
+    EXPECT_EQ(255, behaviour.getBrightness());
+}